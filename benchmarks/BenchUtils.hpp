@@ -0,0 +1,26 @@
+/* Tiny timing helpers shared by the benchmarks/ executables. */
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+// Runs fn once and returns the elapsed wall time in milliseconds.
+template<typename Fn>
+double TimeMs(Fn&& fn) {
+    const auto start = Clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Keeps the optimiser from discarding a computed value.
+template<typename T>
+inline void DoNotOptimize(const T& value) {
+    static const void* volatile sink = nullptr;
+    sink = &value;
+}
+
+}
@@ -0,0 +1,118 @@
+/* Bulk spawn of 100k entities with five components: immediate
+   Coordinator::AddComponent calls versus one CommandBuffer flush. */
+#include "BenchUtils.hpp"
+#include <engine/ecs/CommandBuffer.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+struct C0 { float v[4]; };
+struct C1 { float v[4]; };
+struct C2 { float v[4]; };
+struct C3 { float v[4]; };
+struct C4 { float v[4]; };
+
+// A handful of systems with overlapping signatures, like a real frame has.
+template<int N> struct BenchSystem : ecs::System {};
+
+template<typename T>
+ecs::Signature Bit() { return ecs::Signature::Of<T>(); }
+
+template<int... Ns>
+void RegisterSystems(ecs::Coordinator& c, std::integer_sequence<int, Ns...>) {
+    const ecs::Signature sigs[] = { Bit<C0>(), Bit<C0>() | Bit<C1>(), Bit<C2>(), Bit<C1>() | Bit<C3>(), Bit<C4>(),
+                              Bit<C0>() | Bit<C4>(), Bit<C2>() | Bit<C3>(), Bit<C1>() };
+    ((c.RegisterSystem<BenchSystem<Ns>>(), c.SetSystemSignature<BenchSystem<Ns>>(sigs[Ns % 8])), ...);
+}
+
+void Setup(ecs::Coordinator& c) {
+    c.Init();
+    c.RegisterComponent<C0>();
+    c.RegisterComponent<C1>();
+    c.RegisterComponent<C2>();
+    c.RegisterComponent<C3>();
+    c.RegisterComponent<C4>();
+    RegisterSystems(c, std::make_integer_sequence<int, 16>{});
+    c.View<C0, C1>();
+    c.View<C2>();
+}
+
+}
+
+// Steady state: every round spawns `count` entities and then destroys them
+// again, so slot/array capacity is warm after the first round.
+constexpr int count = 100'000;
+constexpr int rounds = 5;
+
+template<typename SpawnFn, typename ClearFn>
+double BestOf(SpawnFn&& spawn, ClearFn&& clear) {
+    double best = 1e30;
+    for (int round = 0; round < rounds; ++round) {
+        best = std::min(best, bench::TimeMs(spawn));
+        clear();
+    }
+    return best;
+}
+
+int main() {
+    ecs::Coordinator immediate;
+    Setup(immediate);
+    std::vector<ecs::Entity> spawned;
+    spawned.reserve(count);
+
+    const double immediateMs = BestOf([&] {
+        for (int i = 0; i < count; ++i) {
+            const ecs::Entity e = immediate.CreateEntity();
+            immediate.AddComponent(e, C0{});
+            immediate.AddComponent(e, C1{});
+            immediate.AddComponent(e, C2{});
+            immediate.AddComponent(e, C3{});
+            immediate.AddComponent(e, C4{});
+            spawned.push_back(e);
+        }
+    }, [&] {
+        for (ecs::Entity e : spawned) immediate.DestroyEntity(e);
+        spawned.clear();
+    });
+
+    ecs::Coordinator buffered;
+    Setup(buffered);
+    ecs::CommandBuffer cmds;
+    double recordMs = 1e30;
+    const double bufferedMs = BestOf([&] {
+        recordMs = std::min(recordMs, bench::TimeMs([&] {
+            for (int i = 0; i < count; ++i) {
+                const ecs::Entity e = cmds.CreateEntity();
+                cmds.AddComponent(e, C0{});
+                cmds.AddComponent(e, C1{});
+                cmds.AddComponent(e, C2{});
+                cmds.AddComponent(e, C3{});
+                cmds.AddComponent(e, C4{});
+            }
+        }));
+        cmds.Flush(buffered, spawned);
+    }, [&] {
+        for (ecs::Entity e : spawned) cmds.DestroyEntity(e);
+        cmds.Flush(buffered);
+    });
+
+    ecs::Coordinator batched;
+    Setup(batched);
+    const double batchMs = BestOf([&] {
+        cmds.CreateEntities(count, C0{}, C1{}, C2{}, C3{}, C4{});
+        cmds.Flush(batched, spawned);
+    }, [&] {
+        for (ecs::Entity e : spawned) cmds.DestroyEntity(e);
+        cmds.Flush(batched);
+    });
+
+    std::printf("spawn %d entities x 5 components, 16 systems, 2 queries (best of %d)\n", count, rounds);
+    std::printf("  immediate              %8.2f ms\n", immediateMs);
+    std::printf("  command buffer         %8.2f ms (record %.2f ms)  speedup %.1fx\n",
+                bufferedMs, recordMs, immediateMs / bufferedMs);
+    std::printf("  command buffer, batch  %8.2f ms  speedup %.1fx\n", batchMs, immediateMs / batchMs);
+    return 0;
+}
@@ -0,0 +1,89 @@
+/* Compares the sparse-set ComponentArray against the previous
+   unordered_map-backed storage at 10k / 100k / 1M entities. */
+#include "BenchUtils.hpp"
+#include <engine/ecs/ComponentManager.hpp>
+
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct Transform {
+    float position[3];
+    float rotation[4];
+    float scale[3];
+};
+
+// The storage ComponentArray<T> used before the sparse-set rewrite.
+template<typename T>
+class MapComponentArray {
+public:
+    void InsertData(ecs::Entity entity, const T& component) { data.emplace(entity.index, component); }
+    void RemoveData(ecs::Entity entity) { data.erase(entity.index); }
+    T& GetData(ecs::Entity entity) { return data.at(entity.index); }
+
+    template<typename Fn>
+    void ForEach(Fn&& fn) {
+        for (auto& pair : data) fn(pair.second);
+    }
+
+private:
+    std::unordered_map<ecs::EntityIndex, T> data;
+};
+
+template<typename T>
+struct SparseAdapter {
+    ecs::ComponentArray<T> arr;
+
+    void InsertData(ecs::Entity entity, const T& component) { arr.InsertData(entity, component); }
+    void RemoveData(ecs::Entity entity) { arr.RemoveData(entity); }
+    T& GetData(ecs::Entity entity) { return arr.GetData(entity); }
+
+    template<typename Fn>
+    void ForEach(Fn&& fn) {
+        for (T& c : arr.Components()) fn(c);
+    }
+};
+
+template<typename Storage>
+void Run(const char* label, std::size_t count) {
+    std::vector<ecs::Entity> order(count);
+    for (std::size_t i = 0; i < count; ++i) order[i] = ecs::Entity{ static_cast<ecs::EntityIndex>(i), 0 };
+    std::shuffle(order.begin(), order.end(), std::mt19937(1234));
+
+    Storage storage;
+    const double insertMs = bench::TimeMs([&] {
+        for (std::size_t i = 0; i < count; ++i)
+            storage.InsertData(ecs::Entity{ static_cast<ecs::EntityIndex>(i), 0 }, Transform{ { 1, 2, 3 }, { 0, 0, 0, 1 }, { 1, 1, 1 } });
+    });
+
+    float sum = 0.0f;
+    const double randomGetMs = bench::TimeMs([&] {
+        for (ecs::Entity e : order) sum += storage.GetData(e).position[0];
+    });
+
+    const double iterateMs = bench::TimeMs([&] {
+        for (int pass = 0; pass < 10; ++pass)
+            storage.ForEach([&](Transform& t) { t.position[1] += 1.0f; sum += t.position[1]; });
+    });
+
+    const double removeMs = bench::TimeMs([&] {
+        for (std::size_t i = 0; i < count / 2; ++i) storage.RemoveData(order[i]);
+    });
+    bench::DoNotOptimize(sum);
+
+    std::printf("%-8s %8zu  insert %8.2f ms  random get %8.2f ms  iterate x10 %8.2f ms  remove half %8.2f ms\n",
+                label, count, insertMs, randomGetMs, iterateMs, removeMs);
+}
+
+}
+
+int main() {
+    for (std::size_t count : { 10'000u, 100'000u, 1'000'000u }) {
+        Run<MapComponentArray<Transform>>("map", count);
+        Run<SparseAdapter<Transform>>("sparse", count);
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+/* Frustum culling of 1M world AABBs spread over a 4 km outdoor area, camera
+   near the ground looking across it: scalar per-box test, the SIMD kernel
+   over packed bounds, and the static BVH. Then the same boxes as moving
+   ECS entities: packing their world bounds per frame from Transform and
+   MeshRenderer (what RenderSystem did for every dynamic drawable) against
+   culling the bounds TransformSystem keeps, with that upkeep timed
+   separately. Single thread. */
+#include "BenchUtils.hpp"
+#include <engine/ecs/World.hpp>
+#include <engine/systems/Culling.hpp>
+#include <engine/systems/TransformSystem.hpp>
+#include <engine/components/Camera.hpp>
+#include <engine/components/MeshRenderer.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t count = 1'000'000;
+constexpr int rounds = 10;
+
+template<typename Fn>
+double Best(Fn&& fn) {
+    double best = 1e30;
+    for (int i = 0; i < rounds; ++i) best = std::min(best, bench::TimeMs(fn));
+    return best;
+}
+
+}
+
+int main() {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> ground(-2000.0f, 2000.0f), height(0.0f, 30.0f), size(0.5f, 4.0f);
+    std::vector<Aabb> boxes;
+    boxes.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const glm::vec3 center(ground(rng), height(rng), ground(rng));
+        const glm::vec3 extents(size(rng), size(rng), size(rng));
+        boxes.push_back({ center - extents, center + extents });
+    }
+
+    Camera camera;
+    camera.farPlane = 800.0f;
+    Transform eye;
+    eye.position = glm::vec3(0.0f, 10.0f, 0.0f);
+    eye.rotation = glm::angleAxis(0.3f, glm::vec3(0.0f, 1.0f, 0.0f));
+    eye.world = eye.LocalMatrix();
+    const Frustum frustum = Frustum::FromMatrix(camera.ProjectionMatrix() * Camera::ViewMatrix(eye));
+
+    std::size_t scalarVisible = 0;
+    const double scalarMs = Best([&] {
+        scalarVisible = 0;
+        for (const Aabb& box : boxes) scalarVisible += frustum.Intersects(box);
+    });
+
+    BoundsSoA soa;
+    soa.Reserve(count);
+    for (const Aabb& box : boxes) soa.Push(box);
+    std::vector<uint32_t> visible(count);
+    std::size_t simdVisible = 0;
+    const double simdMs = Best([&] { simdVisible = CullBounds(frustum, soa, 0, count, visible.data()); });
+
+    BoundsBvh bvh;
+    const double buildMs = bench::TimeMs([&] { bvh.Build(boxes); });
+    std::vector<uint32_t> bvhVisible;
+    bvhVisible.reserve(count);
+    const double bvhMs = Best([&] {
+        bvhVisible.clear();
+        bvh.Cull(frustum, bvhVisible);
+    });
+    bench::DoNotOptimize(visible);
+
+    // the boxes as entities: a unit mesh box scaled and placed by a Transform
+    ecs::World world;
+    ecs::Coordinator& c = world.GetCoordinator();
+    c.RegisterComponent<Transform>();
+    c.RegisterComponent<MeshRenderer>();
+    std::shared_ptr<TransformSystem> transformSystem = c.RegisterSystem<TransformSystem>();
+    c.SetSystemSignature<TransformSystem>(ecs::Signature::Of<Transform>());
+    const std::vector<Aabb> meshBounds = { { glm::vec3(-1.0f), glm::vec3(1.0f) } };
+    std::vector<ecs::Entity> drawables;
+    drawables.reserve(count);
+    for (const Aabb& box : boxes) {
+        const ecs::Entity e = world.CreateEntity();
+        Transform t;
+        t.position = box.Center();
+        t.scale = box.Extents();
+        c.AddComponent(e, t);
+        c.AddComponent(e, MeshRenderer{});
+        drawables.push_back(e);
+    }
+    transformSystem->Update(0.0f);
+    for (ecs::Entity e : drawables) transformSystem->SetLocalBounds(e, meshBounds[0]);
+
+    ecs::ComponentArray<Transform>& transforms = c.GetComponentStorage<Transform>();
+    ecs::ComponentArray<MeshRenderer>& renderers = c.GetComponentStorage<MeshRenderer>();
+    BoundsSoA gathered;
+    std::size_t gatherVisible = 0;
+    uint64_t entitySink = 0;
+    const double gatherMs = Best([&] {
+        gathered.Resize(drawables.size());
+        for (std::size_t i = 0; i < drawables.size(); ++i) {
+            const glm::mat4& m = transforms.GetData(drawables[i]).world;
+            gathered.Set(i, meshBounds[renderers.GetData(drawables[i]).mesh].Transformed(m));
+        }
+        gatherVisible = CullBounds(frustum, gathered, 0, drawables.size(), visible.data());
+        for (std::size_t i = 0; i < gatherVisible; ++i) entitySink += drawables[visible[i]].index;
+    });
+
+    const BoundsSoA& kept = transformSystem->GetWorldBounds();
+    std::size_t keptVisible = 0;
+    const double keptMs = Best([&] {
+        keptVisible = CullBounds(frustum, kept, 0, kept.Size(), visible.data());
+        for (std::size_t i = 0; i < keptVisible; ++i) entitySink += transformSystem->NodeEntity(visible[i]).index;
+    });
+    bench::DoNotOptimize(entitySink);
+
+    const double idleMs = Best([&] { transformSystem->Update(0.0f); });
+    const double movedMs = Best([&] {
+        for (std::size_t i = 0; i < drawables.size(); i += 10) {
+            transforms.GetData(drawables[i]).position.y += 0.01f;
+            transformSystem->MarkDirty(drawables[i]);
+        }
+        transformSystem->Update(0.0f);
+    });
+
+    std::printf("frustum cull, %zu boxes, %zu visible (best of %d)\n", count, scalarVisible, rounds);
+    std::printf("  scalar AoS   %8.2f ms\n", scalarMs);
+    std::printf("  SIMD SoA     %8.2f ms  (%zu visible)  speedup %.1fx\n", simdMs, simdVisible, scalarMs / simdMs);
+    std::printf("  static BVH   %8.2f ms  (%zu visible)  speedup %.1fx, build %.1f ms, %zu nodes\n",
+                bvhMs, bvhVisible.size(), scalarMs / bvhMs, buildMs, bvh.NodeCount());
+    std::printf("moving entities, %zu drawables\n", drawables.size());
+    std::printf("  gather + cull            %8.2f ms  (%zu visible)\n", gatherMs, gatherVisible);
+    std::printf("  TransformSystem bounds   %8.2f ms  (%zu visible)  speedup %.1fx\n", keptMs, keptVisible, gatherMs / keptMs);
+    std::printf("  bounds upkeep, idle      %8.2f ms\n", idleMs);
+    std::printf("  update, 10%% moved        %8.2f ms  (includes the world matrices)\n", movedMs);
+    return 0;
+}
@@ -0,0 +1,71 @@
+/* Loading a 512x512-quad grid mesh (~525k triangles): parsing the OBJ
+   source versus mapping the baked .emesh and paging it in. Files live in
+   the system temp directory; the .emesh numbers are warm page cache, so
+   they show the parse cost the baked format removes. */
+#include "BenchUtils.hpp"
+#include <engine/assets/MeshLoader.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace {
+
+constexpr int grid = 512;
+constexpr int rounds = 5;
+
+template<typename Fn>
+double Best(Fn&& fn) {
+    double best = 1e30;
+    for (int i = 0; i < rounds; ++i) best = std::min(best, bench::TimeMs(fn));
+    return best;
+}
+
+void WriteGridObj(const std::filesystem::path& path) {
+    std::ofstream out(path);
+    for (int z = 0; z <= grid; ++z)
+        for (int x = 0; x <= grid; ++x)
+            out << "v " << x * 0.25f << ' ' << ((x * 7 + z * 13) % 17) * 0.01f << ' ' << z * 0.25f << '\n';
+    for (int z = 0; z <= grid; ++z)
+        for (int x = 0; x <= grid; ++x)
+            out << "vt " << float(x) / grid << ' ' << float(z) / grid << '\n';
+    out << "vn 0 1 0\n";
+    for (int z = 0; z < grid; ++z)
+        for (int x = 0; x < grid; ++x) {
+            const int a = z * (grid + 1) + x + 1, b = a + 1, c = a + grid + 1, d = c + 1;
+            out << "f " << a << '/' << a << "/1 " << c << '/' << c << "/1 " << d << '/' << d << "/1 "
+                << b << '/' << b << "/1\n";
+        }
+}
+
+}
+
+int main() {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "engine_mesh_load_bench";
+    std::filesystem::create_directories(dir);
+    const std::filesystem::path obj = dir / "grid.obj", baked = dir / "grid.emesh";
+    WriteGridObj(obj);
+
+    std::optional<MeshData> imported;
+    const double importMs = Best([&] { imported = ImportObj(obj); });
+    if (!imported || !WriteMeshFile(baked, imported->View())) return 1;
+
+    std::size_t mappedVertices = 0;
+    const double mapMs = Best([&] {
+        std::optional<MeshFile> file = MeshFile::Open(baked);
+        file->Prefetch();
+        mappedVertices = file->View().VertexCount();
+    });
+
+    const double objMb = std::filesystem::file_size(obj) / (1024.0 * 1024.0);
+    const double bakedMb = std::filesystem::file_size(baked) / (1024.0 * 1024.0);
+    std::printf("mesh load, %zu vertices, %zu triangles (best of %d)\n",
+                mappedVertices, imported->indices.size() / 3, rounds);
+    std::printf("  OBJ parse       %8.2f ms  (%.1f MB, %.0f MB/s)\n", importMs, objMb, objMb / (importMs / 1000.0));
+    std::printf("  .emesh map+page %8.2f ms  (%.1f MB)  speedup %.1fx\n", mapMs, bakedMb, importMs / mapMs);
+
+    std::error_code error;
+    std::filesystem::remove_all(dir, error);
+    return 0;
+}
@@ -0,0 +1,96 @@
+/* OBJ import throughput and index-buffer quality on a large source: a
+   terrain-like grid written in row order with v/vt/vn per corner (about
+   300 MB at the default 1536 x 1536 quads; pass another size as argv[1]).
+   Parses serially and on the JobSystem, then reports ACMR (transformed
+   vertices per triangle, FIFO cache) before and after OptimizeMesh. */
+#include "BenchUtils.hpp"
+#include <engine/assets/MeshLoader.hpp>
+#include <engine/assets/MeshOptimizer.hpp>
+#include <engine/core/JobSystem.hpp>
+
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace {
+
+void Append(std::string& out, float value) {
+    char buffer[32];
+    out.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+}
+
+void Append(std::string& out, int value) {
+    char buffer[16];
+    out.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+}
+
+void WriteGridObj(const std::filesystem::path& path, int grid) {
+    std::ofstream file(path, std::ios::binary);
+    std::string out;
+    const auto flush = [&] {
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        out.clear();
+    };
+    for (int z = 0; z <= grid; ++z) {
+        for (int x = 0; x <= grid; ++x) {
+            const float h = static_cast<float>((x * 7 + z * 13) % 17) * 0.05f;
+            out += "v "; Append(out, x * 0.5f); out += ' '; Append(out, h); out += ' '; Append(out, z * 0.5f);
+            out += "\nvt "; Append(out, float(x) / grid); out += ' '; Append(out, float(z) / grid);
+            out += "\nvn "; Append(out, h * 0.1f); out += " 0.99 "; Append(out, -h * 0.1f); out += '\n';
+        }
+        flush();
+    }
+    for (int z = 0; z < grid; ++z) {
+        for (int x = 0; x < grid; ++x) {
+            const int a = z * (grid + 1) + x + 1;
+            out += 'f';
+            for (const int v : { a, a + grid + 1, a + grid + 2, a + 1 }) {
+                out += ' '; Append(out, v); out += '/'; Append(out, v); out += '/'; Append(out, v);
+            }
+            out += '\n';
+        }
+        flush();
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    const int grid = argc > 1 ? std::atoi(argv[1]) : 1536;
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "engine_obj_import_bench";
+    std::filesystem::create_directories(dir);
+    const std::filesystem::path obj = dir / "grid.obj";
+    WriteGridObj(obj, grid);
+    const double mb = std::filesystem::file_size(obj) / (1024.0 * 1024.0);
+
+    ObjImportOptions options;
+    options.optimize = false;
+    std::optional<MeshData> mesh;
+    const double serialMs = bench::TimeMs([&] { mesh = ImportObj(obj, options); });
+    mesh.reset();
+
+    JobSystem jobs;
+    options.jobs = &jobs;
+    const double parallelMs = bench::TimeMs([&] { mesh = ImportObj(obj, options); });
+    if (!mesh) return 1;
+
+    const uint32_t vertexCount = mesh->View().VertexCount();
+    const float before16 = ComputeAcmr(mesh->indices, vertexCount, 16);
+    const float before32 = ComputeAcmr(mesh->indices, vertexCount, 32);
+    const double optimizeMs = bench::TimeMs([&] { OptimizeMesh(*mesh); });
+    const float after16 = ComputeAcmr(mesh->indices, vertexCount, 16);
+    const float after32 = ComputeAcmr(mesh->indices, vertexCount, 32);
+
+    std::printf("OBJ import, %.1f MB, %u vertices, %zu triangles\n", mb, vertexCount, mesh->indices.size() / 3);
+    std::printf("  parse, 1 thread    %9.1f ms  %7.1f MB/s\n", serialMs, mb / (serialMs / 1000.0));
+    std::printf("  parse, %2u threads  %9.1f ms  %7.1f MB/s\n", jobs.ThreadCount(), parallelMs, mb / (parallelMs / 1000.0));
+    std::printf("  optimize           %9.1f ms\n", optimizeMs);
+    std::printf("  ACMR, 16 entries   %.3f -> %.3f\n", before16, after16);
+    std::printf("  ACMR, 32 entries   %.3f -> %.3f\n", before32, after32);
+
+    std::error_code error;
+    std::filesystem::remove_all(dir, error);
+    return 0;
+}
@@ -0,0 +1,100 @@
+/* Crowd of moving boxes on a plane (density kept constant as the count
+   grows): PhysicsSystem step time, broadphase pair tests and contacts for
+   10k to 100k dynamic bodies, serial and on the JobSystem. The baseline is
+   the all-pairs box test the grid replaces, for the smallest crowd only. */
+#include "BenchUtils.hpp"
+#include <engine/ecs/World.hpp>
+#include <engine/core/JobSystem.hpp>
+#include <engine/systems/PhysicsSystem.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int frames = 30;
+constexpr float spacing = 2.5f; // average distance between neighbours
+
+struct Crowd {
+    ecs::World world;
+    std::shared_ptr<PhysicsSystem> physics;
+    std::vector<ecs::Entity> bodies;
+
+    Crowd(int count, JobSystem* jobs) {
+        ecs::Coordinator& c = world.GetCoordinator();
+        c.SetJobSystem(jobs);
+        c.RegisterComponent<Transform>();
+        c.RegisterComponent<Rigidbody>();
+        c.RegisterComponent<Collider>();
+        physics = c.RegisterSystem<PhysicsSystem>();
+        c.SetSystemSignature<PhysicsSystem>(ecs::Signature::Of<Transform, Collider>());
+        physics->SetGravity(glm::vec3(0.0f));
+
+        const float side = std::sqrt(float(count)) * spacing;
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> place(0.0f, side), speed(-1.5f, 1.5f);
+        for (int i = 0; i < count; ++i) {
+            const ecs::Entity e = world.CreateEntity();
+            Transform t;
+            t.position = glm::vec3(place(random), 0.5f, place(random));
+            c.AddComponent(e, t);
+            c.AddComponent(e, Collider{});
+            Rigidbody body;
+            body.velocity = glm::vec3(speed(random), 0.0f, speed(random));
+            c.AddComponent(e, body);
+            bodies.push_back(e);
+        }
+    }
+};
+
+void Run(const char* label, int count, JobSystem* jobs) {
+    Crowd crowd(count, jobs);
+    const double firstMs = bench::TimeMs([&] { crowd.physics->Update(1.0f / 60.0f); });
+
+    double best = 1e30, total = 0.0;
+    std::size_t tested = 0, contacts = 0, resorts = 0;
+    for (int frame = 0; frame < frames; ++frame) {
+        const double ms = bench::TimeMs([&] { crowd.physics->Update(1.0f / 60.0f); });
+        best = std::min(best, ms);
+        total += ms;
+        tested += crowd.physics->GetStats().pairsTested;
+        contacts += crowd.physics->GetStats().contacts;
+        resorts += crowd.physics->GetStats().resorted;
+    }
+    std::printf("  %-7s %6d bodies  first %7.2f ms  step %7.2f ms (avg %7.2f)  %9zu pairs tested  %6zu contacts  %zu resorts\n",
+                label, count, firstMs, best, total / frames, tested / frames, contacts / frames, resorts);
+}
+
+// Every box against every other, on the same SoA-free component data.
+void RunBaseline(int count) {
+    Crowd crowd(count, nullptr);
+    ecs::Coordinator& c = crowd.world.GetCoordinator();
+    std::vector<glm::vec3> positions;
+    for (ecs::Entity e : crowd.bodies) positions.push_back(c.GetComponent<Transform>(e).position);
+
+    std::size_t overlapping = 0;
+    const double ms = bench::TimeMs([&] {
+        for (std::size_t i = 0; i < positions.size(); ++i)
+            for (std::size_t j = i + 1; j < positions.size(); ++j)
+                overlapping += glm::all(glm::lessThanEqual(glm::abs(positions[i] - positions[j]), glm::vec3(1.0f)));
+    });
+    bench::DoNotOptimize(overlapping);
+    std::printf("  %-7s %6d bodies  all pairs %7.2f ms  %9zu pairs tested  %6zu contacts\n",
+                "baseline", count, ms, positions.size() * (positions.size() - 1) / 2, overlapping);
+}
+
+}
+
+int main() {
+    std::printf("physics step, crowd of unit boxes (best and average of %d steps)\n", frames);
+    RunBaseline(10'000);
+    JobSystem jobs;
+    for (int count : { 10'000, 30'000, 100'000 }) {
+        Run("serial", count, nullptr);
+        Run("jobs", count, &jobs);
+    }
+    return 0;
+}
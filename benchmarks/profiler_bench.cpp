@@ -0,0 +1,64 @@
+/* Cost of one profiler scope (open, close, append to the thread's ring),
+   nested and flat, and of draining a frame's worth of scopes in EndFrame.
+   Uses ProfileScope directly, so it measures the same thing whether or not
+   the build defines ENGINE_PROFILE. */
+#include "BenchUtils.hpp"
+#include <engine/core/Profiler.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+constexpr int scopesPerFrame = 10'000; // fits the ring between two EndFrames
+constexpr int frames = 50;
+
+template<typename Fn>
+double BestNsPerScope(Fn&& fn) {
+    double best = 1e30;
+    for (int frame = 0; frame < frames; ++frame) {
+        best = std::min(best, bench::TimeMs(fn) * 1e6 / scopesPerFrame);
+        Profiler::Instance().EndFrame();
+    }
+    return best;
+}
+
+}
+
+int main() {
+    Profiler& profiler = Profiler::Instance();
+    profiler.SetTraceFrames(2);
+
+    uint64_t sink = 0;
+    const double emptyNs = BestNsPerScope([&] {
+        for (int i = 0; i < scopesPerFrame; ++i) sink += Profiler::Ticks() & 1;
+    });
+    const double flatNs = BestNsPerScope([&] {
+        for (int i = 0; i < scopesPerFrame; ++i) {
+            ProfileScope scope("bench.flat");
+            sink += static_cast<uint64_t>(i);
+        }
+    });
+    const double nestedNs = BestNsPerScope([&] {
+        for (int i = 0; i < scopesPerFrame / 2; ++i) {
+            ProfileScope outer("bench.outer");
+            ProfileScope inner("bench.inner");
+            sink += static_cast<uint64_t>(i);
+        }
+    });
+    bench::DoNotOptimize(sink);
+
+    double drainMs = 1e30;
+    for (int frame = 0; frame < frames; ++frame) {
+        for (int i = 0; i < scopesPerFrame; ++i) ProfileScope scope("bench.drain");
+        drainMs = std::min(drainMs, bench::TimeMs([&] { profiler.EndFrame(); }));
+    }
+
+    std::printf("profiler scopes (best of %d frames of %d scopes)\n", frames, scopesPerFrame);
+    std::printf("  clock read          %6.1f ns\n", emptyNs);
+    std::printf("  flat scope          %6.1f ns\n", flatNs);
+    std::printf("  nested scope        %6.1f ns\n", nestedNs);
+    std::printf("  EndFrame drain      %6.3f ms (%d events)\n", drainMs, scopesPerFrame);
+    std::printf("  dropped events      %llu\n", static_cast<unsigned long long>(profiler.DroppedEvents()));
+    return 0;
+}
@@ -0,0 +1,97 @@
+/* 300k-entity level (every entity named with a Transform, two thirds with
+   a MeshRenderer, a third parented): loading it from JSON with one
+   CreateEntity/AddComponent per component, which is what a scene loader
+   without a baked format does, against InstantiateScene from a mapped
+   .escene, serial and on the JobSystem. */
+#include "BenchUtils.hpp"
+#include <engine/assets/SceneLoader.hpp>
+#include <engine/core/JobSystem.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t entityCount = 300'000;
+constexpr int runs = 5;
+
+std::string LevelJson() {
+    std::string json = "{ \"entities\": [\n";
+    for (uint32_t i = 0; i < entityCount; ++i) {
+        json += "{ \"name\": \"e" + std::to_string(i) + "\"";
+        if (i % 3 == 2) json += ", \"parent\": " + std::to_string(i - 1);
+        json += ", \"components\": [ { \"type\": \"Transform\", \"position\": [" + std::to_string(i % 1000) + ", 0, "
+                + std::to_string(i / 1000) + "], \"rotation\": [0, " + std::to_string(i % 360) + ", 0] }";
+        if (i % 3 != 0)
+            json += ", { \"type\": \"MeshRenderer\", \"mesh\": \"mesh" + std::to_string(i % 50) + "\", \"material\": \"m"
+                    + std::to_string(i % 7) + "\" }";
+        json += " ] }";
+        json += i + 1 < entityCount ? ",\n" : "\n";
+    }
+    return json + "] }";
+}
+
+struct Level {
+    ecs::World world;
+
+    Level() {
+        ecs::Coordinator& c = world.GetCoordinator();
+        c.RegisterComponent<Transform>();
+        c.RegisterComponent<MeshRenderer>();
+        c.RegisterComponent<Camera>();
+    }
+};
+
+template<typename Fn>
+double Best(Fn&& fn) {
+    double best = 1e30;
+    for (int run = 0; run < runs; ++run) best = std::min(best, fn());
+    return best;
+}
+
+}
+
+int main() {
+    const std::string json = LevelJson();
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "engine_scene_load_bench.escene";
+    const std::optional<SceneData> data = ParseSceneJson(json);
+    if (!data || !WriteSceneFile(path, *data)) return 1;
+    std::printf("scene load, %u entities, %.1f MB JSON, %.1f MB .escene (best of %d)\n", entityCount, json.size() / 1e6,
+                std::filesystem::file_size(path) / 1e6, runs);
+
+    const double jsonMs = Best([&] {
+        Level level;
+        return bench::TimeMs([&] {
+            const std::optional<SceneData> scene = ParseSceneJson(json);
+            ecs::Coordinator& c = level.world.GetCoordinator();
+            std::vector<ecs::Entity> entities;
+            for (const SceneEntity& entity : scene->entities) entities.push_back(level.world.CreateEntity(entity.name));
+            for (std::size_t i = 0; i < entities.size(); ++i) {
+                const SceneEntity& entity = scene->entities[i];
+                if (Transform transform = entity.transform.value_or(Transform{}); entity.transform) {
+                    if (transform.parent.IsValid()) transform.parent = entities[transform.parent.index];
+                    c.AddComponent(entities[i], transform);
+                }
+                if (entity.meshRenderer) c.AddComponent(entities[i], *entity.meshRenderer);
+            }
+            bench::DoNotOptimize(entities);
+        });
+    });
+    std::printf("  %-14s %8.2f ms\n", "json + add", jsonMs);
+
+    JobSystem jobs;
+    for (JobSystem* pool : { static_cast<JobSystem*>(nullptr), &jobs }) {
+        const double ms = Best([&] {
+            Level level;
+            return bench::TimeMs([&] {
+                const std::optional<SceneFile> scene = SceneFile::Open(path);
+                bench::DoNotOptimize(InstantiateScene(level.world, *scene, {}, pool));
+            });
+        });
+        std::printf("  %-14s %8.2f ms\n", pool ? "escene, jobs" : "escene, serial", ms);
+    }
+    std::filesystem::remove(path);
+    return 0;
+}
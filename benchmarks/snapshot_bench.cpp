@@ -0,0 +1,100 @@
+/* Checkpointing a 100k-entity world (Transform + MeshRenderer on every
+   entity, a TransformSystem, one cached query): the first capture, which
+   copies everything, an idle frame, a frame where 1% of the transforms
+   moved (with its delta), and a restore. The baseline copies the world the
+   naive way, a vector<T> copy per component type every frame. */
+#include "BenchUtils.hpp"
+#include <engine/components/MeshRenderer.hpp>
+#include <engine/core/JobSystem.hpp>
+#include <engine/ecs/World.hpp>
+#include <engine/ecs/WorldSnapshot.hpp>
+#include <engine/systems/TransformSystem.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+constexpr int entityCount = 100'000;
+constexpr int frames = 20;
+
+struct Level {
+    ecs::World world;
+    std::vector<ecs::Entity> entities;
+
+    explicit Level(JobSystem* jobs) {
+        ecs::Coordinator& c = world.GetCoordinator();
+        c.SetJobSystem(jobs);
+        c.RegisterComponent<Transform>();
+        c.RegisterComponent<MeshRenderer>();
+        c.RegisterSystem<TransformSystem>();
+        c.SetSystemSignature<TransformSystem>(ecs::Signature::Of<Transform>());
+        for (int i = 0; i < entityCount; ++i) {
+            const ecs::Entity e = world.CreateEntity();
+            Transform t;
+            t.position = glm::vec3(float(i % 100), float(i / 100), 0.0f);
+            c.AddComponent(e, t);
+            c.AddComponent(e, MeshRenderer{ .mesh = uint32_t(i % 64) });
+            entities.push_back(e);
+        }
+        bench::DoNotOptimize(world.View<Transform, MeshRenderer>().size());
+    }
+
+    // Moves 1% of the entities, spread out like gameplay would.
+    void MoveSome(int frame) {
+        ecs::Coordinator& c = world.GetCoordinator();
+        for (std::size_t i = frame % 100; i < entities.size(); i += 100) c.GetComponent<Transform>(entities[i]).position.z += 0.01f;
+    }
+};
+
+template<typename Fn>
+double Best(Fn&& fn) {
+    double best = 1e30;
+    for (int frame = 0; frame < frames; ++frame) best = std::min(best, bench::TimeMs([&] { fn(frame); }));
+    return best;
+}
+
+void Run(const char* label, JobSystem* jobs) {
+    Level level(jobs);
+    ecs::WorldSnapshot snapshot;
+    ecs::SnapshotDelta delta;
+    const double firstMs = bench::TimeMs([&] { snapshot.Capture(level.world); });
+    const std::size_t bytes = snapshot.Stats().bytes;
+
+    const double idleMs = Best([&](int) { snapshot.Capture(level.world, &delta); });
+    std::size_t written = 0;
+    const double movingMs = Best([&](int frame) {
+        level.MoveSome(frame);
+        written = snapshot.Capture(level.world, &delta).pagesWritten;
+    });
+    const double restoreMs = Best([&](int) { snapshot.Restore(level.world); });
+
+    std::printf("  %-8s first %6.2f ms  idle %6.3f ms  1%% moving %6.3f ms (%zu pages, %.1f KiB delta)  restore %6.2f ms  [%.1f MiB]\n",
+                label, firstMs, idleMs, movingMs, written, delta.bytes.size() / 1024.0, restoreMs, bytes / 1048576.0);
+}
+
+void RunBaseline() {
+    Level level(nullptr);
+    ecs::Coordinator& c = level.world.GetCoordinator();
+    std::vector<Transform> transforms;
+    std::vector<MeshRenderer> renderers;
+    const double ms = Best([&](int) {
+        const auto t = c.GetComponentStorage<Transform>().Components();
+        const auto r = c.GetComponentStorage<MeshRenderer>().Components();
+        transforms.assign(t.begin(), t.end());
+        renderers.assign(r.begin(), r.end());
+        bench::DoNotOptimize(transforms);
+    });
+    std::printf("  %-8s component copy every frame %6.2f ms\n", "baseline", ms);
+}
+
+}
+
+int main() {
+    std::printf("world snapshot, %d entities (best of %d frames)\n", entityCount, frames);
+    RunBaseline();
+    Run("serial", nullptr);
+    JobSystem jobs;
+    Run("jobs", &jobs);
+    return 0;
+}
@@ -0,0 +1,146 @@
+/* 200k-node transform hierarchy (20k roots, three levels below them):
+   cost of a full update, a static frame, a frame where 1% of the nodes
+   move and a frame that spawns and destroys a few leaves (patched into the
+   layout rather than relinking it), serial and on the JobSystem. The baseline recomputes every node
+   each frame, which is what TransformSystem did before dirty tracking. */
+#include "BenchUtils.hpp"
+#include <engine/ecs/World.hpp>
+#include <engine/core/JobSystem.hpp>
+#include <engine/systems/TransformSystem.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+constexpr int roots = 20'000;
+constexpr int perLevel[] = { 40'000, 60'000, 80'000 };
+constexpr int frames = 20;
+
+struct Scene {
+    ecs::World world;
+    std::shared_ptr<TransformSystem> system;
+    std::vector<ecs::Entity> nodes;
+
+    explicit Scene(JobSystem* jobs) {
+        ecs::Coordinator& c = world.GetCoordinator();
+        c.SetJobSystem(jobs);
+        c.RegisterComponent<Transform>();
+        system = c.RegisterSystem<TransformSystem>();
+        c.SetSystemSignature<TransformSystem>(ecs::Signature::Of<Transform>());
+
+        std::vector<ecs::Entity> previous;
+        for (int i = 0; i < roots; ++i) previous.push_back(Spawn(ecs::NullEntity, i));
+        for (int count : perLevel) {
+            std::vector<ecs::Entity> level;
+            for (int i = 0; i < count; ++i) level.push_back(Spawn(previous[(i * 7919u) % previous.size()], i));
+            previous = level;
+        }
+    }
+
+    ecs::Entity Spawn(ecs::Entity parent, int i) {
+        const ecs::Entity e = world.CreateEntity();
+        Transform t;
+        t.position = glm::vec3(float(i % 100), float(i % 37), 1.0f);
+        t.rotation = glm::angleAxis(0.001f * float(i), glm::vec3(0.0f, 1.0f, 0.0f));
+        t.parent = parent;
+        world.GetCoordinator().AddComponent(e, t);
+        nodes.push_back(e);
+        return e;
+    }
+
+    // Moves every 100th node (1%), spread over all levels.
+    void MoveSome(int frame) {
+        ecs::Coordinator& c = world.GetCoordinator();
+        for (std::size_t i = frame % 100; i < nodes.size(); i += 100) {
+            c.GetComponent<Transform>(nodes[i]).position.x += 0.01f;
+            system->MarkDirty(nodes[i]);
+        }
+    }
+};
+
+template<typename Fn>
+double PerFrame(Fn&& fn) {
+    double best = 1e30;
+    for (int frame = 0; frame < frames; ++frame) best = std::min(best, bench::TimeMs([&] { fn(frame); }));
+    return best;
+}
+
+void Run(const char* label, JobSystem* jobs) {
+    Scene scene(jobs);
+    const double buildMs = bench::TimeMs([&] { scene.system->Update(0.0f); });
+
+    const double rebuildMs = PerFrame([&](int) {
+        scene.system->MarkAllDirty();
+        scene.system->Update(0.0f);
+    });
+    const double fullMs = PerFrame([&](int) {
+        for (int i = 0; i < roots; ++i) scene.system->MarkDirty(scene.nodes[i]);
+        scene.system->Update(0.0f);
+    });
+    const double staticMs = PerFrame([&](int) { scene.system->Update(0.0f); });
+    const double movingMs = PerFrame([&](int frame) {
+        scene.MoveSome(frame);
+        scene.system->Update(0.0f);
+    });
+    const std::size_t movedNodes = scene.system->GetUpdatedCount();
+
+    // 16 leaves in and 16 out per frame
+    constexpr int churn = 16, churnFrames = 500;
+    std::vector<ecs::Entity> spawned;
+    double churnBestMs = 1e30, churnTotalMs = 0.0;
+    for (int frame = 0; frame < churnFrames; ++frame) {
+        const double ms = bench::TimeMs([&] {
+            for (int i = 0; i < churn; ++i) {
+                const ecs::Entity parent = scene.nodes[(static_cast<std::size_t>(frame) * churn + i) * 7919u % scene.nodes.size()];
+                const ecs::Entity e = scene.world.CreateEntity();
+                Transform t;
+                t.parent = parent;
+                scene.world.GetCoordinator().AddComponent(e, t);
+                spawned.push_back(e);
+            }
+            if (spawned.size() > 4 * churn) {
+                for (int i = 0; i < churn; ++i) scene.world.DestroyEntity(spawned[i]);
+                spawned.erase(spawned.begin(), spawned.begin() + churn);
+            }
+            scene.system->Update(0.0f);
+        });
+        churnBestMs = std::min(churnBestMs, ms);
+        churnTotalMs += ms;
+    }
+
+    std::printf("  %-8s first %7.2f ms  relink %7.2f ms  all moving %7.2f ms  static %7.3f ms  1%% moving %7.3f ms (%zu nodes)\n",
+                label, buildMs, rebuildMs, fullMs, staticMs, movingMs, movedNodes);
+    std::printf("  %-8s spawn+destroy %d leaves: best %7.3f ms  average %7.3f ms\n",
+                label, churn, churnBestMs, churnTotalMs / churnFrames);
+}
+
+// Every node, every frame, parent looked up through the component array.
+void RunBaseline() {
+    Scene scene(nullptr);
+    ecs::Coordinator& c = scene.world.GetCoordinator();
+    ecs::ComponentArray<Transform>& transforms = c.GetComponentStorage<Transform>();
+
+    const double ms = PerFrame([&](int) {
+        // nodes are in creation order, so parents come first
+        for (ecs::Entity e : scene.nodes) {
+            Transform& t = transforms.GetData(e);
+            t.local = t.LocalMatrix();
+            t.world = t.parent.IsValid() ? transforms.GetData(t.parent).world * t.local : t.local;
+        }
+    });
+    std::printf("  %-8s every node every frame %7.2f ms\n", "baseline", ms);
+}
+
+}
+
+int main() {
+    std::printf("transform hierarchy, %d nodes (best of %d frames)\n",
+                roots + perLevel[0] + perLevel[1] + perLevel[2], frames);
+    RunBaseline();
+    Run("serial", nullptr);
+    JobSystem jobs;
+    Run("jobs", &jobs);
+    return 0;
+}
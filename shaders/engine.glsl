@@ -0,0 +1,17 @@
+// Uniform blocks shared by every engine shader. The layouts must match
+// FrameUniforms / ObjectUniforms in src/engine/gl/UniformBuffer.hpp.
+
+// Written once per frame by RenderSystem (binding UniformBinding::Frame)
+layout(std140) uniform FrameData {
+    mat4 uView;
+    mat4 uProjection;
+    mat4 uViewProjection;
+    vec4 uCameraPosition;
+    vec4 uTime; // seconds since start, frame delta, frame index
+};
+
+// Per draw, for materials that are not instanced (binding UniformBinding::Object)
+layout(std140) uniform ObjectData {
+    mat4 uModel;
+    vec4 uObjectParams;
+};
@@ -0,0 +1,15 @@
+#version 330 core
+
+in vec3 vNormal;
+in vec2 vUV;
+in vec4 vParams;
+
+uniform sampler2D uTexture;
+
+out vec4 fragColor;
+
+void main() {
+    float light = 0.3 + 0.7 * max(dot(normalize(vNormal), normalize(vec3(0.4, 1.0, 0.3))), 0.0);
+    vec4 albedo = texture(uTexture, vUV) * vParams; // params.rgba tints the instance
+    fragColor = vec4(albedo.rgb * light, albedo.a);
+}
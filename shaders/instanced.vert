@@ -0,0 +1,23 @@
+#version 330 core
+
+// Mesh attributes
+layout(location = 0) in vec3 aPosition;
+layout(location = 1) in vec3 aNormal;
+layout(location = 2) in vec2 aUV;
+
+// Per-instance attributes, filled by RenderQueue (see InstanceBuffer.hpp)
+layout(location = 4) in mat4 aInstanceWorld;
+layout(location = 8) in vec4 aInstanceParams;
+
+#include "engine.glsl"
+
+out vec3 vNormal;
+out vec2 vUV;
+out vec4 vParams;
+
+void main() {
+    vNormal = mat3(aInstanceWorld) * aNormal;
+    vUV = aUV;
+    vParams = aInstanceParams;
+    gl_Position = uViewProjection * aInstanceWorld * vec4(aPosition, 1.0);
+}
@@ -1,10 +1,12 @@
 #include <iostream>
 #include <engine/core/Application.hpp>
-#include <engine/gl/Shader.hpp>
+#include <engine/gl/ShaderLibrary.hpp>
+#include <engine/gl/GLContext.hpp>
 
 // Example user behaviour similar to Unity’s MonoBehaviour
 class MyGame : public MonoBehaviour {
 private:
+    ShaderLibrary shaders;  // compiles each program once, warm starts load cached binaries
     GLuint shaderProgram = 0;
     GLuint vao = 0;
 
@@ -13,32 +15,35 @@ public:
         std::cout << "MyGame::Start() — one-time initialization\n";
 
         // Load shaders (from the shaders/ directory)
-        GLuint vert = LoadVert("triangle.vert");
-        GLuint frag = LoadFrag("triangle.frag");
-        shaderProgram = LinkProgram(vert, frag);
+        shaderProgram = shaders.Load("triangle.vert", "triangle.frag");
 
         // Create a dummy VAO to satisfy core profile requirements
-        glGenVertexArrays(1, &vao);
-        glBindVertexArray(vao);
+        GLContext& gl = GLContext::Instance();
+        gl.GenVertexArrays(1, &vao);
+        gl.BindVertexArray(vao);
     }
 
     void Update(float dt) override {
+        // State goes through the GL context, which drops calls that change nothing
+        GLContext& gl = GLContext::Instance();
+
         // Clear the screen
-        glClearColor(0.1f, 0.15f, 0.2f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+        gl.ClearColor(0.1f, 0.15f, 0.2f, 1.0f);
+        gl.Clear(GL_COLOR_BUFFER_BIT);
 
         // Use the shader
-        glUseProgram(shaderProgram);
+        gl.UseProgram(shaderProgram);
 
         // Bind VAO and draw
-        glBindVertexArray(vao);
-        glDrawArrays(GL_TRIANGLES, 0, 3);
+        gl.BindVertexArray(vao);
+        gl.DrawArrays(GL_TRIANGLES, 0, 3);
     }
 
     void OnExit() override {
         std::cout << "MyGame::OnExit() — cleanup before exit\n";
-        glDeleteVertexArrays(1, &vao);
-        glDeleteProgram(shaderProgram);
+        GLContext& gl = GLContext::Instance();
+        gl.DeleteVertexArrays(1, &vao);
+        shaders.Clear();
     }
 };
 
@@ -0,0 +1,259 @@
+#include "AssetManager.hpp"
+#include "../core/JobSystem.hpp"
+#include <cassert>
+#include <chrono>
+
+AssetManager::AssetManager(JobSystem* jobSystem) : AssetManager(jobSystem, ASSET_DIR) {}
+
+AssetManager::AssetManager(JobSystem* jobSystem, std::filesystem::path rootDirectory)
+    : jobs(jobSystem), root(std::move(rootDirectory)), inFlight(std::make_unique<JobCounter>()) {}
+
+// Decode jobs reference slots, so they must finish before the slots go.
+// GPU objects cannot be freed here (no backend); call Clear() first.
+AssetManager::~AssetManager() {
+    if (jobs) jobs->Wait(*inFlight);
+}
+
+void AssetManager::RegisterErased(std::type_index type, Loader loader) {
+    std::lock_guard<std::mutex> lock(mutex);
+    assert(loaders.find(type) == loaders.end() && "AssetManager: loader registered twice.");
+    loaders.emplace(type, std::move(loader));
+}
+
+std::filesystem::path AssetManager::Resolve(const std::string& path) const {
+    const std::filesystem::path p(path);
+    return p.is_absolute() ? p : root / p;
+}
+
+uint32_t AssetManager::Acquire(std::type_index type, const std::string& path) {
+    std::unique_lock<std::mutex> lock(mutex);
+    ++stats.requests;
+
+    auto loaderIt = loaders.find(type);
+    assert(loaderIt != loaders.end() && "AssetManager::Load: no loader registered for this type.");
+    Loader& loader = loaderIt->second;
+
+    auto [it, inserted] = loader.byPath.try_emplace(path, 0);
+    if (!inserted) {
+        ++stats.deduplicated;
+        ++slots[it->second].refs; // revives it if it was released but not yet unloaded
+        return it->second;
+    }
+
+    uint32_t index;
+    if (!freeSlots.empty()) {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        index = static_cast<uint32_t>(slots.size());
+        slots.emplace_back();
+    }
+    it->second = index;
+
+    Slot& slot = slots[index];
+    slot.refs = 1;
+    slot.state = AssetState::Loading;
+    slot.loader = &loader;
+    slot.path = path;
+    ++loading;
+
+    if (!jobs) {
+        undecoded.push_back(index);
+        return index;
+    }
+    lock.unlock();
+    jobs->Submit([this, index] { Decode(index); }, inFlight.get());
+    return index;
+}
+
+// Runs without the lock: reading and decoding is the slow part, and only
+// this job touches the slot's loader and path until it reports back.
+void AssetManager::Decode(uint32_t index) {
+    Loader* loader;
+    std::filesystem::path path;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        loader = slots[index].loader;
+        path = Resolve(slots[index].path);
+    }
+
+    Erased decoded = loader ? loader->decode(path) : nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Slot& slot = slots[index];
+    if (!decoded || !slot.loader) {
+        slot.state = AssetState::Failed;
+        ++stats.failed;
+        --loading;
+        return;
+    }
+    ++stats.decoded;
+    if (!slot.loader->upload) {
+        slot.value = std::move(decoded);
+        slot.state = AssetState::Ready;
+        --loading;
+        return;
+    }
+    slot.decoded = std::move(decoded);
+    slot.state = AssetState::Uploading;
+    decodedQueue.push_back(index);
+}
+
+// Called with the lock held; the upload itself is GL work on this thread.
+void AssetManager::Upload(GLBackend& gl, uint32_t index) {
+    Slot& slot = slots[index];
+    --loading;
+    Erased decoded = std::move(slot.decoded);
+    if (slot.refs == 0) {
+        // nobody wants it any more; Poll() frees the slot
+        slot.state = AssetState::Failed;
+        return;
+    }
+    slot.value = slot.loader->upload(gl, decoded.get());
+    slot.state = slot.value ? AssetState::Ready : AssetState::Failed;
+    if (!slot.value) {
+        ++stats.failed;
+        return;
+    }
+    ++stats.uploaded;
+    if (residency && slot.loader->restream) {
+        // the decoded form is where higher levels stream back in from
+        const ResidencyLevels levels = slot.loader->describe(gl, decoded.get());
+        residency->Add(index, levels.bytes, levels.baseSize);
+        slot.decoded = std::move(decoded);
+    }
+}
+
+void AssetManager::Free(GLBackend& gl, uint32_t index) {
+    Slot& slot = slots[index];
+    if (slot.value && slot.loader && slot.loader->unload) slot.loader->unload(gl, slot.value.get());
+    if (slot.loader) slot.loader->byPath.erase(slot.path);
+    if (residency) residency->Remove(index);
+    slot = Slot{};
+    freeSlots.push_back(index);
+    ++stats.unloaded;
+}
+
+std::size_t AssetManager::Poll(GLBackend& gl, double budgetMs) {
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    const auto elapsedMs = [&] { return std::chrono::duration<double, std::milli>(Clock::now() - start).count(); };
+
+    std::unique_lock<std::mutex> lock(mutex);
+    stats.uploaded = 0;
+
+    // no JobSystem: decode here, inside the same budget
+    for (bool first = true; !undecoded.empty() && (first || elapsedMs() < budgetMs); first = false) {
+        const uint32_t index = undecoded.front();
+        undecoded.pop_front();
+        lock.unlock();
+        Decode(index);
+        lock.lock();
+    }
+
+    std::size_t next = 0;
+    for (bool first = true; next < decodedQueue.size(); first = false) {
+        if (!first && elapsedMs() >= budgetMs) break;
+        Upload(gl, decodedQueue[next++]);
+    }
+    decodedQueue.erase(decodedQueue.begin(), decodedQueue.begin() + static_cast<std::ptrdiff_t>(next));
+    stats.uploadMs = elapsedMs();
+
+    // released slots are unloaded unless revived or still being decoded
+    std::size_t kept = 0;
+    for (uint32_t index : released) {
+        Slot& slot = slots[index];
+        if (slot.refs > 0) {
+            slot.queuedForRelease = false;
+        } else if (slot.state == AssetState::Loading || slot.state == AssetState::Uploading) {
+            released[kept++] = index;
+        } else {
+            Free(gl, index);
+        }
+    }
+    released.resize(kept);
+
+    stats.resident = static_cast<uint32_t>(slots.size() - freeSlots.size());
+    return loading;
+}
+
+void AssetManager::Flush(GLBackend& gl) {
+    for (;;) {
+        if (jobs) jobs->Wait(*inFlight);
+        if (Poll(gl, 1e9) == 0) return;
+    }
+}
+
+void AssetManager::Clear(GLBackend& gl) {
+    if (jobs) jobs->Wait(*inFlight);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    undecoded.clear();
+    decodedQueue.clear();
+    released.clear();
+    loading = 0;
+    for (uint32_t index = 0; index < slots.size(); ++index) {
+        Slot& slot = slots[index];
+        if (!slot.loader) continue;
+        if (slot.refs == 0) {
+            Free(gl, index);
+            continue;
+        }
+        // still referenced: unload now, the slot itself goes with the last handle
+        if (slot.value && slot.loader->unload) slot.loader->unload(gl, slot.value.get());
+        slot.loader->byPath.erase(slot.path);
+        if (residency) residency->Remove(index);
+        slot.loader = nullptr;
+        slot.decoded.reset();
+        slot.value.reset();
+        slot.state = AssetState::Failed;
+    }
+    stats.resident = static_cast<uint32_t>(slots.size() - freeSlots.size());
+}
+
+void AssetManager::SetResidency(ResidencyManager* residencyManager) {
+    std::lock_guard<std::mutex> lock(mutex);
+    residency = residencyManager;
+}
+
+void AssetManager::UpdateResidency(GLBackend& gl) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!residency) return;
+    for (const ResidencyChange& change : residency->Update()) {
+        Slot& slot = slots[change.key];
+        if (!slot.loader || !slot.value || !slot.decoded) continue;
+        slot.loader->restream(gl, slot.value.get(), slot.decoded.get(), change.to);
+        slot.evicted = !residency->Resident(change.key);
+    }
+}
+
+void AssetManager::Touch(uint32_t index, float screenSize) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (residency) residency->Touch(index, screenSize);
+}
+
+void AssetManager::Retain(uint32_t index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++slots[index].refs;
+}
+
+void AssetManager::Release(uint32_t index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Slot& slot = slots[index];
+    assert(slot.refs > 0 && "AssetManager: handle released twice.");
+    if (--slot.refs > 0 || slot.queuedForRelease) return;
+    slot.queuedForRelease = true;
+    released.push_back(index);
+}
+
+const void* AssetManager::Value(uint32_t index) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Slot& slot = slots[index];
+    return slot.state == AssetState::Ready && !slot.evicted ? slot.value.get() : nullptr;
+}
+
+AssetState AssetManager::StateOf(uint32_t index) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Slot& slot = slots[index];
+    return slot.evicted ? AssetState::Uploading : slot.state;
+}
@@ -0,0 +1,294 @@
+/* Asynchronous, deduplicating asset loading.
+
+   Load<T>(path) returns an Asset<T> handle immediately. The file is read
+   and decoded on the JobSystem by the loader registered for T; Poll() runs
+   the loader's GPU upload on the GL thread, within a time budget per call,
+   so a level that requests thousands of assets streams in over a few
+   frames instead of freezing the window. Until then Get() returns null and
+   the caller draws without (or with a placeholder).
+
+   Every (type, path) pair is loaded once: concurrent and later requests
+   for it share the same slot. Handles are reference counted; when the
+   last one goes away the asset is unloaded by the next Poll() (its GPU
+   objects are freed there, on the GL thread). Requesting it again before
+   that just revives it. A failed load stays failed while handles to it
+   exist; it is retried once they are all gone.
+
+   A loader is two functions: Decode (any thread: path -> CPU data, or
+   nullopt on failure) and Upload (GL thread: CPU data -> T). Types without
+   a GPU part register only Decode and become ready without an upload.
+   Relative paths are resolved against the manager's root (ASSET_DIR).
+
+   With a ResidencyManager (SetResidency), types registered through
+   RegisterStreaming are kept under its GPU budget: their decoded form stays
+   mapped after the upload, the render path reports use with
+   Asset::Touch, and UpdateResidency() moves them to a different first
+   level (or evicts them) as the policy decides. An evicted asset reads as
+   Uploading (Get() is null) until a Touch brings it back, and its GPU
+   names may change whenever its levels do, so read them every frame.
+   RenderSystem does both for the meshes and textures it is given as
+   handles; Application calls UpdateResidency() after each frame's draws.
+
+example usage:
+
+AssetManager assets(&jobs);
+assets.RegisterLoader<Texture, DecodedImage>(DecodeImage, UploadTexture, DeleteTexture);
+Asset<Texture> brick = assets.Load<Texture>("textures/brick.png");
+...
+assets.Poll(gl, 2.0);                        // every frame
+if (const Texture* texture = brick.Get()) Bind(*texture);
+brick.Touch(screenSize);                     // with a ResidencyManager
+assets.UpdateResidency(gl);                  // after the frame is drawn */
+#pragma once
+#include "ResidencyManager.hpp"
+#include "../gl/GLBackend.hpp"
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class JobSystem;
+struct JobCounter;
+class AssetManager;
+
+enum class AssetState : uint8_t { Loading, Uploading, Ready, Failed };
+
+struct AssetStats {
+    uint32_t requests = 0;      // Load calls
+    uint32_t deduplicated = 0;  // Load calls served by an existing slot
+    uint32_t decoded = 0;
+    uint32_t uploaded = 0;      // uploads finished in the last Poll
+    uint32_t failed = 0;
+    uint32_t unloaded = 0;
+    uint32_t resident = 0;      // slots alive after the last Poll
+    double uploadMs = 0.0;      // time spent uploading in the last Poll
+};
+
+// Reference-counted handle to one asset slot. Cheap to copy; null when
+// default-constructed.
+template<typename T>
+class Asset {
+public:
+    Asset() = default;
+    Asset(const Asset& other) : manager(other.manager), slot(other.slot) { Retain(); }
+    Asset(Asset&& other) noexcept : manager(std::exchange(other.manager, nullptr)), slot(other.slot) {}
+    Asset& operator=(Asset other) noexcept {
+        std::swap(manager, other.manager);
+        std::swap(slot, other.slot);
+        return *this;
+    }
+    ~Asset() { Release(); }
+
+    // Null until the asset is ready (and forever if it failed).
+    const T* Get() const;
+    AssetState State() const;
+    bool Ready() const { return State() == AssetState::Ready; }
+    bool Failed() const { return State() == AssetState::Failed; }
+
+    explicit operator bool() const { return manager != nullptr; }
+    uint32_t Slot() const { return slot; }
+    // Drawn this frame at `screenSize` pixels; see ResidencyManager::Touch.
+    void Touch(float screenSize) const;
+    bool operator==(const Asset& other) const { return manager == other.manager && slot == other.slot; }
+
+private:
+    friend class AssetManager;
+    Asset(AssetManager* owner, uint32_t index) : manager(owner), slot(index) {}
+
+    void Retain() const;
+    void Release();
+
+    AssetManager* manager = nullptr;
+    uint32_t slot = 0;
+};
+
+class AssetManager {
+public:
+    // `jobs` runs reads and decodes; null decodes inside Poll() instead.
+    explicit AssetManager(JobSystem* jobs = nullptr); // root is ASSET_DIR
+    AssetManager(JobSystem* jobs, std::filesystem::path root);
+    ~AssetManager();
+
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+
+    template<typename T, typename Decoded>
+    void RegisterLoader(std::function<std::optional<Decoded>(const std::filesystem::path&)> decode,
+                        std::function<std::optional<T>(GLBackend&, Decoded&)> upload,
+                        std::function<void(GLBackend&, T&)> unload = {});
+
+    // CPU-only assets: ready as soon as they are decoded.
+    template<typename T>
+    void RegisterLoader(std::function<std::optional<T>(const std::filesystem::path&)> decode);
+
+    // Lets T's levels be changed after the upload: `describe` gives the GPU
+    // bytes per level of a decoded asset as `gl` would store them (a backend
+    // may have to expand a format it lacks), `restream` replaces the value's GPU
+    // objects with levels firstLevel.. of `decoded` (none: evicted). Only
+    // takes effect with a ResidencyManager.
+    template<typename T, typename Decoded>
+    void RegisterStreaming(std::function<ResidencyLevels(GLBackend& gl, const Decoded&)> describe,
+                           std::function<void(GLBackend&, T&, const Decoded&, uint32_t firstLevel)> restream);
+
+    // Budgets every streaming asset uploaded from now on; set it before the
+    // first Load. Null turns residency off.
+    void SetResidency(ResidencyManager* residency);
+    ResidencyManager* Residency() const { return residency; }
+
+    // Closes the frame for the ResidencyManager and applies its changes.
+    // Call once per frame on the GL thread, after the frame's Touch calls.
+    void UpdateResidency(GLBackend& gl);
+
+    // Never blocks. The loader for T must be registered.
+    template<typename T>
+    Asset<T> Load(const std::string& path);
+
+    // Finishes decoded assets on the calling (GL) thread until `budgetMs`
+    // is spent (at least one upload per call, so loading always makes
+    // progress), then unloads released assets. Returns how many assets are
+    // still loading or waiting for upload.
+    std::size_t Poll(GLBackend& gl, double budgetMs = 2.0);
+
+    // Waits for every outstanding load, helping the JobSystem, and uploads
+    // everything. For loading screens and tests.
+    void Flush(GLBackend& gl);
+
+    // Unloads every asset, including ones still referenced; their handles
+    // read as failed afterwards. Call while the context is alive.
+    void Clear(GLBackend& gl);
+
+    std::filesystem::path Resolve(const std::string& path) const;
+    const AssetStats& GetStats() const { return stats; }
+
+private:
+    template<typename T> friend class Asset;
+
+    using Erased = std::shared_ptr<void>;
+
+    struct Loader {
+        std::function<Erased(const std::filesystem::path&)> decode;
+        std::function<Erased(GLBackend&, void* decoded)> upload; // empty: decoded is the value
+        std::function<void(GLBackend&, void* value)> unload;
+        std::function<ResidencyLevels(GLBackend&, const void* decoded)> describe;
+        std::function<void(GLBackend&, void* value, const void* decoded, uint32_t firstLevel)> restream;
+        std::unordered_map<std::string, uint32_t> byPath;
+    };
+
+    struct Slot {
+        int refs = 0;
+        AssetState state = AssetState::Loading;
+        bool queuedForRelease = false;
+        bool evicted = false;     // by the ResidencyManager
+        Loader* loader = nullptr; // null once Clear() orphaned the slot
+        std::string path;
+        Erased decoded; // set by the decode job, consumed by the upload (kept while streaming)
+        Erased value;
+    };
+
+    void RegisterErased(std::type_index type, Loader loader);
+    uint32_t Acquire(std::type_index type, const std::string& path);
+    void Decode(uint32_t index);
+    void Upload(GLBackend& gl, uint32_t index);
+    void Free(GLBackend& gl, uint32_t index);
+    void Retain(uint32_t index);
+    void Release(uint32_t index);
+    void Touch(uint32_t index, float screenSize);
+    const void* Value(uint32_t index) const;
+    AssetState StateOf(uint32_t index) const;
+
+    JobSystem* jobs;
+    std::filesystem::path root;
+    std::unique_ptr<JobCounter> inFlight;
+    ResidencyManager* residency = nullptr; // keyed by slot index
+
+    mutable std::mutex mutex;                 // guards everything below; decode jobs run unlocked
+    std::unordered_map<std::type_index, Loader> loaders;
+    std::deque<Slot> slots;                   // stable addresses for the decode jobs
+    std::vector<uint32_t> freeSlots;
+    std::deque<uint32_t> undecoded;           // without a JobSystem: decoded in Poll()
+    std::vector<uint32_t> decodedQueue;       // waiting for upload, in completion order
+    std::vector<uint32_t> released;           // refs hit zero; unloaded by Poll() unless revived
+    std::size_t loading = 0;                  // slots in Loading or Uploading
+    AssetStats stats;
+};
+
+template<typename T, typename Decoded>
+void AssetManager::RegisterLoader(std::function<std::optional<Decoded>(const std::filesystem::path&)> decode,
+                                  std::function<std::optional<T>(GLBackend&, Decoded&)> upload,
+                                  std::function<void(GLBackend&, T&)> unload) {
+    Loader loader;
+    loader.decode = [decode = std::move(decode)](const std::filesystem::path& path) -> Erased {
+        std::optional<Decoded> decoded = decode(path);
+        return decoded ? std::make_shared<Decoded>(std::move(*decoded)) : nullptr;
+    };
+    loader.upload = [upload = std::move(upload)](GLBackend& gl, void* decoded) -> Erased {
+        std::optional<T> value = upload(gl, *static_cast<Decoded*>(decoded));
+        return value ? std::make_shared<T>(std::move(*value)) : nullptr;
+    };
+    if (unload)
+        loader.unload = [unload = std::move(unload)](GLBackend& gl, void* value) { unload(gl, *static_cast<T*>(value)); };
+    RegisterErased(std::type_index(typeid(T)), std::move(loader));
+}
+
+template<typename T>
+void AssetManager::RegisterLoader(std::function<std::optional<T>(const std::filesystem::path&)> decode) {
+    Loader loader;
+    loader.decode = [decode = std::move(decode)](const std::filesystem::path& path) -> Erased {
+        std::optional<T> value = decode(path);
+        return value ? std::make_shared<T>(std::move(*value)) : nullptr;
+    };
+    RegisterErased(std::type_index(typeid(T)), std::move(loader));
+}
+
+template<typename T, typename Decoded>
+void AssetManager::RegisterStreaming(std::function<ResidencyLevels(GLBackend&, const Decoded&)> describe,
+                                     std::function<void(GLBackend&, T&, const Decoded&, uint32_t firstLevel)> restream) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = loaders.find(std::type_index(typeid(T)));
+    assert(it != loaders.end() && it->second.upload && "AssetManager::RegisterStreaming: register T's GPU loader first.");
+    it->second.describe = [describe = std::move(describe)](GLBackend& gl, const void* decoded) {
+        return describe(gl, *static_cast<const Decoded*>(decoded));
+    };
+    it->second.restream = [restream = std::move(restream)](GLBackend& gl, void* value, const void* decoded, uint32_t firstLevel) {
+        restream(gl, *static_cast<T*>(value), *static_cast<const Decoded*>(decoded), firstLevel);
+    };
+}
+
+template<typename T>
+Asset<T> AssetManager::Load(const std::string& path) {
+    return Asset<T>(this, Acquire(std::type_index(typeid(T)), path));
+}
+
+template<typename T>
+const T* Asset<T>::Get() const {
+    return manager ? static_cast<const T*>(manager->Value(slot)) : nullptr;
+}
+
+template<typename T>
+AssetState Asset<T>::State() const {
+    return manager ? manager->StateOf(slot) : AssetState::Failed;
+}
+
+template<typename T>
+void Asset<T>::Touch(float screenSize) const {
+    if (manager) manager->Touch(slot, screenSize);
+}
+
+template<typename T>
+void Asset<T>::Retain() const {
+    if (manager) manager->Retain(slot);
+}
+
+template<typename T>
+void Asset<T>::Release() {
+    if (manager) std::exchange(manager, nullptr)->Release(slot);
+}
@@ -0,0 +1,100 @@
+#include "MeshFile.hpp"
+#include <cstring>
+#include <fstream>
+#include <system_error>
+
+namespace {
+
+constexpr uint64_t Align16(uint64_t offset) { return (offset + 15) & ~uint64_t{ 15 }; }
+
+// Section [offset, offset + bytes) lies inside the file and is aligned for its elements.
+bool SectionFits(uint64_t offset, uint64_t bytes, uint64_t fileSize) {
+    return offset % 16 == 0 && offset <= fileSize && bytes <= fileSize - offset;
+}
+
+}
+
+bool WriteMeshFile(const std::filesystem::path& path, const MeshView& mesh) {
+    MeshFileHeader header{};
+    header.magic = MeshFileMagic;
+    header.version = MeshFileVersion;
+    header.vertexCount = mesh.VertexCount();
+    header.indexCount = static_cast<uint32_t>(mesh.indices.size());
+    header.vertexStride = mesh.vertexStride;
+    header.attributeCount = static_cast<uint32_t>(mesh.attributes.size());
+    header.submeshCount = static_cast<uint32_t>(mesh.submeshes.size());
+    header.attributesOffset = Align16(sizeof(MeshFileHeader));
+    header.submeshesOffset = Align16(header.attributesOffset + mesh.attributes.size_bytes());
+    header.verticesOffset = Align16(header.submeshesOffset + mesh.submeshes.size_bytes());
+    header.indicesOffset = Align16(header.verticesOffset + mesh.vertices.size_bytes());
+    header.fileSize = header.indicesOffset + mesh.indices.size_bytes();
+    std::memcpy(header.boundsMin, &mesh.bounds.min, sizeof(header.boundsMin));
+    std::memcpy(header.boundsMax, &mesh.bounds.max, sizeof(header.boundsMax));
+
+    std::error_code error;
+    if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path(), error);
+    const std::filesystem::path temporary = std::filesystem::path(path).concat(".tmp");
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+
+        uint64_t written = 0;
+        const auto write = [&](uint64_t offset, const void* data, std::size_t bytes) {
+            static constexpr char zeros[16] = {};
+            out.write(zeros, static_cast<std::streamsize>(offset - written));
+            out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+            written = offset + bytes;
+        };
+        write(0, &header, sizeof(header));
+        write(header.attributesOffset, mesh.attributes.data(), mesh.attributes.size_bytes());
+        write(header.submeshesOffset, mesh.submeshes.data(), mesh.submeshes.size_bytes());
+        write(header.verticesOffset, mesh.vertices.data(), mesh.vertices.size_bytes());
+        write(header.indicesOffset, mesh.indices.data(), mesh.indices.size_bytes());
+        if (!out) return false;
+    }
+    std::filesystem::rename(temporary, path, error);
+    if (error) std::filesystem::remove(temporary, error);
+    return !error;
+}
+
+std::optional<MeshFile> MeshFile::Open(const std::filesystem::path& path) {
+    std::optional<MappedFile> mapped = MappedFile::Open(path);
+    if (!mapped || mapped->Size() < sizeof(MeshFileHeader)) return std::nullopt;
+
+    // mappings are page aligned, so the header can be read in place
+    const auto* header = reinterpret_cast<const MeshFileHeader*>(mapped->Data());
+    const uint64_t size = mapped->Size();
+    if (header->magic != MeshFileMagic || header->version != MeshFileVersion || header->fileSize != size)
+        return std::nullopt;
+    if (header->vertexStride == 0 && header->vertexCount != 0) return std::nullopt;
+    if (!SectionFits(header->attributesOffset, uint64_t{ header->attributeCount } * sizeof(MeshAttribute), size)
+        || !SectionFits(header->submeshesOffset, uint64_t{ header->submeshCount } * sizeof(MeshSubmesh), size)
+        || !SectionFits(header->verticesOffset, uint64_t{ header->vertexCount } * header->vertexStride, size)
+        || !SectionFits(header->indicesOffset, uint64_t{ header->indexCount } * sizeof(uint32_t), size))
+        return std::nullopt;
+
+    const auto* attributes = reinterpret_cast<const MeshAttribute*>(mapped->Data() + header->attributesOffset);
+    for (uint32_t i = 0; i < header->attributeCount; ++i)
+        if (attributes[i].components == 0 || attributes[i].components > 4 || attributes[i].offset >= header->vertexStride)
+            return std::nullopt;
+    const auto* submeshes = reinterpret_cast<const MeshSubmesh*>(mapped->Data() + header->submeshesOffset);
+    for (uint32_t i = 0; i < header->submeshCount; ++i)
+        if (uint64_t{ submeshes[i].firstIndex } + submeshes[i].indexCount > header->indexCount) return std::nullopt;
+
+    MeshFile file(std::move(*mapped));
+    file.header = reinterpret_cast<const MeshFileHeader*>(file.file.Data());
+    return file;
+}
+
+MeshView MeshFile::View() const {
+    const std::byte* base = file.Data();
+    MeshView view;
+    view.attributes = { reinterpret_cast<const MeshAttribute*>(base + header->attributesOffset), header->attributeCount };
+    view.vertexStride = header->vertexStride;
+    view.vertices = { base + header->verticesOffset, std::size_t{ header->vertexCount } * header->vertexStride };
+    view.indices = { reinterpret_cast<const uint32_t*>(base + header->indicesOffset), header->indexCount };
+    view.submeshes = { reinterpret_cast<const MeshSubmesh*>(base + header->submeshesOffset), header->submeshCount };
+    std::memcpy(&view.bounds.min, header->boundsMin, sizeof(header->boundsMin));
+    std::memcpy(&view.bounds.max, header->boundsMax, sizeof(header->boundsMax));
+    return view;
+}
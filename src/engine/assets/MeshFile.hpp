@@ -0,0 +1,119 @@
+/* Baked binary mesh container (.emesh).
+
+   Layout, little-endian, every section 16-byte aligned:
+
+     MeshFileHeader
+     MeshAttribute[attributeCount]   vertex layout: location, components, type, offset
+     MeshSubmesh[submeshCount]       index ranges with their own bounds
+     vertex blob                     vertexCount * vertexStride bytes, interleaved
+     index blob                      indexCount uint32_t
+
+   The sections are exactly what the GL buffers and VertexAttribPointer
+   calls need, so MeshFile maps the file and hands out spans into the
+   mapping: loading does no parsing and no copies, and costs what paging
+   the file in costs. Open() checks the header and that every section lies
+   inside the file; index values are trusted (the file is our own baked
+   output). Files are produced by WriteMeshFile, usually through the
+   mesh_compiler tool (src/tools/mesh_compiler).
+
+example usage:
+
+WriteMeshFile("rock.emesh", ImportObj("rock.obj")->View());
+std::optional<MeshFile> file = MeshFile::Open("rock.emesh");
+MeshAsset mesh = UploadMesh(gl, file->View()); */
+#pragma once
+#include "../utils/Aabb.hpp"
+#include "../utils/MappedFile.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <vector>
+
+inline constexpr uint32_t MeshFileMagic = 0x48534D45; // "EMSH"
+inline constexpr uint32_t MeshFileVersion = 1;
+
+struct MeshFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t vertexStride;
+    uint32_t attributeCount;
+    uint32_t submeshCount;
+    uint32_t reserved;
+    uint64_t attributesOffset;
+    uint64_t submeshesOffset;
+    uint64_t verticesOffset;
+    uint64_t indicesOffset;
+    uint64_t fileSize;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+struct MeshAttribute {
+    uint32_t location;   // shader attribute location
+    uint32_t components; // 1..4
+    uint32_t type;       // GL_FLOAT, GL_UNSIGNED_BYTE, ...
+    uint32_t normalized;
+    uint32_t offset;     // within a vertex
+};
+
+struct MeshSubmesh {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t material;   // index into the source's material list
+    uint32_t reserved;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+static_assert(sizeof(MeshFileHeader) == 96 && sizeof(MeshAttribute) == 20 && sizeof(MeshSubmesh) == 40,
+              "The .emesh layout is part of the file format.");
+
+// Non-owning view of a mesh in upload-ready form.
+struct MeshView {
+    std::span<const MeshAttribute> attributes;
+    uint32_t vertexStride = 0;
+    std::span<const std::byte> vertices;
+    std::span<const uint32_t> indices;
+    std::span<const MeshSubmesh> submeshes;
+    Aabb bounds;
+
+    uint32_t VertexCount() const { return vertexStride ? static_cast<uint32_t>(vertices.size() / vertexStride) : 0; }
+};
+
+// Owning mesh in the same form, as importers produce it.
+struct MeshData {
+    std::vector<MeshAttribute> attributes;
+    uint32_t vertexStride = 0;
+    std::vector<std::byte> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<MeshSubmesh> submeshes;
+    Aabb bounds;
+
+    MeshView View() const { return { attributes, vertexStride, vertices, indices, submeshes, bounds }; }
+};
+
+// Writes through a temporary file and a rename, like ShaderCache.
+bool WriteMeshFile(const std::filesystem::path& path, const MeshView& mesh);
+
+class MeshFile {
+public:
+    // nullopt if the file is missing, foreign, another version or damaged.
+    static std::optional<MeshFile> Open(const std::filesystem::path& path);
+
+    const MeshFileHeader& Header() const { return *header; }
+    // Spans point into the mapping; valid while this MeshFile lives.
+    MeshView View() const;
+
+    // Pages the whole file in (see MappedFile::Prefetch).
+    void Prefetch() const { file.Prefetch(); }
+
+private:
+    explicit MeshFile(MappedFile mapped) : file(std::move(mapped)) {}
+
+    MappedFile file;
+    const MeshFileHeader* header = nullptr;
+};
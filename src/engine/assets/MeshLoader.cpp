@@ -0,0 +1,463 @@
+#include "MeshLoader.hpp"
+#include "AssetManager.hpp"
+#include "MeshOptimizer.hpp"
+#include "../core/JobSystem.hpp"
+#include "../utils/MappedFile.hpp"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <string>
+
+std::vector<MeshAttribute> StandardMeshLayout() {
+    return {
+        { 0, 3, GL_FLOAT, GL_FALSE, offsetof(StandardVertex, position) },
+        { 1, 3, GL_FLOAT, GL_FALSE, offsetof(StandardVertex, normal) },
+        { 2, 2, GL_FLOAT, GL_FALSE, offsetof(StandardVertex, uv) },
+    };
+}
+
+namespace {
+
+constexpr uint32_t Unassigned = ~0u;
+
+bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+struct LineReader {
+    const char* p;
+    const char* end; // end of the line
+
+    void SkipSpaces() { while (p < end && IsSpace(*p)) ++p; }
+    bool AtEnd() { SkipSpaces(); return p >= end; }
+
+    std::string_view Word() {
+        SkipSpaces();
+        const char* begin = p;
+        while (p < end && !IsSpace(*p)) ++p;
+        return { begin, static_cast<std::size_t>(p - begin) };
+    }
+
+    bool Float(float& value) {
+        SkipSpaces();
+        if (p < end && *p == '+') ++p; // from_chars rejects a leading '+'
+        const auto [next, error] = std::from_chars(p, end, value);
+        if (error != std::errc()) return false;
+        p = next;
+        return true;
+    }
+
+    bool Int(int& value) {
+        if (p < end && *p == '+') ++p;
+        const auto [next, error] = std::from_chars(p, end, value);
+        if (error != std::errc()) return false;
+        p = next;
+        return true;
+    }
+};
+
+// Position/uv/normal references of one face corner, 0-based; -1 when absent.
+struct Corner {
+    int v, vt, vn;
+
+    int& operator[](int component) { return component == 0 ? v : component == 1 ? vt : vn; }
+    bool operator==(const Corner&) const = default;
+};
+
+struct CornerHash {
+    std::size_t operator()(const Corner& c) const {
+        uint64_t h = static_cast<uint32_t>(c.v) * 0x9E3779B97F4A7C15ull;
+        h ^= static_cast<uint32_t>(c.vt) * 0xC2B2AE3D27D4EB4Full;
+        h ^= static_cast<uint32_t>(c.vn) * 0x165667B19E3779F9ull;
+        return static_cast<std::size_t>(h ^ (h >> 32));
+    }
+};
+
+// Open-addressing Corner -> vertex map with linear probing, kept at most
+// half full.
+class CornerTable {
+public:
+    explicit CornerTable(std::size_t expectedKeys) { Allocate(std::bit_ceil(std::max<std::size_t>(16, expectedKeys * 2))); }
+
+    // The vertex already stored for `corner`, or `vertex` after storing it.
+    uint32_t Insert(const Corner& corner, uint32_t vertex) {
+        std::size_t slot = Find(corner);
+        if (values[slot] != Unassigned) return values[slot];
+        if ((count + 1) * 2 > values.size()) {
+            Grow();
+            slot = Find(corner);
+        }
+        keys[slot] = corner;
+        values[slot] = vertex;
+        ++count;
+        return vertex;
+    }
+
+private:
+    std::size_t Find(const Corner& corner) const {
+        const std::size_t mask = values.size() - 1;
+        std::size_t slot = CornerHash{}(corner) & mask;
+        while (values[slot] != Unassigned && !(keys[slot] == corner)) slot = (slot + 1) & mask;
+        return slot;
+    }
+
+    void Allocate(std::size_t capacity) {
+        keys.assign(capacity, Corner{});
+        values.assign(capacity, Unassigned);
+    }
+
+    void Grow() {
+        std::vector<Corner> oldKeys = std::move(keys);
+        std::vector<uint32_t> oldValues = std::move(values);
+        Allocate(oldValues.size() * 2);
+        for (std::size_t i = 0; i < oldValues.size(); ++i)
+            if (oldValues[i] != Unassigned) {
+                const std::size_t slot = Find(oldKeys[i]);
+                keys[slot] = oldKeys[i];
+                values[slot] = oldValues[i];
+            }
+    }
+
+    std::vector<Corner> keys;
+    std::vector<uint32_t> values;
+    std::size_t count = 0;
+};
+
+// One line-aligned slice of the file. Parsed and welded on its own; only
+// the merge into global vertex numbers runs serially.
+struct ObjChunk {
+    std::string_view text;
+
+    std::vector<glm::vec3> positions, normals;
+    std::vector<glm::vec2> uvs;
+    std::vector<Corner> corners;   // three per triangle
+    std::vector<uint32_t> relative; // corner * 3 + component for negative references, resolved once bases are known
+    std::vector<std::pair<uint32_t, std::string>> materials; // usemtl: (first triangle, name)
+    bool failed = false;
+
+    uint32_t positionBase = 0, uvBase = 0, normalBase = 0, triangleBase = 0;
+
+    std::vector<Corner> unique;    // welded within the chunk, first-use order
+    std::vector<uint32_t> local;   // per corner: index into unique
+    std::vector<uint32_t> remap;   // unique -> global vertex
+};
+
+// OBJ indices are 1-based; negative ones count back from the latest element
+// and are kept chunk-relative (marked in `relative`) until the chunk's base is known.
+bool ParseIndex(LineReader& line, int count, int& out, bool& relative) {
+    int raw = 0;
+    if (!line.Int(raw) || raw == 0) return false;
+    relative = raw < 0;
+    out = relative ? count + raw : raw - 1;
+    return true;
+}
+
+void ParseChunk(ObjChunk& chunk) {
+    std::vector<Corner> polygon;
+    std::vector<uint8_t> polygonRelative; // bit per component
+    const char* p = chunk.text.data();
+    const char* const end = p + chunk.text.size();
+    while (p < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+        if (!lineEnd) lineEnd = end;
+        LineReader line{ p, lineEnd };
+        p = lineEnd + 1;
+
+        const std::string_view keyword = line.Word();
+        bool ok = true;
+        if (keyword == "v") {
+            glm::vec3 v;
+            ok = line.Float(v.x) && line.Float(v.y) && line.Float(v.z);
+            chunk.positions.push_back(v);
+        } else if (keyword == "vt") {
+            // u [v [w]]: v defaults to 0, w is ignored
+            glm::vec2 t(0.0f);
+            ok = line.Float(t.x);
+            if (ok && !line.AtEnd()) ok = line.Float(t.y);
+            chunk.uvs.push_back(t);
+        } else if (keyword == "vn") {
+            glm::vec3 n;
+            ok = line.Float(n.x) && line.Float(n.y) && line.Float(n.z);
+            chunk.normals.push_back(n);
+        } else if (keyword == "f") {
+            polygon.clear();
+            polygonRelative.clear();
+            while (ok && !line.AtEnd()) {
+                Corner corner{ -1, -1, -1 };
+                uint8_t relativeBits = 0;
+                bool relative = false;
+                ok = ParseIndex(line, static_cast<int>(chunk.positions.size()), corner.v, relative);
+                relativeBits |= relative ? 1 : 0;
+                if (ok && line.p < line.end && *line.p == '/') {
+                    ++line.p;
+                    if (line.p < line.end && *line.p != '/') {
+                        ok = ParseIndex(line, static_cast<int>(chunk.uvs.size()), corner.vt, relative);
+                        relativeBits |= relative ? 2 : 0;
+                    }
+                    if (ok && line.p < line.end && *line.p == '/') {
+                        ++line.p;
+                        ok = ParseIndex(line, static_cast<int>(chunk.normals.size()), corner.vn, relative);
+                        relativeBits |= relative ? 4 : 0;
+                    }
+                }
+                polygon.push_back(corner);
+                polygonRelative.push_back(relativeBits);
+            }
+            ok = ok && polygon.size() >= 3;
+            for (std::size_t i = 2; ok && i < polygon.size(); ++i)
+                for (const std::size_t k : { std::size_t{ 0 }, i - 1, i }) {
+                    for (int component = 0; component < 3; ++component)
+                        if (polygonRelative[k] & (1 << component))
+                            chunk.relative.push_back(static_cast<uint32_t>(chunk.corners.size() * 3 + component));
+                    chunk.corners.push_back(polygon[k]);
+                }
+        } else if (keyword == "usemtl") {
+            chunk.materials.emplace_back(static_cast<uint32_t>(chunk.corners.size() / 3), std::string(line.Word()));
+        }
+        // o, g, s, mtllib, comments: not needed for geometry
+        if (!ok) {
+            chunk.failed = true;
+            return;
+        }
+    }
+}
+
+// Resolves relative references, range-checks every corner and welds the chunk locally.
+void WeldChunk(ObjChunk& chunk, std::size_t positionCount, std::size_t uvCount, std::size_t normalCount) {
+    const int bases[3] = { static_cast<int>(chunk.positionBase), static_cast<int>(chunk.uvBase), static_cast<int>(chunk.normalBase) };
+    for (uint32_t reference : chunk.relative) chunk.corners[reference / 3][reference % 3] += bases[reference % 3];
+
+    CornerTable table(chunk.corners.size() / 4); // a closed surface has about one vertex per two triangles
+    chunk.local.resize(chunk.corners.size());
+    for (std::size_t i = 0; i < chunk.corners.size(); ++i) {
+        const Corner& c = chunk.corners[i];
+        if (c.v < 0 || static_cast<std::size_t>(c.v) >= positionCount
+            || c.vt < -1 || (c.vt >= 0 && static_cast<std::size_t>(c.vt) >= uvCount)
+            || c.vn < -1 || (c.vn >= 0 && static_cast<std::size_t>(c.vn) >= normalCount)) {
+            chunk.failed = true;
+            return;
+        }
+        chunk.local[i] = table.Insert(c, static_cast<uint32_t>(chunk.unique.size()));
+        if (chunk.local[i] == chunk.unique.size()) chunk.unique.push_back(c);
+    }
+    chunk.corners = {}; // the largest per-chunk array; not needed past this point
+}
+
+// Runs fn(i) for i in [0, count), spread over the pool when there is one.
+template<typename Fn>
+void RunJobs(JobSystem* jobs, std::size_t count, Fn&& fn) {
+    if (!jobs || count < 2) {
+        for (std::size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+    JobCounter done;
+    for (std::size_t i = 1; i < count; ++i) jobs->Submit([&fn, i] { fn(i); }, &done);
+    fn(0);
+    jobs->Wait(done);
+}
+
+void ComputeBounds(const std::vector<StandardVertex>& vertices, const uint32_t* indices, std::size_t count,
+                   float outMin[3], float outMax[3]) {
+    glm::vec3 lo(std::numeric_limits<float>::max()), hi(-std::numeric_limits<float>::max());
+    for (std::size_t i = 0; i < count; ++i) {
+        const float* p = vertices[indices[i]].position;
+        lo = glm::min(lo, glm::vec3(p[0], p[1], p[2]));
+        hi = glm::max(hi, glm::vec3(p[0], p[1], p[2]));
+    }
+    if (count == 0) lo = hi = glm::vec3(0.0f);
+    std::memcpy(outMin, &lo, sizeof(lo));
+    std::memcpy(outMax, &hi, sizeof(hi));
+}
+
+}
+
+std::optional<MeshData> ParseObj(std::string_view text, const ObjImportOptions& options) {
+    // cut at line ends; the cut points depend only on the text, so the
+    // result is identical however many threads parse it
+    std::vector<ObjChunk> chunks;
+    for (std::size_t begin = 0; begin < text.size();) {
+        std::size_t end = std::min(text.size(), begin + std::max<std::size_t>(1, options.chunkBytes));
+        const std::size_t newline = text.find('\n', end - 1);
+        end = newline == std::string_view::npos ? text.size() : newline + 1;
+        chunks.emplace_back().text = text.substr(begin, end - begin);
+        begin = end;
+    }
+
+    RunJobs(options.jobs, chunks.size(), [&](std::size_t i) { ParseChunk(chunks[i]); });
+
+    std::size_t positionCount = 0, uvCount = 0, normalCount = 0, triangleCount = 0;
+    for (ObjChunk& chunk : chunks) {
+        if (chunk.failed) return std::nullopt;
+        chunk.positionBase = static_cast<uint32_t>(positionCount);
+        chunk.uvBase = static_cast<uint32_t>(uvCount);
+        chunk.normalBase = static_cast<uint32_t>(normalCount);
+        chunk.triangleBase = static_cast<uint32_t>(triangleCount);
+        positionCount += chunk.positions.size();
+        uvCount += chunk.uvs.size();
+        normalCount += chunk.normals.size();
+        triangleCount += chunk.corners.size() / 3;
+    }
+    if (triangleCount == 0 || triangleCount * 3 > std::numeric_limits<uint32_t>::max()) return std::nullopt;
+
+    RunJobs(options.jobs, chunks.size(), [&](std::size_t i) { WeldChunk(chunks[i], positionCount, uvCount, normalCount); });
+
+    // serial part: number the chunk-local vertices globally, in first-use order
+    std::size_t localVertices = 0;
+    for (const ObjChunk& chunk : chunks) {
+        if (chunk.failed) return std::nullopt;
+        localVertices += chunk.unique.size();
+    }
+    std::vector<Corner> welded;
+    welded.reserve(localVertices);
+    {
+        CornerTable table(localVertices);
+        for (ObjChunk& chunk : chunks) {
+            chunk.remap.resize(chunk.unique.size());
+            for (std::size_t u = 0; u < chunk.unique.size(); ++u) {
+                chunk.remap[u] = table.Insert(chunk.unique[u], static_cast<uint32_t>(welded.size()));
+                if (chunk.remap[u] == welded.size()) welded.push_back(chunk.unique[u]);
+            }
+        }
+    }
+
+    std::vector<glm::vec3> positions(positionCount), normals(normalCount);
+    std::vector<glm::vec2> uvs(uvCount);
+    std::vector<uint32_t> indices(triangleCount * 3);
+    RunJobs(options.jobs, chunks.size(), [&](std::size_t i) {
+        ObjChunk& chunk = chunks[i];
+        std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.positionBase);
+        std::copy(chunk.uvs.begin(), chunk.uvs.end(), uvs.begin() + chunk.uvBase);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.normalBase);
+        uint32_t* out = indices.data() + std::size_t{ chunk.triangleBase } * 3;
+        for (std::size_t k = 0; k < chunk.local.size(); ++k) out[k] = chunk.remap[chunk.local[k]];
+    });
+
+    std::vector<StandardVertex> vertices(welded.size());
+    constexpr std::size_t VertexBlock = 64 * 1024;
+    RunJobs(options.jobs, (welded.size() + VertexBlock - 1) / VertexBlock, [&](std::size_t block) {
+        const std::size_t end = std::min(welded.size(), (block + 1) * VertexBlock);
+        for (std::size_t i = block * VertexBlock; i < end; ++i) {
+            const Corner& corner = welded[i];
+            StandardVertex& vertex = vertices[i];
+            std::memcpy(vertex.position, &positions[corner.v], sizeof(vertex.position));
+            if (corner.vt >= 0) std::memcpy(vertex.uv, &uvs[corner.vt], sizeof(vertex.uv));
+            if (corner.vn >= 0) std::memcpy(vertex.normal, &normals[corner.vn], sizeof(vertex.normal));
+        }
+    });
+
+    // one submesh per run of faces between usemtl statements
+    std::vector<MeshSubmesh> submeshes;
+    std::vector<std::string> materials;
+    submeshes.push_back({ 0, 0, 0, 0, {}, {} });
+    for (const ObjChunk& chunk : chunks)
+        for (const auto& [triangle, name] : chunk.materials) {
+            uint32_t material = 0;
+            while (material < materials.size() && materials[material] != name) ++material;
+            if (material == materials.size()) materials.push_back(name);
+
+            const uint32_t firstIndex = (chunk.triangleBase + triangle) * 3;
+            if (firstIndex > submeshes.back().firstIndex)
+                submeshes.push_back({ firstIndex, 0, material, 0, {}, {} });
+            else
+                submeshes.back().material = material; // nothing drawn with the previous one
+        }
+    for (std::size_t i = 0; i < submeshes.size(); ++i)
+        submeshes[i].indexCount = (i + 1 < submeshes.size() ? submeshes[i + 1].firstIndex : static_cast<uint32_t>(indices.size()))
+                                  - submeshes[i].firstIndex;
+
+    if (normals.empty()) {
+        std::vector<glm::vec3> accumulated(vertices.size(), glm::vec3(0.0f));
+        for (std::size_t i = 0; i < indices.size(); i += 3) {
+            const float* a = vertices[indices[i]].position;
+            const float* b = vertices[indices[i + 1]].position;
+            const float* c = vertices[indices[i + 2]].position;
+            const glm::vec3 n = glm::cross(glm::vec3(b[0] - a[0], b[1] - a[1], b[2] - a[2]),
+                                           glm::vec3(c[0] - a[0], c[1] - a[1], c[2] - a[2]));
+            for (int k = 0; k < 3; ++k) accumulated[indices[i + k]] += n; // area weighted
+        }
+        for (std::size_t i = 0; i < vertices.size(); ++i) {
+            const float length = glm::length(accumulated[i]);
+            const glm::vec3 n = length > 0.0f ? accumulated[i] / length : glm::vec3(0.0f, 1.0f, 0.0f);
+            std::memcpy(vertices[i].normal, &n, sizeof(n));
+        }
+    }
+
+    MeshData mesh;
+    mesh.attributes = StandardMeshLayout();
+    mesh.vertexStride = sizeof(StandardVertex);
+    for (MeshSubmesh& submesh : submeshes)
+        ComputeBounds(vertices, indices.data() + submesh.firstIndex, submesh.indexCount, submesh.boundsMin, submesh.boundsMax);
+    float lo[3], hi[3];
+    ComputeBounds(vertices, indices.data(), indices.size(), lo, hi);
+    mesh.bounds = { glm::vec3(lo[0], lo[1], lo[2]), glm::vec3(hi[0], hi[1], hi[2]) };
+
+    mesh.vertices.resize(vertices.size() * sizeof(StandardVertex));
+    std::memcpy(mesh.vertices.data(), vertices.data(), mesh.vertices.size());
+    mesh.indices = std::move(indices);
+    mesh.submeshes = std::move(submeshes);
+    if (options.optimize) OptimizeMesh(mesh);
+    return mesh;
+}
+
+std::optional<MeshData> ImportObj(const std::filesystem::path& path, const ObjImportOptions& options) {
+    const std::optional<MappedFile> file = MappedFile::Open(path);
+    if (!file) return std::nullopt;
+    return ParseObj({ reinterpret_cast<const char*>(file->Data()), file->Size() }, options);
+}
+
+MeshAsset UploadMesh(GLBackend& gl, const MeshView& view) {
+    MeshAsset out;
+    gl.GenVertexArrays(1, &out.mesh.vao);
+    gl.BindVertexArray(out.mesh.vao);
+
+    gl.GenBuffers(1, &out.vertexBuffer);
+    gl.BindBuffer(GL_ARRAY_BUFFER, out.vertexBuffer);
+    gl.BufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(view.vertices.size_bytes()), view.vertices.data(), GL_STATIC_DRAW);
+    for (const MeshAttribute& attribute : view.attributes) {
+        gl.EnableVertexAttribArray(attribute.location);
+        gl.VertexAttribPointer(attribute.location, static_cast<GLint>(attribute.components), attribute.type,
+                               attribute.normalized ? GL_TRUE : GL_FALSE, static_cast<GLsizei>(view.vertexStride),
+                               reinterpret_cast<const void*>(static_cast<uintptr_t>(attribute.offset)));
+    }
+
+    if (!view.indices.empty()) {
+        gl.GenBuffers(1, &out.indexBuffer);
+        gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, out.indexBuffer); // recorded in the VAO
+        gl.BufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(view.indices.size_bytes()), view.indices.data(), GL_STATIC_DRAW);
+    }
+    gl.BindVertexArray(0);
+
+    out.mesh.indexed = !view.indices.empty();
+    out.mesh.count = static_cast<GLsizei>(out.mesh.indexed ? view.indices.size() : view.VertexCount());
+    out.mesh.bounds = view.bounds;
+    out.submeshes.assign(view.submeshes.begin(), view.submeshes.end());
+    return out;
+}
+
+void DestroyMesh(GLBackend& gl, MeshAsset& mesh) {
+    const GLuint buffers[] = { mesh.vertexBuffer, mesh.indexBuffer };
+    gl.DeleteBuffers(mesh.indexBuffer ? 2 : 1, buffers);
+    gl.DeleteVertexArrays(1, &mesh.mesh.vao);
+    mesh = {};
+}
+
+ResidencyLevels MeshResidency(const MeshFile& mesh) {
+    const MeshView view = mesh.View();
+    return { { view.vertices.size_bytes() + view.indices.size_bytes() }, 0 };
+}
+
+void RegisterMeshLoader(AssetManager& assets) {
+    assets.RegisterLoader<MeshAsset, MeshFile>(
+        [](const std::filesystem::path& path) -> std::optional<MeshFile> {
+            std::optional<MeshFile> file = MeshFile::Open(path);
+            if (file) file->Prefetch(); // page faults here, not on the GL thread
+            return file;
+        },
+        [](GLBackend& gl, MeshFile& file) -> std::optional<MeshAsset> { return UploadMesh(gl, file.View()); },
+        [](GLBackend& gl, MeshAsset& mesh) { DestroyMesh(gl, mesh); });
+    assets.RegisterStreaming<MeshAsset, MeshFile>([](GLBackend&, const MeshFile& file) { return MeshResidency(file); }, [](GLBackend& gl, MeshAsset& mesh, const MeshFile& file, uint32_t firstLevel) {
+        DestroyMesh(gl, mesh);
+        if (firstLevel == 0) mesh = UploadMesh(gl, file.View());
+    });
+}
@@ -0,0 +1,81 @@
+/* Mesh import and upload.
+
+   ImportObj turns a Wavefront OBJ file into MeshData with the engine's
+   standard vertex layout (StandardMeshLayout) and one submesh per
+   "usemtl" run. It is the offline path: the mesh_compiler tool bakes its
+   output into .emesh files (MeshFile.hpp), and the runtime only ever maps
+   those.
+
+   The importer is built for multi-hundred-MB sources. The text is cut into
+   line-aligned chunks that are parsed (std::from_chars) and welded through
+   a flat hash table in parallel on a JobSystem; only the merge of the
+   chunks' vertices into one numbering is serial. The welded mesh then goes
+   through OptimizeMesh (MeshOptimizer.hpp) for vertex cache and vertex
+   fetch order.
+
+   UploadMesh creates the VAO and buffers for any MeshView, straight from
+   the view's memory, so a mapped MeshFile goes to the driver without an
+   intermediate copy. RegisterMeshLoader teaches an AssetManager to load
+   .emesh files: the file is mapped and paged in on a worker, and only the
+   buffer upload runs on the GL thread.
+
+example usage:
+
+RegisterMeshLoader(assets);
+Asset<MeshAsset> rock = assets.Load<MeshAsset>("models/rock.emesh");
+...
+if (const MeshAsset* mesh = rock.Get()) mesh->mesh.Draw(gl); */
+#pragma once
+#include "MeshFile.hpp"
+#include "ResidencyManager.hpp"
+#include "../gl/GLBackend.hpp"
+#include "../gl/Mesh.hpp"
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+class AssetManager;
+class JobSystem;
+
+// position (location 0, vec3), normal (1, vec3), uv (2, vec2); 32 bytes.
+// Matches the mesh attributes of shaders/instanced.vert.
+struct StandardVertex {
+    float position[3];
+    float normal[3];
+    float uv[2];
+};
+
+std::vector<MeshAttribute> StandardMeshLayout();
+
+struct ObjImportOptions {
+    JobSystem* jobs = nullptr;                 // parse on the pool when set, else on the caller
+    std::size_t chunkBytes = 4 * 1024 * 1024;  // text per parse job; the result does not depend on it
+    bool optimize = true;                      // vertex cache + fetch reordering (OptimizeMesh)
+};
+
+// Parses OBJ text: v/vt/vn/f (any polygon, fan-triangulated; negative
+// indices) and usemtl. Identical position/uv/normal triples share a
+// vertex. Normals are generated (smooth) when the file has none. Returns
+// nullopt on malformed input, including references past the last element.
+std::optional<MeshData> ParseObj(std::string_view text, const ObjImportOptions& options = {});
+std::optional<MeshData> ImportObj(const std::filesystem::path& path, const ObjImportOptions& options = {});
+
+// A mesh on the GPU with its buffers, as the AssetManager holds it.
+struct MeshAsset {
+    Mesh mesh;
+    GLuint vertexBuffer = 0;
+    GLuint indexBuffer = 0;
+    std::vector<MeshSubmesh> submeshes;
+};
+
+MeshAsset UploadMesh(GLBackend& gl, const MeshView& view);
+void DestroyMesh(GLBackend& gl, MeshAsset& mesh);
+
+// GPU bytes of `mesh` as a single level, for a ResidencyManager.
+ResidencyLevels MeshResidency(const MeshFile& mesh);
+
+// Registers MeshAsset loading from .emesh files. Meshes are evicted and
+// reloaded whole under the manager's ResidencyManager, if it has one.
+void RegisterMeshLoader(AssetManager& assets);
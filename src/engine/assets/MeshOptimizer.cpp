@@ -0,0 +1,146 @@
+#include "MeshOptimizer.hpp"
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t Unassigned = ~0u;
+
+// Triangles around each vertex, CSR style: triangles[offsets[v] .. offsets[v + 1]).
+struct Adjacency {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> triangles;
+
+    Adjacency(std::span<const uint32_t> indices, uint32_t vertexCount) : offsets(vertexCount + 1, 0), triangles(indices.size()) {
+        for (uint32_t index : indices) ++offsets[index + 1];
+        for (uint32_t v = 0; v < vertexCount; ++v) offsets[v + 1] += offsets[v];
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (std::size_t i = 0; i < indices.size(); ++i) triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    uint32_t Valence(uint32_t v) const { return offsets[v + 1] - offsets[v]; }
+};
+
+}
+
+void OptimizeVertexCache(std::span<uint32_t> indices, uint32_t vertexCount, uint32_t cacheSize) {
+    const std::size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2 || vertexCount == 0) return;
+
+    const Adjacency adjacency(indices, vertexCount);
+    std::vector<uint32_t> live(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; ++v) live[v] = adjacency.Valence(v);
+
+    // A vertex is cached while time - cacheTime[v] <= cacheSize; time starts past every stamp.
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnd, candidates, output;
+    output.reserve(indices.size());
+    deadEnd.reserve(indices.size());
+    uint32_t scan = 0; // next vertex to try once the dead-end stack runs dry
+
+    uint32_t fan = 0;
+    while (adjacency.Valence(fan) == 0 && fan + 1 < vertexCount) ++fan;
+    while (fan != Unassigned) {
+        // emit every remaining triangle around the fanning vertex
+        candidates.clear();
+        for (uint32_t k = adjacency.offsets[fan]; k < adjacency.offsets[fan + 1]; ++k) {
+            const uint32_t triangle = adjacency.triangles[k];
+            if (emitted[triangle]) continue;
+            emitted[triangle] = true;
+            for (int corner = 0; corner < 3; ++corner) {
+                const uint32_t v = indices[triangle * 3 + corner];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+                if (time - cacheTime[v] > cacheSize) cacheTime[v] = time++;
+            }
+        }
+
+        // next fan: the candidate that will still be cached after its own triangles are emitted, oldest first
+        fan = Unassigned;
+        uint32_t bestPriority = 0;
+        for (uint32_t v : candidates) {
+            if (live[v] == 0) continue;
+            uint32_t priority = 0;
+            if (time - cacheTime[v] + 2 * live[v] <= cacheSize) priority = time - cacheTime[v];
+            if (fan == Unassigned || priority > bestPriority) {
+                fan = v;
+                bestPriority = priority;
+            }
+        }
+        // dead end: most recently referenced vertex with work left, then any vertex in input order
+        while (fan == Unassigned && !deadEnd.empty()) {
+            const uint32_t v = deadEnd.back();
+            deadEnd.pop_back();
+            if (live[v] > 0) fan = v;
+        }
+        while (fan == Unassigned && scan < vertexCount) {
+            if (live[scan] > 0) fan = scan;
+            ++scan;
+        }
+    }
+    std::memcpy(indices.data(), output.data(), output.size() * sizeof(uint32_t));
+}
+
+void OptimizeVertexFetch(std::span<uint32_t> indices, std::span<std::byte> vertices, uint32_t stride) {
+    const uint32_t vertexCount = stride ? static_cast<uint32_t>(vertices.size() / stride) : 0;
+    if (vertexCount == 0) return;
+
+    std::vector<uint32_t> remap(vertexCount, Unassigned);
+    uint32_t next = 0;
+    for (uint32_t& index : indices) {
+        if (remap[index] == Unassigned) remap[index] = next++;
+        index = remap[index];
+    }
+    for (uint32_t& target : remap)
+        if (target == Unassigned) target = next++;
+
+    std::vector<std::byte> reordered(vertices.size());
+    for (uint32_t v = 0; v < vertexCount; ++v)
+        std::memcpy(reordered.data() + std::size_t{ remap[v] } * stride, vertices.data() + std::size_t{ v } * stride, stride);
+    std::memcpy(vertices.data(), reordered.data(), reordered.size());
+}
+
+void OptimizeMesh(MeshData& mesh, uint32_t cacheSize) {
+    const uint32_t vertexCount = mesh.View().VertexCount();
+    if (vertexCount == 0 || mesh.indices.empty()) return;
+
+    // Each submesh is optimised on its own compact vertex numbering, so the
+    // per-call tables stay proportional to the submesh, not the whole mesh.
+    std::vector<uint32_t> local(vertexCount, Unassigned), global;
+    const auto optimizeRange = [&](uint32_t first, uint32_t count) {
+        const std::span<uint32_t> range(mesh.indices.data() + first, count - count % 3);
+        global.clear();
+        for (uint32_t& index : range) {
+            if (local[index] == Unassigned) {
+                local[index] = static_cast<uint32_t>(global.size());
+                global.push_back(index);
+            }
+            index = local[index];
+        }
+        OptimizeVertexCache(range, static_cast<uint32_t>(global.size()), cacheSize);
+        for (uint32_t& index : range) index = global[index];
+        for (uint32_t v : global) local[v] = Unassigned;
+    };
+
+    if (mesh.submeshes.empty())
+        optimizeRange(0, static_cast<uint32_t>(mesh.indices.size()));
+    for (const MeshSubmesh& submesh : mesh.submeshes) optimizeRange(submesh.firstIndex, submesh.indexCount);
+    OptimizeVertexFetch(mesh.indices, mesh.vertices, mesh.vertexStride);
+}
+
+float ComputeAcmr(std::span<const uint32_t> indices, uint32_t vertexCount, uint32_t cacheSize) {
+    if (indices.size() < 3) return 0.0f;
+
+    // insertedAt[v]: the miss that brought v into the FIFO (1-based; 0 = never loaded)
+    std::vector<uint64_t> insertedAt(vertexCount, 0);
+    uint64_t misses = 0;
+    for (uint32_t index : indices) {
+        if (insertedAt[index] != 0 && misses - insertedAt[index] < cacheSize) continue;
+        insertedAt[index] = ++misses;
+    }
+    return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+}
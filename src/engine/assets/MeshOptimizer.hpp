@@ -0,0 +1,39 @@
+/* Index and vertex reordering for GPU-friendly meshes.
+
+   OptimizeVertexCache reorders triangles so that consecutive triangles
+   share vertices that are still in the post-transform cache (Tipsify,
+   Sander, Nehab & Barczak 2007: linear time, tuned for a FIFO cache of
+   `cacheSize` entries). OptimizeVertexFetch then renumbers vertices in
+   the order the index buffer first uses them, so vertex fetch walks the
+   vertex buffer forwards instead of jumping around it.
+
+   OptimizeMesh runs both on a MeshData, one submesh at a time, so
+   triangles never move between submeshes. ComputeAcmr measures the
+   result: transformed vertices per triangle with a FIFO cache, 3.0 at
+   worst and about 0.5 at best for a regular grid.
+
+example usage:
+
+const float before = ComputeAcmr(mesh.indices, mesh.View().VertexCount());
+OptimizeMesh(mesh);
+const float after = ComputeAcmr(mesh.indices, mesh.View().VertexCount()); */
+#pragma once
+#include "MeshFile.hpp"
+#include <cstdint>
+#include <span>
+
+// Post-transform cache size the optimizer and the metric assume by default.
+inline constexpr uint32_t DefaultVertexCacheSize = 16;
+
+void OptimizeVertexCache(std::span<uint32_t> indices, uint32_t vertexCount,
+                         uint32_t cacheSize = DefaultVertexCacheSize);
+
+// Permutes `vertices` (vertexCount * stride bytes) to first-use order and
+// rewrites `indices` to match. Unreferenced vertices move to the end.
+void OptimizeVertexFetch(std::span<uint32_t> indices, std::span<std::byte> vertices, uint32_t stride);
+
+void OptimizeMesh(MeshData& mesh, uint32_t cacheSize = DefaultVertexCacheSize);
+
+// Average cache miss ratio of a FIFO cache of `cacheSize` vertices.
+float ComputeAcmr(std::span<const uint32_t> indices, uint32_t vertexCount,
+                  uint32_t cacheSize = DefaultVertexCacheSize);
@@ -0,0 +1,190 @@
+#include "ResidencyManager.hpp"
+#include <algorithm>
+#include <cassert>
+#include <queue>
+#include <utility>
+
+float ProjectedSize(float radius, float distance, float tanHalfFovY, float viewportHeight) {
+    if (distance <= radius) return viewportHeight; // the camera is inside it
+    return radius / (distance * tanHalfFovY) * viewportHeight;
+}
+
+ResidencyManager::ResidencyManager(const ResidencyOptions& residencyOptions) : options(residencyOptions) {}
+
+void ResidencyManager::Add(uint32_t key, std::span<const uint64_t> levelBytes, uint32_t baseSize, uint32_t firstLevel) {
+    assert(!levelBytes.empty() && "ResidencyManager::Add: a resource needs at least one level.");
+    if (key >= entries.size()) entries.resize(key + 1);
+    Entry& entry = entries[key];
+    assert(!entry.live && "ResidencyManager::Add: key added twice.");
+
+    entry = Entry{};
+    entry.live = true;
+    entry.suffixBytes.assign(levelBytes.size() + 1, 0);
+    for (std::size_t i = levelBytes.size(); i-- > 0;) entry.suffixBytes[i] = entry.suffixBytes[i + 1] + levelBytes[i];
+    entry.baseSize = baseSize;
+    const uint32_t levels = LevelCount(entry);
+    while (baseSize && entry.floorLevel + 1 < levels && (baseSize >> (entry.floorLevel + 1)) >= options.minTextureSize)
+        ++entry.floorLevel;
+    entry.first = std::min(firstLevel, levels);
+    entry.target = entry.first;
+    entry.lastUsed = entry.first < levels ? frame : 0; // fresh uploads are not evicted straight away
+    residentBytes += entry.suffixBytes[entry.first];
+}
+
+void ResidencyManager::Remove(uint32_t key) {
+    if (!Contains(key)) return;
+    Entry& entry = entries[key];
+    residentBytes -= entry.suffixBytes[entry.first];
+    entry = Entry{};
+}
+
+bool ResidencyManager::Contains(uint32_t key) const {
+    return key < entries.size() && entries[key].live;
+}
+
+void ResidencyManager::Touch(uint32_t key, float screenSize) {
+    if (!Contains(key)) return;
+    Entry& entry = entries[key];
+    if (entry.lastUsed != frame) {
+        entry.lastUsed = frame;
+        entry.screenSize = screenSize;
+    } else {
+        entry.screenSize = std::max(entry.screenSize, screenSize);
+    }
+}
+
+uint32_t ResidencyManager::FirstLevel(uint32_t key) const {
+    return Contains(key) ? entries[key].first : 0;
+}
+
+bool ResidencyManager::Resident(uint32_t key) const {
+    return Contains(key) && entries[key].first < LevelCount(entries[key]);
+}
+
+// The smallest level still at least as large as the resource on screen.
+uint32_t ResidencyManager::WantedLevel(const Entry& entry) const {
+    const float screenSize = std::max(entry.screenSize, 1.0f);
+    uint32_t level = 0;
+    while (level < entry.floorLevel && static_cast<float>(entry.baseSize >> (level + 1)) >= screenSize) ++level;
+    return level;
+}
+
+const std::vector<ResidencyChange>& ResidencyManager::Update() {
+    changes.clear();
+    stats = ResidencyStats{};
+    stats.frame = frame;
+    stats.budgetBytes = options.budgetBytes;
+
+    // 1. what every resource wants
+    uint64_t total = 0;
+    std::vector<uint32_t> idle, used;
+    for (uint32_t key = 0; key < entries.size(); ++key) {
+        Entry& entry = entries[key];
+        if (!entry.live) continue;
+        ++stats.resources;
+        const uint32_t levels = LevelCount(entry);
+        if (entry.lastUsed == frame) {
+            ++stats.touched;
+            used.push_back(key);
+            const uint32_t wanted = WantedLevel(entry);
+            entry.target = entry.first < levels ? std::min(entry.first, wanted) : wanted;
+        } else {
+            entry.target = entry.first;
+            if (entry.first < levels) idle.push_back(key);
+        }
+        total += entry.suffixBytes[entry.target];
+    }
+    stats.wantedBytes = total;
+
+    // 2. cap what is streamed in this frame: drawn resources that were
+    //    evicted first come back with their smallest levels, so everything
+    //    on screen has something; then the rest goes to the most important,
+    //    smallest levels first. One increase always goes through, so a
+    //    resource larger than the cap still loads.
+    std::vector<std::pair<uint32_t, uint32_t>> increases; // key, level reached so far
+    uint64_t streamed = 0;
+    for (uint32_t key : used) {
+        Entry& entry = entries[key];
+        if (entry.target >= entry.first) continue;
+        uint32_t level = entry.first;
+        if (level == LevelCount(entry)) {
+            level = std::max(entry.target, entry.floorLevel);
+            streamed += entry.suffixBytes[level];
+        }
+        increases.emplace_back(key, level);
+    }
+    std::sort(increases.begin(), increases.end(),
+              [&](const auto& a, const auto& b) { return entries[a.first].screenSize > entries[b.first].screenSize; });
+    bool progressed = false;
+    for (auto [key, level] : increases) {
+        Entry& entry = entries[key];
+        if (level == entry.target) continue;
+        const uint64_t base = entry.suffixBytes[level];
+        if (!progressed || streamed + entry.suffixBytes[entry.target] - base <= options.streamBytesPerFrame) {
+            streamed += entry.suffixBytes[entry.target] - base;
+            progressed = true;
+            continue;
+        }
+        while (level > entry.target && streamed + entry.suffixBytes[level - 1] - base <= options.streamBytesPerFrame) --level;
+        streamed += entry.suffixBytes[level] - base;
+        total -= entry.suffixBytes[entry.target] - entry.suffixBytes[level];
+        entry.target = level;
+        ++stats.deferred;
+    }
+
+    // 3. evict what was not drawn, least recently used first
+    if (total > options.budgetBytes) {
+        std::sort(idle.begin(), idle.end(), [&](uint32_t a, uint32_t b) {
+            const Entry& x = entries[a];
+            const Entry& y = entries[b];
+            return x.lastUsed != y.lastUsed ? x.lastUsed < y.lastUsed : x.screenSize < y.screenSize;
+        });
+        for (std::size_t i = 0; i < idle.size() && total > options.budgetBytes; ++i) {
+            Entry& entry = entries[idle[i]];
+            total -= entry.suffixBytes[entry.target];
+            entry.target = LevelCount(entry);
+        }
+    }
+
+    // 4. drop top mips of what was drawn, most oversampled first
+    if (total > options.budgetBytes) {
+        const auto texelsPerPixel = [&](uint32_t key) {
+            const Entry& entry = entries[key];
+            return static_cast<float>(entry.baseSize >> entry.target) / std::max(entry.screenSize, 1.0f);
+        };
+        std::priority_queue<std::pair<float, uint32_t>> droppable;
+        for (uint32_t key : used)
+            if (entries[key].target < entries[key].floorLevel) droppable.emplace(texelsPerPixel(key), key);
+        while (total > options.budgetBytes && !droppable.empty()) {
+            const uint32_t key = droppable.top().second;
+            droppable.pop();
+            Entry& entry = entries[key];
+            total -= entry.suffixBytes[entry.target] - entry.suffixBytes[entry.target + 1];
+            if (++entry.target < entry.floorLevel) droppable.emplace(texelsPerPixel(key), key);
+        }
+    }
+
+    // apply
+    for (uint32_t key = 0; key < entries.size(); ++key) {
+        Entry& entry = entries[key];
+        if (!entry.live) continue;
+        const uint32_t levels = LevelCount(entry);
+        if (entry.target != entry.first) {
+            changes.push_back({ key, entry.first, entry.target });
+            if (entry.target == levels)
+                ++stats.evicted;
+            else if (entry.first == levels)
+                ++stats.loaded;
+            else if (entry.target > entry.first)
+                stats.mipsDropped += entry.target - entry.first;
+            else
+                stats.mipsStreamed += entry.first - entry.target;
+            residentBytes = residentBytes - entry.suffixBytes[entry.first] + entry.suffixBytes[entry.target];
+            entry.first = entry.target;
+        }
+        if (entry.first < levels) ++stats.resident;
+    }
+    stats.residentBytes = residentBytes;
+    ++frame;
+    return changes;
+}
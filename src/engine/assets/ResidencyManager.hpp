@@ -0,0 +1,134 @@
+/* GPU memory budget for textures and meshes.
+
+   ResidencyManager is the policy only: it knows each resource by a key,
+   the GPU bytes of its levels (mips, largest first; a mesh has one) and
+   how it was used, and decides once per frame which levels should be on
+   the GPU. It never touches GL, so the policy is tested with plain numbers;
+   AssetManager applies its decisions (AssetManager::UpdateResidency).
+
+   The render path reports what it draws with Touch(key, screenSize),
+   screenSize being the resource's projected extent in pixels. Update()
+   then closes the frame:
+
+     1. Every touched resource wants the level matching its screen size
+        (a 1024 texel texture covering 200 pixels wants level 2). Detail it
+        already has is kept until memory is short; an evicted resource that
+        was touched is loaded again.
+     2. Increases (loads and higher mips) are capped at
+        options.streamBytesPerFrame. A drawn resource that was evicted
+        first comes back with its smallest levels; the rest of the cap goes
+        to the most important, smallest levels first, and what is left
+        follows on later frames.
+     3. While the total still exceeds the budget, resources not touched
+        this frame are evicted, least recently used (then least important)
+        first.
+     4. If that is not enough, the top mips of the touched textures go, one
+        level at a time, always from the texture with the most texels per
+        pixel of screen, never below options.minTextureSize.
+
+   The result is reported as ResidencyChanges (key, old and new first
+   level; levelCount meaning not resident) plus per-frame ResidencyStats.
+   Not thread safe: call from the GL thread.
+
+example usage:
+
+ResidencyManager residency({ .budgetBytes = 512ull << 20 });
+const uint64_t levels[] = { 4u << 20, 1u << 20, 256u << 10 }; // 1024^2 RGBA8, 3 levels
+residency.Add(key, levels, 1024);
+residency.Touch(key, ProjectedSize(radius, distance, tanHalfFovY, viewportHeight));
+for (const ResidencyChange& change : residency.Update()) Restream(change.key, change.to); */
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct ResidencyOptions {
+    uint64_t budgetBytes = 512ull << 20;
+    uint32_t minTextureSize = 32;            // mips are not dropped below this extent
+    uint64_t streamBytesPerFrame = 64ull << 20;
+};
+
+struct ResidencyStats {
+    uint64_t frame = 0;
+    uint64_t budgetBytes = 0;
+    uint64_t residentBytes = 0;   // after this frame's changes
+    uint64_t wantedBytes = 0;     // what the touched and resident resources asked for
+    uint32_t resources = 0;
+    uint32_t resident = 0;
+    uint32_t touched = 0;
+    uint32_t evicted = 0;         // resources evicted this frame
+    uint32_t mipsDropped = 0;     // levels given up by textures still in use
+    uint32_t loaded = 0;          // resources made resident again
+    uint32_t mipsStreamed = 0;    // levels added to resident textures
+    uint32_t deferred = 0;        // increases postponed by streamBytesPerFrame
+
+    // wanted / budget: above 1 the budget is cutting into what is on screen
+    float Pressure() const { return budgetBytes ? static_cast<float>(wantedBytes) / static_cast<float>(budgetBytes) : 0.0f; }
+};
+
+// `from` and `to` are first resident levels; a value equal to the level count means not resident.
+struct ResidencyChange {
+    uint32_t key = 0;
+    uint32_t from = 0;
+    uint32_t to = 0;
+};
+
+// What a resource costs, as ResidencyManager::Add takes it.
+struct ResidencyLevels {
+    std::vector<uint64_t> bytes; // per level, largest first
+    uint32_t baseSize = 0;
+};
+
+// Extent in pixels of a sphere of `radius` at `distance`, for Touch.
+float ProjectedSize(float radius, float distance, float tanHalfFovY, float viewportHeight);
+
+class ResidencyManager {
+public:
+    explicit ResidencyManager(const ResidencyOptions& options = {});
+
+    // `levelBytes`: GPU bytes per level, largest first. `baseSize`: the
+    // larger extent of level 0 in texels, 0 for resources without mips
+    // (meshes). The resource starts with `firstLevel` resident (its level
+    // count: evicted) and, if resident, counts as used this frame. Keys are
+    // the caller's, small and unique.
+    void Add(uint32_t key, std::span<const uint64_t> levelBytes, uint32_t baseSize = 0, uint32_t firstLevel = 0);
+    void Remove(uint32_t key);
+    bool Contains(uint32_t key) const;
+
+    // The render path drew `key` this frame at `screenSize` pixels.
+    void Touch(uint32_t key, float screenSize);
+
+    // Closes the frame; the changes stay valid until the next call.
+    const std::vector<ResidencyChange>& Update();
+
+    // First resident level of `key`; its level count when evicted.
+    uint32_t FirstLevel(uint32_t key) const;
+    bool Resident(uint32_t key) const;
+    uint64_t ResidentBytes() const { return residentBytes; }
+
+    void SetBudget(uint64_t bytes) { options.budgetBytes = bytes; }
+    const ResidencyOptions& Options() const { return options; }
+    const ResidencyStats& GetStats() const { return stats; }
+
+private:
+    struct Entry {
+        bool live = false;
+        std::vector<uint64_t> suffixBytes; // suffixBytes[i]: levels i.. resident; one extra 0 for "evicted"
+        uint32_t baseSize = 0;
+        uint32_t floorLevel = 0;           // the highest first level dropping mips may reach
+        uint32_t first = 0;
+        uint32_t target = 0;
+        uint64_t lastUsed = 0;
+        float screenSize = 0.0f;           // largest reported this frame
+    };
+
+    uint32_t LevelCount(const Entry& entry) const { return static_cast<uint32_t>(entry.suffixBytes.size() - 1); }
+    uint32_t WantedLevel(const Entry& entry) const;
+
+    ResidencyOptions options;
+    std::vector<Entry> entries; // indexed by key
+    uint64_t frame = 1;
+    uint64_t residentBytes = 0;
+    std::vector<ResidencyChange> changes;
+    ResidencyStats stats;
+};
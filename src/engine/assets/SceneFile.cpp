@@ -0,0 +1,283 @@
+#include "SceneFile.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <system_error>
+
+namespace {
+
+constexpr uint64_t Align16(uint64_t offset) { return (offset + 15) & ~uint64_t{ 15 }; }
+
+bool SectionFits(uint64_t offset, uint64_t bytes, uint64_t fileSize) {
+    return offset % 16 == 0 && offset <= fileSize && bytes <= fileSize - offset;
+}
+
+uint32_t ElementSize(SceneComponent type) {
+    switch (type) {
+    case SceneComponent::Name: return sizeof(SceneString);
+    case SceneComponent::Transform: return sizeof(Transform);
+    case SceneComponent::MeshRenderer: return sizeof(MeshRenderer);
+    case SceneComponent::Camera: return sizeof(Camera);
+    }
+    return 0;
+}
+
+constexpr SceneComponent ComponentOrder[] = { SceneComponent::Name, SceneComponent::Transform, SceneComponent::MeshRenderer,
+                                              SceneComponent::Camera };
+
+bool Has(const SceneEntity& entity, SceneComponent type) {
+    switch (type) {
+    case SceneComponent::Name: return !entity.name.empty();
+    case SceneComponent::Transform: return entity.transform.has_value();
+    case SceneComponent::MeshRenderer: return entity.meshRenderer.has_value();
+    case SceneComponent::Camera: return entity.camera.has_value();
+    }
+    return false;
+}
+
+}
+
+bool WriteSceneFile(const std::filesystem::path& path, const SceneData& scene, uint32_t chunkEntities) {
+    const auto entityCount = static_cast<uint32_t>(scene.entities.size());
+    chunkEntities = std::max(chunkEntities, 1u);
+
+    // columns: the component types that occur, in SceneComponent order
+    std::vector<SceneColumn> columns;
+    uint32_t typeMask[std::size(ComponentOrder)] = {};
+    for (SceneComponent type : ComponentOrder) {
+        const bool used = std::any_of(scene.entities.begin(), scene.entities.end(),
+                                      [&](const SceneEntity& entity) { return Has(entity, type); });
+        if (!used) continue;
+        typeMask[static_cast<uint32_t>(type)] = 1u << columns.size();
+        columns.push_back({ type, ElementSize(type), 0, 0, 0 });
+    }
+
+    // archetype order: entities with the same columns become adjacent, file order kept within one
+    std::vector<uint32_t> masks(entityCount, 0);
+    for (uint32_t e = 0; e < entityCount; ++e)
+        for (SceneComponent type : ComponentOrder)
+            if (Has(scene.entities[e], type)) masks[e] |= typeMask[static_cast<uint32_t>(type)];
+    std::vector<uint32_t> order(entityCount);
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return masks[a] < masks[b]; });
+    std::vector<uint32_t> fileIndex(entityCount);
+    for (uint32_t i = 0; i < entityCount; ++i) fileIndex[order[i]] = i;
+
+    // runs break where the archetype changes and at chunk boundaries
+    std::vector<SceneRun> runs;
+    std::vector<SceneChunk> chunks;
+    for (uint32_t i = 0; i < entityCount; ++i) {
+        const uint32_t mask = masks[order[i]];
+        if (i % chunkEntities == 0) chunks.push_back({ static_cast<uint32_t>(runs.size()), 0, i, 0 });
+        if (runs.empty() || i % chunkEntities == 0 || runs.back().columnMask != mask) {
+            runs.push_back({ i, 0, mask, 0 });
+            ++chunks.back().runCount;
+        }
+        ++runs.back().count;
+        ++chunks.back().entityCount;
+    }
+
+    // column data and strings
+    std::vector<std::vector<std::byte>> data(columns.size());
+    std::string blob;
+    const auto addString = [&](std::string_view text) {
+        const SceneString string{ static_cast<uint32_t>(blob.size()), static_cast<uint32_t>(text.size()) };
+        blob.append(text);
+        return string;
+    };
+    const auto append = [](std::vector<std::byte>& out, const auto& value) {
+        const auto* bytes = reinterpret_cast<const std::byte*>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(value));
+    };
+    std::vector<SceneString> strings;
+    for (const std::string& mesh : scene.meshes) strings.push_back(addString(mesh));
+    for (const std::string& material : scene.materials) strings.push_back(addString(material));
+
+    for (std::size_t c = 0; c < columns.size(); ++c) {
+        data[c].reserve(std::size_t{ columns[c].elementSize } * entityCount);
+        for (uint32_t i = 0; i < entityCount; ++i) {
+            const SceneEntity& entity = scene.entities[order[i]];
+            if (!(masks[order[i]] & (1u << c))) continue;
+            ++columns[c].count;
+            switch (columns[c].type) {
+            case SceneComponent::Name: append(data[c], addString(entity.name)); break;
+            case SceneComponent::Transform: {
+                Transform transform = *entity.transform;
+                if (transform.parent.IsValid())
+                    transform.parent = transform.parent.index < entityCount ? ecs::Entity{ fileIndex[transform.parent.index], 0 } : ecs::NullEntity;
+                append(data[c], transform);
+                break;
+            }
+            case SceneComponent::MeshRenderer: append(data[c], *entity.meshRenderer); break;
+            case SceneComponent::Camera: append(data[c], *entity.camera); break;
+            }
+        }
+    }
+
+    SceneFileHeader header{};
+    header.magic = SceneFileMagic;
+    header.version = SceneFileVersion;
+    header.entityCount = entityCount;
+    header.columnCount = static_cast<uint32_t>(columns.size());
+    header.runCount = static_cast<uint32_t>(runs.size());
+    header.chunkCount = static_cast<uint32_t>(chunks.size());
+    header.meshCount = static_cast<uint32_t>(scene.meshes.size());
+    header.materialCount = static_cast<uint32_t>(scene.materials.size());
+    header.columnsOffset = Align16(sizeof(SceneFileHeader));
+    header.runsOffset = Align16(header.columnsOffset + columns.size() * sizeof(SceneColumn));
+    header.chunksOffset = Align16(header.runsOffset + runs.size() * sizeof(SceneRun));
+    header.stringsOffset = Align16(header.chunksOffset + chunks.size() * sizeof(SceneChunk));
+    header.sourceOffset = Align16(header.stringsOffset + strings.size() * sizeof(SceneString));
+    uint64_t offset = header.sourceOffset + order.size() * sizeof(uint32_t);
+    for (std::size_t c = 0; c < columns.size(); ++c) {
+        columns[c].dataOffset = Align16(offset);
+        offset = columns[c].dataOffset + data[c].size();
+    }
+    header.blobOffset = Align16(offset);
+    header.blobSize = blob.size();
+    header.fileSize = header.blobOffset + blob.size();
+
+    std::error_code error;
+    if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path(), error);
+    const std::filesystem::path temporary = std::filesystem::path(path).concat(".tmp");
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+
+        uint64_t written = 0;
+        const auto write = [&](uint64_t at, const void* bytes, std::size_t size) {
+            static constexpr char zeros[16] = {};
+            out.write(zeros, static_cast<std::streamsize>(at - written));
+            out.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(size));
+            written = at + size;
+        };
+        write(0, &header, sizeof(header));
+        write(header.columnsOffset, columns.data(), columns.size() * sizeof(SceneColumn));
+        write(header.runsOffset, runs.data(), runs.size() * sizeof(SceneRun));
+        write(header.chunksOffset, chunks.data(), chunks.size() * sizeof(SceneChunk));
+        write(header.stringsOffset, strings.data(), strings.size() * sizeof(SceneString));
+        write(header.sourceOffset, order.data(), order.size() * sizeof(uint32_t));
+        for (std::size_t c = 0; c < columns.size(); ++c) write(columns[c].dataOffset, data[c].data(), data[c].size());
+        write(header.blobOffset, blob.data(), blob.size());
+        if (!out) return false;
+    }
+    std::filesystem::rename(temporary, path, error);
+    if (error) std::filesystem::remove(temporary, error);
+    return !error;
+}
+
+std::optional<SceneFile> SceneFile::Open(const std::filesystem::path& path) {
+    std::optional<MappedFile> mapped = MappedFile::Open(path);
+    if (!mapped || mapped->Size() < sizeof(SceneFileHeader)) return std::nullopt;
+
+    const auto* header = reinterpret_cast<const SceneFileHeader*>(mapped->Data());
+    const uint64_t size = mapped->Size();
+    if (header->magic != SceneFileMagic || header->version != SceneFileVersion || header->fileSize != size)
+        return std::nullopt;
+    const uint64_t stringCount = uint64_t{ header->meshCount } + header->materialCount;
+    if (header->columnCount > MaxSceneColumns
+        || !SectionFits(header->columnsOffset, uint64_t{ header->columnCount } * sizeof(SceneColumn), size)
+        || !SectionFits(header->runsOffset, uint64_t{ header->runCount } * sizeof(SceneRun), size)
+        || !SectionFits(header->chunksOffset, uint64_t{ header->chunkCount } * sizeof(SceneChunk), size)
+        || !SectionFits(header->stringsOffset, stringCount * sizeof(SceneString), size)
+        || !SectionFits(header->sourceOffset, uint64_t{ header->entityCount } * sizeof(uint32_t), size)
+        || header->blobOffset > size || header->blobSize > size - header->blobOffset)
+        return std::nullopt;
+
+    // columns: known, built with this build's component layouts, one per type
+    const auto* columns = reinterpret_cast<const SceneColumn*>(mapped->Data() + header->columnsOffset);
+    uint32_t types = 0;
+    for (uint32_t c = 0; c < header->columnCount; ++c) {
+        const SceneColumn& column = columns[c];
+        const uint32_t elementSize = ElementSize(column.type);
+        if (elementSize == 0 || column.elementSize != elementSize || (types & (1u << static_cast<uint32_t>(column.type)))
+            || !SectionFits(column.dataOffset, uint64_t{ column.count } * elementSize, size))
+            return std::nullopt;
+        types |= 1u << static_cast<uint32_t>(column.type);
+    }
+
+    // runs tile the entities and account for every column element; chunks tile the runs
+    const auto* runs = reinterpret_cast<const SceneRun*>(mapped->Data() + header->runsOffset);
+    std::vector<uint64_t> covered(header->columnCount, 0);
+    uint64_t next = 0;
+    for (uint32_t r = 0; r < header->runCount; ++r) {
+        const SceneRun& run = runs[r];
+        if (run.firstEntity != next || (header->columnCount < 32 && (run.columnMask >> header->columnCount) != 0)) return std::nullopt;
+        next += run.count;
+        for (uint32_t c = 0; c < header->columnCount; ++c)
+            if (run.columnMask & (1u << c)) covered[c] += run.count;
+    }
+    if (next != header->entityCount) return std::nullopt;
+    for (uint32_t c = 0; c < header->columnCount; ++c)
+        if (covered[c] != columns[c].count) return std::nullopt;
+
+    const auto* chunks = reinterpret_cast<const SceneChunk*>(mapped->Data() + header->chunksOffset);
+    uint64_t nextRun = 0;
+    for (uint32_t k = 0; k < header->chunkCount; ++k) {
+        const SceneChunk& chunk = chunks[k];
+        if (chunk.firstRun != nextRun || chunk.runCount == 0 || nextRun + chunk.runCount > header->runCount) return std::nullopt;
+        const SceneRun& first = runs[chunk.firstRun];
+        const SceneRun& last = runs[chunk.firstRun + chunk.runCount - 1];
+        if (chunk.firstEntity != first.firstEntity || uint64_t{ chunk.firstEntity } + chunk.entityCount != uint64_t{ last.firstEntity } + last.count)
+            return std::nullopt;
+        nextRun += chunk.runCount;
+    }
+    if (nextRun != header->runCount) return std::nullopt;
+
+    // the source order is a permutation
+    const auto* source = reinterpret_cast<const uint32_t*>(mapped->Data() + header->sourceOffset);
+    std::vector<bool> seen(header->entityCount, false);
+    for (uint32_t e = 0; e < header->entityCount; ++e) {
+        if (source[e] >= header->entityCount || seen[source[e]]) return std::nullopt;
+        seen[source[e]] = true;
+    }
+
+    // every string lies inside the blob
+    const auto stringFits = [&](const SceneString& string) { return uint64_t{ string.offset } + string.length <= header->blobSize; };
+    const auto* strings = reinterpret_cast<const SceneString*>(mapped->Data() + header->stringsOffset);
+    for (uint64_t i = 0; i < stringCount; ++i)
+        if (!stringFits(strings[i])) return std::nullopt;
+    for (uint32_t c = 0; c < header->columnCount; ++c) {
+        if (columns[c].type != SceneComponent::Name) continue;
+        const auto* names = reinterpret_cast<const SceneString*>(mapped->Data() + columns[c].dataOffset);
+        for (uint32_t i = 0; i < columns[c].count; ++i)
+            if (!stringFits(names[i])) return std::nullopt;
+    }
+
+    SceneFile file(std::move(*mapped));
+    file.header = reinterpret_cast<const SceneFileHeader*>(file.file.Data());
+    return file;
+}
+
+std::span<const SceneColumn> SceneFile::Columns() const {
+    return { At<SceneColumn>(header->columnsOffset), header->columnCount };
+}
+
+std::span<const SceneRun> SceneFile::Runs() const {
+    return { At<SceneRun>(header->runsOffset), header->runCount };
+}
+
+std::span<const SceneChunk> SceneFile::Chunks() const {
+    return { At<SceneChunk>(header->chunksOffset), header->chunkCount };
+}
+
+std::span<const uint32_t> SceneFile::SourceOrder() const {
+    return { At<uint32_t>(header->sourceOffset), header->entityCount };
+}
+
+std::span<const std::byte> SceneFile::ColumnData(const SceneColumn& column) const {
+    return { At<std::byte>(column.dataOffset), std::size_t{ column.count } * column.elementSize };
+}
+
+std::string_view SceneFile::Mesh(uint32_t index) const {
+    return index < header->meshCount ? String(At<SceneString>(header->stringsOffset)[index]) : std::string_view();
+}
+
+std::string_view SceneFile::Material(uint32_t index) const {
+    return index < header->materialCount ? String(At<SceneString>(header->stringsOffset)[header->meshCount + index]) : std::string_view();
+}
+
+std::string_view SceneFile::String(const SceneString& string) const {
+    return { reinterpret_cast<const char*>(file.Data() + header->blobOffset + string.offset), string.length };
+}
@@ -0,0 +1,163 @@
+/* Baked binary scene container (.escene).
+
+   Layout, little-endian, every section 16-byte aligned:
+
+     SceneFileHeader
+     SceneColumn[columnCount]     one per component type present
+     SceneRun[runCount]           entities grouped by which columns they have
+     SceneChunk[chunkCount]       runs grouped into independently loadable ranges
+     SceneString[meshCount + materialCount]
+     uint32_t[entityCount]        authoring index of each file entity
+     column data                  per column: `count` raw components, packed
+     string blob
+
+   Entities are numbered 0..entityCount-1 in the file, sorted so that
+   entities with the same set of components (an archetype) are adjacent: a
+   run is such a range, and its columnMask says which columns cover it.
+   Each column stores its component values back to back, in entity order,
+   exactly as they sit in ComponentArray storage, so loading a column is a
+   block copy; a column's element for entity e is found from the runs, which
+   are the scene's column table. The source section maps each file entity
+   back to its position in the authored scene. References inside components are file
+   numbers the loader remaps: Transform::parent holds the parent's entity
+   number (or NullEntity), MeshRenderer::mesh and ::material index the mesh
+   and material name tables. Names are a column of SceneStrings.
+
+   Chunks split the entities into ranges that share nothing, so
+   InstantiateScene (SceneLoader.hpp) fills them on worker threads. Files
+   come from WriteSceneFile, usually through the scene_compiler tool.
+
+example usage:
+
+WriteSceneFile("level.escene", *ParseSceneJson(json));
+std::optional<SceneFile> scene = SceneFile::Open("level.escene");
+InstantiateScene(world, *scene, bindings, &jobs); */
+#pragma once
+#include "../components/Camera.hpp"
+#include "../components/MeshRenderer.hpp"
+#include "../components/Transform.hpp"
+#include "../utils/MappedFile.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+inline constexpr uint32_t SceneFileMagic = 0x4E435345; // "ESCN"
+inline constexpr uint32_t SceneFileVersion = 1;
+inline constexpr uint32_t MaxSceneColumns = 32;         // SceneRun::columnMask
+inline constexpr uint32_t DefaultSceneChunkEntities = 16384;
+
+enum class SceneComponent : uint32_t {
+    Name = 0, // SceneString
+    Transform = 1,
+    MeshRenderer = 2,
+    Camera = 3,
+};
+
+struct SceneFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entityCount;
+    uint32_t columnCount;
+    uint32_t runCount;
+    uint32_t chunkCount;
+    uint32_t meshCount;
+    uint32_t materialCount;
+    uint64_t columnsOffset;
+    uint64_t runsOffset;
+    uint64_t chunksOffset;
+    uint64_t stringsOffset;
+    uint64_t blobOffset;
+    uint64_t blobSize;
+    uint64_t sourceOffset;
+    uint64_t fileSize;
+};
+
+struct SceneColumn {
+    SceneComponent type;
+    uint32_t elementSize; // sizeof the component; must match this build
+    uint32_t count;
+    uint32_t reserved;
+    uint64_t dataOffset;
+};
+
+struct SceneRun {
+    uint32_t firstEntity;
+    uint32_t count;
+    uint32_t columnMask;  // bit c: column c has an element for every entity of the run
+    uint32_t reserved;
+};
+
+struct SceneChunk {
+    uint32_t firstRun;
+    uint32_t runCount;
+    uint32_t firstEntity;
+    uint32_t entityCount;
+};
+
+struct SceneString {
+    uint32_t offset;      // into the string blob
+    uint32_t length;
+};
+
+static_assert(sizeof(SceneFileHeader) == 96 && sizeof(SceneColumn) == 24 && sizeof(SceneRun) == 16
+                  && sizeof(SceneChunk) == 16 && sizeof(SceneString) == 8,
+              "The .escene layout is part of the file format.");
+
+// Owning scene in authoring form, one struct per entity, as the JSON
+// compiler produces it. References use the same numbering as the file:
+// Transform::parent is Entity{ index into `entities` } or NullEntity,
+// MeshRenderer::mesh / ::material index `meshes` / `materials`.
+struct SceneEntity {
+    std::string name;
+    std::optional<Transform> transform;
+    std::optional<MeshRenderer> meshRenderer;
+    std::optional<Camera> camera;
+};
+
+struct SceneData {
+    std::vector<SceneEntity> entities;
+    std::vector<std::string> meshes;
+    std::vector<std::string> materials;
+};
+
+// Sorts the entities by archetype (remapping parents), splits them into
+// chunks of about `chunkEntities` and writes through a temporary file and a
+// rename, like WriteMeshFile.
+bool WriteSceneFile(const std::filesystem::path& path, const SceneData& scene,
+                    uint32_t chunkEntities = DefaultSceneChunkEntities);
+
+class SceneFile {
+public:
+    // nullopt if the file is missing, foreign, another version, damaged, or
+    // was written by a build whose component layouts differ.
+    static std::optional<SceneFile> Open(const std::filesystem::path& path);
+
+    const SceneFileHeader& Header() const { return *header; }
+
+    // Spans point into the mapping; valid while this SceneFile lives.
+    std::span<const SceneColumn> Columns() const;
+    std::span<const SceneRun> Runs() const;
+    std::span<const SceneChunk> Chunks() const;
+    std::span<const uint32_t> SourceOrder() const; // file entity -> index in the authored SceneData
+    std::span<const std::byte> ColumnData(const SceneColumn& column) const;
+    std::string_view Mesh(uint32_t index) const;
+    std::string_view Material(uint32_t index) const;
+    std::string_view String(const SceneString& string) const;
+
+    // Pages the whole file in (see MappedFile::Prefetch).
+    void Prefetch() const { file.Prefetch(); }
+
+private:
+    explicit SceneFile(MappedFile mapped) : file(std::move(mapped)) {}
+
+    template<typename T>
+    const T* At(uint64_t offset) const { return reinterpret_cast<const T*>(file.Data() + offset); }
+
+    MappedFile file;
+    const SceneFileHeader* header = nullptr;
+};
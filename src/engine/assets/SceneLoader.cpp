@@ -0,0 +1,328 @@
+#include "SceneLoader.hpp"
+#include "../core/JobSystem.hpp"
+#include "../utils/Json.hpp"
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+
+namespace {
+
+template<typename Fn>
+void RunJobs(JobSystem* jobs, std::size_t count, Fn&& fn) {
+    if (!jobs || count < 2) {
+        for (std::size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+    JobCounter done;
+    for (std::size_t i = 1; i < count; ++i) jobs->Submit([&fn, i] { fn(i); }, &done);
+    fn(0);
+    jobs->Wait(done);
+}
+
+// [x, y, z], or a single number for all three when `uniform` allows it.
+template<int N>
+bool ReadVector(const JsonValue& value, glm::vec<N, float>& out, bool uniform = false) {
+    if (uniform && value.IsNumber()) {
+        out = glm::vec<N, float>(static_cast<float>(value.Number()));
+        return true;
+    }
+    if (!value.IsArray() || value.Size() != N) return false;
+    for (int i = 0; i < N; ++i) {
+        if (!value.Items()[i].IsNumber()) return false;
+        out[i] = static_cast<float>(value.Items()[i].Number());
+    }
+    return true;
+}
+
+class SceneParser {
+public:
+    explicit SceneParser(std::string* errorOut) : error(errorOut) {}
+
+    std::optional<SceneData> Parse(const JsonValue& root) {
+        const JsonValue* entities = root.Find("entities");
+        if (!entities || !entities->IsArray()) return Fail("\"entities\" must be an array");
+
+        const std::vector<JsonValue>& items = entities->Items();
+        scene.entities.resize(items.size());
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            if (!items[i].IsObject()) return Fail(Where(i) + " is not an object");
+            if (const JsonValue* name = items[i].Find("name")) {
+                if (!name->IsString()) return Fail(Where(i) + ".name must be a string");
+                scene.entities[i].name = name->String();
+                byName.try_emplace(scene.entities[i].name, static_cast<uint32_t>(i));
+            }
+        }
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            SceneEntity& entity = scene.entities[i];
+            if (const JsonValue* components = items[i].Find("components")) {
+                if (!components->IsArray()) return Fail(Where(i) + ".components must be an array");
+                for (std::size_t c = 0; c < components->Size(); ++c)
+                    if (!ParseComponent(components->Items()[c], i, c, entity)) return std::nullopt;
+            }
+            if (const JsonValue* parent = items[i].Find("parent"); parent && !ParseParent(*parent, i, entity))
+                return std::nullopt;
+        }
+        return std::move(scene);
+    }
+
+private:
+    static std::string Where(std::size_t entity) { return "entities[" + std::to_string(entity) + "]"; }
+
+    std::nullopt_t Fail(const std::string& message) {
+        if (error) *error = message;
+        return std::nullopt;
+    }
+
+    bool Invalid(std::size_t entity, std::string_view field) {
+        Fail(Where(entity) + ": invalid " + std::string(field));
+        return false;
+    }
+
+    uint32_t Intern(std::vector<std::string>& table, std::unordered_map<std::string, uint32_t>& index, std::string_view name) {
+        auto [it, inserted] = index.try_emplace(std::string(name), static_cast<uint32_t>(table.size()));
+        if (inserted) table.emplace_back(name);
+        return it->second;
+    }
+
+    // Number fields: absent keeps `out`, present must be a number.
+    static bool ReadNumber(const JsonValue& value, const char* key, float& out, float scale = 1.0f) {
+        const JsonValue* field = value.Find(key);
+        if (!field) return true;
+        if (!field->IsNumber()) return false;
+        out = static_cast<float>(field->Number()) * scale;
+        return true;
+    }
+
+    bool ParseComponent(const JsonValue& value, std::size_t i, std::size_t c, SceneEntity& entity) {
+        const JsonValue* type = value.IsObject() ? value.Find("type") : nullptr;
+        if (!type || !type->IsString()) {
+            Fail(Where(i) + ".components[" + std::to_string(c) + "] needs a \"type\"");
+            return false;
+        }
+        if (type->String() == "Transform") return ParseTransform(value, i, entity);
+        if (type->String() == "MeshRenderer") return ParseMeshRenderer(value, i, entity);
+        if (type->String() == "Camera") return ParseCamera(value, i, entity);
+        Fail(Where(i) + ": unknown component type \"" + std::string(type->String()) + "\"");
+        return false;
+    }
+
+    bool ParseTransform(const JsonValue& value, std::size_t i, SceneEntity& entity) {
+        Transform& transform = entity.transform ? *entity.transform : entity.transform.emplace();
+        if (const JsonValue* position = value.Find("position"); position && !ReadVector(*position, transform.position))
+            return Invalid(i, "Transform position");
+        if (const JsonValue* rotation = value.Find("rotation")) {
+            glm::vec3 degrees;
+            if (!ReadVector(*rotation, degrees)) return Invalid(i, "Transform rotation");
+            transform.rotation = glm::quat(glm::radians(degrees));
+        }
+        if (const JsonValue* scale = value.Find("scale"); scale && !ReadVector(*scale, transform.scale, true))
+            return Invalid(i, "Transform scale");
+        transform.local = transform.LocalMatrix();
+        transform.world = transform.local;
+        return true;
+    }
+
+    bool ParseParent(const JsonValue& parent, std::size_t i, SceneEntity& entity) {
+        uint32_t index;
+        if (parent.IsString()) {
+            auto it = byName.find(std::string(parent.String()));
+            if (it == byName.end()) {
+                Fail(Where(i) + ": no parent entity named \"" + std::string(parent.String()) + "\"");
+                return false;
+            }
+            index = it->second;
+        } else if (parent.IsNumber() && parent.Number() >= 0 && parent.Number() < static_cast<double>(scene.entities.size())) {
+            index = static_cast<uint32_t>(parent.Number());
+        } else {
+            return Invalid(i, "parent");
+        }
+        if (index == i) return Invalid(i, "parent (the entity itself)");
+        // the parent link lives on Transform, so a parented entity always has one
+        if (!entity.transform) entity.transform.emplace();
+        entity.transform->parent = ecs::Entity{ index, 0 };
+        return true;
+    }
+
+    bool ParseMeshRenderer(const JsonValue& value, std::size_t i, SceneEntity& entity) {
+        MeshRenderer& renderer = entity.meshRenderer.emplace();
+        if (const JsonValue* mesh = value.Find("mesh")) {
+            if (!mesh->IsString()) return Invalid(i, "MeshRenderer mesh");
+            renderer.mesh = Intern(scene.meshes, meshIndex, mesh->String());
+        }
+        if (const JsonValue* material = value.Find("material")) {
+            if (!material->IsString()) return Invalid(i, "MeshRenderer material");
+            renderer.material = Intern(scene.materials, materialIndex, material->String());
+        }
+        if (const JsonValue* layer = value.Find("layer")) {
+            if (!layer->IsNumber() || layer->Number() < 0 || layer->Number() > 15) return Invalid(i, "MeshRenderer layer");
+            renderer.layer = static_cast<uint8_t>(layer->Number());
+        }
+        if (const JsonValue* isStatic = value.Find("static")) {
+            if (!isStatic->IsBool()) return Invalid(i, "MeshRenderer static");
+            renderer.isStatic = isStatic->Bool();
+        }
+        if (const JsonValue* params = value.Find("params"); params && !ReadVector(*params, renderer.params))
+            return Invalid(i, "MeshRenderer params");
+        return true;
+    }
+
+    bool ParseCamera(const JsonValue& value, std::size_t i, SceneEntity& entity) {
+        Camera& camera = entity.camera.emplace();
+        if (const JsonValue* projection = value.Find("projection")) {
+            if (projection->String() == "perspective")
+                camera.projection = Camera::Projection::Perspective;
+            else if (projection->String() == "orthographic")
+                camera.projection = Camera::Projection::Orthographic;
+            else
+                return Invalid(i, "Camera projection");
+        }
+        if (!ReadNumber(value, "fov", camera.fovY, glm::radians(1.0f))) return Invalid(i, "Camera fov");
+        if (!ReadNumber(value, "orthoHeight", camera.orthoHeight)) return Invalid(i, "Camera orthoHeight");
+        if (!ReadNumber(value, "aspect", camera.aspect)) return Invalid(i, "Camera aspect");
+        if (!ReadNumber(value, "near", camera.nearPlane)) return Invalid(i, "Camera near");
+        if (!ReadNumber(value, "far", camera.farPlane)) return Invalid(i, "Camera far");
+        return true;
+    }
+
+    std::string* error;
+    SceneData scene;
+    std::unordered_map<std::string, uint32_t> byName; // first entity with each name
+    std::unordered_map<std::string, uint32_t> meshIndex;
+    std::unordered_map<std::string, uint32_t> materialIndex;
+};
+
+// One run of one column: a block copy into the packed storage, then the
+// handles and the references that need remapping.
+template<typename T, typename Fix>
+void FillRun(ecs::ComponentArray<T>& storage, uint32_t dense, const std::byte* source, std::span<const ecs::Entity> entities,
+             Fix&& fix) {
+    static_assert(std::is_trivially_copyable_v<T>, "Scene columns are block copied into component storage.");
+    T* out = storage.Components().data() + dense;
+    std::memcpy(static_cast<void*>(out), source, entities.size() * sizeof(T));
+    for (uint32_t i = 0; i < entities.size(); ++i) {
+        storage.Place(dense + i, entities[i]);
+        fix(out[i]);
+    }
+}
+
+}
+
+std::optional<SceneData> ParseSceneJson(std::string_view json, std::string* error) {
+    const std::optional<JsonValue> root = ParseJson(json, error);
+    if (!root) return std::nullopt;
+    return SceneParser(error).Parse(*root);
+}
+
+std::vector<ecs::Entity> InstantiateScene(ecs::World& world, const SceneFile& scene, const SceneBindings& bindings, JobSystem* jobs) {
+    ecs::Coordinator& coordinator = world.GetCoordinator();
+    const SceneFileHeader& header = scene.Header();
+    const std::span<const SceneColumn> columns = scene.Columns();
+    const std::span<const SceneRun> runs = scene.Runs();
+    const std::span<const SceneChunk> chunks = scene.Chunks();
+
+    // 1. the remap table: file entity number -> entity
+    std::vector<ecs::Entity> entities;
+    coordinator.CreateEntities(header.entityCount, entities);
+    if (entities.empty()) return entities;
+    ecs::EntityIndex maxIndex = 0;
+    for (ecs::Entity entity : entities) maxIndex = std::max(maxIndex, entity.index);
+
+    std::vector<MeshHandle> meshes(header.meshCount);
+    for (uint32_t i = 0; i < header.meshCount; ++i) meshes[i] = bindings.mesh ? bindings.mesh(scene.Mesh(i)) : i;
+    std::vector<MaterialHandle> materials(header.materialCount);
+    for (uint32_t i = 0; i < header.materialCount; ++i) materials[i] = bindings.material ? bindings.material(scene.Material(i)) : i;
+
+    // 2. grow each component array once; runStart[r * columns + c] is run r's first element in column c
+    const std::size_t columnCount = columns.size();
+    std::vector<uint32_t> runStart(runs.size() * columnCount);
+    std::vector<uint32_t> filled(columnCount, 0);
+    for (std::size_t r = 0; r < runs.size(); ++r)
+        for (std::size_t c = 0; c < columnCount; ++c) {
+            runStart[r * columnCount + c] = filled[c];
+            if (runs[r].columnMask & (1u << c)) filled[c] += runs[r].count;
+        }
+
+    ecs::ComponentArray<Transform>* transforms = nullptr;
+    ecs::ComponentArray<MeshRenderer>* renderers = nullptr;
+    ecs::ComponentArray<Camera>* cameras = nullptr;
+    std::vector<uint32_t> base(columnCount, 0);
+    for (std::size_t c = 0; c < columnCount; ++c) {
+        switch (columns[c].type) {
+        case SceneComponent::Name: break;
+        case SceneComponent::Transform:
+            transforms = &coordinator.GetComponentStorage<Transform>();
+            base[c] = transforms->Extend(columns[c].count, maxIndex);
+            break;
+        case SceneComponent::MeshRenderer:
+            renderers = &coordinator.GetComponentStorage<MeshRenderer>();
+            base[c] = renderers->Extend(columns[c].count, maxIndex);
+            break;
+        case SceneComponent::Camera:
+            cameras = &coordinator.GetComponentStorage<Camera>();
+            base[c] = cameras->Extend(columns[c].count, maxIndex);
+            break;
+        }
+    }
+
+    // 3. chunks touch disjoint storage ranges and entities, so they fill in parallel
+    const auto entityOf = [&](ecs::Entity file) {
+        return file.IsValid() && file.index < entities.size() ? entities[file.index] : ecs::NullEntity;
+    };
+    RunJobs(jobs, chunks.size(), [&](std::size_t k) {
+        const SceneChunk& chunk = chunks[k];
+        for (uint32_t r = chunk.firstRun; r < chunk.firstRun + chunk.runCount; ++r) {
+            const SceneRun& run = runs[r];
+            const std::span<const ecs::Entity> runEntities(entities.data() + run.firstEntity, run.count);
+            for (std::size_t c = 0; c < columnCount; ++c) {
+                if (!(run.columnMask & (1u << c))) continue;
+                const uint32_t element = runStart[r * columnCount + c];
+                const std::byte* source = scene.ColumnData(columns[c]).data() + std::size_t{ element } * columns[c].elementSize;
+                switch (columns[c].type) {
+                case SceneComponent::Name: break;
+                case SceneComponent::Transform:
+                    FillRun(*transforms, base[c] + element, source, runEntities,
+                            [&](Transform& transform) { transform.parent = entityOf(transform.parent); });
+                    break;
+                case SceneComponent::MeshRenderer:
+                    FillRun(*renderers, base[c] + element, source, runEntities, [&](MeshRenderer& renderer) {
+                        renderer.mesh = renderer.mesh < meshes.size() ? meshes[renderer.mesh] : 0;
+                        renderer.material = renderer.material < materials.size() ? materials[renderer.material] : 0;
+                    });
+                    break;
+                case SceneComponent::Camera:
+                    FillRun(*cameras, base[c] + element, source, runEntities, [](Camera&) {});
+                    break;
+                }
+            }
+        }
+    });
+
+    // 4. one signature and one system/query match per run; names go to the world
+    for (const SceneColumn& column : columns)
+        if (column.type == SceneComponent::Name) world.ReserveNames(column.count);
+    for (std::size_t r = 0; r < runs.size(); ++r) {
+        const SceneRun& run = runs[r];
+        const std::span<const ecs::Entity> runEntities(entities.data() + run.firstEntity, run.count);
+        ecs::Signature signature;
+        for (std::size_t c = 0; c < columnCount; ++c) {
+            if (!(run.columnMask & (1u << c))) continue;
+            switch (columns[c].type) {
+            case SceneComponent::Name: {
+                const auto* names = reinterpret_cast<const SceneString*>(scene.ColumnData(columns[c]).data()) + runStart[r * columnCount + c];
+                for (uint32_t i = 0; i < run.count; ++i) world.SetName(runEntities[i], std::string(scene.String(names[i])));
+                break;
+            }
+            case SceneComponent::Transform: signature.set(ecs::ComponentType<Transform>::id); break;
+            case SceneComponent::MeshRenderer: signature.set(ecs::ComponentType<MeshRenderer>::id); break;
+            case SceneComponent::Camera: signature.set(ecs::ComponentType<Camera>::id); break;
+            }
+        }
+        coordinator.SetSignatures(runEntities, signature);
+    }
+
+    std::vector<ecs::Entity> authored(entities.size());
+    const std::span<const uint32_t> source = scene.SourceOrder();
+    for (std::size_t e = 0; e < entities.size(); ++e) authored[source[e]] = entities[e];
+    return authored;
+}
@@ -0,0 +1,63 @@
+/* Scene authoring (JSON) and bulk instantiation from baked .escene files.
+
+   Scenes are authored as JSON and compiled offline (ParseSceneJson +
+   WriteSceneFile, i.e. the scene_compiler tool, which the build runs over
+   assets/scenes). At runtime InstantiateScene never touches JSON and never
+   adds components one at a time:
+
+     1. every entity is created in one call (EntityManager::CreateEntities),
+        which gives the file-number -> Entity remap table;
+     2. each component array grows once per column (ComponentArray::Extend);
+     3. the chunks are filled on worker threads: per run and column one
+        block copy from the mapping into the packed storage, then the
+        references (parents, mesh and material handles) are remapped;
+     4. signatures are set and systems/queries matched once per run.
+
+   JSON layout, as in the README ("assets" and other top-level keys are the
+   application's and are ignored here; names in components are resolved
+   through SceneBindings):
+
+   { "entities": [
+       { "name": "ship", "parent": "fleet",                       // parent: name, or index into "entities"
+         "components": [
+           { "type": "Transform", "position": [0, 1, 0],
+             "rotation": [0, 90, 0], "scale": [1, 1, 1] },        // Euler degrees, XYZ; scale may be a number
+           { "type": "MeshRenderer", "mesh": "ship", "material": "hull",
+             "layer": 0, "static": false, "params": [1, 1, 1, 1] },
+           { "type": "Camera", "projection": "perspective", "fov": 60,   // degrees
+             "orthoHeight": 10, "aspect": 1.777, "near": 0.1, "far": 1000 } ] } ] }
+
+example usage:
+
+std::optional<SceneFile> scene = SceneFile::Open("scenes/level1.escene");
+SceneBindings bindings{ [&](std::string_view mesh) { return renderer.AddMesh(Load(mesh)); },
+                        [&](std::string_view material) { return materials.at(std::string(material)); } };
+std::vector<ecs::Entity> entities = InstantiateScene(world, *scene, bindings, &jobs); */
+#pragma once
+#include "SceneFile.hpp"
+#include "../ecs/World.hpp"
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class JobSystem;
+
+// nullopt on malformed JSON or a bad reference; `error` then says why.
+std::optional<SceneData> ParseSceneJson(std::string_view json, std::string* error = nullptr);
+
+// Turns the scene's mesh and material names into RenderSystem handles;
+// each name is resolved once per instantiation, not once per entity. Left
+// empty, the handles are the table indices.
+struct SceneBindings {
+    std::function<MeshHandle(std::string_view)> mesh;
+    std::function<MaterialHandle(std::string_view)> material;
+};
+
+// Creates every entity of `scene` in `world` and returns them in authoring
+// order (index = position in the SceneData the file was written from). The component types the scene uses
+// must be registered with the world's coordinator. `jobs` fills the chunks
+// in parallel; null fills them on the calling thread.
+std::vector<ecs::Entity> InstantiateScene(ecs::World& world, const SceneFile& scene, const SceneBindings& bindings = {},
+                                          JobSystem* jobs = nullptr);
@@ -0,0 +1,117 @@
+#include "TextureFile.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <system_error>
+
+namespace {
+
+constexpr uint64_t Align16(uint64_t offset) { return (offset + 15) & ~uint64_t{ 15 }; }
+
+// Unique per writer, across threads and processes: two bakes of the same
+// entry each write their own file and the last rename wins.
+std::filesystem::path TemporaryPath(const std::filesystem::path& path) {
+    static const uint64_t process = (uint64_t{ std::random_device{}() } << 32) ^ std::random_device{}();
+    static std::atomic<uint64_t> writers{ 0 };
+    char suffix[48];
+    std::snprintf(suffix, sizeof(suffix), ".%016llx-%llu.tmp", static_cast<unsigned long long>(process),
+                  static_cast<unsigned long long>(writers.fetch_add(1, std::memory_order_relaxed)));
+    return std::filesystem::path(path).concat(suffix);
+}
+
+}
+
+std::size_t TextureLevelSize(TextureFormat format, uint32_t width, uint32_t height) {
+    const std::size_t blocks = std::size_t{ (width + 3) / 4 } * ((height + 3) / 4);
+    switch (format) {
+    case TextureFormat::RGBA8: return std::size_t{ width } * height * 4;
+    case TextureFormat::BC1: return blocks * 8;
+    case TextureFormat::BC3: return blocks * 16;
+    }
+    return 0;
+}
+
+bool WriteTextureFile(const std::filesystem::path& path, const TextureView& texture, uint64_t sourceKey) {
+    if (texture.levels.empty() || texture.levels.size() > MaxTextureMips) return false;
+
+    TextureFileHeader header{};
+    header.magic = TextureFileMagic;
+    header.version = TextureFileVersion;
+    header.width = texture.levels[0].width;
+    header.height = texture.levels[0].height;
+    header.mipCount = static_cast<uint32_t>(texture.levels.size());
+    header.format = texture.format;
+    header.srgb = texture.srgb ? 1 : 0;
+    header.sourceKey = sourceKey;
+
+    std::vector<TextureMip> mips;
+    uint64_t offset = Align16(sizeof(header) + texture.levels.size() * sizeof(TextureMip));
+    for (const TextureLevel& level : texture.levels) {
+        mips.push_back({ level.width, level.height, offset, level.data.size() });
+        offset = Align16(offset + level.data.size());
+    }
+    header.fileSize = mips.back().offset + mips.back().size;
+
+    std::error_code error;
+    if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path(), error);
+    const std::filesystem::path temporary = TemporaryPath(path);
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+
+        uint64_t written = 0;
+        const auto write = [&](uint64_t at, const void* data, std::size_t bytes) {
+            static constexpr char zeros[16] = {};
+            out.write(zeros, static_cast<std::streamsize>(at - written));
+            out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+            written = at + bytes;
+        };
+        write(0, &header, sizeof(header));
+        write(sizeof(header), mips.data(), mips.size() * sizeof(TextureMip));
+        for (std::size_t i = 0; i < mips.size(); ++i) write(mips[i].offset, texture.levels[i].data.data(), mips[i].size);
+        if (!out) return false;
+    }
+    std::filesystem::rename(temporary, path, error);
+    if (error) std::filesystem::remove(temporary, error);
+    return !error;
+}
+
+std::optional<TextureFile> TextureFile::Open(const std::filesystem::path& path) {
+    std::optional<MappedFile> mapped = MappedFile::Open(path);
+    if (!mapped || mapped->Size() < sizeof(TextureFileHeader)) return std::nullopt;
+
+    const auto* header = reinterpret_cast<const TextureFileHeader*>(mapped->Data());
+    const uint64_t size = mapped->Size();
+    if (header->magic != TextureFileMagic || header->version != TextureFileVersion || header->fileSize != size)
+        return std::nullopt;
+    if (header->mipCount == 0 || header->mipCount > MaxTextureMips || header->format > TextureFormat::BC3
+        || sizeof(TextureFileHeader) + header->mipCount * sizeof(TextureMip) > size)
+        return std::nullopt;
+
+    // every level lies inside the file, is aligned and has the size its dimensions need
+    const auto* mips = reinterpret_cast<const TextureMip*>(mapped->Data() + sizeof(TextureFileHeader));
+    for (uint32_t i = 0; i < header->mipCount; ++i) {
+        const TextureMip& mip = mips[i];
+        if (mip.offset % 16 != 0 || mip.offset > size || mip.size > size - mip.offset
+            || mip.width != std::max(1u, header->width >> i) || mip.height != std::max(1u, header->height >> i)
+            || mip.size != TextureLevelSize(header->format, mip.width, mip.height))
+            return std::nullopt;
+    }
+
+    TextureFile file(std::move(*mapped));
+    file.header = reinterpret_cast<const TextureFileHeader*>(file.file.Data());
+    return file;
+}
+
+TextureView TextureFile::View() const {
+    const std::byte* base = file.Data();
+    const auto* mips = reinterpret_cast<const TextureMip*>(base + sizeof(TextureFileHeader));
+    TextureView view;
+    view.format = header->format;
+    view.srgb = header->srgb != 0;
+    for (uint32_t i = 0; i < header->mipCount; ++i)
+        view.levels.push_back({ mips[i].width, mips[i].height, { base + mips[i].offset, mips[i].size } });
+    return view;
+}
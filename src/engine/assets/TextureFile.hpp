@@ -0,0 +1,100 @@
+/* Baked texture container (.etex), KTX-like.
+
+   Layout, little-endian, every level 16-byte aligned:
+
+     TextureFileHeader
+     TextureMip[mipCount]     level 0 first: size and where its bytes are
+     level data               in the texture's GL upload format
+
+   Levels are stored exactly as glTexImage2D / glCompressedTexImage2D take
+   them (tight RGBA8 rows, or 4x4 BC blocks), so TextureFile maps the file
+   and hands the mapping to the driver: a cached texture costs a page-in,
+   with no image decoding and no mip generation. `sourceKey` identifies the
+   source the file was baked from (TextureCache::KeyOf), so a stale entry
+   reads as a miss. Files come from WriteTextureFile.
+
+example usage:
+
+std::optional<TextureFile> file = TextureFile::Open(cache.PathOf(key));
+if (file && file->Header().sourceKey == key) UploadTexture(gl, file->View()); */
+#pragma once
+#include "../utils/MappedFile.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <vector>
+
+inline constexpr uint32_t TextureFileMagic = 0x58455445; // "ETEX"
+inline constexpr uint32_t TextureFileVersion = 1;
+inline constexpr uint32_t MaxTextureMips = 16;           // 32768 x 32768
+
+enum class TextureFormat : uint32_t {
+    RGBA8 = 0,
+    BC1 = 1, // opaque, 8 bytes per 4x4 block
+    BC3 = 2, // with alpha, 16 bytes per 4x4 block
+};
+
+struct TextureFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t mipCount;
+    TextureFormat format;
+    uint32_t srgb;      // colour data in sRGB encoding (sampled through an sRGB format)
+    uint32_t reserved;
+    uint64_t sourceKey;
+    uint64_t fileSize;
+};
+
+struct TextureMip {
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;
+    uint64_t size;
+};
+
+static_assert(sizeof(TextureFileHeader) == 48 && sizeof(TextureMip) == 24,
+              "The .etex layout is part of the file format.");
+
+// Bytes of one level of a width x height image in `format`.
+std::size_t TextureLevelSize(TextureFormat format, uint32_t width, uint32_t height);
+
+struct TextureLevel {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::span<const std::byte> data;
+};
+
+// Non-owning view of a texture in upload-ready form.
+struct TextureView {
+    TextureFormat format = TextureFormat::RGBA8;
+    bool srgb = true;
+    std::vector<TextureLevel> levels; // level 0 first
+};
+
+// Writes through a temporary file and a rename, like WriteMeshFile; the
+// temporary's name is unique per call, so concurrent writers of one path
+// never share it.
+bool WriteTextureFile(const std::filesystem::path& path, const TextureView& texture, uint64_t sourceKey);
+
+class TextureFile {
+public:
+    // nullopt if the file is missing, foreign, another version or damaged.
+    static std::optional<TextureFile> Open(const std::filesystem::path& path);
+
+    const TextureFileHeader& Header() const { return *header; }
+    // Level spans point into the mapping; valid while this TextureFile lives.
+    TextureView View() const;
+
+    // Pages the whole file in (see MappedFile::Prefetch).
+    void Prefetch() const { file.Prefetch(); }
+
+private:
+    explicit TextureFile(MappedFile mapped) : file(std::move(mapped)) {}
+
+    MappedFile file;
+    const TextureFileHeader* header = nullptr;
+};
@@ -0,0 +1,564 @@
+#include "TextureLoader.hpp"
+#include "AssetManager.hpp"
+#include "../gl/GLExtensions.hpp"
+#include "../utils/Hash.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <system_error>
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#pragma GCC diagnostic ignored "-Wunused-but-set-variable"
+#endif
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_FAILURE_USERMSG
+#include <stb_image.h>
+#define STB_DXT_IMPLEMENTATION
+#include <stb_dxt.h>
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ENGINE_TEXTURE_SSE 1
+#endif
+
+namespace {
+
+// Linear values are encoded through a table this fine so that the darkest
+// sRGB steps (where the curve is steepest) still round correctly.
+constexpr int EncodeSteps = 16384;
+
+struct ColorTables {
+    float srgbToLinear[256];
+    float unorm[256];                // byte / 255
+    uint8_t linearToSrgb[EncodeSteps];
+};
+
+const ColorTables& Tables() {
+    static const ColorTables tables = [] {
+        ColorTables t{};
+        for (int i = 0; i < 256; ++i) {
+            const float c = static_cast<float>(i) / 255.0f;
+            t.srgbToLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            t.unorm[i] = c;
+        }
+        for (int i = 0; i < EncodeSteps; ++i) {
+            const float l = static_cast<float>(i) / (EncodeSteps - 1);
+            const float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            t.linearToSrgb[i] = static_cast<uint8_t>(std::lround(std::clamp(c, 0.0f, 1.0f) * 255.0f));
+        }
+        return t;
+    }();
+    return tables;
+}
+
+// One source row to planar floats (r, g, b, a): colour through `color`,
+// alpha as unorm. Pixels [begin, width).
+void DecodeRowScalar(const uint8_t* row, uint32_t begin, uint32_t width, const float* color, const float* unorm,
+                     float* const planes[4]) {
+    for (uint32_t x = begin; x < width; ++x) {
+        const uint8_t* pixel = row + std::size_t{ x } * 4;
+        planes[0][x] = color[pixel[0]];
+        planes[1][x] = color[pixel[1]];
+        planes[2][x] = color[pixel[2]];
+        planes[3][x] = unorm[pixel[3]];
+    }
+}
+
+// Box sum order shared by both paths, so they agree to the bit.
+inline int32_t Quantise(float a, float b, float c, float d, float scale) {
+    const float average = std::clamp(((a + b) + (c + d)) * 0.25f, 0.0f, 1.0f);
+    return static_cast<int32_t>(average * scale + 0.5f);
+}
+
+// Output pixels [begin, end) of one row from two decoded source rows.
+// Indices are clamped so a 1-wide source pairs each pixel with itself.
+void FilterRowScalar(const float* const top[4], const float* const bottom[4], uint32_t begin, uint32_t end,
+                     uint32_t lastColumn, bool srgb, float encodeScale, const ColorTables& tables, uint8_t* dst) {
+    for (uint32_t x = begin; x < end; ++x) {
+        const uint32_t a = std::min(2 * x, lastColumn), b = std::min(2 * x + 1, lastColumn);
+        uint8_t* pixel = dst + std::size_t{ x } * 4;
+        for (int c = 0; c < 3; ++c) {
+            const int32_t q = Quantise(top[c][a], top[c][b], bottom[c][a], bottom[c][b], encodeScale);
+            pixel[c] = srgb ? tables.linearToSrgb[q] : static_cast<uint8_t>(q);
+        }
+        pixel[3] = static_cast<uint8_t>(Quantise(top[3][a], top[3][b], bottom[3][a], bottom[3][b], 255.0f));
+    }
+}
+
+#ifdef ENGINE_TEXTURE_SSE
+// Four pixels per vector. SSE2 has no gather, so sRGB colour stays a table
+// load per channel; linear colour and alpha convert in registers.
+void DecodeRowSse(const uint8_t* row, uint32_t width, bool srgb, const float* color, const float* unorm,
+                  float* const planes[4]) {
+    const __m128i low = _mm_set1_epi32(0xff);
+    const __m128 max = _mm_set1_ps(255.0f); // divided, not multiplied by 1/255: matches the unorm table exactly
+    uint32_t x = 0;
+    for (; x + 4 <= width; x += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + std::size_t{ x } * 4));
+        _mm_storeu_ps(planes[3] + x, _mm_div_ps(_mm_cvtepi32_ps(_mm_srli_epi32(pixels, 24)), max));
+        if (srgb) {
+            const uint8_t* p = row + std::size_t{ x } * 4;
+            for (int c = 0; c < 3; ++c)
+                _mm_storeu_ps(planes[c] + x, _mm_setr_ps(color[p[c]], color[p[4 + c]], color[p[8 + c]], color[p[12 + c]]));
+        } else {
+            _mm_storeu_ps(planes[0] + x, _mm_div_ps(_mm_cvtepi32_ps(_mm_and_si128(pixels, low)), max));
+            _mm_storeu_ps(planes[1] + x, _mm_div_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pixels, 8), low)), max));
+            _mm_storeu_ps(planes[2] + x, _mm_div_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pixels, 16), low)), max));
+        }
+    }
+    DecodeRowScalar(row, x, width, color, unorm, planes);
+}
+
+// Quantised 2x2 averages of one channel for output pixels x..x+3, i.e.
+// source columns 2x..2x+7: the even and odd columns are split out with a
+// shuffle so four boxes are summed per add.
+inline __m128i QuantiseSse(const float* top, const float* bottom, std::size_t column, __m128 scale) {
+    const __m128 t0 = _mm_loadu_ps(top + column), t1 = _mm_loadu_ps(top + column + 4);
+    const __m128 b0 = _mm_loadu_ps(bottom + column), b1 = _mm_loadu_ps(bottom + column + 4);
+    const __m128 topPairs = _mm_add_ps(_mm_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 1, 3, 1)));
+    const __m128 bottomPairs = _mm_add_ps(_mm_shuffle_ps(b0, b1, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 1, 3, 1)));
+    __m128 average = _mm_mul_ps(_mm_add_ps(topPairs, bottomPairs), _mm_set1_ps(0.25f));
+    average = _mm_min_ps(_mm_max_ps(average, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(average, scale), _mm_set1_ps(0.5f)));
+}
+
+void FilterRowSse(const float* const top[4], const float* const bottom[4], uint32_t width, uint32_t sourceWidth,
+                  bool srgb, float encodeScale, const ColorTables& tables, uint8_t* dst) {
+    const __m128 colorScale = _mm_set1_ps(encodeScale), alphaScale = _mm_set1_ps(255.0f);
+    uint32_t x = 0;
+    for (; x + 4 <= width && 2 * x + 8 <= sourceWidth; x += 4) {
+        const std::size_t column = std::size_t{ 2 } * x;
+        const __m128i r = QuantiseSse(top[0], bottom[0], column, colorScale);
+        const __m128i g = QuantiseSse(top[1], bottom[1], column, colorScale);
+        const __m128i b = QuantiseSse(top[2], bottom[2], column, colorScale);
+        const __m128i a = QuantiseSse(top[3], bottom[3], column, alphaScale);
+        uint8_t* pixels = dst + std::size_t{ x } * 4;
+        if (srgb) {
+            alignas(16) int32_t q[4][4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(q[0]), r);
+            _mm_store_si128(reinterpret_cast<__m128i*>(q[1]), g);
+            _mm_store_si128(reinterpret_cast<__m128i*>(q[2]), b);
+            _mm_store_si128(reinterpret_cast<__m128i*>(q[3]), _mm_slli_epi32(a, 24));
+            const uint8_t* encode = tables.linearToSrgb;
+            const __m128i packed = _mm_setr_epi32(
+                q[3][0] | encode[q[0][0]] | (encode[q[1][0]] << 8) | (encode[q[2][0]] << 16),
+                q[3][1] | encode[q[0][1]] | (encode[q[1][1]] << 8) | (encode[q[2][1]] << 16),
+                q[3][2] | encode[q[0][2]] | (encode[q[1][2]] << 8) | (encode[q[2][2]] << 16),
+                q[3][3] | encode[q[0][3]] | (encode[q[1][3]] << 8) | (encode[q[2][3]] << 16));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), packed);
+        } else {
+            const __m128i packed = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)),
+                                                _mm_or_si128(_mm_slli_epi32(b, 16), _mm_slli_epi32(a, 24)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), packed);
+        }
+    }
+    FilterRowScalar(top, bottom, x, width, sourceWidth - 1, srgb, encodeScale, tables, dst);
+}
+#endif
+
+template<bool Simd>
+Image DownsampleWith(const Image& source, ColorSpace colorSpace) {
+    const ColorTables& tables = Tables();
+    const bool srgb = colorSpace == ColorSpace::Srgb;
+    const float* color = srgb ? tables.srgbToLinear : tables.unorm;
+
+    Image out;
+    out.width = std::max(1u, source.width / 2);
+    out.height = std::max(1u, source.height / 2);
+    out.pixels.resize(std::size_t{ out.width } * out.height * 4);
+
+    // Two decoded source rows, four planes each.
+    const std::size_t planeSize = source.width;
+    std::vector<float> rows(planeSize * 8);
+    float* top[4];
+    float* bottom[4];
+    for (std::size_t c = 0; c < 4; ++c) {
+        top[c] = rows.data() + c * planeSize;
+        bottom[c] = rows.data() + (c + 4) * planeSize;
+    }
+    const float encodeScale = srgb ? static_cast<float>(EncodeSteps - 1) : 255.0f;
+
+    for (uint32_t y = 0; y < out.height; ++y) {
+        const uint32_t y0 = std::min(2 * y, source.height - 1), y1 = std::min(2 * y + 1, source.height - 1);
+        const uint8_t* row0 = source.pixels.data() + std::size_t{ y0 } * source.width * 4;
+        const uint8_t* row1 = source.pixels.data() + std::size_t{ y1 } * source.width * 4;
+        uint8_t* dst = out.pixels.data() + std::size_t{ y } * out.width * 4;
+#ifdef ENGINE_TEXTURE_SSE
+        if constexpr (Simd) {
+            DecodeRowSse(row0, source.width, srgb, color, tables.unorm, top);
+            DecodeRowSse(row1, source.width, srgb, color, tables.unorm, bottom);
+            FilterRowSse(top, bottom, out.width, source.width, srgb, encodeScale, tables, dst);
+            continue;
+        }
+#endif
+        DecodeRowScalar(row0, 0, source.width, color, tables.unorm, top);
+        DecodeRowScalar(row1, 0, source.width, color, tables.unorm, bottom);
+        FilterRowScalar(top, bottom, 0, out.width, source.width - 1, srgb, encodeScale, tables, dst);
+    }
+    return out;
+}
+
+bool HasAlpha(const Image& image) {
+    for (std::size_t i = 3; i < image.pixels.size(); i += 4)
+        if (image.pixels[i] != 255) return true;
+    return false;
+}
+
+// BC1/BC3 blocks of one level; edge blocks repeat the last row/column.
+std::vector<uint8_t> CompressLevel(const Image& level, TextureFormat format) {
+    const bool alpha = format == TextureFormat::BC3;
+    std::vector<uint8_t> out(TextureLevelSize(format, level.width, level.height));
+    uint8_t* block = out.data();
+    uint8_t texels[16 * 4];
+    for (uint32_t by = 0; by < level.height; by += 4)
+        for (uint32_t bx = 0; bx < level.width; bx += 4) {
+            for (uint32_t y = 0; y < 4; ++y)
+                for (uint32_t x = 0; x < 4; ++x) {
+                    const uint32_t sx = std::min(bx + x, level.width - 1), sy = std::min(by + y, level.height - 1);
+                    std::memcpy(texels + (y * 4 + x) * 4, level.pixels.data() + (std::size_t{ sy } * level.width + sx) * 4, 4);
+                }
+            stb_compress_dxt_block(block, texels, alpha ? 1 : 0, STB_DXT_NORMAL);
+            block += alpha ? 16 : 8;
+        }
+    return out;
+}
+
+void Expand565(uint16_t color, uint8_t* rgb) {
+    const uint32_t r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+    rgb[0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+    rgb[1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+    rgb[2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+}
+
+// 16 RGBA texels of a BC1 colour block. Inside BC3 the block always uses
+// the four-colour mode; standalone, color0 <= color1 selects three colours
+// and transparent black.
+void DecodeColorBlock(const uint8_t* block, bool fourColor, uint8_t* texels) {
+    const uint16_t c0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+    const uint16_t c1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+    uint8_t palette[4][4] = {};
+    Expand565(c0, palette[0]);
+    Expand565(c1, palette[1]);
+    palette[0][3] = palette[1][3] = palette[2][3] = 255;
+    for (int c = 0; c < 3; ++c) {
+        if (fourColor || c0 > c1) {
+            palette[2][c] = static_cast<uint8_t>((2 * palette[0][c] + palette[1][c]) / 3);
+            palette[3][c] = static_cast<uint8_t>((palette[0][c] + 2 * palette[1][c]) / 3);
+        } else {
+            palette[2][c] = static_cast<uint8_t>((palette[0][c] + palette[1][c]) / 2);
+        }
+    }
+    palette[3][3] = fourColor || c0 > c1 ? 255 : 0;
+
+    const uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | (uint32_t{ block[7] } << 24);
+    for (int i = 0; i < 16; ++i) std::memcpy(texels + i * 4, palette[(indices >> (2 * i)) & 3], 4);
+}
+
+// Overwrites the alpha of 16 texels from a BC3 alpha block.
+void DecodeAlphaBlock(const uint8_t* block, uint8_t* texels) {
+    uint8_t palette[8] = { block[0], block[1] };
+    if (block[0] > block[1]) {
+        for (int i = 1; i < 7; ++i) palette[i + 1] = static_cast<uint8_t>(((7 - i) * block[0] + i * block[1]) / 7);
+    } else {
+        for (int i = 1; i < 5; ++i) palette[i + 1] = static_cast<uint8_t>(((5 - i) * block[0] + i * block[1]) / 5);
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+    uint64_t indices = 0;
+    for (int i = 0; i < 6; ++i) indices |= uint64_t{ block[2 + i] } << (8 * i);
+    for (int i = 0; i < 16; ++i) texels[i * 4 + 3] = palette[(indices >> (3 * i)) & 7];
+}
+
+Image DecompressLevel(const TextureLevel& level, TextureFormat format) {
+    Image out;
+    out.width = level.width;
+    out.height = level.height;
+    out.pixels.resize(std::size_t{ level.width } * level.height * 4);
+    const auto* block = reinterpret_cast<const uint8_t*>(level.data.data());
+    uint8_t texels[16 * 4];
+    for (uint32_t by = 0; by < level.height; by += 4)
+        for (uint32_t bx = 0; bx < level.width; bx += 4) {
+            if (format == TextureFormat::BC3) {
+                DecodeColorBlock(block + 8, true, texels);
+                DecodeAlphaBlock(block, texels);
+                block += 16;
+            } else {
+                DecodeColorBlock(block, false, texels);
+                block += 8;
+            }
+            for (uint32_t y = 0; y < 4 && by + y < level.height; ++y)
+                for (uint32_t x = 0; x < 4 && bx + x < level.width; ++x)
+                    std::memcpy(out.pixels.data() + (std::size_t{ by + y } * level.width + bx + x) * 4, texels + (y * 4 + x) * 4, 4);
+        }
+    return out;
+}
+
+GLenum InternalFormat(TextureFormat format, bool srgb) {
+    switch (format) {
+    case TextureFormat::BC1: return srgb ? glext::COMPRESSED_SRGB_S3TC_DXT1 : glext::COMPRESSED_RGB_S3TC_DXT1;
+    case TextureFormat::BC3: return srgb ? glext::COMPRESSED_SRGB_ALPHA_S3TC_DXT5 : glext::COMPRESSED_RGBA_S3TC_DXT5;
+    case TextureFormat::RGBA8: break;
+    }
+    return srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+}
+
+}
+
+std::optional<Image> DecodeImage(const std::filesystem::path& path) {
+    int width = 0, height = 0, channels = 0;
+    stbi_uc* pixels = stbi_load(path.string().c_str(), &width, &height, &channels, 4);
+    if (!pixels) {
+        std::fprintf(stderr, "DecodeImage: %s: %s\n", path.string().c_str(), stbi_failure_reason());
+        return std::nullopt;
+    }
+    Image image;
+    image.width = static_cast<uint32_t>(width);
+    image.height = static_cast<uint32_t>(height);
+    image.pixels.assign(pixels, pixels + std::size_t{ image.width } * image.height * 4);
+    stbi_image_free(pixels);
+    return image;
+}
+
+Image Downsample(const Image& source, ColorSpace colorSpace) {
+    return DownsampleWith<true>(source, colorSpace);
+}
+
+Image DownsampleScalar(const Image& source, ColorSpace colorSpace) {
+    return DownsampleWith<false>(source, colorSpace);
+}
+
+std::vector<Image> BuildMipChain(Image base, ColorSpace colorSpace) {
+    std::vector<Image> chain;
+    chain.push_back(std::move(base));
+    while (chain.back().width > 1 || chain.back().height > 1) {
+        Image next = Downsample(chain.back(), colorSpace);
+        chain.push_back(std::move(next));
+    }
+    return chain;
+}
+
+TextureView TextureData::View() const {
+    TextureView view;
+    view.format = format;
+    view.srgb = srgb;
+    for (const Image& level : levels)
+        view.levels.push_back({ level.width, level.height, std::as_bytes(std::span(level.pixels)) });
+    return view;
+}
+
+TextureData BakeTexture(Image image, const TextureOptions& options) {
+    TextureData baked;
+    baked.srgb = options.colorSpace == ColorSpace::Srgb;
+    if (options.compress) baked.format = HasAlpha(image) ? TextureFormat::BC3 : TextureFormat::BC1;
+    if (options.mipmaps)
+        baked.levels = BuildMipChain(std::move(image), options.colorSpace);
+    else
+        baked.levels.push_back(std::move(image));
+    if (baked.format != TextureFormat::RGBA8)
+        for (Image& level : baked.levels) level.pixels = CompressLevel(level, baked.format);
+    return baked;
+}
+
+TextureCache::TextureCache() : TextureCache(TEXTURE_CACHE_DIR) {}
+
+TextureCache::TextureCache(std::filesystem::path dir) : directory(std::move(dir)) {
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+}
+
+uint64_t TextureCache::KeyOf(const std::filesystem::path& source, const TextureOptions& options) {
+    std::error_code error;
+    const uint64_t size = std::filesystem::file_size(source, error);
+    if (error) return 0;
+    const auto modified = std::filesystem::last_write_time(source, error);
+    if (error) return 0;
+
+    uint64_t key = HashString(std::filesystem::absolute(source, error).lexically_normal().generic_string());
+    key = HashCombine(key, size);
+    key = HashCombine(key, static_cast<uint64_t>(modified.time_since_epoch().count()));
+    key = HashCombine(key, (static_cast<uint64_t>(options.colorSpace) << 2) | (options.compress ? 2u : 0u) | (options.mipmaps ? 1u : 0u));
+    key = HashCombine(key, TextureFileVersion);
+    return key ? key : 1;
+}
+
+std::filesystem::path TextureCache::PathOf(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.etex", static_cast<unsigned long long>(key));
+    return directory / name;
+}
+
+std::optional<TextureFile> TextureCache::Load(const std::filesystem::path& source, const TextureOptions& options) {
+    const uint64_t key = KeyOf(source, options);
+    if (key == 0) return std::nullopt;
+    const std::filesystem::path cached = PathOf(key);
+
+    std::optional<TextureFile> file = TextureFile::Open(cached);
+    if (file && file->Header().sourceKey == key) {
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return file;
+    }
+
+    std::optional<Image> image = DecodeImage(source);
+    if (!image) return std::nullopt;
+    const TextureData baked = BakeTexture(std::move(*image), options);
+    if (!WriteTextureFile(cached, baked.View(), key)) return std::nullopt;
+    bakes.fetch_add(1, std::memory_order_relaxed);
+    return TextureFile::Open(cached);
+}
+
+TextureData DecompressTexture(const TextureView& view) {
+    TextureData out;
+    out.srgb = view.srgb;
+    for (const TextureLevel& level : view.levels) {
+        if (view.format == TextureFormat::RGBA8) {
+            const auto* bytes = reinterpret_cast<const uint8_t*>(level.data.data());
+            out.levels.push_back({ level.width, level.height, std::vector<uint8_t>(bytes, bytes + level.data.size()) });
+        } else {
+            out.levels.push_back(DecompressLevel(level, view.format));
+        }
+    }
+    return out;
+}
+
+namespace {
+
+// Uploads source levels [begin, end) of `view` into the bound texture under
+// their own level numbers, decoding blocks to RGBA8 when `decode`. Returns
+// the bytes sent.
+std::size_t UploadLevels(GLBackend& gl, const TextureView& view, bool decode, uint32_t begin, uint32_t end) {
+    const GLenum internalFormat = InternalFormat(decode ? TextureFormat::RGBA8 : view.format, view.srgb);
+    std::size_t bytes = 0;
+    for (uint32_t i = begin; i < end; ++i) {
+        const TextureLevel& level = view.levels[i];
+        if (decode) {
+            const Image pixels = DecompressLevel(level, view.format);
+            gl.TexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), static_cast<GLint>(internalFormat), static_cast<GLsizei>(level.width),
+                          static_cast<GLsizei>(level.height), 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.pixels.data());
+            bytes += pixels.pixels.size();
+        } else if (view.format == TextureFormat::RGBA8) {
+            gl.TexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), static_cast<GLint>(internalFormat), static_cast<GLsizei>(level.width),
+                          static_cast<GLsizei>(level.height), 0, GL_RGBA, GL_UNSIGNED_BYTE, level.data.data());
+            bytes += level.data.size();
+        } else {
+            gl.CompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), internalFormat, static_cast<GLsizei>(level.width),
+                                    static_cast<GLsizei>(level.height), 0, static_cast<GLsizei>(level.data.size()), level.data.data());
+            bytes += level.data.size();
+        }
+    }
+    return bytes;
+}
+
+// Empties levels [begin, end) of the bound texture: a 0x0 image gives their
+// storage back, and below the base level they do not affect completeness.
+void ReleaseLevels(GLBackend& gl, const TextureAsset& texture, bool srgb, uint32_t begin, uint32_t end) {
+    const GLenum internalFormat = InternalFormat(texture.format, srgb);
+    for (uint32_t i = begin; i < end; ++i) {
+        if (texture.format == TextureFormat::RGBA8)
+            gl.TexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), static_cast<GLint>(internalFormat), 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        else
+            gl.CompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), internalFormat, 0, 0, 0, 0, nullptr);
+    }
+}
+
+std::size_t ResidentBytes(const TextureView& view, bool decode, uint32_t firstLevel) {
+    std::size_t bytes = 0;
+    for (std::size_t i = firstLevel; i < view.levels.size(); ++i)
+        bytes += decode ? std::size_t{ view.levels[i].width } * view.levels[i].height * 4 : view.levels[i].data.size();
+    return bytes;
+}
+
+void SetFirstLevel(TextureAsset& texture, const TextureView& view, bool decode, uint32_t firstLevel) {
+    const bool any = firstLevel < view.levels.size();
+    texture.width = any ? view.levels[firstLevel].width : 0;
+    texture.height = any ? view.levels[firstLevel].height : 0;
+    texture.mipCount = any ? static_cast<uint32_t>(view.levels.size()) - firstLevel : 0;
+    texture.firstLevel = firstLevel;
+    texture.gpuBytes = ResidentBytes(view, decode, firstLevel);
+}
+
+}
+
+TextureAsset UploadTexture(GLBackend& gl, const TextureView& view, uint32_t firstLevel) {
+    const uint32_t levels = static_cast<uint32_t>(view.levels.size());
+    firstLevel = std::min(firstLevel, levels);
+    // no S3TC in the driver: decode the uploaded levels here and send RGBA8
+    const bool decode = view.format != TextureFormat::RGBA8 && !gl.HasTextureCompressionS3tc();
+    TextureAsset out;
+    out.format = decode ? TextureFormat::RGBA8 : view.format;
+    SetFirstLevel(out, view, decode, firstLevel);
+
+    gl.GenTextures(1, &out.texture);
+    gl.BindTexture(GL_TEXTURE_2D, out.texture);
+    gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(firstLevel));
+    gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levels) - 1);
+    gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    UploadLevels(gl, view, decode, firstLevel, levels);
+    return out;
+}
+
+void RestreamTexture(GLBackend& gl, TextureAsset& texture, const TextureView& view, uint32_t firstLevel) {
+    if (firstLevel >= view.levels.size()) {
+        if (texture.texture) DestroyTexture(gl, texture);
+        return;
+    }
+    if (!texture.texture) {
+        texture = UploadTexture(gl, view, firstLevel);
+        return;
+    }
+    if (firstLevel == texture.firstLevel) return;
+
+    const bool decode = texture.format != view.format;
+    gl.BindTexture(GL_TEXTURE_2D, texture.texture);
+    if (firstLevel < texture.firstLevel) {
+        // the new levels first, so the base never points at an empty one
+        UploadLevels(gl, view, decode, firstLevel, texture.firstLevel);
+        gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(firstLevel));
+    } else {
+        gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(firstLevel));
+        ReleaseLevels(gl, texture, view.srgb, texture.firstLevel, firstLevel);
+    }
+    SetFirstLevel(texture, view, decode, firstLevel);
+}
+
+void DestroyTexture(GLBackend& gl, TextureAsset& texture) {
+    gl.DeleteTextures(1, &texture.texture);
+    texture = {};
+}
+
+ResidencyLevels TextureResidency(GLBackend& gl, const TextureFile& file) {
+    const TextureFileHeader& header = file.Header();
+    const TextureView view = file.View();
+    // without S3TC the levels go up as RGBA8 (UploadTexture), 4-8x the blocks
+    const bool decode = view.format != TextureFormat::RGBA8 && !gl.HasTextureCompressionS3tc();
+    ResidencyLevels levels;
+    levels.baseSize = std::max(header.width, header.height);
+    for (const TextureLevel& level : view.levels)
+        levels.bytes.push_back(decode ? uint64_t{ level.width } * level.height * 4 : level.data.size());
+    return levels;
+}
+
+void RegisterTextureLoader(AssetManager& assets, TextureCache& cache, const TextureOptions& options) {
+    assets.RegisterLoader<TextureAsset, TextureFile>(
+        [&cache, options](const std::filesystem::path& path) -> std::optional<TextureFile> {
+            std::optional<TextureFile> file = cache.Load(path, options);
+            if (file) file->Prefetch(); // page faults here, not on the GL thread
+            return file;
+        },
+        [](GLBackend& gl, TextureFile& file) -> std::optional<TextureAsset> { return UploadTexture(gl, file.View()); },
+        [](GLBackend& gl, TextureAsset& texture) { DestroyTexture(gl, texture); });
+    assets.RegisterStreaming<TextureAsset, TextureFile>(
+        TextureResidency, [](GLBackend& gl, TextureAsset& texture, const TextureFile& file, uint32_t firstLevel) {
+            RestreamTexture(gl, texture, file.View(), firstLevel);
+        });
+}
@@ -0,0 +1,138 @@
+/* Texture decoding, mip generation, the baked texture cache and upload.
+
+   Source images (PNG, JPEG, TGA, ... through stb_image) are only ever
+   decoded once. TextureCache::Load decodes the source, builds the full mip
+   chain with BuildMipChain, optionally block-compresses it (BC1, or BC3
+   when the image has alpha), and writes the result as a .etex file
+   (TextureFile.hpp) keyed by the source's path, size and modification
+   time. Every later load, in this run or the next, maps that file and
+   skips decoding and mip generation entirely.
+
+   BuildMipChain is gamma correct: colour is averaged in linear light
+   (sRGB decoded through a table, encoded back through a finer one) and
+   alpha linearly. Rows are decoded into planar floats and the 2x2 boxes
+   averaged and quantised four output pixels per SSE vector. Linear data
+   (normal maps, masks) skips the conversion and stays in registers end to
+   end; sRGB goes through its tables one channel at a time, since SSE2 has
+   no gather.
+
+   RegisterTextureLoader teaches an AssetManager to load TextureAssets
+   through a cache: lookup, baking and page-in run on the worker, only the
+   glTexImage2D calls (straight from the mapping) on the GL thread.
+
+example usage:
+
+TextureCache textures;                        // TEXTURE_CACHE_DIR
+RegisterTextureLoader(assets, textures);
+Asset<TextureAsset> brick = assets.Load<TextureAsset>("textures/brick.png");
+...
+MaterialHandle wall = renderSystem->AddMaterial(material, brick); // follows brick's GL name */
+#pragma once
+#include "ResidencyManager.hpp"
+#include "TextureFile.hpp"
+#include "../gl/GLBackend.hpp"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+class AssetManager;
+
+// Tightly packed 8-bit RGBA.
+struct Image {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+enum class ColorSpace : uint8_t { Srgb, Linear };
+
+std::optional<Image> DecodeImage(const std::filesystem::path& path);
+
+// Halves `source` (rounding down, at least 1) with a gamma-correct 2x2 box.
+// An odd last row or column is dropped, as with D3D's box filter.
+Image Downsample(const Image& source, ColorSpace colorSpace);
+// The same filter one pixel at a time, bit-identical to Downsample; the
+// reference for tests and the benchmark.
+Image DownsampleScalar(const Image& source, ColorSpace colorSpace);
+
+// `base` followed by every smaller level down to 1x1.
+std::vector<Image> BuildMipChain(Image base, ColorSpace colorSpace);
+
+struct TextureOptions {
+    ColorSpace colorSpace = ColorSpace::Srgb;
+    bool compress = true;  // BC1/BC3; decoded at upload when the driver lacks S3TC
+    bool mipmaps = true;
+};
+
+// Owning texture in upload-ready form, as the baker produces it.
+struct TextureData {
+    TextureFormat format = TextureFormat::RGBA8;
+    bool srgb = true;
+    std::vector<Image> levels; // width/height per level; pixels hold the level's bytes in `format`
+
+    TextureView View() const;
+};
+
+TextureData BakeTexture(Image image, const TextureOptions& options);
+
+// RGBA8 copy of `view`, decoding BC1/BC3 blocks; for drivers without S3TC.
+TextureData DecompressTexture(const TextureView& view);
+
+// Directory of baked textures, one .etex per (source, options).
+class TextureCache {
+public:
+    TextureCache(); // TEXTURE_CACHE_DIR
+    explicit TextureCache(std::filesystem::path directory);
+
+    // Maps the baked form of `source`, baking it first when there is no
+    // current entry. Safe to call from several threads and processes, for the
+    // same source too: each bake writes its own temporary file.
+    std::optional<TextureFile> Load(const std::filesystem::path& source, const TextureOptions& options = {});
+
+    // Changes whenever the source file or the options do; 0 if the source is missing.
+    static uint64_t KeyOf(const std::filesystem::path& source, const TextureOptions& options);
+    std::filesystem::path PathOf(uint64_t key) const;
+
+    uint32_t Hits() const { return hits.load(std::memory_order_relaxed); }
+    uint32_t Bakes() const { return bakes.load(std::memory_order_relaxed); }
+
+private:
+    std::filesystem::path directory;
+    std::atomic<uint32_t> hits{ 0 };
+    std::atomic<uint32_t> bakes{ 0 };
+};
+
+// A texture on the GPU, as the AssetManager holds it.
+struct TextureAsset {
+    GLuint texture = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t mipCount = 0;    // resident levels
+    uint32_t firstLevel = 0;  // source levels left out (dropped by residency); the GL base level
+    TextureFormat format = TextureFormat::RGBA8;
+    std::size_t gpuBytes = 0; // sum of the resident level sizes
+};
+
+// GL_TEXTURE_2D with trilinear filtering and repeat wrapping; leaves it bound.
+// Uploads levels firstLevel.. of `view` under their own level numbers, with
+// GL_TEXTURE_BASE_LEVEL at firstLevel. Block-compressed levels are decoded
+// and uploaded as RGBA8 when the backend has no S3TC (the asset's format
+// then says RGBA8).
+TextureAsset UploadTexture(GLBackend& gl, const TextureView& view, uint32_t firstLevel = 0);
+// Moves `texture`'s base level to `firstLevel` in place, keeping its GL
+// name: only the levels streamed back in are uploaded, dropped ones are
+// emptied. Past the last level the texture is deleted; an empty asset is
+// uploaded afresh.
+void RestreamTexture(GLBackend& gl, TextureAsset& texture, const TextureView& view, uint32_t firstLevel);
+void DestroyTexture(GLBackend& gl, TextureAsset& texture);
+
+// GPU bytes per level of `file` as UploadTexture stores them on `gl`
+// (RGBA8 when it has no S3TC), for a ResidencyManager.
+ResidencyLevels TextureResidency(GLBackend& gl, const TextureFile& file);
+
+// Registers TextureAsset loading from image files through `cache`, which
+// must outlive the manager's loads. Textures stream their mips under the
+// manager's ResidencyManager, if it has one.
+void RegisterTextureLoader(AssetManager& assets, TextureCache& cache, const TextureOptions& options = {});
@@ -0,0 +1,16 @@
+#include "Camera.hpp"
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+glm::mat4 Camera::ProjectionMatrix() const {
+    if (projection == Projection::Orthographic) {
+        const float halfHeight = orthoHeight * 0.5f;
+        const float halfWidth = halfHeight * aspect;
+        return glm::ortho(-halfWidth, halfWidth, -halfHeight, halfHeight, nearPlane, farPlane);
+    }
+    return glm::perspective(fovY, aspect, nearPlane, farPlane);
+}
+
+glm::mat4 Camera::ViewMatrix(const glm::mat4& world) {
+    return glm::affineInverse(world);
+}
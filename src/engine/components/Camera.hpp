@@ -0,0 +1,21 @@
+/* Perspective or orthographic camera. The view matrix comes from the
+   entity's world matrix (the camera looks down its local -Z axis); renderers
+   pass the interpolated one so the view moves in step with what it draws. */
+#pragma once
+#include "Transform.hpp"
+#include <glm/glm.hpp>
+
+struct Camera {
+    enum class Projection { Perspective, Orthographic };
+
+    Projection projection = Projection::Perspective;
+    float fovY = 1.0471976f;     // vertical field of view, radians (60 degrees)
+    float orthoHeight = 10.0f;   // view height in world units for Orthographic
+    float aspect = 16.0f / 9.0f;
+    float nearPlane = 0.1f;
+    float farPlane = 1000.0f;
+
+    glm::mat4 ProjectionMatrix() const;
+    static glm::mat4 ViewMatrix(const glm::mat4& world);
+    static glm::mat4 ViewMatrix(const Transform& transform) { return ViewMatrix(transform.world); }
+};
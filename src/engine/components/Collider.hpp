@@ -0,0 +1,11 @@
+/* Axis-aligned box collider for PhysicsSystem. The box is centred on the
+   entity's position plus `offset` and scaled by Transform::scale; rotation
+   does not turn it. */
+#pragma once
+#include <glm/glm.hpp>
+
+struct Collider {
+    glm::vec3 halfExtents{0.5f};
+    glm::vec3 offset{0.0f};
+    bool isTrigger = false;     // contacts are reported but not resolved
+};
@@ -1,12 +1,16 @@
-/* example usage:
-
-// MeshRenderer.hpp
+/* Which mesh and material an entity is drawn with. Both are handles into
+   the tables owned by RenderSystem (RenderSystem::AddMesh / AddMaterial). */
 #pragma once
-#include <string>
+#include <glm/glm.hpp>
+#include <cstdint>
+
+using MeshHandle = uint32_t;
+using MaterialHandle = uint32_t;
 
 struct MeshRenderer {
-    std::string meshName;
-    std::string materialName;
+    MeshHandle mesh = 0;
+    MaterialHandle material = 0;
+    uint8_t layer = 0;      // 0..15, lower layers draw first
+    bool isStatic = false;  // never moves: culled through RenderSystem's BVH
+    glm::vec4 params{1.0f}; // free shader parameters, e.g. a tint (instance attribute or ObjectData.uObjectParams)
 };
-
-*/
\ No newline at end of file
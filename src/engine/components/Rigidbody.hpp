@@ -0,0 +1,11 @@
+/* Makes an entity with a Collider a moving body (see PhysicsSystem); without
+   one the collider is static. PhysicsSystem reads and writes `velocity`. */
+#pragma once
+#include <glm/glm.hpp>
+
+struct Rigidbody {
+    glm::vec3 velocity{0.0f};
+    float mass = 1.0f;          // 0 = kinematic: moves with its velocity, is never pushed
+    float restitution = 0.0f;   // bounciness, 0..1; a contact uses the larger of the two
+    bool useGravity = true;
+};
@@ -0,0 +1,11 @@
+#include "Transform.hpp"
+
+glm::mat4 Transform::LocalMatrix() const {
+    // T * R * S without the three full matrix products glm::translate/rotate/scale do
+    glm::mat4 m = glm::mat4_cast(rotation);
+    m[0] *= scale.x;
+    m[1] *= scale.y;
+    m[2] *= scale.z;
+    m[3] = glm::vec4(position, 1.0f);
+    return m;
+}
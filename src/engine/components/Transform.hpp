@@ -1,13 +1,29 @@
-/*example usage:
-
-// Transform.hpp
+/* Local position / rotation / scale of an entity plus an optional parent.
+   TransformSystem writes `local` and `world` from these values; it only
+   recomputes transforms that were marked dirty (see TransformSystem). */
 #pragma once
+#include "../ecs/Component.hpp"
+#include "../ecs/Entity.hpp"
+#include <cstddef>
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 struct Transform {
     glm::vec3 position{0.0f};
-    glm::vec3 rotation{0.0f};
+    glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f}; // identity (w, x, y, z)
     glm::vec3 scale{1.0f};
+
+    ecs::Entity parent = ecs::NullEntity;     // NullEntity (or an entity without Transform) = root; see TransformSystem::SetParent
+
+    glm::mat4 local{1.0f};    // cached TRS matrix
+    glm::mat4 world{1.0f};    // cached local-to-world matrix (parent.world * local)
+
+    glm::mat4 LocalMatrix() const;
 };
 
-*/
\ No newline at end of file
+// `local` and `world` stay out of snapshots: restoring changes the
+// TransformSystem's entity set, which makes it recompute every node.
+template<>
+struct ecs::SnapshotBytes<Transform> {
+    static constexpr std::size_t value = offsetof(Transform, local);
+};
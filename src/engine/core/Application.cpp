@@ -1,7 +1,15 @@
 #include "Application.hpp"
+#include "../gl/GLContext.hpp"
+#include "../gl/GLExtensions.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <chrono>
 #include <stdexcept>
+#include <thread>
 
-Application::Application(Window& window) : m_window(&window) {}
+Application::Application(Window& window) : m_window(&window) {
+    m_world.GetCoordinator().SetJobSystem(&m_jobs);
+}
 
 
 Application::Application(int width, int height, const char* title) {
@@ -10,7 +18,9 @@ Application::Application(int width, int height, const char* title) {
 
     if (!gladLoadGL(glfwGetProcAddress)) 
         throw std::runtime_error("Failed to initialize GLAD.");
+    glext::Load(glfwGetProcAddress);
     
+    m_world.GetCoordinator().SetJobSystem(&m_jobs);
 
 }
 
@@ -21,28 +31,98 @@ void Application::AddBehaviour(const std::shared_ptr<MonoBehaviour>& behaviour)
 
 void Application::Run(MonoBehaviour* behaviour) {
 
-    /* implement this here: 
-        along with its dependencies in other files
-        
-    engine.Init();
-    while (!window->ShouldClose()) {
-        float dt = CalculateDeltaTime();
-        engine.Update(dt);
-        window->SwapBuffers();
-    }
-*/
-
     std::shared_ptr<MonoBehaviour> mainBehaviour(behaviour);
     m_behaviours.push_back(mainBehaviour);
     mainBehaviour->Start();
 
+    ecs::Coordinator& coordinator = m_world.GetCoordinator();
+    GLContext& gl = GLContext::Instance();
+    m_window->GetDeltaTime(); // time spent loading in Start() is not simulated
+    PROFILE_THREAD("Main");
+    m_nextFrame = glfwGetTime();
+
     while (!m_window->ShouldClose())
     {
-        
-        mainBehaviour->Update(0.016f);
-        m_window->SwapBuffers();
-        m_window->PollEvents();
+        {
+            PROFILE_SCOPE("Frame");
+            const float dt = m_window->GetDeltaTime();
+
+            gl.BeginFrame();
+            {
+                PROFILE_SCOPE("Asset uploads");
+                m_assets.Poll(gl, m_assetUploadBudgetMs);
+            }
+
+            const int steps = m_timestep.Advance(dt);
+            const float step = static_cast<float>(m_timestep.Step());
+            for (int i = 0; i < steps; ++i) {
+                PROFILE_SCOPE("Fixed step");
+                mainBehaviour->FixedUpdate(step);
+                m_scheduler.Run(coordinator, step, ecs::SystemPhase::Simulation);
+                m_stepStats = m_scheduler.GetLastFrameStats();
+            }
+
+            {
+                PROFILE_SCOPE("Interpolate");
+                const float alpha = static_cast<float>(m_timestep.Alpha());
+                for (ecs::System* system : coordinator.GetSystems()) system->Interpolate(alpha);
+            }
+
+            {
+                PROFILE_SCOPE("Update");
+                PROFILE_GPU_SCOPE(m_gpuTimer, gl, "Frame (GPU)");
+                mainBehaviour->Update(dt);
+                m_scheduler.Run(coordinator, dt, ecs::SystemPhase::Frame);
+            }
+            {
+                // after the frame's draws have touched what they use
+                PROFILE_SCOPE("Asset residency");
+                m_assets.UpdateResidency(gl);
+            }
+            {
+                PROFILE_SCOPE("Swap buffers");
+                m_window->SwapBuffers();
+            }
+            PROFILE_GPU_COLLECT(m_gpuTimer, gl);
+
+            // wait before polling, so the next frame starts from the freshest input
+            {
+                PROFILE_SCOPE("Frame limit");
+                LimitFrameRate();
+            }
+            m_window->PollEvents();
+        }
+        PROFILE_FRAME_MARK();
     }
 
     mainBehaviour->OnExit();
+    m_gpuTimer.Release(gl);
+    m_assets.Clear(gl);
+}
+
+// A quarter of the cores, at least one: loads make progress without
+// crowding out the frame's workers.
+unsigned Application::LoadWorkerCount() {
+    return std::max(1u, std::thread::hardware_concurrency() / 4);
+}
+
+// Sleeps until the next frame deadline: coarse sleeps while more than a
+// couple of milliseconds are left (they overshoot), then yields. Deadlines
+// advance by exactly one period, so the time PollEvents takes counts towards
+// the frame; a frame that overran its deadline restarts the schedule from
+// now rather than rushing the following ones.
+void Application::LimitFrameRate() {
+    if (m_frameRateLimit <= 0.0) return;
+    const double now = glfwGetTime();
+    m_nextFrame += 1.0 / m_frameRateLimit;
+    if (m_nextFrame <= now) {
+        m_nextFrame = now;
+        return;
+    }
+    for (double t = now; t < m_nextFrame; t = glfwGetTime()) {
+        if (m_nextFrame - t > 0.002)
+            std::this_thread::sleep_for(std::chrono::duration<double>(m_nextFrame - t - 0.0015));
+        else
+            std::this_thread::yield();
+    }
 }
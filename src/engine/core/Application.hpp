@@ -6,12 +6,36 @@
 
 #include "../scripting/MonoBehaviour.hpp"
 #include "../platform/Window.hpp"
+#include "../ecs/World.hpp"
+#include "JobSystem.hpp"
+#include "FixedTimestep.hpp"
+#include "FrameScheduler.hpp"
+#include "../assets/AssetManager.hpp"
+#include "../gl/GpuTimer.hpp"
 
 class Application {
 
 private:
     Window* m_window = nullptr;
     std::vector<std::shared_ptr<MonoBehaviour>> m_behaviours;
+
+    JobSystem m_jobs;                    // declared before m_scheduler, which borrows it
+    FrameScheduler m_scheduler{ m_jobs };
+    // Decodes and texture bakes can take seconds, so they get workers of
+    // their own: the frame's scheduler and waits never pick one up.
+    JobSystem m_loadJobs{ LoadWorkerCount() };
+    AssetManager m_assets{ &m_loadJobs }; // decodes on m_loadJobs, uploads at the start of each frame
+    ecs::World m_world;                  // after m_assets: systems may hold asset handles
+    double m_assetUploadBudgetMs = 2.0;
+
+    FixedTimestep m_timestep;            // FixedUpdate and Simulation-phase systems
+    double m_frameRateLimit = 0.0;       // frames per second, 0 = unlimited
+    double m_nextFrame = 0.0;            // glfwGetTime() the limiter waits for
+    FrameStats m_stepStats;
+    GpuTimer m_gpuTimer;                 // the Frame phase, in builds with ENGINE_PROFILE
+
+    void LimitFrameRate();
+    static unsigned LoadWorkerCount();
     
 public:
 
@@ -22,9 +46,39 @@ public:
     // Behaviour management
     void AddBehaviour(const std::shared_ptr<MonoBehaviour>& behaviour);
 
-    // Run loop with user behaviour
+    // Run loop with user behaviour. Each frame runs as many fixed steps as
+    // real time calls for (FixedUpdate, then the Simulation-phase systems),
+    // lets systems interpolate towards the next step, then runs Update and
+    // the Frame-phase systems (rendering) with the real frame time. The
+    // loop's stages and every system update are profiler scopes, and each
+    // iteration closes a profiler frame.
     void Run(MonoBehaviour* behaviour);
 
+    // Simulation rate, 1/60 s by default.
+    void SetFixedTimestep(double seconds) { m_timestep.SetStep(seconds); }
+    // Most steps run in one frame; a larger backlog is dropped (default 5).
+    void SetMaxSubSteps(int steps) { m_timestep.SetMaxSteps(steps); }
+    void SetVSync(bool enabled) { m_window->SetVSync(enabled); }
+    // Caps the frame rate by sleeping before input is polled; 0 turns it off.
+    // Mostly useful with vsync off.
+    void SetFrameRateLimit(double framesPerSecond) { m_frameRateLimit = framesPerSecond; }
+    const FixedTimestep& GetTimestep() const { return m_timestep; }
+    // Times the Frame phase on the GPU too (see GpuTimer); off by default,
+    // and ignored where the context has no timer queries.
+    void SetGpuProfiling(bool enabled) { m_gpuTimer.SetEnabled(enabled && GpuTimer::Supported()); }
+
+    // ECS world whose systems are updated every frame by the FrameScheduler
+    ecs::World& GetWorld() { return m_world; }
+    JobSystem& GetJobSystem() { return m_jobs; }
+    // Background pool the AssetManager decodes on; for loaders' own parallel work.
+    JobSystem& GetLoadJobSystem() { return m_loadJobs; }
+    AssetManager& GetAssets() { return m_assets; }
+    // GL time per frame spent finishing loaded assets
+    void SetAssetUploadBudget(double milliseconds) { m_assetUploadBudgetMs = milliseconds; }
+    // Scheduler stats of the last Frame phase and of the last simulation step
+    const FrameStats& GetFrameStats() const { return m_scheduler.GetLastFrameStats(); }
+    const FrameStats& GetStepStats() const { return m_stepStats; }
+
     ~Application() = default;
 
 };
@@ -0,0 +1,53 @@
+/* Accumulator for a fixed simulation rate under a variable frame rate.
+
+   Each frame adds its real duration; every whole step in the accumulator is
+   one simulation update, and what is left over, as a fraction of a step, is
+   how far rendering should interpolate past the last simulated state. At
+   most maxSteps steps run per frame: when the simulation cannot keep up (a
+   hitch, a breakpoint, a step that costs more than it simulates) the backlog
+   beyond that is dropped, so the game slows down instead of spending ever
+   longer frames catching up.
+
+example usage:
+
+FixedTimestep timestep(1.0 / 60.0, 5);
+const int steps = timestep.Advance(window.GetDeltaTime());
+for (int i = 0; i < steps; ++i) Simulate(float(timestep.Step()));
+Render(float(timestep.Alpha())); */
+#pragma once
+#include <algorithm>
+#include <cmath>
+
+class FixedTimestep {
+public:
+    explicit FixedTimestep(double step = 1.0 / 60.0, int maxSteps = 5) { SetStep(step); SetMaxSteps(maxSteps); }
+
+    void SetStep(double seconds) { step = seconds > 0.0 ? seconds : 1.0 / 60.0; }
+    void SetMaxSteps(int count) { maxSteps = std::max(count, 1); }
+
+    // Adds one frame's real time and returns how many steps to run now.
+    int Advance(double frameSeconds) {
+        accumulator += std::max(frameSeconds, 0.0);
+        int steps = static_cast<int>(accumulator / step);
+        if (steps > maxSteps) {
+            droppedSeconds += (steps - maxSteps) * step;
+            steps = maxSteps;
+            accumulator = std::fmod(accumulator, step) + maxSteps * step;
+        }
+        accumulator -= steps * step;
+        return steps;
+    }
+
+    // Fraction of a step simulated time is behind real time, 0..1.
+    double Alpha() const { return std::clamp(accumulator / step, 0.0, 1.0); }
+    double Step() const { return step; }
+    int MaxSteps() const { return maxSteps; }
+    // Real time the step cap has discarded so far.
+    double DroppedSeconds() const { return droppedSeconds; }
+
+private:
+    double step = 1.0 / 60.0;
+    double accumulator = 0.0;
+    double droppedSeconds = 0.0;
+    int maxSteps = 5;
+};
@@ -0,0 +1,155 @@
+#include "FrameScheduler.hpp"
+#include "Profiler.hpp"
+#include <chrono>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+}
+
+FrameScheduler::FrameScheduler(JobSystem& jobs) : m_jobs(jobs) {}
+
+void FrameScheduler::BuildGraph(const std::vector<ecs::System*>& systems) {
+    m_nodeCount = systems.size();
+    if (m_nodeCount > m_nodeCapacity) {
+        m_nodes = std::make_unique<Node[]>(m_nodeCount);
+        m_nodeCapacity = m_nodeCount;
+    }
+
+    for (std::size_t i = 0; i < m_nodeCount; ++i) {
+        Node& node = m_nodes[i];
+        node.system = systems[i];
+        node.successors.clear();
+        node.predecessorCount = 0;
+        node.ms = 0.0;
+    }
+
+    // j depends on every earlier i it conflicts with. Main-thread systems are
+    // also ordered among themselves since they share one thread (and GL state).
+    for (std::size_t j = 0; j < m_nodeCount; ++j) {
+        const ecs::SystemAccess& aj = systems[j]->GetAccess();
+        for (std::size_t i = 0; i < j; ++i) {
+            const ecs::SystemAccess& ai = systems[i]->GetAccess();
+            if (ai.ConflictsWith(aj) || (ai.mainThreadOnly && aj.mainThreadOnly)) {
+                m_nodes[i].successors.push_back(static_cast<uint32_t>(j));
+                ++m_nodes[j].predecessorCount;
+            }
+        }
+    }
+}
+
+void FrameScheduler::Dispatch(uint32_t index, float dt) {
+    if (m_nodes[index].system->GetAccess().mainThreadOnly) {
+        std::lock_guard<std::mutex> lock(m_mainMutex);
+        m_mainReady.push_back(index);
+        return;
+    }
+
+    m_jobs.Submit([this, index, dt] { Complete(index, dt); });
+}
+
+void FrameScheduler::Complete(uint32_t index, float dt) {
+    Node& node = m_nodes[index];
+
+    const auto start = Clock::now();
+    {
+        PROFILE_SCOPE(node.system->GetName().c_str());
+        node.system->Update(dt);
+    }
+    node.ms = MsSince(start);
+
+    for (uint32_t next : node.successors) {
+        if (m_nodes[next].remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            Dispatch(next, dt);
+    }
+    m_unfinished.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void FrameScheduler::Run(ecs::Coordinator& coordinator, float dt) {
+    Execute(coordinator.GetSystems(), dt);
+}
+
+void FrameScheduler::Run(ecs::Coordinator& coordinator, float dt, ecs::SystemPhase phase) {
+    m_phaseSystems.clear();
+    for (ecs::System* system : coordinator.GetSystems())
+        if (system->GetPhase() == phase) m_phaseSystems.push_back(system);
+    Execute(m_phaseSystems, dt);
+}
+
+void FrameScheduler::Execute(const std::vector<ecs::System*>& systems, float dt) {
+    const auto frameStart = Clock::now();
+
+    BuildGraph(systems);
+    if (m_nodeCount == 0) {
+        m_stats = FrameStats{};
+        return;
+    }
+
+    m_unfinished.store(static_cast<uint32_t>(m_nodeCount), std::memory_order_relaxed);
+    for (std::size_t i = 0; i < m_nodeCount; ++i)
+        m_nodes[i].remaining.store(m_nodes[i].predecessorCount, std::memory_order_relaxed);
+
+    for (std::size_t i = 0; i < m_nodeCount; ++i) {
+        if (m_nodes[i].predecessorCount == 0) Dispatch(static_cast<uint32_t>(i), dt);
+    }
+
+    // The calling thread runs main-thread systems and otherwise helps the pool.
+    std::vector<uint32_t> mainBatch;
+    while (m_unfinished.load(std::memory_order_acquire) > 0) {
+        {
+            std::lock_guard<std::mutex> lock(m_mainMutex);
+            mainBatch.swap(m_mainReady);
+        }
+
+        if (!mainBatch.empty()) {
+            for (uint32_t index : mainBatch) Complete(index, dt);
+            mainBatch.clear();
+        }
+        else if (!m_jobs.TryRunOne()) {
+            std::this_thread::yield();
+        }
+    }
+
+    m_stats.frameMs = MsSince(frameStart);
+    ComputeCriticalPath();
+}
+
+void FrameScheduler::ComputeCriticalPath() {
+    // Edges always point from lower to higher index, so index order is a
+    // topological order and one forward pass finds the longest path.
+    std::vector<double>& finish = m_finish;
+    std::vector<int64_t>& previous = m_previous;
+    finish.assign(m_nodeCount, 0.0);
+    previous.assign(m_nodeCount, -1);
+
+    m_stats.systemMs.resize(m_nodeCount);
+    m_stats.totalSystemMs = 0.0;
+
+    for (std::size_t i = 0; i < m_nodeCount; ++i) {
+        finish[i] += m_nodes[i].ms;
+        m_stats.systemMs[i] = m_nodes[i].ms;
+        m_stats.totalSystemMs += m_nodes[i].ms;
+
+        for (uint32_t next : m_nodes[i].successors) {
+            if (finish[i] > finish[next]) {
+                finish[next] = finish[i];
+                previous[next] = static_cast<int64_t>(i);
+            }
+        }
+    }
+
+    std::size_t last = 0;
+    for (std::size_t i = 1; i < m_nodeCount; ++i)
+        if (finish[i] > finish[last]) last = i;
+
+    m_stats.criticalPathMs = finish[last];
+    m_stats.criticalPath.clear();
+    for (int64_t i = static_cast<int64_t>(last); i >= 0; i = previous[i])
+        m_stats.criticalPath.insert(m_stats.criticalPath.begin(), m_nodes[i].system->GetName());
+}
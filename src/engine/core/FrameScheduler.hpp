@@ -0,0 +1,74 @@
+/* Runs the ECS systems of one frame on the JobSystem.
+
+   Every frame the scheduler builds a dependency graph from the systems'
+   declared component access (System::Reads / Writes): a system depends on
+   each earlier-registered system it conflicts with, so registration order is
+   kept wherever it matters and everything else runs concurrently. Systems
+   flagged RunOnMainThread() execute on the thread that calls Run().
+
+   Run() can be limited to one SystemPhase, so Application runs the simulation
+   systems once per fixed step and the per-frame ones once per frame.
+
+   After each Run GetLastFrameStats() reports per-system times and the
+   critical path, i.e. the chain of dependent systems that bounded the frame. */
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "JobSystem.hpp"
+#include "../ecs/Coordinator.hpp"
+
+struct FrameStats {
+    double frameMs = 0.0;          // wall time of Run()
+    double criticalPathMs = 0.0;   // sum of system times along the critical path
+    double totalSystemMs = 0.0;    // sum of all system times (serial cost)
+    std::vector<double> systemMs;  // per system that ran, registration order
+    std::vector<std::string> criticalPath;
+};
+
+class FrameScheduler {
+public:
+    explicit FrameScheduler(JobSystem& jobs);
+
+    // Updates every system registered with the coordinator.
+    void Run(ecs::Coordinator& coordinator, float dt);
+    // Updates the systems of one phase.
+    void Run(ecs::Coordinator& coordinator, float dt, ecs::SystemPhase phase);
+
+    const FrameStats& GetLastFrameStats() const { return m_stats; }
+
+private:
+    struct Node {
+        ecs::System* system = nullptr;
+        std::vector<uint32_t> successors;
+        uint32_t predecessorCount = 0;
+        std::atomic<uint32_t> remaining{ 0 };
+        double ms = 0.0;
+    };
+
+    void Execute(const std::vector<ecs::System*>& systems, float dt);
+    void BuildGraph(const std::vector<ecs::System*>& systems);
+    void Dispatch(uint32_t index, float dt);
+    void Complete(uint32_t index, float dt);
+    void ComputeCriticalPath();
+
+    JobSystem& m_jobs;
+    std::unique_ptr<Node[]> m_nodes;
+    std::size_t m_nodeCount = 0;
+    std::size_t m_nodeCapacity = 0;
+
+    std::atomic<uint32_t> m_unfinished{ 0 };
+
+    // ready main-thread systems, handed from workers to the Run() thread
+    std::mutex m_mainMutex;
+    std::vector<uint32_t> m_mainReady;
+
+    FrameStats m_stats;
+    std::vector<ecs::System*> m_phaseSystems;
+    std::vector<double> m_finish;     // critical-path scratch
+    std::vector<int64_t> m_previous;
+};
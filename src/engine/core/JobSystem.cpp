@@ -0,0 +1,121 @@
+#include "JobSystem.hpp"
+#include "Profiler.hpp"
+
+namespace {
+
+// Identifies the pool and slot of the current thread, so Submit() from inside
+// a job goes to the worker's own deque.
+thread_local const JobSystem* tlsPool = nullptr;
+thread_local unsigned tlsIndex = 0;
+
+}
+
+JobSystem::JobSystem(unsigned workerCount) {
+    if (workerCount == 0) {
+        const unsigned hw = std::thread::hardware_concurrency();
+        workerCount = hw > 1 ? hw - 1 : 1;
+    }
+
+    for (unsigned i = 0; i <= workerCount; ++i)
+        queues.push_back(std::make_unique<Queue>());
+
+    for (unsigned i = 1; i <= workerCount; ++i)
+        workers.emplace_back([this, i] { WorkerLoop(i); });
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    sleepCv.notify_all();
+
+    for (auto& worker : workers) worker.join();
+}
+
+unsigned JobSystem::ThreadIndex() const {
+    return tlsPool == this ? tlsIndex : 0;
+}
+
+void JobSystem::Submit(Job job, JobCounter* counter) {
+    if (counter) counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+    const unsigned self = ThreadIndex();
+    {
+        std::lock_guard<std::mutex> lock(queues[self]->mutex);
+        queues[self]->tasks.push_back({ std::move(job), counter });
+    }
+
+    queued.fetch_add(1, std::memory_order_release);
+    {
+        // taking the lock orders this notify after a worker's predicate check
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    sleepCv.notify_one();
+}
+
+bool JobSystem::PopOrSteal(unsigned self, Task& out) {
+    if (queued.load(std::memory_order_acquire) == 0) return false;
+
+    // own deque: newest first (LIFO keeps caches warm)
+    {
+        Queue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            out = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // steal: oldest first, starting after ourselves so victims are spread out
+    const std::size_t count = queues.size();
+    for (std::size_t n = 1; n < count; ++n) {
+        Queue& victim = *queues[(self + n) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            out = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::Execute(Task& task) {
+    task.job();
+    if (task.counter) task.counter->pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+bool JobSystem::TryRunOne() {
+    Task task;
+    if (!PopOrSteal(ThreadIndex(), task)) return false;
+    Execute(task);
+    return true;
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+    while (!counter.Done()) {
+        if (!TryRunOne()) std::this_thread::yield();
+    }
+}
+
+void JobSystem::WorkerLoop(unsigned index) {
+    tlsPool = this;
+    tlsIndex = index;
+    PROFILE_THREAD("Job worker " + std::to_string(index));
+
+    for (;;) {
+        Task task;
+        if (PopOrSteal(index, task)) {
+            Execute(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepCv.wait(lock, [this] { return stopping.load() || queued.load(std::memory_order_acquire) > 0; });
+        if (stopping.load() && queued.load() == 0) return;
+    }
+}
@@ -0,0 +1,84 @@
+/* Work-stealing thread pool shared by the engine (FrameScheduler, parallel
+   component iteration). Application runs asset loading on a second pool,
+   so long decodes never sit in the queues a frame waits on.
+
+   Every worker owns a deque: it pushes and pops its own jobs at the back and
+   steals from the front of other workers' deques when it runs dry. Jobs
+   submitted from a non-worker thread go to a shared injection queue that all
+   workers steal from. Threads that wait on a JobCounter help execute jobs
+   instead of blocking, so nested waits cannot deadlock the pool.
+
+example usage:
+
+JobSystem jobs;                 // hardware_concurrency() - 1 workers
+JobCounter done;
+for (int i = 0; i < 8; ++i)
+    jobs.Submit([i] { Work(i); }, &done);
+jobs.Wait(done); */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Number of submitted-but-unfinished jobs; Wait() returns when it reaches zero.
+struct JobCounter {
+    std::atomic<int> pending{ 0 };
+
+    bool Done() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+
+    // workerCount == 0 picks hardware_concurrency() - 1 (the caller is the extra thread).
+    explicit JobSystem(unsigned workerCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    void Submit(Job job, JobCounter* counter = nullptr);
+
+    // Runs queued jobs on the calling thread until `counter` reaches zero.
+    void Wait(JobCounter& counter);
+
+    // Executes one queued job on the calling thread if any is available.
+    bool TryRunOne();
+
+    // Worker threads plus the calling thread.
+    unsigned ThreadCount() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    // 1..ThreadCount()-1 on this pool's workers, 0 on any other thread.
+    // Stable for the lifetime of the pool; use it to index per-thread scratch.
+    unsigned ThreadIndex() const;
+
+private:
+    struct Task {
+        Job job;
+        JobCounter* counter;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void WorkerLoop(unsigned index);
+    bool PopOrSteal(unsigned self, Task& out);
+    void Execute(Task& task);
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Queue>> queues; // [0] = injection queue, [i] = worker i
+
+    std::atomic<int> queued{ 0 };
+    std::atomic<bool> stopping{ false };
+    std::mutex sleepMutex;
+    std::condition_variable sleepCv;
+};
@@ -0,0 +1,286 @@
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+struct Profiler::Lease {
+    ThreadRing* ring = nullptr;
+
+    ~Lease() {
+        if (ring) Profiler::Retire(ring);
+    }
+};
+
+namespace {
+
+void AppendEscaped(std::string& out, std::string_view text) {
+    for (const char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20) {
+            char code[8];
+            std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(c));
+            out += code;
+        }
+        else {
+            out += c;
+        }
+    }
+}
+
+void AppendMicroseconds(std::string& out, int64_t ns) {
+    char number[32];
+    std::snprintf(number, sizeof(number), "%.3f", static_cast<double>(ns) / 1000.0);
+    out += number;
+}
+
+}
+
+// Never destroyed: threads may still close scopes while statics are torn down.
+Profiler& Profiler::Instance() {
+    static Profiler* profiler = new Profiler();
+    return *profiler;
+}
+
+Profiler::Profiler() : epoch(std::chrono::steady_clock::now()), epochTicks(Ticks()) {
+#ifdef ENGINE_PROFILE_RDTSC
+    // a first estimate of the TSC rate; EndFrame refines it as time passes
+    while (std::chrono::steady_clock::now() - epoch < std::chrono::milliseconds(1)) {}
+#endif
+    Calibrate();
+}
+
+Profiler::ThreadRing* Profiler::Register() {
+    ThreadRing* ring = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const std::unique_ptr<ThreadRing>& candidate : rings) {
+            if (candidate->retired.load(std::memory_order_acquire)
+                && candidate->tail == candidate->head.load(std::memory_order_relaxed)) {
+                ring = candidate.get();
+                ring->retired.store(false, std::memory_order_relaxed);
+                break;
+            }
+        }
+        if (!ring) {
+            rings.push_back(std::make_unique<ThreadRing>());
+            ring = rings.back().get();
+            ring->track = static_cast<uint32_t>(trackNames.size());
+            trackNames.push_back("Thread " + std::to_string(ring->track));
+        }
+    }
+
+    // thread_local with a destructor: only touched here, not on the Record path
+    thread_local Lease lease;
+    lease.ring = ring;
+    t_ring = ring;
+    return ring;
+}
+
+void Profiler::Retire(ThreadRing* ring) {
+    ring->retired.store(true, std::memory_order_release);
+    t_ring = nullptr;
+}
+
+void Profiler::SetThreadName(std::string name) {
+    ThreadRing* ring = t_ring ? t_ring : Register();
+    std::lock_guard<std::mutex> lock(mutex);
+    trackNames[ring->track] = std::move(name);
+}
+
+uint32_t Profiler::TrackOf(const char* name) {
+    const auto it = std::find(trackNames.begin(), trackNames.end(), name);
+    if (it != trackNames.end()) return static_cast<uint32_t>(it - trackNames.begin());
+    trackNames.emplace_back(name);
+    return static_cast<uint32_t>(trackNames.size() - 1);
+}
+
+void Profiler::AddTrackEvent(const char* track, const char* name, int64_t beginNs, int64_t endNs) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingTrackEvents.push_back({ Intern(name), TrackOf(track), beginNs, endNs });
+}
+
+int64_t Profiler::NowNs() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiler::Calibrate() {
+#ifdef ENGINE_PROFILE_RDTSC
+    const uint64_t ticks = Ticks();
+    const int64_t ns = NowNs();
+    if (ticks > epochTicks && ns > 0) nsPerTick = static_cast<double>(ns) / static_cast<double>(ticks - epochTicks);
+#else
+    using Period = std::chrono::steady_clock::period;
+    nsPerTick = 1e9 * static_cast<double>(Period::num) / static_cast<double>(Period::den);
+#endif
+}
+
+int64_t Profiler::ToNs(uint64_t ticks) const {
+    return static_cast<int64_t>(std::llround(static_cast<double>(static_cast<int64_t>(ticks - epochTicks)) * nsPerTick));
+}
+
+// Names are interned by pointer; the text is compared as well, since a
+// pointer can be reused for another string once its owner is gone.
+uint32_t Profiler::Intern(const char* name) {
+    const auto known = nameByPointer.find(name);
+    if (known != nameByPointer.end() && names[known->second] == name) return known->second;
+
+    auto [it, inserted] = nameByText.try_emplace(name, static_cast<uint32_t>(names.size()));
+    if (inserted) {
+        names.emplace_back(name);
+        stats.emplace_back();
+        frameMs.push_back(0.0);
+        frameCalls.push_back(0);
+    }
+    nameByPointer[name] = it->second;
+    return it->second;
+}
+
+// The ring is copied without stopping its writer, so once the copy is done
+// the head is read again: any slot the writer may have reached meanwhile is
+// discarded rather than trusted.
+void Profiler::Drain(ThreadRing& ring, std::vector<TraceEvent>& out) {
+    const uint64_t head = ring.head.load(std::memory_order_acquire);
+    uint64_t from = ring.tail;
+    if (head - from > RingEvents) {
+        dropped += head - from - RingEvents;
+        from = head - RingEvents;
+    }
+
+    drained.clear();
+    for (uint64_t i = from; i < head; ++i) drained.push_back(ring.events[i & (RingEvents - 1)]);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t after = ring.head.load(std::memory_order_relaxed);
+    std::size_t skip = 0;
+    if (after > RingEvents && after - RingEvents > from)
+        skip = static_cast<std::size_t>(std::min(after - RingEvents - from, head - from));
+    dropped += skip;
+    ring.tail = head;
+
+    for (std::size_t i = skip; i < drained.size(); ++i) {
+        const Event& event = drained[i];
+        out.push_back({ Intern(event.name), ring.track, ToNs(event.begin), ToNs(event.end) });
+    }
+}
+
+void Profiler::EndFrame() {
+    std::lock_guard<std::mutex> lock(mutex);
+    Calibrate();
+
+    std::vector<TraceEvent> events;
+    if (!trace.empty() && trace.size() >= traceFrames) {
+        events = std::move(trace.front());
+        trace.pop_front();
+        events.clear();
+    }
+    for (const std::unique_ptr<ThreadRing>& ring : rings) Drain(*ring, events);
+    events.insert(events.end(), pendingTrackEvents.begin(), pendingTrackEvents.end());
+    pendingTrackEvents.clear();
+
+    for (const TraceEvent& event : events) {
+        if (frameCalls[event.name]++ == 0) frameTouched.push_back(event.name);
+        frameMs[event.name] += static_cast<double>(event.endNs - event.beginNs) * 1e-6;
+    }
+    for (uint32_t id : frameTouched) {
+        NameStats& s = stats[id];
+        s.lastMs = static_cast<float>(frameMs[id]);
+        s.calls = frameCalls[id];
+        s.history[s.written % HistoryFrames] = s.lastMs;
+        ++s.written;
+        frameMs[id] = 0.0;
+        frameCalls[id] = 0;
+    }
+    frameTouched.clear();
+
+    if (traceFrames > 0) trace.push_back(std::move(events));
+    ++frame;
+}
+
+ScopeStats Profiler::Summarize(uint32_t id) const {
+    const NameStats& s = stats[id];
+    ScopeStats result;
+    result.name = names[id];
+    result.frames = std::min(s.written, HistoryFrames);
+    result.calls = s.calls;
+    result.lastMs = s.lastMs;
+    if (result.frames == 0) return result;
+
+    std::array<float, HistoryFrames> sorted;
+    std::copy_n(s.history.begin(), result.frames, sorted.begin());
+    std::sort(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(result.frames));
+
+    double sum = 0.0;
+    for (std::size_t i = 0; i < result.frames; ++i) sum += sorted[i];
+    const std::size_t p99 = static_cast<std::size_t>(std::ceil(0.99 * static_cast<double>(result.frames))) - 1;
+    result.minMs = sorted[0];
+    result.maxMs = sorted[result.frames - 1];
+    result.avgMs = sum / static_cast<double>(result.frames);
+    result.p99Ms = sorted[p99];
+    return result;
+}
+
+std::vector<ScopeStats> Profiler::Statistics() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<ScopeStats> result;
+    result.reserve(names.size());
+    for (uint32_t id = 0; id < names.size(); ++id) result.push_back(Summarize(id));
+    return result;
+}
+
+ScopeStats Profiler::Statistics(std::string_view name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto it = nameByText.find(std::string(name));
+    if (it == nameByText.end()) return ScopeStats{ std::string(name) };
+    return Summarize(it->second);
+}
+
+void Profiler::SetTraceFrames(std::size_t frames) {
+    std::lock_guard<std::mutex> lock(mutex);
+    traceFrames = frames;
+    while (trace.size() > traceFrames) trace.pop_front();
+}
+
+std::string Profiler::ChromeTrace() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    const auto separate = [&] {
+        if (!first) out += ",\n";
+        first = false;
+    };
+
+    for (std::size_t track = 0; track < trackNames.size(); ++track) {
+        separate();
+        out += "{\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(track) + ",\"name\":\"thread_name\",\"args\":{\"name\":\"";
+        AppendEscaped(out, trackNames[track]);
+        out += "\"}}";
+    }
+    for (const std::vector<TraceEvent>& events : trace) {
+        for (const TraceEvent& event : events) {
+            separate();
+            out += "{\"ph\":\"X\",\"pid\":1,\"tid\":" + std::to_string(event.track) + ",\"name\":\"";
+            AppendEscaped(out, names[event.name]);
+            out += "\",\"ts\":";
+            AppendMicroseconds(out, event.beginNs);
+            out += ",\"dur\":";
+            AppendMicroseconds(out, event.endNs - event.beginNs);
+            out += '}';
+        }
+    }
+    out += "]}\n";
+    return out;
+}
+
+bool Profiler::WriteChromeTrace(const std::filesystem::path& path) const {
+    const std::string json = ChromeTrace();
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    out.write(json.data(), static_cast<std::streamsize>(json.size()));
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,223 @@
+/* Frame profiler: named CPU scopes on every thread, rolling per-scope
+   statistics and Chrome trace export (chrome://tracing, ui.perfetto.dev).
+
+   A scope reads the CPU's cycle counter (rdtsc; steady_clock where there is
+   none) when it opens and again when it closes, and appends one event to a
+   ring buffer owned by the calling thread: no locks, no allocation, no
+   string copies, so the name must outlive the profiler's use of it (a
+   literal, or a string owned by something longer-lived such as a System).
+   EndFrame(), on one thread once per frame, drains every thread's ring,
+   converts ticks to nanoseconds and folds each scope's total time in that
+   frame into a history of the last HistoryFrames frames it ran in, from
+   which Statistics() reports min / avg / p99 / max. The events of the last
+   few hundred frames are kept for WriteChromeTrace(). A ring that fills up
+   between two EndFrame calls overwrites its oldest events; they are counted
+   in DroppedEvents().
+
+   The macros are what engine code uses, and they compile to nothing unless
+   ENGINE_PROFILE is defined (CMake defines it for every configuration but
+   Release and MinSizeRel while ENGINE_PROFILER is on). Application profiles
+   the run loop and FrameScheduler every system update; GpuTimer adds GPU
+   times on their own track.
+
+example usage:
+
+void Physics::Update(float dt) {
+    PROFILE_FUNCTION();
+    { PROFILE_SCOPE("Broadphase"); ... }
+}
+...
+PROFILE_FRAME_MARK();   // once per frame, after the last scope
+for (const ScopeStats& s : Profiler::Instance().Statistics()) Print(s.name, s.avgMs, s.p99Ms);
+Profiler::Instance().WriteChromeTrace("frame.trace.json"); */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define ENGINE_PROFILE_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define ENGINE_PROFILE_RDTSC 1
+#endif
+
+// Events per thread ring; a power of two. 24 bytes each.
+#ifndef ENGINE_PROFILE_RING_EVENTS
+#define ENGINE_PROFILE_RING_EVENTS 16384
+#endif
+
+struct ScopeStats {
+    std::string name;
+    std::size_t frames = 0;  // frames in the history, i.e. that ran the scope
+    std::size_t calls = 0;   // in the last frame it ran in
+    double lastMs = 0.0;     // per frame: every call of the scope summed
+    double minMs = 0.0;
+    double avgMs = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+};
+
+class Profiler {
+public:
+    static constexpr std::size_t RingEvents = ENGINE_PROFILE_RING_EVENTS;
+    static constexpr std::size_t HistoryFrames = 240;
+    static_assert((RingEvents & (RingEvents - 1)) == 0, "ENGINE_PROFILE_RING_EVENTS must be a power of two.");
+
+    static Profiler& Instance();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    static uint64_t Ticks() {
+#ifdef ENGINE_PROFILE_RDTSC
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    // Appends a closed scope to the calling thread's ring.
+    static void Record(const char* name, uint64_t begin, uint64_t end) {
+        ThreadRing* ring = t_ring ? t_ring : Instance().Register();
+        const uint64_t head = ring->head.load(std::memory_order_relaxed);
+        ring->events[head & (RingEvents - 1)] = Event{ name, begin, end };
+        ring->head.store(head + 1, std::memory_order_release);
+    }
+
+    // Names the calling thread's track in the trace.
+    void SetThreadName(std::string name);
+
+    // An event measured elsewhere (GPU timer queries), in NowNs() time, shown
+    // on its own named track.
+    void AddTrackEvent(const char* track, const char* name, int64_t beginNs, int64_t endNs);
+    // Nanoseconds since the profiler started, the time base of the trace.
+    int64_t NowNs() const;
+
+    // Closes a frame: drains the rings and updates statistics and trace.
+    void EndFrame();
+
+    // Every scope seen so far, in the order first seen.
+    std::vector<ScopeStats> Statistics() const;
+    // Statistics of one scope; frames == 0 if it never ran.
+    ScopeStats Statistics(std::string_view name) const;
+
+    // Frames whose events are kept for the trace (default 300).
+    void SetTraceFrames(std::size_t frames);
+    // The kept events as Chrome trace JSON ("X" complete events, microseconds).
+    std::string ChromeTrace() const;
+    bool WriteChromeTrace(const std::filesystem::path& path) const;
+
+    uint64_t Frame() const { return frame; }
+    uint64_t DroppedEvents() const { return dropped; }
+
+private:
+    struct Event {
+        const char* name;
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    struct ThreadRing {
+        std::array<Event, RingEvents> events;
+        std::atomic<uint64_t> head{ 0 };   // written by the owning thread only
+        uint64_t tail = 0;                 // read by EndFrame only
+        uint32_t track = 0;
+        std::atomic<bool> retired{ false }; // the thread exited; reusable once drained
+    };
+
+    struct TraceEvent {
+        uint32_t name;   // index into names
+        uint32_t track;
+        int64_t beginNs;
+        int64_t endNs;
+    };
+
+    struct NameStats {
+        std::array<float, HistoryFrames> history{};  // ms per frame, a ring
+        std::size_t written = 0;                     // frames ever recorded
+        std::size_t calls = 0;
+        float lastMs = 0.0f;
+    };
+
+    Profiler();
+
+    ThreadRing* Register();
+    static void Retire(ThreadRing* ring);
+    uint32_t Intern(const char* name);
+    uint32_t TrackOf(const char* name);
+    void Calibrate();
+    int64_t ToNs(uint64_t ticks) const;
+    void Drain(ThreadRing& ring, std::vector<TraceEvent>& out);
+    ScopeStats Summarize(uint32_t id) const;
+
+    // Returns the thread's ring when the thread exits.
+    struct Lease;
+
+    static inline thread_local ThreadRing* t_ring = nullptr;
+
+    mutable std::mutex mutex;                        // rings, tracks and pending track events
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+    std::vector<std::string> trackNames;             // per track id
+    std::vector<TraceEvent> pendingTrackEvents;
+
+    // Tick to nanosecond conversion, measured against steady_clock.
+    std::chrono::steady_clock::time_point epoch;
+    uint64_t epochTicks = 0;
+    double nsPerTick = 1.0;
+
+    // Touched by EndFrame (and the readers, under `mutex`) only.
+    std::vector<std::string> names;
+    std::unordered_map<const char*, uint32_t> nameByPointer;
+    std::unordered_map<std::string, uint32_t> nameByText;
+    std::vector<NameStats> stats;
+    std::vector<double> frameMs;
+    std::vector<std::size_t> frameCalls;
+    std::vector<uint32_t> frameTouched;
+    std::vector<Event> drained;
+    std::deque<std::vector<TraceEvent>> trace;
+    std::size_t traceFrames = 300;
+    uint64_t frame = 0;
+    uint64_t dropped = 0;
+};
+
+// Times its own lifetime; what PROFILE_SCOPE declares.
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name) : name(name), begin(Profiler::Ticks()) {}
+    ~ProfileScope() { Profiler::Record(name, begin, Profiler::Ticks()); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    uint64_t begin;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef ENGINE_PROFILE
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#define PROFILE_THREAD(name) Profiler::Instance().SetThreadName(name)
+#define PROFILE_FRAME_MARK() Profiler::Instance().EndFrame()
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#define PROFILE_FRAME_MARK() ((void)0)
+#endif
@@ -0,0 +1,310 @@
+#include "CommandBuffer.hpp"
+#include "../core/JobSystem.hpp"
+#include <algorithm>
+#include <cstdint>
+
+namespace ecs {
+
+namespace {
+
+// Small per-thread number used to pick a lane; assigned on first use.
+uint32_t ThreadSlot() {
+    static std::atomic<uint32_t> nextSlot{ 0 };
+    thread_local const uint32_t slot = nextSlot.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+}
+
+}
+
+// A payload with size + align <= BlockSize always fits a fresh block, so
+// the loop ends at the latest one block further on.
+void* CommandBuffer::Arena::Allocate(std::size_t size, std::size_t align) {
+    if (size + align > BlockSize) {
+        void* memory = ::operator new(size, std::align_val_t(align));
+        large.push_back({ memory, align });
+        return memory;
+    }
+
+    for (;; ++block, offset = 0) {
+        if (block == blocks.size())
+            blocks.emplace_back(static_cast<std::byte*>(::operator new(BlockSize, std::align_val_t(BlockAlignment))));
+
+        const auto base = reinterpret_cast<std::uintptr_t>(blocks[block].get());
+        const std::size_t aligned = ((base + offset + align - 1) & ~(align - 1)) - base;
+        if (aligned + size <= BlockSize) {
+            offset = aligned + size;
+            return blocks[block].get() + aligned;
+        }
+    }
+}
+
+void CommandBuffer::Arena::Reset() {
+    for (const Destructor& d : destructors) d.destroy(d.object);
+    destructors.clear();
+    for (const Large& allocation : large) ::operator delete(allocation.memory, std::align_val_t(allocation.align));
+    large.clear();
+    block = 0;
+    offset = 0;
+}
+
+CommandBuffer::CommandBuffer() : lanes(std::make_unique<Lane[]>(LaneCount)) {}
+
+CommandBuffer::~CommandBuffer() {
+    for (std::size_t i = 0; i < LaneCount; ++i) lanes[i].arena.Reset();
+}
+
+CommandBuffer::Lane& CommandBuffer::CurrentLane() {
+    return lanes[ThreadSlot() % LaneCount];
+}
+
+void CommandBuffer::Record(Entity entity, Op op, ComponentTypeId type) {
+    Lane& lane = CurrentLane();
+    std::lock_guard<std::mutex> lock(lane.mutex);
+    lane.commands.push_back({ entity, type, nullptr, op });
+}
+
+Entity CommandBuffer::CreateEntity() {
+    return Entity{ pendingCount.fetch_add(1, std::memory_order_relaxed), PendingGeneration };
+}
+
+void CommandBuffer::DestroyEntity(Entity entity) {
+    Record(entity, Op::Destroy, 0);
+}
+
+bool CommandBuffer::Empty() const {
+    if (pendingCount.load() != 0) return false;
+    for (std::size_t i = 0; i < LaneCount; ++i)
+        if (!lanes[i].commands.empty() || !lanes[i].batches.empty()) return false;
+    return true;
+}
+
+// True when all commands of each entity index already sit next to each other.
+// `seen` stamps every index that started a run, so one linear pass suffices.
+bool CommandBuffer::IsGroupedByEntity(const std::vector<Command>& commands, std::size_t slotCount) {
+    ++groupStamp;
+    if (seen.size() < slotCount) seen.resize(slotCount, 0);
+
+    EntityIndex current = InvalidEntityIndex;
+    for (const Command& cmd : commands) {
+        const EntityIndex index = cmd.target.index;
+        if (index == current) continue;
+        if (index >= slotCount || seen[index] == groupStamp) return false;
+        seen[index] = groupStamp;
+        current = index;
+    }
+    return true;
+}
+
+void CommandBuffer::Flush(Coordinator& coordinator) {
+    Flush(coordinator, created);
+}
+
+void CommandBuffer::Flush(Coordinator& coordinator, std::vector<Entity>& createdEntities) {
+    EntityManager& entityManager = *coordinator.entityManager;
+    ComponentManager& componentManager = *coordinator.componentManager;
+
+    // 1. Turn pending handles into real entities, in creation order.
+    const EntityIndex pending = pendingCount.exchange(0);
+    remap.clear();
+    entityManager.CreateEntities(pending, remap);
+    createdEntities.assign(remap.begin(), remap.end());
+
+    // Entities created one by one are in no system or query yet, so step 5
+    // can append them unchecked too; stamp those outside every batch.
+    ++freshStamp;
+    if (fresh.size() < entityManager.SlotCount()) fresh.resize(entityManager.SlotCount(), 0);
+    batchRanges.clear();
+    for (std::size_t i = 0; i < LaneCount; ++i)
+        for (const Batch& batch : lanes[i].batches) batchRanges.push_back({ batch.firstPending, batch.firstPending + batch.count });
+    std::sort(batchRanges.begin(), batchRanges.end());
+    EntityIndex next = 0;
+    for (const auto& [first, last] : batchRanges) {
+        for (; next < first; ++next) fresh[remap[next].index] = freshStamp;
+        next = last;
+    }
+    for (; next < pending; ++next) fresh[remap[next].index] = freshStamp;
+
+    // Spawn batches are contiguous in `remap`: fill each component array with
+    // one block of copies and match the whole batch with a single signature.
+    // The entities are new, so system and query sets append them unchecked.
+    // Every array and set is a separate job when the coordinator has a job
+    // system and the batch is large enough.
+    JobSystem* jobs = coordinator.GetJobSystem();
+    for (std::size_t i = 0; i < LaneCount; ++i) {
+        const Lane& lane = lanes[i];
+        for (const Batch& batch : lane.batches) {
+            const std::span<const Entity> entities(remap.data() + batch.firstPending, batch.count);
+            EntityIndex maxIndex = 0;
+            for (Entity entity : entities) maxIndex = std::max(maxIndex, entity.index);
+            Signature signature;
+            for (uint32_t c = 0; c < batch.componentCount; ++c) signature.set(lane.batchComponents[batch.componentsBegin + c].type);
+
+            matchingSets.clear();
+            coordinator.systemManager->MatchingSets(signature, matchingSets);
+            coordinator.queryManager->MatchingSets(signature, matchingSets);
+
+            const auto fill = [&, entities, maxIndex](uint32_t c) {
+                const Command& component = lane.batchComponents[batch.componentsBegin + c];
+                componentManager.FillErased(component.type, entities, maxIndex, component.payload);
+            };
+            const auto match = [entities, maxIndex](EntitySet* set) { set->InsertNew(entities.data(), entities.size(), maxIndex); };
+
+            if (!jobs || batch.count < ParallelBatchSize) {
+                for (uint32_t c = 0; c < batch.componentCount; ++c) fill(c);
+                for (EntitySet* set : matchingSets) match(set);
+                entityManager.SetSignatures(entities, signature);
+                continue;
+            }
+
+            JobCounter done;
+            for (uint32_t c = 0; c < batch.componentCount; ++c) jobs->Submit([&fill, c] { fill(c); }, &done);
+            for (EntitySet* set : matchingSets) jobs->Submit([&match, set] { match(set); }, &done);
+            entityManager.SetSignatures(entities, signature);
+            jobs->Wait(done);
+        }
+    }
+
+    // 2. Bring the commands of each entity together. Only grouping matters,
+    //    not order, and the common cases (one recording thread, entities
+    //    recorded one after another) are grouped already, so they are used in
+    //    place. Otherwise the lanes are merged and a stable counting sort by
+    //    entity index keeps each thread's recording order per entity.
+    const std::size_t slotCount = entityManager.SlotCount();
+    std::vector<Command>* source = &merged;
+    std::size_t activeLanes = 0;
+    for (std::size_t i = 0; i < LaneCount; ++i) {
+        if (lanes[i].commands.empty()) continue;
+        source = &lanes[i].commands;
+        ++activeLanes;
+    }
+
+    if (activeLanes > 1) {
+        merged.clear();
+        for (std::size_t i = 0; i < LaneCount; ++i)
+            merged.insert(merged.end(), lanes[i].commands.begin(), lanes[i].commands.end());
+        source = &merged;
+    }
+
+    for (Command& cmd : *source) {
+        if (IsPending(cmd.target)) cmd.target = remap[cmd.target.index];
+    }
+
+    if (!IsGroupedByEntity(*source, slotCount)) {
+        offsets.assign(slotCount + 2, 0);
+        for (const Command& cmd : *source) ++offsets[std::min<std::size_t>(cmd.target.index, slotCount) + 1];
+        for (std::size_t i = 1; i < offsets.size(); ++i) offsets[i] += offsets[i - 1];
+
+        sorted.resize(source->size());
+        for (const Command& cmd : *source) sorted[offsets[std::min<std::size_t>(cmd.target.index, slotCount)]++] = cmd;
+        source->swap(sorted);
+    }
+    const std::vector<Command>& commands = *source;
+
+    // 3. Coalesce per entity: the last Add/Remove per component type wins and
+    //    Destroy discards everything. Surviving operations are bucketed by
+    //    component type so each array is touched in one batch.
+    for (auto& bucket : inserts) bucket.clear();
+    for (auto& bucket : removes) bucket.clear();
+    destroyed.clear();
+    changedEntities.clear();
+    changedSignatures.clear();
+    changedFresh.clear();
+
+    for (std::size_t begin = 0; begin < commands.size();) {
+        const EntityIndex index = commands[begin].target.index;
+        std::size_t end = begin;
+        while (end < commands.size() && commands[end].target.index == index) ++end;
+
+        // commands made through stale handles for this slot are ignored
+        Entity entity = NullEntity;
+        for (std::size_t i = begin; i < end; ++i) {
+            if (entityManager.IsAlive(commands[i].target)) { entity = commands[i].target; break; }
+        }
+
+        bool destroyedHere = false;
+        pendingOps.clear();
+        for (std::size_t i = begin; i < end && entity.IsValid(); ++i) {
+            const Command& cmd = commands[i];
+            if (cmd.target != entity) continue;
+            if (cmd.op == Op::Destroy) { destroyedHere = true; break; }
+
+            auto it = std::find_if(pendingOps.begin(), pendingOps.end(),
+                                   [&](const Command* op) { return op->type == cmd.type; });
+            if (it != pendingOps.end()) *it = &cmd; else pendingOps.push_back(&cmd);
+        }
+        begin = end;
+
+        if (!entity.IsValid()) continue;
+        if (destroyedHere) {
+            destroyed.push_back(entity);
+            continue;
+        }
+
+        const Signature before = entityManager.GetSignature(entity);
+        Signature signature = before;
+        for (const Command* op : pendingOps) {
+            if (op->type >= inserts.size()) {
+                inserts.resize(op->type + 1);
+                removes.resize(op->type + 1);
+            }
+            if (op->op == Op::Add) {
+                inserts[op->type].push_back({ entity, op->payload });
+                signature.set(op->type);
+            } else {
+                removes[op->type].push_back(entity);
+                signature.reset(op->type);
+            }
+        }
+
+        if (signature != before) {
+            changedEntities.push_back(entity);
+            changedSignatures.push_back(signature);
+            changedFresh.push_back(fresh[entity.index] == freshStamp);
+        }
+    }
+
+    // 4. Apply the destroys together, then the component changes, one type
+    //    at a time.
+    if (!destroyed.empty()) coordinator.DestroyEntities(destroyed);
+    for (ComponentTypeId type = 0; type < inserts.size(); ++type) {
+        if (!removes[type].empty()) componentManager.RemoveErased(type, removes[type]);
+        if (!inserts[type].empty()) componentManager.InsertOrAssignErased(type, inserts[type]);
+    }
+
+    // 5. Write each signature once and re-match each entity once. Runs of
+    //    entities that ended with the same signature are matched together;
+    //    runs of entities created in this flush are appended unchecked.
+    for (std::size_t begin = 0; begin < changedEntities.size();) {
+        const Signature signature = changedSignatures[begin];
+        const uint8_t isFresh = changedFresh[begin];
+        EntityIndex maxIndex = 0;
+        std::size_t end = begin;
+        while (end < changedEntities.size() && changedSignatures[end] == signature && changedFresh[end] == isFresh) {
+            maxIndex = std::max(maxIndex, changedEntities[end].index);
+            ++end;
+        }
+
+        const std::span<const Entity> run(changedEntities.data() + begin, end - begin);
+        entityManager.SetSignatures(run, signature);
+        if (isFresh) {
+            matchingSets.clear();
+            coordinator.systemManager->MatchingSets(signature, matchingSets);
+            coordinator.queryManager->MatchingSets(signature, matchingSets);
+            for (EntitySet* set : matchingSets) set->InsertNew(run.data(), run.size(), maxIndex);
+        } else {
+            coordinator.systemManager->EntitiesSignatureChanged(run, signature);
+            coordinator.queryManager->EntitiesSignatureChanged(run, signature);
+        }
+        begin = end;
+    }
+
+    // 6. Recycle the lanes; moved-from payloads are destroyed here.
+    for (std::size_t i = 0; i < LaneCount; ++i) {
+        lanes[i].commands.clear();
+        lanes[i].batches.clear();
+        lanes[i].batchComponents.clear();
+        lanes[i].arena.Reset();
+    }
+}
+
+}
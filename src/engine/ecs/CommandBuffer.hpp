@@ -0,0 +1,195 @@
+/* Deferred structural changes.
+
+   Records create / add / remove / destroy operations during a frame and
+   applies them at a sync point with Flush(). The flush sorts the commands by
+   entity, coalesces everything recorded for one entity, writes the final
+   signature once and re-matches the entity against systems and queries once,
+   instead of once per AddComponent/RemoveComponent. Destroyed entities
+   leave every array, system and query in one pass for the whole flush.
+   Spawn batches (CreateEntities) are block copies; with a JobSystem on the
+   coordinator, a large batch fills each component array and each matching
+   system or query set as a job of its own.
+
+   Recording is thread-safe: each thread appends to its own lane. Flush must
+   run on one thread while nothing records. Component types must be registered
+   with the Coordinator before they are recorded.
+
+example usage:
+
+ecs::CommandBuffer cmds;
+ecs::Entity e = cmds.CreateEntity();      // pending handle, valid on `cmds` only
+cmds.AddComponent(e, Transform{});
+cmds.AddComponent(e, MeshRenderer{});
+cmds.Flush(coordinator);                  // e becomes a real entity here */
+#pragma once
+
+#include "Coordinator.hpp"
+#include "../utils/AlignedAllocator.hpp"
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ecs {
+
+class CommandBuffer {
+public:
+    CommandBuffer();
+    ~CommandBuffer();
+
+    CommandBuffer(const CommandBuffer&) = delete;
+    CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+    // Returns a pending handle that can be passed to this buffer's other
+    // recording calls. It is resolved to a real entity during Flush().
+    Entity CreateEntity();
+
+    // Records `count` new entities that all start with copies of `components`
+    // and returns the pending handle of the first; entity i of the batch is
+    // Entity{ first.index + i, first.generation }. A batch is applied as one
+    // block copy per component type and matched against systems once.
+    template<typename... Ts>
+    Entity CreateEntities(uint32_t count, const Ts&... components) {
+        const Entity first{ pendingCount.fetch_add(count, std::memory_order_relaxed), PendingGeneration };
+        Lane& lane = CurrentLane();
+        std::lock_guard<std::mutex> lock(lane.mutex);
+        const auto componentsBegin = static_cast<uint32_t>(lane.batchComponents.size());
+        (lane.batchComponents.push_back({ first, ComponentType<Ts>::id,
+                                          lane.arena.Store(components), Op::Add }), ...);
+        lane.batches.push_back({ first.index, count, componentsBegin, static_cast<uint32_t>(sizeof...(Ts)) });
+        return first;
+    }
+
+    void DestroyEntity(Entity entity);
+
+    // Adding a component the entity already has replaces its value.
+    template<typename T>
+    void AddComponent(Entity entity, T component) {
+        using U = std::decay_t<T>;
+        Lane& lane = CurrentLane();
+        std::lock_guard<std::mutex> lock(lane.mutex);
+        void* payload = lane.arena.Store(std::move(component));
+        lane.commands.push_back({ entity, ComponentType<U>::id, payload, Op::Add });
+    }
+
+    template<typename T>
+    void RemoveComponent(Entity entity) {
+        Record(entity, Op::Remove, ComponentType<T>::id);
+    }
+
+    // Applies and clears everything recorded so far. Handles returned by
+    // CreateEntity() are only meaningful until this returns; use the
+    // overload below to find out which real entities they became.
+    void Flush(Coordinator& coordinator);
+    void Flush(Coordinator& coordinator, std::vector<Entity>& createdEntities);
+
+    bool Empty() const;
+
+    static bool IsPending(Entity entity) { return entity.generation == PendingGeneration; }
+
+private:
+    static constexpr EntityGeneration PendingGeneration = std::numeric_limits<EntityGeneration>::max();
+    static constexpr std::size_t LaneCount = 64;
+    static constexpr uint32_t ParallelBatchSize = 4096; // smaller spawn batches are applied on the flushing thread
+
+    enum class Op : uint8_t { Add, Remove, Destroy };
+
+    struct Command {
+        Entity target;
+        ComponentTypeId type;
+        void* payload;      // Add only: a T owned by the lane arena
+        Op op;
+    };
+
+    // Bump allocator with stable addresses: payloads are never relocated, so
+    // non-trivially-relocatable components stay valid until the flush.
+    // Blocks start on a cache line and offsets are aligned as addresses, so
+    // over-aligned components get their alignment; a payload too large for
+    // a block gets an allocation of its own.
+    struct Arena {
+        static constexpr std::size_t BlockSize = 64 * 1024;
+        static constexpr std::size_t BlockAlignment = CacheLineSize;
+
+        struct BlockDeleter {
+            void operator()(std::byte* block) const { ::operator delete(block, std::align_val_t(BlockAlignment)); }
+        };
+
+        struct Large {
+            void* memory;
+            std::size_t align;
+        };
+
+        struct Destructor {
+            void* object;
+            void (*destroy)(void*);
+        };
+
+        void* Allocate(std::size_t size, std::size_t align);
+        void Reset(); // runs destructors, keeps the blocks for reuse, frees large payloads
+
+        template<typename T>
+        void* Store(T&& value) {
+            using U = std::decay_t<T>;
+            void* object = Allocate(sizeof(U), alignof(U));
+            new (object) U(std::forward<T>(value));
+            if constexpr (!std::is_trivially_destructible_v<U>)
+                destructors.push_back({ object, [](void* p) { static_cast<U*>(p)->~U(); } });
+            return object;
+        }
+
+        std::vector<std::unique_ptr<std::byte[], BlockDeleter>> blocks;
+        std::size_t block = 0;
+        std::size_t offset = 0;
+        std::vector<Large> large;
+        std::vector<Destructor> destructors;
+    };
+
+    struct Batch {
+        EntityIndex firstPending;
+        uint32_t count;
+        uint32_t componentsBegin; // range in Lane::batchComponents
+        uint32_t componentCount;
+    };
+
+    struct Lane {
+        std::mutex mutex; // uncontended unless two threads hash to the same lane
+        std::vector<Command> commands;
+        std::vector<Batch> batches;
+        std::vector<Command> batchComponents; // prototype payloads of every batch
+        Arena arena;
+    };
+
+    Lane& CurrentLane();
+    void Record(Entity entity, Op op, ComponentTypeId type);
+    bool IsGroupedByEntity(const std::vector<Command>& commands, std::size_t slotCount);
+
+    std::unique_ptr<Lane[]> lanes;
+    std::atomic<EntityIndex> pendingCount{ 0 };
+
+    // Flush scratch, kept between frames so steady-state flushes don't allocate.
+    std::vector<Command> merged;
+    std::vector<Command> sorted;
+    std::vector<std::size_t> offsets;
+    std::vector<uint32_t> seen;
+    uint32_t groupStamp = 0;
+    std::vector<Entity> remap;
+    std::vector<uint32_t> fresh;   // per slot: freshStamp when created by this flush outside a batch
+    uint32_t freshStamp = 0;
+    std::vector<std::pair<EntityIndex, EntityIndex>> batchRanges;
+    std::vector<EntitySet*> matchingSets;
+    std::vector<Entity> created;   // Flush(Coordinator&)'s created list, discarded
+    std::vector<Entity> destroyed;
+    std::vector<const Command*> pendingOps;
+    std::vector<std::vector<ComponentManager::ErasedInsert>> inserts; // by component type
+    std::vector<std::vector<Entity>> removes;                         // by component type
+    std::vector<Entity> changedEntities;
+    std::vector<Signature> changedSignatures;
+    std::vector<uint8_t> changedFresh;
+};
+
+}
@@ -0,0 +1,129 @@
+/* Component type ids and entity signatures.
+
+   ComponentType<T>::id is a static inline variable, so every type gets its id
+   once during static initialisation and reading it afterwards is a plain load
+   (no map lookup, no guard). Ids are dense (0..N-1) but their order depends on
+   initialisation order, so never persist them; don't read them from other
+   static initialisers either.
+
+   Signature is a fixed-width bitset with one bit per component type. The
+   width defaults to 256 and can be raised by defining ECS_MAX_COMPONENTS. */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef ECS_MAX_COMPONENTS
+#define ECS_MAX_COMPONENTS 256
+#endif
+
+namespace ecs {
+
+using ComponentTypeId = std::size_t;
+
+inline constexpr std::size_t MaxComponents = ECS_MAX_COMPONENTS;
+
+inline ComponentTypeId NextComponentTypeId() {
+    static std::atomic<ComponentTypeId> next{ 0 };
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+template<typename T>
+struct ComponentType {
+    static inline const ComponentTypeId id = NextComponentTypeId();
+};
+
+// How many leading bytes of each T a WorldSnapshot records. Components that
+// end in derived data (caches a system recomputes, like Transform's
+// matrices) specialize it to leave that tail out: captures compare and copy
+// less, and a restored component keeps whatever its tail held until the
+// system recomputes it. Trivially copyable types only.
+template<typename T>
+struct SnapshotBytes {
+    static constexpr std::size_t value = sizeof(T);
+};
+
+template<std::size_t Bits>
+class BasicSignature {
+public:
+    static constexpr std::size_t WordCount = (Bits + 63) / 64;
+
+    // Signature with the bits of Ts set.
+    template<typename... Ts>
+    static BasicSignature Of() {
+        BasicSignature signature;
+        (signature.set(ComponentType<Ts>::id), ...);
+        return signature;
+    }
+
+    BasicSignature& set(std::size_t bit) {
+        words[bit / 64] |= uint64_t{ 1 } << (bit % 64);
+        return *this;
+    }
+
+    BasicSignature& reset(std::size_t bit) {
+        words[bit / 64] &= ~(uint64_t{ 1 } << (bit % 64));
+        return *this;
+    }
+
+    BasicSignature& reset() {
+        words = {};
+        return *this;
+    }
+
+    bool test(std::size_t bit) const {
+        return (words[bit / 64] >> (bit % 64)) & 1u;
+    }
+
+    bool none() const {
+        for (uint64_t word : words)
+            if (word) return false;
+        return true;
+    }
+
+    bool any() const { return !none(); }
+
+    std::size_t count() const {
+        std::size_t bits = 0;
+        for (uint64_t word : words) bits += static_cast<std::size_t>(std::popcount(word));
+        return bits;
+    }
+
+    // True when every bit of `required` is set here (entity matches a system/query).
+    bool Contains(const BasicSignature& required) const {
+        for (std::size_t i = 0; i < WordCount; ++i)
+            if ((words[i] & required.words[i]) != required.words[i]) return false;
+        return true;
+    }
+
+    bool Intersects(const BasicSignature& other) const {
+        for (std::size_t i = 0; i < WordCount; ++i)
+            if (words[i] & other.words[i]) return true;
+        return false;
+    }
+
+    BasicSignature& operator|=(const BasicSignature& other) {
+        for (std::size_t i = 0; i < WordCount; ++i) words[i] |= other.words[i];
+        return *this;
+    }
+
+    BasicSignature& operator&=(const BasicSignature& other) {
+        for (std::size_t i = 0; i < WordCount; ++i) words[i] &= other.words[i];
+        return *this;
+    }
+
+    friend BasicSignature operator|(BasicSignature a, const BasicSignature& b) { return a |= b; }
+    friend BasicSignature operator&(BasicSignature a, const BasicSignature& b) { return a &= b; }
+
+    bool operator==(const BasicSignature&) const = default;
+
+private:
+    std::array<uint64_t, WordCount> words{};
+};
+
+using Signature = BasicSignature<MaxComponents>;
+
+}
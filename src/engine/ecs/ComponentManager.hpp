@@ -1,132 +1,380 @@
 /* Stores data for each component type. Manages adding/removing components. */
 #pragma once
 
-#include <unordered_map>
+#include "Component.hpp"
+#include "Entity.hpp"
+#include "WorldSnapshot.hpp"
+#include "../utils/AlignedAllocator.hpp"
+#include "../utils/Reserve.hpp"
+#include <algorithm>
 #include <memory>
-#include <typeindex>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace ecs {
 
-using EntityId = uint32_t;
-using ComponentTypeId = std::size_t;
+// ComponentArray: sparse-set storage for components of type T.
+//   components[] - packed T values, iterated linearly by systems; the buffer
+//                  starts on a cache line so parallel chunks can too
+//   entities[]   - dense entity handles, parallel to components[]
+//   sparse[]     - Entity::index -> dense index (npos when absent)
+// Lookup is two array loads; removal swaps the last element into the hole.
+// HasData compares the stored handle, so a stale handle never matches.
+template<typename T>
+class ComponentArray {
+public:
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
 
-// Simple component type ID generator
-inline ComponentTypeId GetUniqueComponentTypeId() {
-    static ComponentTypeId lastId = 0u;
-    return lastId++;
-}
+    void InsertData(Entity entity, const T& component) {
+        assert(!HasData(entity) && "Component added to same entity more than once.");
+        if (entity.index >= sparse.size())
+            sparse.resize(static_cast<std::size_t>(entity.index) + 1, npos);
 
-// A runtime mapping from std::type_index -> ComponentTypeId
-class ComponentTypeRegistry {
-public:
-    template<typename T>
-    static ComponentTypeId GetComponentType() {
-        const std::type_index ti(typeid(T));
-        auto it = registry().find(ti);
-        if (it != registry().end())
-            return it->second;
-        
-        ComponentTypeId id = GetUniqueComponentTypeId();
-        registry().emplace(ti, id);
-        return id;
+        sparse[entity.index] = static_cast<uint32_t>(components.size());
+        entities.push_back(entity);
+        components.push_back(component);
+        ++layoutVersion;
     }
 
-private:
-    static std::unordered_map<std::type_index, ComponentTypeId>& registry() {
-        static std::unordered_map<std::type_index, ComponentTypeId> reg;
-        return reg;
+    void InsertData(Entity entity, T&& component) {
+        assert(!HasData(entity) && "Component added to same entity more than once.");
+        if (entity.index >= sparse.size())
+            sparse.resize(static_cast<std::size_t>(entity.index) + 1, npos);
+
+        sparse[entity.index] = static_cast<uint32_t>(components.size());
+        entities.push_back(entity);
+        components.push_back(std::move(component));
+        ++layoutVersion;
     }
-};
 
-// ComponentArray: stores components of type T indexed by EntityId
-template<typename T>
-class ComponentArray {
-public:
-    void InsertData(EntityId entity, const T& component) {
-        assert(data.find(entity) == data.end() && "Component added to same entity more than once.");
-        data.emplace(entity, component);
+    // Gives every entity (none of which may have the component yet, none
+    // with an index above maxIndex) a copy of `value`: one block append per
+    // array instead of a push per entity.
+    void InsertCopies(std::span<const Entity> added, const T& value, EntityIndex maxIndex) {
+        for ([[maybe_unused]] Entity entity : added)
+            assert(!HasData(entity) && entity.index <= maxIndex && "Component added to same entity more than once.");
+        if (!added.empty() && maxIndex >= sparse.size())
+            sparse.resize(static_cast<std::size_t>(maxIndex) + 1, npos);
+
+        const auto base = static_cast<uint32_t>(components.size());
+        // resize + fill: a fill-insert constructs element by element through
+        // the aligned allocator, several times slower for small components
+        components.resize(base + added.size());
+        std::fill(components.begin() + base, components.end(), value);
+        entities.insert(entities.end(), added.begin(), added.end());
+        for (std::size_t i = 0; i < added.size(); ++i) sparse[added[i].index] = base + static_cast<uint32_t>(i);
+        ++layoutVersion;
+    }
+
+    void RemoveData(Entity entity) {
+        if (!HasData(entity)) return;
+
+        const uint32_t hole = sparse[entity.index];
+        const uint32_t last = static_cast<uint32_t>(components.size() - 1);
+        if (hole != last) {
+            components[hole] = std::move(components[last]);
+            entities[hole]   = entities[last];
+            sparse[entities[hole].index] = hole;
+        }
+
+        components.pop_back();
+        entities.pop_back();
+        sparse[entity.index] = npos;
+        ++layoutVersion;
     }
 
-    void RemoveData(EntityId entity) {
-        data.erase(entity);
+    T& GetData(Entity entity) {
+        assert(HasData(entity) && "Retrieving non-existent component.");
+        return components[sparse[entity.index]];
     }
 
-    T& GetData(EntityId entity) {
-        assert(data.find(entity) != data.end() && "Retrieving non-existent component.");
-        return data.at(entity);
+    bool HasData(Entity entity) const {
+        return entity.index < sparse.size() && sparse[entity.index] != npos
+            && entities[sparse[entity.index]] == entity;
     }
 
-    bool HasData(EntityId entity) const {
-        return data.find(entity) != data.end();
+    void EntityDestroyed(Entity entity) {
+        RemoveData(entity);
+    }
+
+    // Pre-sizes the dense arrays and the sparse index for bulk inserts. Grows
+    // geometrically, so calling it before every small batch stays cheap.
+    void Reserve(std::size_t count, EntityIndex maxIndex = 0) {
+        ReserveMore(components, count);
+        ReserveMore(entities, count);
+        if (maxIndex >= sparse.size())
+            sparse.resize(static_cast<std::size_t>(maxIndex) + 1, npos);
+    }
+
+    // Bulk loading (SceneLoader): appends `count` default values and returns
+    // the dense index of the first. Each one must then be given its entity
+    // with Place() before the array is used; Place() calls for different
+    // entities may run in parallel.
+    uint32_t Extend(std::size_t count, EntityIndex maxIndex) {
+        const auto first = static_cast<uint32_t>(components.size());
+        components.resize(components.size() + count);
+        entities.resize(entities.size() + count);
+        if (maxIndex >= sparse.size())
+            sparse.resize(static_cast<std::size_t>(maxIndex) + 1, npos);
+        ++layoutVersion;
+        return first;
+    }
+
+    void Place(uint32_t dense, Entity entity) {
+        assert(entity.index < sparse.size() && !HasData(entity) && "Placing a component the array already holds.");
+        entities[dense] = entity;
+        sparse[entity.index] = dense;
+    }
+
+    // Moves the components of `order` (all of which must be present) to the
+    // front of the packed array, in that order. Lets a system that walks
+    // entities in its own order (e.g. TransformSystem's depth order) read the
+    // storage linearly.
+    void Reorder(std::span<const Entity> order) {
+        ++layoutVersion;
+        for (uint32_t target = 0; target < order.size(); ++target) {
+            assert(HasData(order[target]) && "Reordering a component the array does not hold.");
+            const uint32_t current = sparse[order[target].index];
+            if (current == target) continue;
+            std::swap(components[target], components[current]);
+            std::swap(entities[target], entities[current]);
+            sparse[entities[target].index] = target;
+            sparse[entities[current].index] = current;
+        }
+    }
+
+    std::size_t Size() const { return components.size(); }
+
+    // Dense index of a present entity's component: Components()[DenseIndex(e)].
+    uint32_t DenseIndex(Entity entity) const {
+        assert(HasData(entity) && "Indexing a non-existent component.");
+        return sparse[entity.index];
+    }
+
+    // Changes whenever a dense index changes (insert, remove, reorder, load),
+    // so a cached DenseIndex column is current while this is unchanged.
+    uint64_t LayoutVersion() const { return layoutVersion; }
+
+    // Snapshot support (WorldSnapshot.hpp): three blocks, the packed values
+    // raw when T is trivially copyable and through `serializer` otherwise,
+    // then the entity and sparse indices, which are keyed by layoutVersion.
+    // Types with a SnapshotBytes<T> below sizeof(T) are written as those
+    // leading bytes of each value, packed. Without a serializer a
+    // non-trivial array is left out (an empty block) and Load keeps what the
+    // array holds.
+    void Save(WorldSnapshot& snapshot, const ComponentSerializer<T>* serializer) const {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            snapshot.WriteStrided(components.data(), components.size(), sizeof(T), SnapshotBytes<T>::value);
+        } else {
+            assert(serializer && "Snapshotting a non-trivially-copyable component without a serializer.");
+            std::vector<std::byte>& bytes = snapshot.Scratch();
+            if (serializer) {
+                ByteWriter writer(bytes);
+                writer.Write(static_cast<uint64_t>(components.size()));
+                for (const T& component : components) serializer->save(component, writer);
+            }
+            snapshot.WriteBlock(bytes);
+        }
+        const uint64_t key = SnapshotKey(owner, layoutVersion);
+        snapshot.WriteArray(std::span<const Entity>(entities), key);
+        snapshot.WriteArray(std::span<const uint32_t>(sparse), key);
     }
 
-    void EntityDestroyed(EntityId entity) {
-        if (data.find(entity) != data.end()) data.erase(entity);
+    void Load(WorldSnapshot& snapshot, const ComponentSerializer<T>* serializer) {
+        if constexpr (std::is_trivially_copyable_v<T> && SnapshotBytes<T>::value < sizeof(T)) {
+            constexpr std::size_t width = SnapshotBytes<T>::value;
+            const std::span<const std::byte> bytes = snapshot.ReadBlock();
+            components.resize(bytes.size() / width);
+            for (std::size_t i = 0; i < components.size(); ++i) std::memcpy(static_cast<void*>(&components[i]), bytes.data() + i * width, width);
+        } else if constexpr (std::is_trivially_copyable_v<T>) {
+            snapshot.ReadArray(components);
+        } else {
+            const std::span<const std::byte> bytes = snapshot.ReadBlock();
+            if (bytes.empty() || !serializer) {
+                snapshot.ReadBlock();
+                snapshot.ReadBlock();
+                return;
+            }
+            ByteReader reader(bytes);
+            const auto count = reader.Read<uint64_t>();
+            components.clear();
+            components.reserve(count);
+            for (uint64_t i = 0; i < count && !reader.Failed(); ++i) components.push_back(serializer->load(reader));
+        }
+        snapshot.ReadArray(entities);
+        snapshot.ReadArray(sparse);
+        ++layoutVersion;
     }
 
+    // Contiguous views for linear iteration; Entities()[i] owns Components()[i].
+    // Both are invalidated by any insert or remove.
+    std::span<T> Components() { return components; }
+    std::span<const T> Components() const { return components; }
+    std::span<const Entity> Entities() const { return entities; }
+
 private:
-    std::unordered_map<EntityId, T> data;
+    std::vector<T, AlignedAllocator<T>> components;
+    std::vector<Entity> entities;
+    std::vector<uint32_t> sparse;
+    uint64_t layoutVersion = 0;           // bumped when entities[] or sparse[] change: snapshot keys, query columns
+    uint64_t owner = NewSnapshotOwner();
 };
 
-// ComponentManager: hold arrays for all registered component types (type-erased)
+// ComponentManager: hold arrays for all registered component types (type-erased).
+// Arrays live in a flat vector indexed by ComponentTypeId, so typed access is
+// one indexed load plus a static_cast.
 class ComponentManager {
 public:
     template<typename T>
     void RegisterComponent() {
-        const ComponentTypeId typeId = ComponentTypeRegistry::GetComponentType<T>();
-        assert(componentArrays.find(typeId) == componentArrays.end() && "Registering component type more than once.");
-        componentArrays.emplace(typeId, std::make_shared<ErasedComponentArray<T>>());
+        const ComponentTypeId typeId = ComponentType<T>::id;
+        assert(typeId < MaxComponents && "Too many component types, raise ECS_MAX_COMPONENTS.");
+        if (typeId >= componentArrays.size()) componentArrays.resize(typeId + 1);
+        assert(!componentArrays[typeId] && "Registering component type more than once.");
+        componentArrays[typeId] = std::make_unique<ErasedComponentArray<T>>();
+    }
+
+    template<typename T>
+    void AddComponent(Entity entity, const T& component) {
+        GetComponentArray<T>()->arr.InsertData(entity, component);
     }
 
     template<typename T>
-    void AddComponent(EntityId entity, const T& component) {
-        GetComponentArray<T>()->InsertData(entity, component);
+    void RemoveComponent(Entity entity) {
+        GetComponentArray<T>()->arr.RemoveData(entity);
     }
 
     template<typename T>
-    void RemoveComponent(EntityId entity) {
-        GetComponentArray<T>()->RemoveData(entity);
+    T& GetComponent(Entity entity) {
+        return GetComponentArray<T>()->arr.GetData(entity);
     }
 
     template<typename T>
-    T& GetComponent(EntityId entity) {
-        return GetComponentArray<T>()->GetData(entity);
+    bool HasComponent(Entity entity) {
+        return GetComponentArray<T>()->arr.HasData(entity);
     }
 
+    // Direct access to the packed storage, for systems that iterate one type linearly.
     template<typename T>
-    bool HasComponent(EntityId entity) {
-        return GetComponentArray<T>()->HasData(entity);
+    ComponentArray<T>& GetComponentStorage() {
+        return GetComponentArray<T>()->arr;
     }
 
-    void EntityDestroyed(EntityId entity) {
-        for (auto const &pair : componentArrays) {
-            pair.second->EntityDestroyed(entity);
+    void EntityDestroyed(Entity entity) {
+        for (auto const &array : componentArrays) {
+            if (array) array->EntityDestroyed(entity);
         }
     }
 
+    void EntitiesDestroyed(std::span<const Entity> entities) {
+        for (auto const &array : componentArrays) {
+            if (array) array->Remove(entities);
+        }
+    }
+
+    // Needed for snapshots of component types that are not trivially copyable.
+    template<typename T>
+    void SetSerializer(ComponentSerializer<T> serializer) {
+        GetComponentArray<T>()->serializer = std::move(serializer);
+    }
+
+    // Registered type ids, ascending; what a snapshot's layout check compares.
+    void RegisteredTypes(std::vector<uint32_t>& out) const {
+        for (std::size_t id = 0; id < componentArrays.size(); ++id)
+            if (componentArrays[id]) out.push_back(static_cast<uint32_t>(id));
+    }
+
+    void Save(WorldSnapshot& snapshot) const {
+        for (auto const &array : componentArrays)
+            if (array) array->Save(snapshot);
+    }
+
+    void Load(WorldSnapshot& snapshot) {
+        for (auto const &array : componentArrays)
+            if (array) array->Load(snapshot);
+    }
+
+    // Type-erased batch access used by CommandBuffer::Flush, which only knows
+    // type ids. Each `component` must point to a T and is moved from; an entity
+    // that already has the component gets its value replaced.
+    struct ErasedInsert {
+        Entity entity;
+        void* component;
+    };
+
+    void InsertOrAssignErased(ComponentTypeId typeId, std::span<const ErasedInsert> inserts) {
+        ErasedArray(typeId)->InsertOrAssign(inserts);
+    }
+
+    void RemoveErased(ComponentTypeId typeId, std::span<const Entity> entities) {
+        ErasedArray(typeId)->Remove(entities);
+    }
+
+    // Gives every entity (none of which may have the component yet) a copy of *prototype.
+    void FillErased(ComponentTypeId typeId, std::span<const Entity> entities, EntityIndex maxIndex, const void* prototype) {
+        ErasedArray(typeId)->Fill(entities, maxIndex, prototype);
+    }
+
 private:
     // Type-erased wrapper around ComponentArray<T>
     struct IComponentArray {
         virtual ~IComponentArray() = default;
-        virtual void EntityDestroyed(EntityId entity) = 0;
+        virtual void EntityDestroyed(Entity entity) = 0;
+        virtual void InsertOrAssign(std::span<const ErasedInsert> inserts) = 0;
+        virtual void Remove(std::span<const Entity> entities) = 0;
+        virtual void Fill(std::span<const Entity> entities, EntityIndex maxIndex, const void* prototype) = 0;
+        virtual void Save(WorldSnapshot& snapshot) const = 0;
+        virtual void Load(WorldSnapshot& snapshot) = 0;
     };
 
     template<typename T>
     struct ErasedComponentArray : IComponentArray {
         ComponentArray<T> arr;
-        void EntityDestroyed(EntityId entity) override { arr.EntityDestroyed(entity); }
+        std::optional<ComponentSerializer<T>> serializer;
+        void EntityDestroyed(Entity entity) override { arr.EntityDestroyed(entity); }
+        void Save(WorldSnapshot& snapshot) const override { arr.Save(snapshot, serializer ? &*serializer : nullptr); }
+        void Load(WorldSnapshot& snapshot) override { arr.Load(snapshot, serializer ? &*serializer : nullptr); }
+
+        void InsertOrAssign(std::span<const ErasedInsert> inserts) override {
+            arr.Reserve(arr.Size() + inserts.size());
+            for (const ErasedInsert& insert : inserts) {
+                T& value = *static_cast<T*>(insert.component);
+                if (arr.HasData(insert.entity))
+                    arr.GetData(insert.entity) = std::move(value);
+                else
+                    arr.InsertData(insert.entity, std::move(value));
+            }
+        }
+
+        void Remove(std::span<const Entity> entities) override {
+            for (Entity entity : entities) arr.RemoveData(entity);
+        }
+
+        void Fill(std::span<const Entity> entities, EntityIndex maxIndex, const void* prototype) override {
+            arr.InsertCopies(entities, *static_cast<const T*>(prototype), maxIndex);
+        }
     };
 
+    IComponentArray* ErasedArray(ComponentTypeId typeId) {
+        assert(typeId < componentArrays.size() && componentArrays[typeId] && "Component not registered before use.");
+        return componentArrays[typeId].get();
+    }
+
     template<typename T>
-    std::shared_ptr< ErasedComponentArray<T> > GetComponentArray() {
-        const ComponentTypeId typeId = ComponentTypeRegistry::GetComponentType<T>();
-        auto it = componentArrays.find(typeId);
-        assert(it != componentArrays.end() && "Component not registered before use.");
-        return std::static_pointer_cast<ErasedComponentArray<T>>(it->second);
+    ErasedComponentArray<T>* GetComponentArray() {
+        const ComponentTypeId typeId = ComponentType<T>::id;
+        assert(typeId < componentArrays.size() && componentArrays[typeId] && "Component not registered before use.");
+        return static_cast<ErasedComponentArray<T>*>(componentArrays[typeId].get());
     }
 
-    std::unordered_map<ComponentTypeId, std::shared_ptr<IComponentArray>> componentArrays;
+    std::vector<std::unique_ptr<IComponentArray>> componentArrays; // indexed by ComponentTypeId, null if unregistered
 };
 
 }
\ No newline at end of file
@@ -13,14 +13,12 @@ gCoordinator.AddComponent(player, MeshRenderer{...}); */
 #include "ComponentManager.hpp"
 #include "EntityManager.hpp"
 #include "SystemManager.hpp"
-#include <bitset>
-#include <typeindex>
-#include <unordered_map>
+#include "Query.hpp"
+#include <cstring>
 
-namespace ecs {
+class JobSystem;
 
-using EntityId = uint32_t;
-using Signature = uint64_t; // simple fixed-size signature (up to 64 component types)
+namespace ecs {
 
 class Coordinator {
 public:
@@ -28,14 +26,29 @@ public:
         componentManager = std::make_unique<ComponentManager>();
         entityManager    = std::make_unique<EntityManager>();
         systemManager    = std::make_unique<SystemManager>();
+        queryManager     = std::make_unique<QueryManager>();
     }
 
     // Entity interface
-    EntityId CreateEntity() { return entityManager->CreateEntity(); }
-    void DestroyEntity(EntityId entity) {
+    Entity CreateEntity() { return entityManager->CreateEntity(); }
+    void CreateEntities(std::size_t count, std::vector<Entity>& out) { entityManager->CreateEntities(count, out); }
+    bool IsAlive(Entity entity) const { return entityManager->IsAlive(entity); }
+    void DestroyEntity(Entity entity) {
+        assert(IsAlive(entity) && "Destroying a dead or stale entity.");
+        if (!IsAlive(entity)) return;
         entityManager->DestroyEntity(entity);
         componentManager->EntityDestroyed(entity);
         systemManager->EntityDestroyed(entity);
+        queryManager->EntityDestroyed(entity);
+    }
+
+    // Batched DestroyEntity for distinct live entities: each component
+    // array, system and query is visited once for the whole span.
+    void DestroyEntities(std::span<const Entity> entities) {
+        for (Entity entity : entities) entityManager->DestroyEntity(entity);
+        componentManager->EntitiesDestroyed(entities);
+        systemManager->EntitiesDestroyed(entities);
+        queryManager->EntitiesDestroyed(entities);
     }
 
     // Component interface
@@ -45,40 +58,66 @@ public:
     }
 
     template<typename T>
-    void AddComponent(EntityId entity, const T& component) {
+    void AddComponent(Entity entity, const T& component) {
+        assert(IsAlive(entity) && "Adding a component to a dead or stale entity.");
         componentManager->AddComponent<T>(entity, component);
         // set bit in signature
         Signature sig = entityManager->GetSignature(entity);
-        const ComponentTypeId typeId = ComponentTypeRegistry::GetComponentType<T>();
-        sig |= (1ULL << typeId);
+        sig.set(ComponentType<T>::id);
         entityManager->SetSignature(entity, sig);
         systemManager->EntitySignatureChanged(entity, sig);
+        queryManager->EntitySignatureChanged(entity, sig);
     }
 
     template<typename T>
-    void RemoveComponent(EntityId entity) {
+    void RemoveComponent(Entity entity) {
         componentManager->RemoveComponent<T>(entity);
         Signature sig = entityManager->GetSignature(entity);
-        const ComponentTypeId typeId = ComponentTypeRegistry::GetComponentType<T>();
-        sig &= ~(1ULL << typeId);
+        sig.reset(ComponentType<T>::id);
         entityManager->SetSignature(entity, sig);
         systemManager->EntitySignatureChanged(entity, sig);
+        queryManager->EntitySignatureChanged(entity, sig);
     }
 
     template<typename T>
-    T& GetComponent(EntityId entity) {
+    T& GetComponent(Entity entity) {
         return componentManager->GetComponent<T>(entity);
     }
 
     template<typename T>
-    bool HasComponent(EntityId entity) {
+    bool HasComponent(Entity entity) {
         return componentManager->HasComponent<T>(entity);
     }
 
+    template<typename T>
+    ComponentArray<T>& GetComponentStorage() {
+        return componentManager->GetComponentStorage<T>();
+    }
+
+    // For bulk loaders that fill component storage directly (Extend/Place):
+    // gives `entities` their signature and matches them against systems and
+    // queries once for the whole span.
+    void SetSignatures(std::span<const Entity> entities, const Signature& signature) {
+        for (Entity entity : entities) entityManager->SetSignature(entity, signature);
+        systemManager->EntitiesSignatureChanged(entities, signature);
+        queryManager->EntitiesSignatureChanged(entities, signature);
+    }
+
+    // Query interface: every entity that has all of Ts, see Query.hpp
+    template<typename... Ts>
+    QueryView<Ts...> View() {
+        // first use of this signature seeds the cache, later changes are incremental
+        QueryCache& cache = queryManager->FindOrCreate(Signature::Of<Ts...>(), [&](QueryCache& created) { Seed(created); });
+        cache.Refresh(componentManager->GetComponentStorage<Ts>()...);
+        return QueryView<Ts...>(cache, &componentManager->GetComponentStorage<Ts>()...);
+    }
+
     // System interface
     template<typename T>
     std::shared_ptr<T> RegisterSystem() {
-        return systemManager->RegisterSystem<T>();
+        auto sys = systemManager->RegisterSystem<T>();
+        sys->coordinator = this;
+        return sys;
     }
 
     template<typename T>
@@ -91,13 +130,66 @@ public:
         return systemManager->GetSystem<T>();
     }
 
+    const std::vector<System*>& GetSystems() const { return systemManager->GetSystems(); }
+
+    // Worker pool systems may use for ParallelForEach; null means run serially.
+    void SetJobSystem(JobSystem* jobs) { jobSystem = jobs; }
+    JobSystem* GetJobSystem() const { return jobSystem; }
+
     // Utility
-    std::vector<EntityId> GetAllEntities() const { return entityManager->GetAllEntities(); }
+    EntityManager::AliveRange GetAllEntities() const { return entityManager->GetAllEntities(); }
+
+    // Needed to snapshot component types that are not trivially copyable.
+    template<typename T>
+    void SetComponentSerializer(ComponentSerializer<T> serializer) {
+        componentManager->SetSerializer<T>(std::move(serializer));
+    }
+
+    // Snapshot support, see WorldSnapshot.hpp. The first block records which
+    // component types and how many systems are registered; Load refuses (and
+    // changes nothing) when they differ.
+    void Save(WorldSnapshot& snapshot) const {
+        std::vector<uint32_t> layout{ static_cast<uint32_t>(systemManager->Count()) };
+        componentManager->RegisteredTypes(layout);
+        std::vector<std::byte>& bytes = snapshot.Scratch();
+        ByteWriter(bytes).Write(layout.data(), layout.size() * sizeof(uint32_t));
+        snapshot.WriteBlock(bytes);
+
+        entityManager->Save(snapshot);
+        componentManager->Save(snapshot);
+        systemManager->Save(snapshot);
+        queryManager->Save(snapshot);
+    }
+
+    bool Load(WorldSnapshot& snapshot) {
+        std::vector<uint32_t> layout{ static_cast<uint32_t>(systemManager->Count()) };
+        componentManager->RegisteredTypes(layout);
+        const std::span<const std::byte> saved = snapshot.ReadBlock();
+        if (saved.size() != layout.size() * sizeof(uint32_t) || std::memcmp(saved.data(), layout.data(), saved.size()) != 0)
+            return false;
+
+        entityManager->Load(snapshot);
+        componentManager->Load(snapshot);
+        systemManager->Load(snapshot);
+        queryManager->Load(snapshot, [&](QueryCache& cache) { Seed(cache); });
+        return true;
+    }
 
 private:
+    void Seed(QueryCache& cache) {
+        for (Entity entity : entityManager->GetAllEntities()) {
+            if (entityManager->GetSignature(entity).Contains(cache.signature))
+                cache.entities.Insert(entity);
+        }
+    }
+
+    friend class CommandBuffer; // applies batched structural changes directly to the managers
+
     std::unique_ptr<ComponentManager> componentManager;
     std::unique_ptr<EntityManager> entityManager;
     std::unique_ptr<SystemManager> systemManager;
+    std::unique_ptr<QueryManager> queryManager;
+    JobSystem* jobSystem = nullptr;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,40 @@
+/* Entity handle: a slot index plus the generation of that slot.
+
+   EntityManager bumps a slot's generation every time the slot is freed, so a
+   handle kept after DestroyEntity no longer compares equal to the live handle
+   in that slot and is detected as stale in O(1) instead of silently aliasing
+   whatever entity reuses the index. Sparse storage is indexed by `index`. */
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <limits>
+
+namespace ecs {
+
+using EntityIndex = uint32_t;
+using EntityGeneration = uint32_t;
+
+inline constexpr EntityIndex InvalidEntityIndex = std::numeric_limits<EntityIndex>::max();
+
+struct Entity {
+    EntityIndex index = InvalidEntityIndex;
+    EntityGeneration generation = 0;
+
+    bool IsValid() const { return index != InvalidEntityIndex; }
+
+    friend bool operator==(const Entity&, const Entity&) = default;
+};
+
+// Returned by lookups that find nothing (e.g. World::FindByName).
+inline constexpr Entity NullEntity{};
+
+}
+
+template<>
+struct std::hash<ecs::Entity> {
+    std::size_t operator()(const ecs::Entity& e) const noexcept {
+        return std::hash<uint64_t>{}((static_cast<uint64_t>(e.generation) << 32) | e.index);
+    }
+};
@@ -1,68 +1,172 @@
 /* Creates/destroys entities, tracks which components they have. */
 #pragma once
 
-#include <queue>
-#include <unordered_map>
+#include "Component.hpp"
+#include "Entity.hpp"
+#include "WorldSnapshot.hpp"
+#include "../utils/Reserve.hpp"
 #include <vector>
-#include <algorithm>
 #include <cassert>
-#include <string>
-#include <memory>
+#include <cstdint>
+#include <span>
 
 namespace ecs {
 
-using EntityId = uint32_t;
+/* Slots live in one flat vector indexed by Entity::index.
 
+   A live slot stores its own handle (slots[i].index == i). A free slot stores
+   the index of the next free slot instead, which forms an intrusive free list
+   through the same array, and its generation is already bumped for the next
+   occupant. Creating and destroying entities therefore never allocates once
+   the array has reached its high-water mark. */
 class EntityManager {
 public:
     EntityManager() = default;
 
-    EntityId CreateEntity() {
-        EntityId id;
-        if (!freeIds.empty())
-            id = freeIds.front(); freeIds.pop();
-        
-        else
-            id = nextId++;
-        
-        // initialize signature as empty
-        signatures[id] = 0u;
-        return id;
+    Entity CreateEntity() {
+        if (freeHead != InvalidEntityIndex) {
+            const EntityIndex index = freeHead;
+            freeHead = slots[index].index;
+            slots[index].index = index;
+            ++aliveCount;
+            ++version;
+            return slots[index];
+        }
+
+        const Entity entity{ static_cast<EntityIndex>(slots.size()), 0 };
+        slots.push_back(entity);
+        signatures.push_back(Signature{});
+        ++aliveCount;
+        ++version;
+        return entity;
+    }
+
+    // Appends `count` new entities to `out`: free slots first, then one
+    // block of fresh slots, without a per-entity push_back.
+    void CreateEntities(std::size_t count, std::vector<Entity>& out) {
+        ReserveMore(out, out.size() + count);
+        for (; count > 0 && freeHead != InvalidEntityIndex; --count) out.push_back(CreateEntity());
+
+        const std::size_t first = slots.size();
+        slots.resize(first + count);
+        signatures.resize(first + count);
+        for (std::size_t i = first; i < slots.size(); ++i) {
+            slots[i] = Entity{ static_cast<EntityIndex>(i), 0 };
+            out.push_back(slots[i]);
+        }
+        aliveCount += count;
+        ++version;
+    }
+
+    void DestroyEntity(Entity entity) {
+        assert(IsAlive(entity) && "Destroying a dead or stale entity.");
+        if (!IsAlive(entity)) return;
+
+        signatures[entity.index].reset();
+        slots[entity.index] = Entity{ freeHead, entity.generation + 1 };
+        freeHead = entity.index;
+        --aliveCount;
+        ++version;
+    }
+
+    bool IsAlive(Entity entity) const {
+        return entity.index < slots.size() && slots[entity.index] == entity;
+    }
+
+    void SetSignature(Entity entity, const Signature& signature) {
+        assert(IsAlive(entity) && "Setting signature of a dead or stale entity.");
+        signatures[entity.index] = signature;
+        ++version;
     }
 
-    void DestroyEntity(EntityId entity) {
-        signatures.erase(entity);
-        freeIds.push(entity);
+    // One signature for a run of live entities.
+    void SetSignatures(std::span<const Entity> entities, const Signature& signature) {
+        for (Entity entity : entities) {
+            assert(IsAlive(entity) && "Setting signature of a dead or stale entity.");
+            signatures[entity.index] = signature;
+        }
+        ++version;
     }
 
-    void SetSignature(EntityId entity, uint64_t signature) {
-        signatures[entity] = signature;
+    Signature GetSignature(Entity entity) const {
+        return IsAlive(entity) ? signatures[entity.index] : Signature{};
     }
 
-    uint64_t GetSignature(EntityId entity) const {
-        auto it = signatures.find(entity);
-        
-        if (it == signatures.end())
-            return 0;
-        
-        return it->second;
+    // Grows the slot array up front so the first `count` creations don't allocate.
+    void Reserve(std::size_t count) {
+        slots.reserve(count);
+        signatures.reserve(count);
     }
 
-    // Utility to iterate all existing entity ids
-    std::vector<EntityId> GetAllEntities() const {
-        std::vector<EntityId> out;
-        out.reserve(signatures.size());
-        for (auto it = signatures.begin(); it != signatures.end(); ++it) {
-            out.push_back(it->first);
+    std::size_t Size() const { return aliveCount; }
+
+    // Number of slots ever handed out (live + free); every Entity::index is below this.
+    std::size_t SlotCount() const { return slots.size(); }
+
+    // Range over live entities: a linear scan of the slot array, no allocation.
+    class AliveRange {
+    public:
+        class Iterator {
+        public:
+            Iterator(const Entity* it, const Entity* end, EntityIndex index) : it(it), end(end), index(index) { Skip(); }
+
+            Entity operator*() const { return *it; }
+            Iterator& operator++() { ++it; ++index; Skip(); return *this; }
+            bool operator!=(const Iterator& other) const { return it != other.it; }
+            bool operator==(const Iterator& other) const { return it == other.it; }
+
+        private:
+            void Skip() { while (it != end && it->index != index) { ++it; ++index; } }
+
+            const Entity* it;
+            const Entity* end;
+            EntityIndex index;
+        };
+
+        explicit AliveRange(const std::vector<Entity>& slots) : slots(&slots) {}
+
+        Iterator begin() const { return Iterator(slots->data(), slots->data() + slots->size(), 0); }
+        Iterator end() const {
+            const Entity* last = slots->data() + slots->size();
+            return Iterator(last, last, static_cast<EntityIndex>(slots->size()));
         }
 
-        return out;
+    private:
+        const std::vector<Entity>* slots;
+    };
+
+    AliveRange GetAllEntities() const { return AliveRange(slots); }
+
+    // Snapshot support (WorldSnapshot.hpp): the slot array is the free list
+    // too, so three blocks restore every handle and generation exactly.
+    void Save(WorldSnapshot& snapshot) const {
+        const uint64_t key = SnapshotKey(owner, version);
+        snapshot.WriteValue(SavedState{ freeHead, aliveCount }, key);
+        snapshot.WriteArray(std::span<const Entity>(slots), key);
+        snapshot.WriteArray(std::span<const Signature>(signatures), key);
+    }
+
+    void Load(WorldSnapshot& snapshot) {
+        const SavedState state = snapshot.ReadValue<SavedState>();
+        freeHead = static_cast<EntityIndex>(state.freeHead);
+        aliveCount = static_cast<std::size_t>(state.aliveCount);
+        snapshot.ReadArray(slots);
+        snapshot.ReadArray(signatures);
+        ++version;
     }
 
 private:
-    EntityId nextId = 1; // start at 1 for easier debugging (0 = invalid)
-    std::queue<EntityId> freeIds;
-    std::unordered_map<EntityId, uint64_t> signatures; // bitset signature per entity
+    struct SavedState {
+        uint64_t freeHead;
+        uint64_t aliveCount;
+    };
+
+    std::vector<Entity> slots;
+    std::vector<Signature> signatures; // bitset signature per slot
+    EntityIndex freeHead = InvalidEntityIndex;
+    std::size_t aliveCount = 0;
+    uint64_t version = 0;                 // bumped by every change, for snapshot keys
+    uint64_t owner = NewSnapshotOwner();
 };
 
-}
\ No newline at end of file
+}
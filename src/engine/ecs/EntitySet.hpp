@@ -0,0 +1,159 @@
+/* Sparse set of entity ids: dense, cache-friendly iteration with O(1)
+   insert / erase / contains. Used for system membership and query caches. */
+#pragma once
+
+#include "Entity.hpp"
+#include "WorldSnapshot.hpp"
+#include "../utils/Reserve.hpp"
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace ecs {
+
+class EntitySet {
+public:
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+    // Returns false if the entity was already present.
+    bool Insert(Entity entity) {
+        if (Contains(entity)) return false;
+        if (entity.index >= sparse.size())
+            sparse.resize(static_cast<std::size_t>(entity.index) + 1, npos);
+
+        sparse[entity.index] = static_cast<uint32_t>(dense.size());
+        dense.push_back(entity);
+        ++version;
+        LogChanges(&entity, 1);
+        return true;
+    }
+
+    // Bulk insert: grows the arrays once, then appends every entity not yet present.
+    void InsertRange(const Entity* first, std::size_t count) {
+        EntityIndex maxIndex = 0;
+        for (std::size_t i = 0; i < count; ++i) maxIndex = first[i].index > maxIndex ? first[i].index : maxIndex;
+        if (count && maxIndex >= sparse.size())
+            sparse.resize(static_cast<std::size_t>(maxIndex) + 1, npos);
+        ReserveMore(dense, dense.size() + count);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            const Entity entity = first[i];
+            if (sparse[entity.index] != npos && dense[sparse[entity.index]] == entity) continue;
+            sparse[entity.index] = static_cast<uint32_t>(dense.size());
+            dense.push_back(entity);
+            ++version;
+            LogChanges(&entity, 1);
+        }
+    }
+
+    // Bulk insert of entities known not to be present yet (just created),
+    // none with an index above maxIndex: one block append to the dense
+    // array, no membership checks.
+    void InsertNew(const Entity* first, std::size_t count, EntityIndex maxIndex) {
+        if (count == 0) return;
+        if (maxIndex >= sparse.size())
+            sparse.resize(static_cast<std::size_t>(maxIndex) + 1, npos);
+
+        const auto base = static_cast<uint32_t>(dense.size());
+        dense.insert(dense.end(), first, first + count);
+        for (std::size_t i = 0; i < count; ++i) sparse[first[i].index] = base + static_cast<uint32_t>(i);
+        ++version;
+        LogChanges(first, count);
+    }
+
+    // Swap-and-pop; returns false if the entity was not present.
+    bool Erase(Entity entity) {
+        if (!Contains(entity)) return false;
+
+        const uint32_t hole = sparse[entity.index];
+        const Entity last = dense.back();
+        dense[hole] = last;
+        sparse[last.index] = hole;
+
+        dense.pop_back();
+        sparse[entity.index] = npos;
+        ++version;
+        LogChanges(&entity, 1);
+        return true;
+    }
+
+    bool Contains(Entity entity) const {
+        return entity.index < sparse.size() && sparse[entity.index] != npos
+            && dense[sparse[entity.index]] == entity;
+    }
+
+    void Clear() {
+        for (Entity e : dense) sparse[e.index] = npos;
+        if (!dense.empty()) {
+            ++version;
+            changesOverflowed = trackChanges;
+        }
+        dense.clear();
+    }
+
+    std::size_t size() const { return dense.size(); }
+    bool empty() const { return dense.empty(); }
+    const Entity* data() const { return dense.data(); }
+
+    // Bumped whenever membership changes; lets owners cache derived data
+    // (e.g. TransformSystem's depth order) and rebuild it only when needed.
+    uint64_t Version() const { return version; }
+
+    // Change log, for owners that update derived data incrementally instead
+    // (e.g. TransformSystem). Once enabled, every entity inserted or erased
+    // is appended to Changes(); one entity may be listed more than once, so
+    // compare with Contains() when reading. When the log outgrows half the
+    // set, or on Clear / Load, it stops and reports ChangesOverflowed():
+    // rebuilding from scratch is as cheap by then.
+    void TrackChanges(bool enabled) {
+        trackChanges = enabled;
+        ClearChanges();
+    }
+    std::span<const Entity> Changes() const { return changes; }
+    bool ChangesOverflowed() const { return changesOverflowed; }
+    void ClearChanges() {
+        changes.clear();
+        changesOverflowed = false;
+    }
+
+    // Snapshot support (WorldSnapshot.hpp). Load counts as a membership change.
+    void Save(WorldSnapshot& snapshot) const {
+        const uint64_t key = SnapshotKey(owner, version);
+        snapshot.WriteArray(std::span<const Entity>(dense), key);
+        snapshot.WriteArray(std::span<const uint32_t>(sparse), key);
+    }
+
+    void Load(WorldSnapshot& snapshot) {
+        snapshot.ReadArray(dense);
+        snapshot.ReadArray(sparse);
+        ++version;
+        changesOverflowed = trackChanges;
+    }
+
+    auto begin() const { return dense.begin(); }
+    auto end() const { return dense.end(); }
+
+private:
+    static constexpr std::size_t ChangeSlack = 64;
+
+    void LogChanges(const Entity* first, std::size_t count) {
+        if (!trackChanges || changesOverflowed) return;
+        if (changes.size() + count > dense.size() / 2 + ChangeSlack) {
+            changesOverflowed = true;
+            changes.clear();
+            return;
+        }
+        changes.insert(changes.end(), first, first + count);
+    }
+
+    std::vector<Entity> dense;
+    std::vector<uint32_t> sparse;
+    std::vector<Entity> changes;
+    bool trackChanges = false;
+    bool changesOverflowed = false;
+    uint64_t version = 0;
+    uint64_t owner = NewSnapshotOwner();
+};
+
+}
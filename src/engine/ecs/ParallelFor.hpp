@@ -0,0 +1,177 @@
+/* Chunked parallel iteration over component storage and query views.
+
+   A range of N elements is cut into fixed-size chunks that are handed to the
+   JobSystem; the calling thread runs the first chunk and then helps until all
+   chunks are done. Chunk sizes are rounded so that, for packed component
+   arrays, every chunk starts on a cache line and no two threads write to the
+   same line.
+
+   Determinism: the chunk size depends only on the element count and the
+   requested grain, never on the thread count, and ParallelReduce combines the
+   per-chunk partial results in chunk order on the calling thread. Given the
+   same ECS state the result is bit-identical no matter how many workers run
+   or which worker picks up which chunk. PerThread<T> scratch is for caches
+   and temporaries only; merging it is not ordered.
+
+example usage:
+
+ecs::ParallelForEach(jobs, coordinator.GetComponentStorage<Transform>(),
+    [](ecs::Entity, Transform& t) { t.world = t.LocalMatrix(); });
+
+float total = ecs::ParallelReduce(jobs, coordinator.View<Rigidbody>(), 0.0f,
+    [](float& acc, ecs::Entity, Rigidbody& rb) { acc += rb.mass; },
+    [](float& acc, const float& chunk) { acc += chunk; }); */
+#pragma once
+
+#include "ComponentManager.hpp"
+#include "Query.hpp"
+#include "../core/JobSystem.hpp"
+#include "../utils/AlignedAllocator.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace ecs {
+
+struct ChunkContext {
+    std::size_t chunk;   // chunk number, 0..chunkCount-1
+    std::size_t begin;   // element range [begin, end)
+    std::size_t end;
+    unsigned thread;     // JobSystem::ThreadIndex() of the executing thread
+};
+
+// Chunk size used when the caller passes 0: about 16 KiB of elements.
+inline constexpr std::size_t DefaultChunkBytes = 16 * 1024;
+
+// Rounds `grain` (elements) up to a whole number of cache lines of T.
+template<typename T>
+std::size_t AlignedChunkSize(std::size_t grain) {
+    std::size_t perLine = 1;
+    while ((perLine * sizeof(T)) % CacheLineSize != 0 && perLine < CacheLineSize) ++perLine;
+    if (grain == 0) grain = std::max<std::size_t>(1, DefaultChunkBytes / sizeof(T));
+    return (grain + perLine - 1) / perLine * perLine;
+}
+
+// Runs chunkFn(const ChunkContext&) for every chunk of [0, count).
+template<typename Fn>
+void ParallelChunks(JobSystem& jobs, std::size_t count, std::size_t chunkSize, Fn&& chunkFn) {
+    if (count == 0) return;
+    const std::size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+    const auto context = [&](std::size_t chunk) {
+        return ChunkContext{ chunk, chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize), jobs.ThreadIndex() };
+    };
+
+    if (chunkCount == 1) {
+        chunkFn(context(0));
+        return;
+    }
+
+    JobCounter counter;
+    for (std::size_t chunk = 1; chunk < chunkCount; ++chunk)
+        jobs.Submit([&, chunk] { chunkFn(context(chunk)); }, &counter);
+
+    chunkFn(context(0));
+    jobs.Wait(counter);
+}
+
+// fn(Entity, T&) over every component of one type, in cache-aligned chunks.
+template<typename T, typename Fn>
+void ParallelForEach(JobSystem& jobs, ComponentArray<T>& storage, Fn&& fn, std::size_t grain = 0) {
+    const std::span<T> components = storage.Components();
+    const std::span<const Entity> entities = storage.Entities();
+    ParallelChunks(jobs, components.size(), AlignedChunkSize<T>(grain), [&](const ChunkContext& ctx) {
+        for (std::size_t i = ctx.begin; i < ctx.end; ++i) fn(entities[i], components[i]);
+    });
+}
+
+// fn(Entity, Ts&...) over every entity of a view. Chunks split the view's
+// iteration order; components are read through its dense-index columns.
+template<typename... Ts, typename Fn>
+void ParallelForEach(JobSystem& jobs, const QueryView<Ts...>& view, Fn&& fn, std::size_t grain = 0) {
+    const std::span<const Entity> entities = view.Entities();
+    ParallelChunks(jobs, entities.size(), AlignedChunkSize<Entity>(grain), [&](const ChunkContext& ctx) {
+        for (std::size_t i = ctx.begin; i < ctx.end; ++i) view.ApplyAt(fn, i);
+    });
+}
+
+namespace detail {
+
+// One partial result per chunk, each on its own cache line.
+template<typename R>
+struct alignas(CacheLineSize) Partial {
+    R value;
+};
+
+template<typename R, typename Combine>
+R CombineInOrder(std::vector<Partial<R>, AlignedAllocator<Partial<R>>>& partials, R identity, Combine& combine) {
+    R result = std::move(identity);
+    for (auto& partial : partials) combine(result, partial.value);
+    return result;
+}
+
+}
+
+// Deterministic reduction over one component type. accumulate(R&, Entity, T&)
+// folds an element into its chunk's partial; combine(R&, const R&) merges the
+// partials in chunk order.
+template<typename T, typename R, typename Accumulate, typename Combine>
+R ParallelReduce(JobSystem& jobs, ComponentArray<T>& storage, R identity,
+                 Accumulate&& accumulate, Combine&& combine, std::size_t grain = 0) {
+    const std::span<T> components = storage.Components();
+    const std::span<const Entity> entities = storage.Entities();
+    const std::size_t chunkSize = AlignedChunkSize<T>(grain);
+
+    std::vector<detail::Partial<R>, AlignedAllocator<detail::Partial<R>>> partials(
+        (components.size() + chunkSize - 1) / chunkSize, detail::Partial<R>{ identity });
+    ParallelChunks(jobs, components.size(), chunkSize, [&](const ChunkContext& ctx) {
+        R& acc = partials[ctx.chunk].value;
+        for (std::size_t i = ctx.begin; i < ctx.end; ++i) accumulate(acc, entities[i], components[i]);
+    });
+    return detail::CombineInOrder(partials, identity, combine);
+}
+
+// Deterministic reduction over a view; accumulate(R&, Entity, Ts&...).
+template<typename... Ts, typename R, typename Accumulate, typename Combine>
+R ParallelReduce(JobSystem& jobs, const QueryView<Ts...>& view, R identity,
+                 Accumulate&& accumulate, Combine&& combine, std::size_t grain = 0) {
+    const std::span<const Entity> entities = view.Entities();
+    const std::size_t chunkSize = AlignedChunkSize<Entity>(grain);
+
+    std::vector<detail::Partial<R>, AlignedAllocator<detail::Partial<R>>> partials(
+        (entities.size() + chunkSize - 1) / chunkSize, detail::Partial<R>{ identity });
+    ParallelChunks(jobs, entities.size(), chunkSize, [&](const ChunkContext& ctx) {
+        R& acc = partials[ctx.chunk].value;
+        for (std::size_t i = ctx.begin; i < ctx.end; ++i)
+            view.ApplyAt([&](Entity e, Ts&... components) { accumulate(acc, e, components...); }, i);
+    });
+    return detail::CombineInOrder(partials, identity, combine);
+}
+
+// Per-thread scratch for one JobSystem: Local() returns the calling thread's
+// instance. Slots are cache-line separated to avoid false sharing.
+template<typename T>
+class PerThread {
+public:
+    explicit PerThread(const JobSystem& jobs, const T& initial = T{})
+        : jobs(&jobs), slots(jobs.ThreadCount(), Slot{ initial }) {}
+
+    T& Local() { return slots[jobs->ThreadIndex()].value; }
+
+    // Visits every thread's instance, in thread-index order.
+    template<typename Fn>
+    void ForEach(Fn&& fn) {
+        for (auto& slot : slots) fn(slot.value);
+    }
+
+private:
+    struct alignas(CacheLineSize) Slot {
+        T value;
+    };
+
+    const JobSystem* jobs;
+    std::vector<Slot, AlignedAllocator<Slot>> slots;
+};
+
+}
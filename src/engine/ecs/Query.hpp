@@ -0,0 +1,294 @@
+/* Typed multi-component queries.
+
+   coordinator.View<Transform, MeshRenderer>() returns a QueryView backed by a
+   cached match list. The cache is created on first use for a signature and is
+   then updated incrementally by the Coordinator whenever an entity's signature
+   changes, so building a view every frame costs one small linear search.
+
+   Iteration does no sparse lookups. When every entity of the smallest viewed
+   array matches (the usual case, e.g. every MeshRenderer has a Transform) the
+   view walks that array's dense storage in order; otherwise it walks the match
+   list. The other arrays are read through a column of dense indices cached
+   with the match list and rebuilt only after a structural change.
+
+example usage:
+
+for (auto [entity, transform, renderer] : world.View<Transform, MeshRenderer>()) {
+    ...
+}
+*/
+#pragma once
+
+#include "ComponentManager.hpp"
+#include "EntitySet.hpp"
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace ecs {
+
+// Match list for one component signature, plus the iteration order and
+// dense-index columns views read through (see Refresh).
+struct QueryCache {
+    // Where each iterated entity's component of one type sits in its array.
+    // `direct` marks the array the order was taken from: index i is i.
+    struct Column {
+        ComponentTypeId type = 0;
+        uint64_t layoutVersion = 0;
+        bool direct = false;
+        std::vector<uint32_t> index;
+    };
+
+    Signature signature;
+    EntitySet entities;
+
+    const Entity* order = nullptr;
+    std::size_t count = 0;
+    std::vector<Column> columns;
+
+    // Brings order and columns up to date with the match list and the
+    // arrays' layouts. Cheap when nothing structural changed since the last
+    // call; safe to call from systems running in parallel.
+    template<typename... Ts>
+    void Refresh(ComponentArray<Ts>&... arrays) {
+        std::lock_guard<std::mutex> lock(refreshMutex);
+        if (columns.size() == sizeof...(Ts) && matchVersion == entities.Version()
+            && (Current(ComponentType<Ts>::id, arrays.LayoutVersion()) && ...)) return;
+
+        // the smallest array holds every match exactly when the sizes agree
+        std::size_t smallest = std::numeric_limits<std::size_t>::max();
+        ComponentTypeId driver = 0;
+        const Entity* driverOrder = nullptr;
+        const auto consider = [&]<typename T>(const ComponentArray<T>& array) {
+            if (array.Size() >= smallest) return;
+            smallest = array.Size();
+            driver = ComponentType<T>::id;
+            driverOrder = array.Entities().data();
+        };
+        (consider(arrays), ...);
+        const bool direct = smallest == entities.size();
+        order = direct ? driverOrder : entities.data();
+        count = entities.size();
+
+        columns.resize(sizeof...(Ts));
+        std::size_t next = 0;
+        (Rebuild(columns[next++], arrays, direct && ComponentType<Ts>::id == driver), ...);
+        matchVersion = entities.Version();
+    }
+
+    const Column& ColumnOf(ComponentTypeId type) const {
+        for (const Column& column : columns)
+            if (column.type == type) return column;
+        assert(false && "Query column missing; call Refresh first.");
+        return columns.front();
+    }
+
+private:
+    bool Current(ComponentTypeId type, uint64_t layoutVersion) const {
+        for (const Column& column : columns)
+            if (column.type == type) return column.layoutVersion == layoutVersion;
+        return false;
+    }
+
+    template<typename T>
+    void Rebuild(Column& column, const ComponentArray<T>& array, bool isDriver) {
+        column.type = ComponentType<T>::id;
+        column.layoutVersion = array.LayoutVersion();
+        column.direct = isDriver;
+        column.index.clear();
+        if (isDriver) return;
+        column.index.resize(count);
+        for (std::size_t i = 0; i < count; ++i) column.index[i] = array.DenseIndex(order[i]);
+    }
+
+    uint64_t matchVersion = std::numeric_limits<uint64_t>::max();
+    std::mutex refreshMutex;
+};
+
+class QueryManager {
+public:
+    // Returns the cache for a signature, creating it and calling seed(cache)
+    // on first use. Safe to call from systems running in parallel; structural
+    // changes must still happen outside the parallel phase.
+    template<typename Seed>
+    QueryCache& FindOrCreate(const Signature& signature, Seed&& seed) {
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            if (QueryCache* cache = Find(signature)) return *cache;
+        }
+
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        if (QueryCache* cache = Find(signature)) return *cache;
+
+        caches.push_back(std::make_unique<QueryCache>());
+        QueryCache& cache = *caches.back();
+        cache.signature = signature;
+        seed(cache);
+        return cache;
+    }
+
+    void EntitySignatureChanged(Entity entity, const Signature& entitySignature) {
+        for (auto& cache : caches) {
+            if (entitySignature.Contains(cache->signature))
+                cache->entities.Insert(entity);
+            else
+                cache->entities.Erase(entity);
+        }
+    }
+
+    void EntitiesSignatureChanged(std::span<const Entity> entities, const Signature& entitySignature) {
+        for (auto& cache : caches) {
+            if (entitySignature.Contains(cache->signature)) {
+                cache->entities.InsertRange(entities.data(), entities.size());
+            } else {
+                for (Entity entity : entities) cache->entities.Erase(entity);
+            }
+        }
+    }
+
+    void MatchingSets(const Signature& entitySignature, std::vector<EntitySet*>& out) {
+        for (auto& cache : caches) {
+            if (entitySignature.Contains(cache->signature)) out.push_back(&cache->entities);
+        }
+    }
+
+    void EntityDestroyed(Entity entity) {
+        for (auto& cache : caches) cache->entities.Erase(entity);
+    }
+
+    void EntitiesDestroyed(std::span<const Entity> entities) {
+        for (auto& cache : caches) {
+            if (cache->entities.empty()) continue;
+            for (Entity entity : entities) cache->entities.Erase(entity);
+        }
+    }
+
+    // Snapshot support: the cache signatures, then each cache's match list.
+    // Caches are never removed, so cache i at Load is cache i at Save unless
+    // its signature says otherwise; caches without saved state (created
+    // since) are cleared and re-seeded from the restored signatures.
+    void Save(WorldSnapshot& snapshot) const {
+        std::vector<std::byte>& bytes = snapshot.Scratch();
+        ByteWriter writer(bytes);
+        for (const auto& cache : caches) writer.Write(cache->signature);
+        snapshot.WriteBlock(bytes);
+        for (const auto& cache : caches) cache->entities.Save(snapshot);
+    }
+
+    template<typename Seed>
+    void Load(WorldSnapshot& snapshot, Seed&& seed) {
+        const std::span<const std::byte> signatures = snapshot.ReadBlock();
+        const std::size_t saved = signatures.size() / sizeof(Signature);
+        std::vector<bool> restored(caches.size(), false);
+        for (std::size_t i = 0; i < saved; ++i) {
+            Signature signature;
+            std::memcpy(static_cast<void*>(&signature), signatures.data() + i * sizeof(Signature), sizeof(Signature));
+            if (i < caches.size() && caches[i]->signature == signature) {
+                caches[i]->entities.Load(snapshot);
+                restored[i] = true;
+            } else {
+                snapshot.ReadBlock();
+                snapshot.ReadBlock();
+            }
+        }
+        for (std::size_t i = 0; i < caches.size(); ++i) {
+            if (restored[i]) continue;
+            caches[i]->entities.Clear();
+            seed(*caches[i]);
+        }
+    }
+
+private:
+    QueryCache* Find(const Signature& signature) {
+        for (auto& cache : caches)
+            if (cache->signature == signature) return cache.get();
+        return nullptr;
+    }
+
+    std::vector<std::unique_ptr<QueryCache>> caches; // unique_ptr keeps views valid across creation
+    std::shared_mutex mutex;
+};
+
+// Iterable view over every entity that has all of Ts. Dereferencing yields
+// (entity, Ts&...) straight from the packed component arrays, each found
+// through the cache's dense-index column. Adding or removing components of
+// the viewed types while iterating is not allowed.
+template<typename... Ts>
+class QueryView {
+public:
+    using Arrays = std::tuple<ComponentArray<Ts>*...>;
+
+    class Iterator {
+    public:
+        Iterator(const QueryView* view, std::size_t i) : view(view), i(i) {}
+
+        std::tuple<Entity, Ts&...> operator*() const { return view->At(i, std::index_sequence_for<Ts...>{}); }
+
+        Iterator& operator++() { ++i; return *this; }
+        bool operator!=(const Iterator& other) const { return i != other.i; }
+        bool operator==(const Iterator& other) const { return i == other.i; }
+
+    private:
+        const QueryView* view;
+        std::size_t i;
+    };
+
+    // The cache must have been refreshed for these arrays.
+    QueryView(const QueryCache& cache, ComponentArray<Ts>*... arrays)
+        : order(cache.order), count(cache.count), arrays(arrays...),
+          data(arrays->Components().data()...),
+          columns{ ColumnData(cache.ColumnOf(ComponentType<Ts>::id))... } {}
+
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, count); }
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // Iteration order; ApplyAt(fn, i) visits Entities()[i].
+    std::span<const Entity> Entities() const { return { order, count }; }
+
+    // Calls fn(entity, Ts&...) for the i-th entity of the view.
+    template<typename Fn>
+    void ApplyAt(Fn&& fn, std::size_t i) const {
+        std::apply(fn, At(i, std::index_sequence_for<Ts...>{}));
+    }
+
+    // Calls fn(entity, Ts&...) for one matched entity, looked up by handle.
+    template<typename Fn>
+    void Apply(Fn&& fn, Entity entity) const {
+        std::apply([&](auto*... arr) { fn(entity, arr->GetData(entity)...); }, arrays);
+    }
+
+    // fn(Entity, Ts&...)
+    template<typename Fn>
+    void Each(Fn&& fn) const {
+        for (std::size_t i = 0; i < count; ++i) ApplyAt(fn, i);
+    }
+
+private:
+    static const uint32_t* ColumnData(const QueryCache::Column& column) {
+        return column.direct ? nullptr : column.index.data();
+    }
+
+    template<std::size_t... K>
+    std::tuple<Entity, Ts&...> At(std::size_t i, std::index_sequence<K...>) const {
+        return { order[i], std::get<K>(data)[columns[K] ? columns[K][i] : i]... };
+    }
+
+    const Entity* order;
+    std::size_t count;
+    Arrays arrays;
+    std::tuple<Ts*...> data;
+    std::array<const uint32_t*, sizeof...(Ts)> columns; // null: the array is walked in order
+};
+
+}
@@ -0,0 +1,85 @@
+/* Base class for systems. A system declares a component signature through
+   Coordinator::SetSystemSignature and receives every matching entity in
+   `entities`. Update() is called once per fixed simulation step, or once per
+   rendered frame for systems that call RunPerFrame() (rendering, cameras);
+   between the two, Interpolate() lets simulation systems present a state
+   part way to the next step.
+
+   Systems also declare which component types they read and write (usually in
+   their constructor). FrameScheduler uses that to run systems that don't
+   conflict at the same time. A system that declares nothing is treated as
+   writing everything and always runs alone. */
+#pragma once
+
+#include "ComponentManager.hpp"
+#include "EntitySet.hpp"
+#include <cstdint>
+#include <string>
+
+namespace ecs {
+
+class Coordinator;
+
+enum class SystemPhase : uint8_t {
+    Simulation, // Update(fixed dt), zero or more times per frame
+    Frame,      // Update(frame dt), once per rendered frame
+};
+
+struct SystemAccess {
+    Signature reads;
+    Signature writes;
+    bool declared = false;
+    bool mainThreadOnly = false; // e.g. systems that issue GL calls
+
+    bool ConflictsWith(const SystemAccess& other) const {
+        if (!declared || !other.declared) return true;
+        return writes.Intersects(other.reads) || writes.Intersects(other.writes) || reads.Intersects(other.writes);
+    }
+};
+
+class System {
+public:
+    virtual ~System() = default;
+
+    virtual void Update(float /*dt*/) {}
+
+    // Called once per frame, before the Frame phase, with how far (0..1) the
+    // frame is from the last simulation step towards the next one.
+    virtual void Interpolate(float /*alpha*/) {}
+
+    // Entities whose signature currently matches this system's signature.
+    EntitySet entities;
+
+    const SystemAccess& GetAccess() const { return access; }
+    const std::string& GetName() const { return name; }
+    SystemPhase GetPhase() const { return phase; }
+
+protected:
+    template<typename... Ts>
+    void Reads() {
+        access.declared = true;
+        access.reads |= Signature::Of<Ts...>();
+    }
+
+    template<typename... Ts>
+    void Writes() {
+        access.declared = true;
+        access.writes |= Signature::Of<Ts...>();
+    }
+
+    void RunOnMainThread() { access.mainThreadOnly = true; }
+    void RunPerFrame() { phase = SystemPhase::Frame; }
+
+    // Set by Coordinator::RegisterSystem; gives systems access to views/components.
+    Coordinator* coordinator = nullptr;
+
+private:
+    SystemAccess access;
+    SystemPhase phase = SystemPhase::Simulation;
+    std::string name; // set from the type name at registration, used in frame stats
+
+    friend class Coordinator;
+    friend class SystemManager;
+};
+
+}
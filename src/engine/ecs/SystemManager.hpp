@@ -1,71 +1,116 @@
 /* Holds all systems and their entity lists. */
 #pragma once
 
+#include "System.hpp"
 #include <memory>
+#include <span>
 #include <unordered_map>
-#include <set>
+#include <typeindex>
 #include <vector>
 #include <cassert>
 
 namespace ecs {
 
-using EntityId = uint32_t;
-
-// Base system type: users derive from this and systems keep a set of matched entities
-class System {
-public:
-    virtual ~System() = default;
-    std::set<EntityId> entities;
-};
-
 class SystemManager {
 public:
     template<typename T>
     std::shared_ptr<T> RegisterSystem() {
         const std::type_index ti(typeid(T));
-        assert(systems.find(ti) == systems.end() && "Registering system more than once.");
+        assert(slots.find(ti) == slots.end() && "Registering system more than once.");
         auto sys = std::make_shared<T>();
-        systems.emplace(ti, sys);
+        if (sys->name.empty()) sys->name = typeid(T).name();
+        slots.emplace(ti, systems.size());
+        systems.push_back({ sys, Signature{} });
+        ordered.push_back(sys.get());
         return sys;
     }
 
     template<typename T>
-    void SetSignature(uint64_t signature) {
-        const std::type_index ti(typeid(T));
-        assert(systems.find(ti) != systems.end() && "System used before registered.");
-        signatures[ti] = signature;
+    void SetSignature(const Signature& signature) {
+        systems[SlotOf<T>()].signature = signature;
+    }
+
+    void EntityDestroyed(Entity entity) {
+        for (auto &entry : systems) {
+            entry.system->entities.Erase(entity);
+        }
     }
 
-    void EntityDestroyed(EntityId entity) {
-        for (auto const &pair : systems) {
-            auto const &sys = pair.second;
-            sys->entities.erase(entity);
+    void EntitiesDestroyed(std::span<const Entity> entities) {
+        for (auto &entry : systems) {
+            EntitySet& set = entry.system->entities;
+            if (set.empty()) continue;
+            for (Entity entity : entities) set.Erase(entity);
         }
     }
 
-    void EntitySignatureChanged(EntityId entity, uint64_t entitySignature) {
-        for (auto const &pair : systems) {
-            const std::type_index ti = pair.first;
-            auto const &sys = pair.second;
-            uint64_t systemSignature = signatures.count(ti) ? signatures.at(ti) : 0u;
-            if ((entitySignature & systemSignature) == systemSignature) {
-                sys->entities.insert(entity);
+    // Hot path: a linear walk over a flat array with O(1) set updates.
+    void EntitySignatureChanged(Entity entity, const Signature& entitySignature) {
+        for (auto &entry : systems) {
+            if (entitySignature.Contains(entry.signature)) {
+                entry.system->entities.Insert(entity);
             } else {
-                sys->entities.erase(entity);
+                entry.system->entities.Erase(entity);
             }
         }
     }
 
+    // Batched form for entities that all ended up with the same signature:
+    // each system's signature is tested once for the whole run.
+    void EntitiesSignatureChanged(std::span<const Entity> entities, const Signature& entitySignature) {
+        for (auto &entry : systems) {
+            EntitySet& set = entry.system->entities;
+            if (entitySignature.Contains(entry.signature)) {
+                set.InsertRange(entities.data(), entities.size());
+            } else {
+                for (Entity entity : entities) set.Erase(entity);
+            }
+        }
+    }
+
+    // Entity sets of the systems an entity with `entitySignature` belongs to,
+    // for callers that fill them directly (and possibly in parallel).
+    void MatchingSets(const Signature& entitySignature, std::vector<EntitySet*>& out) {
+        for (auto &entry : systems) {
+            if (entitySignature.Contains(entry.signature)) out.push_back(&entry.system->entities);
+        }
+    }
+
     template<typename T>
     std::shared_ptr<T> GetSystem() {
-        const std::type_index ti(typeid(T));
-        assert(systems.find(ti) != systems.end() && "System not registered.");
-        return std::static_pointer_cast<T>(systems.at(ti));
+        return std::static_pointer_cast<T>(systems[SlotOf<T>()].system);
+    }
+
+    // Snapshot support: each system's entity set, in registration order.
+    void Save(WorldSnapshot& snapshot) const {
+        for (const auto &entry : systems) entry.system->entities.Save(snapshot);
+    }
+
+    void Load(WorldSnapshot& snapshot) {
+        for (auto &entry : systems) entry.system->entities.Load(snapshot);
     }
 
+    std::size_t Count() const { return systems.size(); }
+
+    // All systems in registration order (the order FrameScheduler preserves).
+    const std::vector<System*>& GetSystems() const { return ordered; }
+
 private:
-    std::unordered_map<std::type_index, std::shared_ptr<System>> systems;
-    std::unordered_map<std::type_index, uint64_t> signatures;
+    struct Entry {
+        std::shared_ptr<System> system;
+        Signature signature;
+    };
+
+    template<typename T>
+    std::size_t SlotOf() const {
+        auto it = slots.find(std::type_index(typeid(T)));
+        assert(it != slots.end() && "System used before registered.");
+        return it->second;
+    }
+
+    std::vector<Entry> systems;                            // registration order
+    std::vector<System*> ordered;                          // same order, raw pointers
+    std::unordered_map<std::type_index, std::size_t> slots; // cold-path lookup only
 };
 
-} 
\ No newline at end of file
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Coordinator.hpp"
+#include "WorldSnapshot.hpp"
 #include <string>
 #include <unordered_map>
 #include <memory>
@@ -16,36 +17,98 @@ class World {
 public:
     World() { coordinator.Init(); }
 
-    EntityId CreateEntity(const std::string &name = "") {
-        EntityId id = coordinator.CreateEntity();
-        if (!name.empty())
+    Entity CreateEntity(const std::string &name = "") {
+        Entity id = coordinator.CreateEntity();
+        if (!name.empty()) {
             nameIndex.emplace(name, id);
+            ++namesVersion;
+        }
         return id;
     }
 
-    void DestroyEntity(EntityId id) {
+    // Names an entity created without one (e.g. by SceneLoader).
+    void SetName(Entity id, const std::string &name) {
+        nameIndex.emplace(name, id);
+        ++namesVersion;
+    }
+
+    // Sizes the name index for `count` more names, so a bulk load does
+    // not rehash it over and over.
+    void ReserveNames(std::size_t count) {
+        nameIndex.reserve(nameIndex.size() + count);
+    }
+
+    void DestroyEntity(Entity id) {
         /* detach parent/children bookkeeping happens externally here; since
            this World doesn't keep explicit children lists (to keep it simple),
            user can implement relationship components if needed.
            Remove from name index
            NOTE: we keep it simple and remove any matching name entries.*/
         for (auto it = nameIndex.begin(); it != nameIndex.end();) {
-            if (it->second == id) it = nameIndex.erase(it); else ++it;
+            if (it->second == id) {
+                it = nameIndex.erase(it);
+                ++namesVersion;
+            } else {
+                ++it;
+            }
         }
         coordinator.DestroyEntity(id);
     }
 
-    EntityId FindByName(const std::string &name) const {
+    Entity FindByName(const std::string &name) const {
         auto it = nameIndex.find(name);
-        if (it == nameIndex.end()) return 0;
+        if (it == nameIndex.end()) return NullEntity;
         return it->second;
     }
 
+    template<typename... Ts>
+    QueryView<Ts...> View() { return coordinator.View<Ts...>(); }
+
     Coordinator& GetCoordinator() { return coordinator; }
 
+    // Snapshot support, see WorldSnapshot.hpp. The name index goes in as one
+    // serialized block, re-serialized only after names changed; its key lets
+    // Load skip rebuilding the index when it is still the one saved.
+    void Save(WorldSnapshot& snapshot) {
+        coordinator.Save(snapshot);
+        if (namesSaved != namesVersion) {
+            namesBlob.clear();
+            ByteWriter writer(namesBlob);
+            writer.Write(static_cast<uint64_t>(nameIndex.size()));
+            for (const auto &[name, entity] : nameIndex) {
+                writer.WriteString(name);
+                writer.Write(entity);
+            }
+            namesSaved = namesVersion;
+        }
+        snapshot.WriteBlock(namesBlob, SnapshotKey(owner, namesVersion));
+    }
+
+    bool Load(WorldSnapshot& snapshot) {
+        if (!coordinator.Load(snapshot)) return false;
+        const std::span<const std::byte> names = snapshot.ReadBlock();
+        if (snapshot.BlockKey() == SnapshotKey(owner, namesVersion)) return true;
+
+        nameIndex.clear();
+        ByteReader reader(names);
+        const auto count = reader.Read<uint64_t>();
+        nameIndex.reserve(count);
+        for (uint64_t i = 0; i < count && !reader.Failed(); ++i) {
+            std::string name = reader.ReadString();
+            nameIndex.emplace(std::move(name), reader.Read<Entity>());
+        }
+        namesBlob.assign(names.begin(), names.end());
+        namesSaved = ++namesVersion;
+        return true;
+    }
+
 private:
     Coordinator coordinator;
-    std::unordered_multimap<std::string, EntityId> nameIndex;
+    std::unordered_multimap<std::string, Entity> nameIndex;
+    uint64_t owner = NewSnapshotOwner();
+    uint64_t namesVersion = 0;
+    uint64_t namesSaved = ~uint64_t{ 0 };
+    std::vector<std::byte> namesBlob;
 };
 
 }
\ No newline at end of file
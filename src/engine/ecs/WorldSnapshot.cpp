@@ -0,0 +1,203 @@
+#include "WorldSnapshot.hpp"
+#include "ParallelFor.hpp"
+#include "World.hpp"
+#include <algorithm>
+
+namespace ecs {
+
+namespace {
+
+// Pages per job: big enough that the compare, not the scheduling, dominates.
+constexpr std::size_t PagesPerChunk = 64;
+
+constexpr std::size_t PageBytes(uint64_t blockSize, std::size_t page) {
+    const uint64_t begin = uint64_t{ page } * WorldSnapshot::PageSize;
+    return blockSize > begin ? static_cast<std::size_t>(std::min<uint64_t>(WorldSnapshot::PageSize, blockSize - begin)) : 0;
+}
+
+template<typename Fn>
+void ForRange(JobSystem* jobs, std::size_t count, Fn&& fn) {
+    if (!jobs || count <= PagesPerChunk) {
+        fn(0, count);
+        return;
+    }
+    ParallelChunks(*jobs, count, PagesPerChunk, [&](const ChunkContext& chunk) { fn(chunk.begin, chunk.end); });
+}
+
+}
+
+std::vector<std::byte>& WorldSnapshot::Scratch() {
+    if (scratchUsed == scratch.size()) scratch.emplace_back();
+    std::vector<std::byte>& buffer = scratch[scratchUsed++];
+    buffer.clear();
+    return buffer;
+}
+
+void WorldSnapshot::WriteBlock(std::span<const std::byte> bytes, uint64_t key) {
+    pending.push_back({ bytes, key });
+}
+
+void WorldSnapshot::WriteStrided(const void* first, std::size_t count, std::size_t stride, std::size_t width, uint64_t key) {
+    if (stride == width) {
+        WriteBlock({ static_cast<const std::byte*>(first), count * width }, key);
+        return;
+    }
+    pending.push_back({ { static_cast<const std::byte*>(first), count * width }, key, stride, width });
+}
+
+// Whether packed bytes [offset, offset + size) of `block` equal `stored`.
+bool WorldSnapshot::Matches(const Pending& block, std::size_t offset, std::size_t size, const std::byte* stored) {
+    if (block.stride == 0) return std::memcmp(block.bytes.data() + offset, stored, size) == 0;
+    std::size_t record = offset / block.width;
+    std::size_t within = offset % block.width;
+    while (size) {
+        const std::size_t run = std::min(block.width - within, size);
+        if (std::memcmp(block.bytes.data() + record * block.stride + within, stored, run) != 0) return false;
+        stored += run;
+        size -= run;
+        ++record;
+        within = 0;
+    }
+    return true;
+}
+
+// Packs bytes [offset, offset + size) of `block` into `out`.
+void WorldSnapshot::CopyOut(const Pending& block, std::size_t offset, std::size_t size, std::byte* out) {
+    if (block.stride == 0) {
+        if (size) std::memcpy(out, block.bytes.data() + offset, size);
+        return;
+    }
+    std::size_t record = offset / block.width;
+    std::size_t within = offset % block.width;
+    while (size) {
+        const std::size_t run = std::min(block.width - within, size);
+        std::memcpy(out, block.bytes.data() + record * block.stride + within, run);
+        out += run;
+        size -= run;
+        ++record;
+        within = 0;
+    }
+}
+
+std::span<const std::byte> WorldSnapshot::ReadBlock() {
+    if (readCursor >= blocks.size()) {
+        ++readCursor;
+        return {};
+    }
+    const Block& block = blocks[readCursor++];
+    return { block.data.data(), block.data.size() };
+}
+
+const SnapshotStats& WorldSnapshot::Capture(World& world, SnapshotDelta* delta) {
+    pending.clear();
+    scratchUsed = 0;
+    world.Save(*this);
+    if (delta) delta->Clear();
+
+    // blocks this capture did not write (fewer than last time) become empty
+    if (blocks.size() < pending.size()) blocks.resize(pending.size());
+    pending.resize(blocks.size(), Pending{ {}, 0 });
+    sizeBefore.assign(blocks.size(), 0);
+    stats = {};
+    stats.blocks = blocks.size();
+
+    // 1. grow the blocks that grew and list the pages to compare
+    pageList.clear();
+    for (uint32_t b = 0; b < blocks.size(); ++b) {
+        Block& block = blocks[b];
+        const Pending& next = pending[b];
+        sizeBefore[b] = block.data.size();
+        stats.bytes += next.bytes.size();
+        if (next.key != 0 && next.key == block.key && next.bytes.size() == block.data.size()) {
+            ++stats.blocksSkipped;
+            continue;
+        }
+        block.key = next.key;
+        if (delta && next.bytes.size() != block.data.size()) delta->resizes.push_back({ b, block.data.size(), next.bytes.size() });
+        if (next.bytes.size() > block.data.size()) block.data.resize(next.bytes.size());
+        const std::size_t pages = (std::max<uint64_t>(sizeBefore[b], next.bytes.size()) + PageSize - 1) / PageSize;
+        for (uint32_t page = 0; page < pages; ++page) pageList.emplace_back(b, page);
+    }
+    stats.pages = pageList.size();
+
+    // 2. compare, in parallel: nothing is written yet
+    JobSystem* jobs = world.GetCoordinator().GetJobSystem();
+    pageChanged.assign(pageList.size(), 0);
+    ForRange(jobs, pageList.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const auto [b, page] = pageList[i];
+            const std::size_t before = PageBytes(sizeBefore[b], page);
+            const std::size_t after = PageBytes(pending[b].bytes.size(), page);
+            const std::size_t offset = std::size_t{ page } * PageSize;
+            pageChanged[i] = before != after || !Matches(pending[b], offset, after, blocks[b].data.data() + offset);
+        }
+    });
+
+    // 3. the delta keeps both sides of every changed page
+    if (delta) {
+        for (std::size_t i = 0; i < pageList.size(); ++i) {
+            if (!pageChanged[i]) continue;
+            const auto [b, page] = pageList[i];
+            const std::size_t offset = std::size_t{ page } * PageSize;
+            SnapshotDelta::Page record{ b, page, delta->bytes.size(), 0, static_cast<uint32_t>(PageBytes(sizeBefore[b], page)),
+                                        static_cast<uint32_t>(PageBytes(pending[b].bytes.size(), page)) };
+            delta->bytes.insert(delta->bytes.end(), blocks[b].data.data() + offset, blocks[b].data.data() + offset + record.beforeSize);
+            record.after = delta->bytes.size();
+            delta->bytes.resize(delta->bytes.size() + record.afterSize);
+            CopyOut(pending[b], offset, record.afterSize, delta->bytes.data() + record.after);
+            delta->pages.push_back(record);
+        }
+    }
+
+    // 4. copy the changed pages, in parallel
+    ForRange(jobs, pageList.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            if (!pageChanged[i]) continue;
+            const auto [b, page] = pageList[i];
+            const std::size_t offset = std::size_t{ page } * PageSize;
+            CopyOut(pending[b], offset, PageBytes(pending[b].bytes.size(), page), blocks[b].data.data() + offset);
+        }
+    });
+    stats.pagesWritten = static_cast<std::size_t>(std::count(pageChanged.begin(), pageChanged.end(), uint8_t{ 1 }));
+
+    // 5. shrink the blocks that shrank, now that the delta has their tails
+    for (uint32_t b = 0; b < blocks.size(); ++b)
+        if (pending[b].bytes.size() < blocks[b].data.size()) blocks[b].data.resize(pending[b].bytes.size());
+    while (!blocks.empty() && blocks.back().data.empty()) blocks.pop_back();
+    pending.clear();
+    return stats;
+}
+
+bool WorldSnapshot::Restore(World& world) {
+    if (Empty()) return false;
+    readCursor = 0;
+    return world.Load(*this);
+}
+
+void WorldSnapshot::Revert(const SnapshotDelta& delta) {
+    for (const SnapshotDelta::Resize& resize : delta.resizes) {
+        if (resize.block >= blocks.size()) blocks.resize(resize.block + 1);
+        blocks[resize.block].data.resize(resize.before);
+    }
+    for (const SnapshotDelta::Page& page : delta.pages) {
+        Block& block = blocks[page.block];
+        block.key = 0;
+        std::memcpy(block.data.data() + std::size_t{ page.page } * PageSize, delta.bytes.data() + page.before, page.beforeSize);
+    }
+    while (!blocks.empty() && blocks.back().data.empty()) blocks.pop_back();
+}
+
+void WorldSnapshot::Apply(const SnapshotDelta& delta) {
+    for (const SnapshotDelta::Resize& resize : delta.resizes) {
+        if (resize.block >= blocks.size()) blocks.resize(resize.block + 1);
+        blocks[resize.block].data.resize(resize.after);
+    }
+    for (const SnapshotDelta::Page& page : delta.pages) {
+        Block& block = blocks[page.block];
+        block.key = 0;
+        std::memcpy(block.data.data() + std::size_t{ page.page } * PageSize, delta.bytes.data() + page.after, page.afterSize);
+    }
+    while (!blocks.empty() && blocks.back().data.empty()) blocks.pop_back();
+}
+
+}
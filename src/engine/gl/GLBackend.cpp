@@ -0,0 +1,127 @@
+#include "GLBackend.hpp"
+#include "GLExtensions.hpp"
+
+OpenGLBackend& OpenGLBackend::Instance() {
+    static OpenGLBackend backend;
+    return backend;
+}
+
+void OpenGLBackend::UseProgram(GLuint program) { glUseProgram(program); }
+void OpenGLBackend::BindVertexArray(GLuint vao) { glBindVertexArray(vao); }
+void OpenGLBackend::ActiveTexture(GLenum unit) { glActiveTexture(unit); }
+void OpenGLBackend::BindTexture(GLenum target, GLuint texture) { glBindTexture(target, texture); }
+void OpenGLBackend::BindBuffer(GLenum target, GLuint buffer) { glBindBuffer(target, buffer); }
+void OpenGLBackend::BindBufferBase(GLenum target, GLuint index, GLuint buffer) { glBindBufferBase(target, index, buffer); }
+
+void OpenGLBackend::BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    glBindBufferRange(target, index, buffer, offset, size);
+}
+
+void OpenGLBackend::Enable(GLenum capability) { glEnable(capability); }
+void OpenGLBackend::Disable(GLenum capability) { glDisable(capability); }
+void OpenGLBackend::BlendFunc(GLenum source, GLenum destination) { glBlendFunc(source, destination); }
+void OpenGLBackend::DepthFunc(GLenum func) { glDepthFunc(func); }
+void OpenGLBackend::DepthMask(GLboolean write) { glDepthMask(write); }
+void OpenGLBackend::CullFace(GLenum face) { glCullFace(face); }
+void OpenGLBackend::Viewport(GLint x, GLint y, GLsizei width, GLsizei height) { glViewport(x, y, width, height); }
+void OpenGLBackend::ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) { glClearColor(r, g, b, a); }
+void OpenGLBackend::Clear(GLbitfield mask) { glClear(mask); }
+
+void OpenGLBackend::GetIntegerv(GLenum pname, GLint* data) { glGetIntegerv(pname, data); }
+void OpenGLBackend::GetProgramiv(GLuint program, GLenum pname, GLint* params) { glGetProgramiv(program, pname, params); }
+
+void OpenGLBackend::GetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name) {
+    glGetActiveUniform(program, index, bufSize, length, size, type, name);
+}
+
+void OpenGLBackend::GetActiveUniformBlockiv(GLuint program, GLuint index, GLenum pname, GLint* params) {
+    glGetActiveUniformBlockiv(program, index, pname, params);
+}
+
+void OpenGLBackend::GetActiveUniformBlockName(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLchar* name) {
+    glGetActiveUniformBlockName(program, index, bufSize, length, name);
+}
+
+GLint OpenGLBackend::GetUniformLocation(GLuint program, const GLchar* name) {
+    return glGetUniformLocation(program, name);
+}
+
+void OpenGLBackend::UniformBlockBinding(GLuint program, GLuint blockIndex, GLuint binding) {
+    glUniformBlockBinding(program, blockIndex, binding);
+}
+
+void OpenGLBackend::Uniform1i(GLint location, GLint value) { glUniform1i(location, value); }
+void OpenGLBackend::Uniform1f(GLint location, GLfloat value) { glUniform1f(location, value); }
+void OpenGLBackend::Uniform4fv(GLint location, GLsizei count, const GLfloat* value) { glUniform4fv(location, count, value); }
+
+void OpenGLBackend::UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    glUniformMatrix4fv(location, count, transpose, value);
+}
+
+void OpenGLBackend::EnableVertexAttribArray(GLuint index) { glEnableVertexAttribArray(index); }
+
+void OpenGLBackend::VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) {
+    glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+}
+
+void OpenGLBackend::VertexAttribDivisor(GLuint index, GLuint divisor) { glVertexAttribDivisor(index, divisor); }
+
+void OpenGLBackend::GenBuffers(GLsizei n, GLuint* buffers) { glGenBuffers(n, buffers); }
+void OpenGLBackend::GenVertexArrays(GLsizei n, GLuint* vaos) { glGenVertexArrays(n, vaos); }
+void OpenGLBackend::DeleteBuffers(GLsizei n, const GLuint* buffers) { glDeleteBuffers(n, buffers); }
+void OpenGLBackend::DeleteVertexArrays(GLsizei n, const GLuint* vaos) { glDeleteVertexArrays(n, vaos); }
+void OpenGLBackend::DeleteTextures(GLsizei n, const GLuint* textures) { glDeleteTextures(n, textures); }
+void OpenGLBackend::DeleteProgram(GLuint program) { glDeleteProgram(program); }
+
+void OpenGLBackend::BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+    glBufferData(target, size, data, usage);
+}
+
+void OpenGLBackend::BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+    glBufferSubData(target, offset, size, data);
+}
+
+void OpenGLBackend::GenTextures(GLsizei n, GLuint* textures) { glGenTextures(n, textures); }
+void OpenGLBackend::TexParameteri(GLenum target, GLenum pname, GLint param) { glTexParameteri(target, pname, param); }
+
+void OpenGLBackend::TexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border,
+                               GLenum format, GLenum type, const void* pixels) {
+    glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+}
+
+void OpenGLBackend::CompressedTexImage2D(GLenum target, GLint level, GLenum internalFormat, GLsizei width, GLsizei height,
+                                         GLint border, GLsizei imageSize, const void* data) {
+    glCompressedTexImage2D(target, level, internalFormat, width, height, border, imageSize, data);
+}
+
+bool OpenGLBackend::HasTextureCompressionS3tc() { return glext::HasTextureCompressionS3tc(); }
+
+void OpenGLBackend::GenQueries(GLsizei n, GLuint* queries) { glGenQueries(n, queries); }
+void OpenGLBackend::DeleteQueries(GLsizei n, const GLuint* queries) { glDeleteQueries(n, queries); }
+void OpenGLBackend::QueryCounter(GLuint query, GLenum target) { glQueryCounter(query, target); }
+void OpenGLBackend::GetQueryObjectiv(GLuint query, GLenum pname, GLint* params) { glGetQueryObjectiv(query, pname, params); }
+void OpenGLBackend::GetQueryObjectui64v(GLuint query, GLenum pname, GLuint64* params) { glGetQueryObjectui64v(query, pname, params); }
+
+void OpenGLBackend::DrawArrays(GLenum mode, GLint first, GLsizei count) { glDrawArrays(mode, first, count); }
+
+void OpenGLBackend::DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) {
+    glDrawElements(mode, count, type, indices);
+}
+
+void OpenGLBackend::DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount) {
+    glDrawArraysInstanced(mode, first, count, instanceCount);
+}
+
+void OpenGLBackend::DrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount) {
+    glDrawElementsInstanced(mode, count, type, indices, instanceCount);
+}
+
+bool OpenGLBackend::HasBaseInstance() { return glext::HasBaseInstance(); }
+
+void OpenGLBackend::DrawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount, GLuint baseInstance) {
+    glext::DrawArraysInstancedBaseInstance(mode, first, count, instanceCount, baseInstance);
+}
+
+void OpenGLBackend::DrawElementsInstancedBaseInstance(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount, GLuint baseInstance) {
+    glext::DrawElementsInstancedBaseInstance(mode, count, type, indices, instanceCount, baseInstance);
+}
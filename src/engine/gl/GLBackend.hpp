@@ -0,0 +1,248 @@
+/* The GL entry points the renderer issues, behind an interface so render code
+   can run against a recording stand-in in headless tests. OpenGLBackend
+   forwards each call to the glad-loaded function of the same name;
+   NullGLBackend drops them and reports empty queries (benchmarks, tools
+   without a context). Engine code
+   normally talks to GLContext, which wraps one of these and skips redundant
+   state changes. */
+#pragma once
+#include <glad/gl.h>
+
+class GLBackend {
+public:
+    virtual ~GLBackend() = default;
+
+    // binds
+    virtual void UseProgram(GLuint program) = 0;
+    virtual void BindVertexArray(GLuint vao) = 0;
+    virtual void ActiveTexture(GLenum unit) = 0;
+    virtual void BindTexture(GLenum target, GLuint texture) = 0;
+    virtual void BindBuffer(GLenum target, GLuint buffer) = 0;
+    virtual void BindBufferBase(GLenum target, GLuint index, GLuint buffer) = 0;
+    virtual void BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) = 0;
+
+    // fixed-function state
+    virtual void Enable(GLenum capability) = 0;
+    virtual void Disable(GLenum capability) = 0;
+    virtual void BlendFunc(GLenum source, GLenum destination) = 0;
+    virtual void DepthFunc(GLenum func) = 0;
+    virtual void DepthMask(GLboolean write) = 0;
+    virtual void CullFace(GLenum face) = 0;
+    virtual void Viewport(GLint x, GLint y, GLsizei width, GLsizei height) = 0;
+    virtual void ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) = 0;
+    virtual void Clear(GLbitfield mask) = 0;
+
+    // queries and reflection
+    virtual void GetIntegerv(GLenum pname, GLint* data) = 0;
+    virtual void GetProgramiv(GLuint program, GLenum pname, GLint* params) = 0;
+    virtual void GetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name) = 0;
+    virtual void GetActiveUniformBlockiv(GLuint program, GLuint index, GLenum pname, GLint* params) = 0;
+    virtual void GetActiveUniformBlockName(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLchar* name) = 0;
+    virtual GLint GetUniformLocation(GLuint program, const GLchar* name) = 0;
+
+    // uniforms (of the program in use)
+    virtual void UniformBlockBinding(GLuint program, GLuint blockIndex, GLuint binding) = 0;
+    virtual void Uniform1i(GLint location, GLint value) = 0;
+    virtual void Uniform1f(GLint location, GLfloat value) = 0;
+    virtual void Uniform4fv(GLint location, GLsizei count, const GLfloat* value) = 0;
+    virtual void UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) = 0;
+
+    // vertex arrays (attribute state belongs to the bound VAO)
+    virtual void EnableVertexAttribArray(GLuint index) = 0;
+    virtual void VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) = 0;
+    virtual void VertexAttribDivisor(GLuint index, GLuint divisor) = 0;
+
+    // objects
+    virtual void GenBuffers(GLsizei n, GLuint* buffers) = 0;
+    virtual void GenVertexArrays(GLsizei n, GLuint* vaos) = 0;
+    virtual void DeleteBuffers(GLsizei n, const GLuint* buffers) = 0;
+    virtual void DeleteVertexArrays(GLsizei n, const GLuint* vaos) = 0;
+    virtual void DeleteTextures(GLsizei n, const GLuint* textures) = 0;
+    virtual void DeleteProgram(GLuint program) = 0;
+    virtual void BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) = 0;
+    virtual void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) = 0;
+
+    // textures (the one bound to `target` on the active unit)
+    virtual void GenTextures(GLsizei n, GLuint* textures) = 0;
+    virtual void TexParameteri(GLenum target, GLenum pname, GLint param) = 0;
+    virtual void TexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels) = 0;
+    virtual void CompressedTexImage2D(GLenum target, GLint level, GLenum internalFormat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void* data) = 0;
+    // EXT_texture_compression_s3tc: whether CompressedTexImage2D takes BC1/BC3
+    virtual bool HasTextureCompressionS3tc() = 0;
+
+    // timer queries (GL_TIMESTAMP counters)
+    virtual void GenQueries(GLsizei n, GLuint* queries) = 0;
+    virtual void DeleteQueries(GLsizei n, const GLuint* queries) = 0;
+    virtual void QueryCounter(GLuint query, GLenum target) = 0;
+    virtual void GetQueryObjectiv(GLuint query, GLenum pname, GLint* params) = 0;
+    virtual void GetQueryObjectui64v(GLuint query, GLenum pname, GLuint64* params) = 0;
+
+    // draws
+    virtual void DrawArrays(GLenum mode, GLint first, GLsizei count) = 0;
+    virtual void DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) = 0;
+    virtual void DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount) = 0;
+    virtual void DrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount) = 0;
+    // GL 4.2 / ARB_base_instance; only call these when HasBaseInstance()
+    virtual bool HasBaseInstance() = 0;
+    virtual void DrawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount, GLuint baseInstance) = 0;
+    virtual void DrawElementsInstancedBaseInstance(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount, GLuint baseInstance) = 0;
+};
+
+class OpenGLBackend final : public GLBackend {
+public:
+    // The process-wide backend for the current context.
+    static OpenGLBackend& Instance();
+
+    // binds
+    void UseProgram(GLuint program) override;
+    void BindVertexArray(GLuint vao) override;
+    void ActiveTexture(GLenum unit) override;
+    void BindTexture(GLenum target, GLuint texture) override;
+    void BindBuffer(GLenum target, GLuint buffer) override;
+    void BindBufferBase(GLenum target, GLuint index, GLuint buffer) override;
+    void BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) override;
+
+    // fixed-function state
+    void Enable(GLenum capability) override;
+    void Disable(GLenum capability) override;
+    void BlendFunc(GLenum source, GLenum destination) override;
+    void DepthFunc(GLenum func) override;
+    void DepthMask(GLboolean write) override;
+    void CullFace(GLenum face) override;
+    void Viewport(GLint x, GLint y, GLsizei width, GLsizei height) override;
+    void ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) override;
+    void Clear(GLbitfield mask) override;
+
+    // queries and reflection
+    void GetIntegerv(GLenum pname, GLint* data) override;
+    void GetProgramiv(GLuint program, GLenum pname, GLint* params) override;
+    void GetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name) override;
+    void GetActiveUniformBlockiv(GLuint program, GLuint index, GLenum pname, GLint* params) override;
+    void GetActiveUniformBlockName(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLchar* name) override;
+    GLint GetUniformLocation(GLuint program, const GLchar* name) override;
+
+    // uniforms (of the program in use)
+    void UniformBlockBinding(GLuint program, GLuint blockIndex, GLuint binding) override;
+    void Uniform1i(GLint location, GLint value) override;
+    void Uniform1f(GLint location, GLfloat value) override;
+    void Uniform4fv(GLint location, GLsizei count, const GLfloat* value) override;
+    void UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) override;
+
+    // vertex arrays (attribute state belongs to the bound VAO)
+    void EnableVertexAttribArray(GLuint index) override;
+    void VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) override;
+    void VertexAttribDivisor(GLuint index, GLuint divisor) override;
+
+    // objects
+    void GenBuffers(GLsizei n, GLuint* buffers) override;
+    void GenVertexArrays(GLsizei n, GLuint* vaos) override;
+    void DeleteBuffers(GLsizei n, const GLuint* buffers) override;
+    void DeleteVertexArrays(GLsizei n, const GLuint* vaos) override;
+    void DeleteTextures(GLsizei n, const GLuint* textures) override;
+    void DeleteProgram(GLuint program) override;
+    void BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) override;
+    void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) override;
+
+    // textures (the one bound to `target` on the active unit)
+    void GenTextures(GLsizei n, GLuint* textures) override;
+    void TexParameteri(GLenum target, GLenum pname, GLint param) override;
+    void TexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels) override;
+    void CompressedTexImage2D(GLenum target, GLint level, GLenum internalFormat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void* data) override;
+    bool HasTextureCompressionS3tc() override;
+
+    // timer queries (GL_TIMESTAMP counters)
+    void GenQueries(GLsizei n, GLuint* queries) override;
+    void DeleteQueries(GLsizei n, const GLuint* queries) override;
+    void QueryCounter(GLuint query, GLenum target) override;
+    void GetQueryObjectiv(GLuint query, GLenum pname, GLint* params) override;
+    void GetQueryObjectui64v(GLuint query, GLenum pname, GLuint64* params) override;
+
+    // draws
+    void DrawArrays(GLenum mode, GLint first, GLsizei count) override;
+    void DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) override;
+    void DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount) override;
+    void DrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount) override;
+    bool HasBaseInstance() override;
+    void DrawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount, GLuint baseInstance) override;
+    void DrawElementsInstancedBaseInstance(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount, GLuint baseInstance) override;
+};
+
+// Accepts every call and does nothing. Gen* hand out increasing names and
+// uniform lookups fail (-1), so callers take their "no uniform" paths.
+class NullGLBackend final : public GLBackend {
+public:
+    void UseProgram(GLuint) override {}
+    void BindVertexArray(GLuint) override {}
+    void ActiveTexture(GLenum) override {}
+    void BindTexture(GLenum, GLuint) override {}
+    void BindBuffer(GLenum, GLuint) override {}
+    void BindBufferBase(GLenum, GLuint, GLuint) override {}
+    void BindBufferRange(GLenum, GLuint, GLuint, GLintptr, GLsizeiptr) override {}
+
+    void Enable(GLenum) override {}
+    void Disable(GLenum) override {}
+    void BlendFunc(GLenum, GLenum) override {}
+    void DepthFunc(GLenum) override {}
+    void DepthMask(GLboolean) override {}
+    void CullFace(GLenum) override {}
+    void Viewport(GLint, GLint, GLsizei, GLsizei) override {}
+    void ClearColor(GLfloat, GLfloat, GLfloat, GLfloat) override {}
+    void Clear(GLbitfield) override {}
+
+    void GetIntegerv(GLenum, GLint* data) override { *data = 0; }
+    void GetProgramiv(GLuint, GLenum, GLint* params) override { *params = 0; }
+    void GetActiveUniform(GLuint, GLuint, GLsizei, GLsizei* length, GLint* size, GLenum* type, GLchar* name) override {
+        if (length) *length = 0;
+        *size = 0;
+        *type = 0;
+        name[0] = '\0';
+    }
+    void GetActiveUniformBlockiv(GLuint, GLuint, GLenum, GLint* params) override { *params = 0; }
+    void GetActiveUniformBlockName(GLuint, GLuint, GLsizei, GLsizei* length, GLchar* name) override {
+        if (length) *length = 0;
+        name[0] = '\0';
+    }
+    GLint GetUniformLocation(GLuint, const GLchar*) override { return -1; }
+
+    void UniformBlockBinding(GLuint, GLuint, GLuint) override {}
+    void Uniform1i(GLint, GLint) override {}
+    void Uniform1f(GLint, GLfloat) override {}
+    void Uniform4fv(GLint, GLsizei, const GLfloat*) override {}
+    void UniformMatrix4fv(GLint, GLsizei, GLboolean, const GLfloat*) override {}
+
+    void EnableVertexAttribArray(GLuint) override {}
+    void VertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*) override {}
+    void VertexAttribDivisor(GLuint, GLuint) override {}
+
+    void GenBuffers(GLsizei n, GLuint* buffers) override { for (GLsizei i = 0; i < n; ++i) buffers[i] = nextName++; }
+    void GenVertexArrays(GLsizei n, GLuint* vaos) override { for (GLsizei i = 0; i < n; ++i) vaos[i] = nextName++; }
+    void DeleteBuffers(GLsizei, const GLuint*) override {}
+    void DeleteVertexArrays(GLsizei, const GLuint*) override {}
+    void DeleteTextures(GLsizei, const GLuint*) override {}
+    void DeleteProgram(GLuint) override {}
+    void BufferData(GLenum, GLsizeiptr, const void*, GLenum) override {}
+    void BufferSubData(GLenum, GLintptr, GLsizeiptr, const void*) override {}
+
+    void GenTextures(GLsizei n, GLuint* textures) override { for (GLsizei i = 0; i < n; ++i) textures[i] = nextName++; }
+    void TexParameteri(GLenum, GLenum, GLint) override {}
+    void TexImage2D(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const void*) override {}
+    void CompressedTexImage2D(GLenum, GLint, GLenum, GLsizei, GLsizei, GLint, GLsizei, const void*) override {}
+    bool HasTextureCompressionS3tc() override { return true; } // accepts every upload
+
+    void GenQueries(GLsizei n, GLuint* queries) override { for (GLsizei i = 0; i < n; ++i) queries[i] = nextName++; }
+    void DeleteQueries(GLsizei, const GLuint*) override {}
+    void QueryCounter(GLuint, GLenum) override {}
+    void GetQueryObjectiv(GLuint, GLenum, GLint* params) override { *params = 0; }
+    void GetQueryObjectui64v(GLuint, GLenum, GLuint64* params) override { *params = 0; }
+
+    void DrawArrays(GLenum, GLint, GLsizei) override {}
+    void DrawElements(GLenum, GLsizei, GLenum, const void*) override {}
+    void DrawArraysInstanced(GLenum, GLint, GLsizei, GLsizei) override {}
+    void DrawElementsInstanced(GLenum, GLsizei, GLenum, const void*, GLsizei) override {}
+    bool HasBaseInstance() override { return false; }
+    void DrawArraysInstancedBaseInstance(GLenum, GLint, GLsizei, GLsizei, GLuint) override {}
+    void DrawElementsInstancedBaseInstance(GLenum, GLsizei, GLenum, const void*, GLsizei, GLuint) override {}
+
+private:
+    GLuint nextName = 1;
+};
@@ -0,0 +1,409 @@
+#include "GLContext.hpp"
+#include <limits>
+
+namespace {
+
+int TextureSlot(GLenum target) {
+    switch (target) {
+    case GL_TEXTURE_2D: return 0;
+    case GL_TEXTURE_CUBE_MAP: return 1;
+    default: return -1;
+    }
+}
+
+int BufferSlot(GLenum target) {
+    switch (target) {
+    case GL_ARRAY_BUFFER: return 0;
+    case GL_UNIFORM_BUFFER: return 1;
+    case GL_COPY_READ_BUFFER: return 2;
+    case GL_COPY_WRITE_BUFFER: return 3;
+    default: return -1;
+    }
+}
+
+int CapabilitySlot(GLenum capability) {
+    switch (capability) {
+    case GL_BLEND: return 0;
+    case GL_DEPTH_TEST: return 1;
+    case GL_CULL_FACE: return 2;
+    case GL_SCISSOR_TEST: return 3;
+    case GL_STENCIL_TEST: return 4;
+    case GL_POLYGON_OFFSET_FILL: return 5;
+    default: return -1;
+    }
+}
+
+}
+
+GLContext::GLContext(GLBackend& backend) : backend(backend) {
+    Invalidate();
+}
+
+GLContext& GLContext::Instance() {
+    static GLContext context(OpenGLBackend::Instance());
+    return context;
+}
+
+void GLContext::Invalidate() {
+    program = vao = activeUnit = Unknown;
+    for (auto& unit : textures) unit.fill(Unknown);
+    buffers.fill(Unknown);
+    uniformBindings.fill({ Unknown, 0, 0 });
+    capabilities.fill(-1);
+    blendSource = blendDestination = depthFunc = cullFace = Unknown;
+    depthMask = -1;
+    viewport = { 0, 0, -1, -1 };
+    clearColor.fill(std::numeric_limits<GLfloat>::quiet_NaN());
+    vertexArrays.clear();
+}
+
+void GLContext::BeginFrame() {
+    lastFrame = frame;
+    frame = {};
+}
+
+GLContext::VertexArrayState* GLContext::CurrentVertexArray() {
+    return vao == Unknown ? nullptr : &vertexArrays[vao];
+}
+
+void GLContext::UseProgram(GLuint value) {
+    if (Redundant(program == value)) return;
+    program = value;
+    backend.UseProgram(value);
+}
+
+void GLContext::BindVertexArray(GLuint value) {
+    if (Redundant(vao == value)) return;
+    vao = value;
+    backend.BindVertexArray(value);
+}
+
+void GLContext::ActiveTexture(GLenum unit) {
+    const GLuint index = unit - GL_TEXTURE0;
+    if (Redundant(activeUnit == index)) return;
+    activeUnit = index < MaxTextureUnits ? index : Unknown;
+    backend.ActiveTexture(unit);
+}
+
+void GLContext::BindTexture(GLenum target, GLuint texture) {
+    const int slot = TextureSlot(target);
+    GLuint* bound = slot >= 0 && activeUnit != Unknown ? &textures[activeUnit][slot] : nullptr;
+    if (Redundant(bound && *bound == texture)) return;
+    if (bound) *bound = texture;
+    backend.BindTexture(target, texture);
+}
+
+void GLContext::BindBuffer(GLenum target, GLuint buffer) {
+    const int slot = BufferSlot(target);
+    if (Redundant(slot >= 0 && buffers[slot] == buffer)) return;
+    if (slot >= 0) buffers[slot] = buffer;
+    backend.BindBuffer(target, buffer);
+}
+
+// Indexed binds also set the generic binding of the target.
+void GLContext::BindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    BindBufferRange(target, index, buffer, 0, -1);
+}
+
+void GLContext::BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    const bool tracked = target == GL_UNIFORM_BUFFER && index < MaxUniformBindings;
+    const BufferRange range{ buffer, offset, size };
+    if (Redundant(tracked && uniformBindings[index] == range)) return;
+    if (tracked) uniformBindings[index] = range;
+    if (target == GL_UNIFORM_BUFFER) buffers[BufferSlot(target)] = buffer;
+    if (size < 0)
+        backend.BindBufferBase(target, index, buffer);
+    else
+        backend.BindBufferRange(target, index, buffer, offset, size);
+}
+
+void GLContext::Enable(GLenum capability) {
+    const int slot = CapabilitySlot(capability);
+    if (Redundant(slot >= 0 && capabilities[slot] == 1)) return;
+    if (slot >= 0) capabilities[slot] = 1;
+    backend.Enable(capability);
+}
+
+void GLContext::Disable(GLenum capability) {
+    const int slot = CapabilitySlot(capability);
+    if (Redundant(slot >= 0 && capabilities[slot] == 0)) return;
+    if (slot >= 0) capabilities[slot] = 0;
+    backend.Disable(capability);
+}
+
+void GLContext::BlendFunc(GLenum source, GLenum destination) {
+    if (Redundant(blendSource == source && blendDestination == destination)) return;
+    blendSource = source;
+    blendDestination = destination;
+    backend.BlendFunc(source, destination);
+}
+
+void GLContext::DepthFunc(GLenum func) {
+    if (Redundant(depthFunc == func)) return;
+    depthFunc = func;
+    backend.DepthFunc(func);
+}
+
+void GLContext::DepthMask(GLboolean write) {
+    const int8_t value = write ? 1 : 0;
+    if (Redundant(depthMask == value)) return;
+    depthMask = value;
+    backend.DepthMask(write);
+}
+
+void GLContext::CullFace(GLenum face) {
+    if (Redundant(cullFace == face)) return;
+    cullFace = face;
+    backend.CullFace(face);
+}
+
+void GLContext::Viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    const std::array<GLint, 4> value = { x, y, width, height };
+    if (Redundant(viewport == value)) return;
+    viewport = value;
+    backend.Viewport(x, y, width, height);
+}
+
+void GLContext::ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+    const std::array<GLfloat, 4> value = { r, g, b, a };
+    if (Redundant(clearColor == value)) return;
+    clearColor = value;
+    backend.ClearColor(r, g, b, a);
+}
+
+void GLContext::Clear(GLbitfield mask) {
+    ++frame.issued;
+    backend.Clear(mask);
+}
+
+void GLContext::GetIntegerv(GLenum pname, GLint* data) {
+    ++frame.issued;
+    backend.GetIntegerv(pname, data);
+}
+
+void GLContext::GetProgramiv(GLuint programName, GLenum pname, GLint* params) {
+    ++frame.issued;
+    backend.GetProgramiv(programName, pname, params);
+}
+
+void GLContext::GetActiveUniform(GLuint programName, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name) {
+    ++frame.issued;
+    backend.GetActiveUniform(programName, index, bufSize, length, size, type, name);
+}
+
+void GLContext::GetActiveUniformBlockiv(GLuint programName, GLuint index, GLenum pname, GLint* params) {
+    ++frame.issued;
+    backend.GetActiveUniformBlockiv(programName, index, pname, params);
+}
+
+void GLContext::GetActiveUniformBlockName(GLuint programName, GLuint index, GLsizei bufSize, GLsizei* length, GLchar* name) {
+    ++frame.issued;
+    backend.GetActiveUniformBlockName(programName, index, bufSize, length, name);
+}
+
+GLint GLContext::GetUniformLocation(GLuint programName, const GLchar* name) {
+    ++frame.issued;
+    return backend.GetUniformLocation(programName, name);
+}
+
+void GLContext::UniformBlockBinding(GLuint programName, GLuint blockIndex, GLuint binding) {
+    ++frame.issued;
+    backend.UniformBlockBinding(programName, blockIndex, binding);
+}
+
+void GLContext::Uniform1i(GLint location, GLint value) {
+    ++frame.issued;
+    backend.Uniform1i(location, value);
+}
+
+void GLContext::Uniform1f(GLint location, GLfloat value) {
+    ++frame.issued;
+    backend.Uniform1f(location, value);
+}
+
+void GLContext::Uniform4fv(GLint location, GLsizei count, const GLfloat* value) {
+    ++frame.issued;
+    backend.Uniform4fv(location, count, value);
+}
+
+void GLContext::UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    ++frame.issued;
+    backend.UniformMatrix4fv(location, count, transpose, value);
+}
+
+void GLContext::EnableVertexAttribArray(GLuint index) {
+    VertexArrayState* state = index < MaxVertexAttribs ? CurrentVertexArray() : nullptr;
+    const uint32_t bit = 1u << (index % MaxVertexAttribs);
+    if (Redundant(state && (state->enabledKnown & state->enabled & bit))) return;
+    if (state) {
+        state->enabled |= bit;
+        state->enabledKnown |= bit;
+    }
+    backend.EnableVertexAttribArray(index);
+}
+
+// The attribute captures the buffer bound to GL_ARRAY_BUFFER, so a call is
+// only redundant when that binding is known and the same as before.
+void GLContext::VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) {
+    VertexArrayState* state = index < MaxVertexAttribs && buffers[0] != Unknown ? CurrentVertexArray() : nullptr;
+    const uint32_t bit = 1u << (index % MaxVertexAttribs);
+    const AttribPointer source{ buffers[0], size, type, normalized, stride, pointer };
+    if (Redundant(state && (state->pointerKnown & bit) && state->pointers[index] == source)) return;
+    if (state) {
+        state->pointers[index] = source;
+        state->pointerKnown |= bit;
+    }
+    backend.VertexAttribPointer(index, size, type, normalized, stride, pointer);
+}
+
+void GLContext::VertexAttribDivisor(GLuint index, GLuint divisor) {
+    VertexArrayState* state = index < MaxVertexAttribs ? CurrentVertexArray() : nullptr;
+    const uint32_t bit = 1u << (index % MaxVertexAttribs);
+    if (Redundant(state && (state->divisorKnown & bit) && state->divisors[index] == divisor)) return;
+    if (state) {
+        state->divisors[index] = divisor;
+        state->divisorKnown |= bit;
+    }
+    backend.VertexAttribDivisor(index, divisor);
+}
+
+void GLContext::GenBuffers(GLsizei n, GLuint* names) {
+    ++frame.issued;
+    backend.GenBuffers(n, names);
+}
+
+// A new VAO has every attribute disabled with divisor 0, so its shadow
+// starts out fully known, except for the attribute pointers.
+void GLContext::GenVertexArrays(GLsizei n, GLuint* vaos) {
+    ++frame.issued;
+    backend.GenVertexArrays(n, vaos);
+    for (GLsizei i = 0; i < n; ++i) vertexArrays[vaos[i]] = { 0, ~0u, ~0u, 0, {}, {} };
+}
+
+// Deleting a bound object reverts that binding to 0; names may be reused.
+void GLContext::DeleteBuffers(GLsizei n, const GLuint* names) {
+    ++frame.issued;
+    for (GLsizei i = 0; i < n; ++i) {
+        for (GLuint& bound : buffers)
+            if (bound == names[i]) bound = 0;
+        for (BufferRange& range : uniformBindings)
+            if (range.buffer == names[i]) range = { 0, 0, -1 };
+    }
+    backend.DeleteBuffers(n, names);
+}
+
+void GLContext::DeleteVertexArrays(GLsizei n, const GLuint* vaos) {
+    ++frame.issued;
+    for (GLsizei i = 0; i < n; ++i) {
+        vertexArrays.erase(vaos[i]);
+        if (vao == vaos[i]) vao = 0;
+    }
+    backend.DeleteVertexArrays(n, vaos);
+}
+
+void GLContext::DeleteTextures(GLsizei n, const GLuint* names) {
+    ++frame.issued;
+    for (GLsizei i = 0; i < n; ++i)
+        for (auto& unit : textures)
+            for (GLuint& bound : unit)
+                if (bound == names[i]) bound = 0;
+    backend.DeleteTextures(n, names);
+}
+
+// A deleted program stays current until another one is used, so the
+// binding is kept.
+void GLContext::DeleteProgram(GLuint programName) {
+    ++frame.issued;
+    backend.DeleteProgram(programName);
+}
+
+void GLContext::BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+    ++frame.issued;
+    backend.BufferData(target, size, data, usage);
+}
+
+void GLContext::BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+    ++frame.issued;
+    backend.BufferSubData(target, offset, size, data);
+}
+
+void GLContext::GenTextures(GLsizei n, GLuint* names) {
+    ++frame.issued;
+    backend.GenTextures(n, names);
+}
+
+void GLContext::TexParameteri(GLenum target, GLenum pname, GLint param) {
+    ++frame.issued;
+    backend.TexParameteri(target, pname, param);
+}
+
+void GLContext::TexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border,
+                           GLenum format, GLenum type, const void* pixels) {
+    ++frame.issued;
+    backend.TexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+}
+
+void GLContext::CompressedTexImage2D(GLenum target, GLint level, GLenum internalFormat, GLsizei width, GLsizei height,
+                                     GLint border, GLsizei imageSize, const void* data) {
+    ++frame.issued;
+    backend.CompressedTexImage2D(target, level, internalFormat, width, height, border, imageSize, data);
+}
+
+bool GLContext::HasTextureCompressionS3tc() { return backend.HasTextureCompressionS3tc(); }
+
+void GLContext::GenQueries(GLsizei n, GLuint* queries) {
+    ++frame.issued;
+    backend.GenQueries(n, queries);
+}
+
+void GLContext::DeleteQueries(GLsizei n, const GLuint* queries) {
+    ++frame.issued;
+    backend.DeleteQueries(n, queries);
+}
+
+void GLContext::QueryCounter(GLuint query, GLenum target) {
+    ++frame.issued;
+    backend.QueryCounter(query, target);
+}
+
+void GLContext::GetQueryObjectiv(GLuint query, GLenum pname, GLint* params) {
+    ++frame.issued;
+    backend.GetQueryObjectiv(query, pname, params);
+}
+
+void GLContext::GetQueryObjectui64v(GLuint query, GLenum pname, GLuint64* params) {
+    ++frame.issued;
+    backend.GetQueryObjectui64v(query, pname, params);
+}
+
+void GLContext::DrawArrays(GLenum mode, GLint first, GLsizei count) {
+    ++frame.issued;
+    backend.DrawArrays(mode, first, count);
+}
+
+void GLContext::DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) {
+    ++frame.issued;
+    backend.DrawElements(mode, count, type, indices);
+}
+
+void GLContext::DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount) {
+    ++frame.issued;
+    backend.DrawArraysInstanced(mode, first, count, instanceCount);
+}
+
+void GLContext::DrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount) {
+    ++frame.issued;
+    backend.DrawElementsInstanced(mode, count, type, indices, instanceCount);
+}
+
+bool GLContext::HasBaseInstance() { return backend.HasBaseInstance(); }
+
+void GLContext::DrawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount, GLuint baseInstance) {
+    ++frame.issued;
+    backend.DrawArraysInstancedBaseInstance(mode, first, count, instanceCount, baseInstance);
+}
+
+void GLContext::DrawElementsInstancedBaseInstance(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount, GLuint baseInstance) {
+    ++frame.issued;
+    backend.DrawElementsInstancedBaseInstance(mode, count, type, indices, instanceCount, baseInstance);
+}
@@ -0,0 +1,177 @@
+/* Redundant-state filter in front of a GLBackend.
+
+   GLContext keeps a shadow of the state the engine sets: bound program,
+   VAO, buffers, uniform buffer ranges, textures per unit, blend/depth/cull state, viewport, clear
+   color and the enabled attributes, divisors and attribute pointers of
+   each VAO. A call that would
+   not change anything is dropped before it reaches the driver; everything
+   else is forwarded. Calls are counted per frame as issued or skipped.
+
+   Objects and state it does not track (element buffers, which belong to
+   the VAO, other texture targets, other capabilities) are passed straight
+   through. The shadow starts out unknown, so the first call of each kind is
+   always issued; call Invalidate() after foreign code touched GL directly.
+
+example usage:
+
+GLContext& gl = GLContext::Instance();
+gl.BeginFrame();
+gl.UseProgram(program);
+gl.UseProgram(program);   // skipped
+const GLCallStats& stats = gl.GetFrameStats(); // issued 1, skipped 1 */
+#pragma once
+#include "GLBackend.hpp"
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+
+struct GLCallStats {
+    uint32_t issued = 0;   // forwarded to the backend
+    uint32_t skipped = 0;  // dropped: the shadow already had that state
+};
+
+class GLContext final : public GLBackend {
+public:
+    static constexpr GLuint MaxTextureUnits = 32;
+    static constexpr GLuint MaxVertexAttribs = 16;
+    static constexpr GLuint MaxUniformBindings = 16;
+
+    explicit GLContext(GLBackend& backend);
+
+    // Wraps OpenGLBackend::Instance(); what engine code draws through by default.
+    static GLContext& Instance();
+
+    // Forgets all shadowed state.
+    void Invalidate();
+
+    // Starts a new set of per-frame counters; the finished frame's are kept.
+    void BeginFrame();
+    const GLCallStats& GetFrameStats() const { return frame; }
+    const GLCallStats& GetLastFrameStats() const { return lastFrame; }
+
+    void UseProgram(GLuint program) override;
+    void BindVertexArray(GLuint vao) override;
+    void ActiveTexture(GLenum unit) override;
+    void BindTexture(GLenum target, GLuint texture) override;
+    void BindBuffer(GLenum target, GLuint buffer) override;
+    void BindBufferBase(GLenum target, GLuint index, GLuint buffer) override;
+    void BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) override;
+
+    void Enable(GLenum capability) override;
+    void Disable(GLenum capability) override;
+    void BlendFunc(GLenum source, GLenum destination) override;
+    void DepthFunc(GLenum func) override;
+    void DepthMask(GLboolean write) override;
+    void CullFace(GLenum face) override;
+    void Viewport(GLint x, GLint y, GLsizei width, GLsizei height) override;
+    void ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) override;
+    void Clear(GLbitfield mask) override;
+
+    void GetIntegerv(GLenum pname, GLint* data) override;
+    void GetProgramiv(GLuint program, GLenum pname, GLint* params) override;
+    void GetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name) override;
+    void GetActiveUniformBlockiv(GLuint program, GLuint index, GLenum pname, GLint* params) override;
+    void GetActiveUniformBlockName(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLchar* name) override;
+    GLint GetUniformLocation(GLuint program, const GLchar* name) override;
+
+    void UniformBlockBinding(GLuint program, GLuint blockIndex, GLuint binding) override;
+    void Uniform1i(GLint location, GLint value) override;
+    void Uniform1f(GLint location, GLfloat value) override;
+    void Uniform4fv(GLint location, GLsizei count, const GLfloat* value) override;
+    void UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) override;
+
+    void EnableVertexAttribArray(GLuint index) override;
+    void VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) override;
+    void VertexAttribDivisor(GLuint index, GLuint divisor) override;
+
+    void GenBuffers(GLsizei n, GLuint* buffers) override;
+    void GenVertexArrays(GLsizei n, GLuint* vaos) override;
+    void DeleteBuffers(GLsizei n, const GLuint* buffers) override;
+    void DeleteVertexArrays(GLsizei n, const GLuint* vaos) override;
+    void DeleteTextures(GLsizei n, const GLuint* textures) override;
+    void DeleteProgram(GLuint program) override;
+    void BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) override;
+    void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) override;
+
+    // textures (the one bound to `target` on the active unit)
+    void GenTextures(GLsizei n, GLuint* textures) override;
+    void TexParameteri(GLenum target, GLenum pname, GLint param) override;
+    void TexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels) override;
+    void CompressedTexImage2D(GLenum target, GLint level, GLenum internalFormat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void* data) override;
+    bool HasTextureCompressionS3tc() override;
+
+    // timer queries
+    void GenQueries(GLsizei n, GLuint* queries) override;
+    void DeleteQueries(GLsizei n, const GLuint* queries) override;
+    void QueryCounter(GLuint query, GLenum target) override;
+    void GetQueryObjectiv(GLuint query, GLenum pname, GLint* params) override;
+    void GetQueryObjectui64v(GLuint query, GLenum pname, GLuint64* params) override;
+
+    void DrawArrays(GLenum mode, GLint first, GLsizei count) override;
+    void DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) override;
+    void DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount) override;
+    void DrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount) override;
+    bool HasBaseInstance() override;
+    void DrawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount, GLuint baseInstance) override;
+    void DrawElementsInstancedBaseInstance(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount, GLuint baseInstance) override;
+
+private:
+    static constexpr GLuint Unknown = 0xFFFFFFFFu;
+
+    // Counts the call and returns true when it is redundant.
+    bool Redundant(bool sameState) {
+        sameState ? ++frame.skipped : ++frame.issued;
+        return sameState;
+    }
+
+    // Source of one vertex attribute, as set by VertexAttribPointer.
+    struct AttribPointer {
+        GLuint buffer;
+        GLint size;
+        GLenum type;
+        GLboolean normalized;
+        GLsizei stride;
+        const void* pointer;
+
+        bool operator==(const AttribPointer&) const = default;
+    };
+
+    // Attribute state of one VAO; bits of `known*` say which entries are valid.
+    struct VertexArrayState {
+        uint32_t enabled = 0;
+        uint32_t enabledKnown = 0;
+        uint32_t divisorKnown = 0;
+        uint32_t pointerKnown = 0;
+        std::array<GLuint, MaxVertexAttribs> divisors{};
+        std::array<AttribPointer, MaxVertexAttribs> pointers{};
+    };
+    VertexArrayState* CurrentVertexArray();
+
+    // Indexed GL_UNIFORM_BUFFER binding; size -1 for a whole-buffer BindBufferBase.
+    struct BufferRange {
+        GLuint buffer;
+        GLintptr offset;
+        GLsizeiptr size;
+
+        bool operator==(const BufferRange&) const = default;
+    };
+
+    GLBackend& backend;
+    GLCallStats frame;
+    GLCallStats lastFrame;
+
+    GLuint program = Unknown;
+    GLuint vao = Unknown;
+    GLuint activeUnit = Unknown;                                   // index, not GL_TEXTUREi
+    std::array<std::array<GLuint, 2>, MaxTextureUnits> textures;   // 2D, cube map
+    std::array<GLuint, 4> buffers;                                 // array, uniform, copy read, copy write
+    std::array<BufferRange, MaxUniformBindings> uniformBindings;
+    std::array<int8_t, 6> capabilities;                            // -1 unknown, 0 off, 1 on
+    GLenum blendSource = Unknown, blendDestination = Unknown;
+    GLenum depthFunc = Unknown;
+    int8_t depthMask = -1;
+    GLenum cullFace = Unknown;
+    std::array<GLint, 4> viewport;
+    std::array<GLfloat, 4> clearColor;                             // NaN when unknown: never equal
+    std::unordered_map<GLuint, VertexArrayState> vertexArrays;
+};
@@ -0,0 +1,68 @@
+#include "GLExtensions.hpp"
+#include <cstring>
+
+namespace glext {
+
+GetProgramBinaryFn GetProgramBinary = nullptr;
+ProgramBinaryFn ProgramBinary = nullptr;
+ProgramParameteriFn ProgramParameteri = nullptr;
+MaxShaderCompilerThreadsFn MaxShaderCompilerThreads = nullptr;
+DrawArraysInstancedBaseInstanceFn DrawArraysInstancedBaseInstance = nullptr;
+DrawElementsInstancedBaseInstanceFn DrawElementsInstancedBaseInstance = nullptr;
+
+namespace {
+bool programBinaryFormats = false;
+bool textureCompressionS3tc = false;
+bool baseInstance = false;
+
+bool HasExtension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const GLubyte* extension = glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i));
+        if (extension && std::strcmp(reinterpret_cast<const char*>(extension), name) == 0) return true;
+    }
+    return false;
+}
+
+bool HasVersion(GLint major, GLint minor) {
+    GLint contextMajor = 0, contextMinor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &contextMajor);
+    glGetIntegerv(GL_MINOR_VERSION, &contextMinor);
+    return contextMajor > major || (contextMajor == major && contextMinor >= minor);
+}
+
+}
+
+void Load(GLADloadfunc load) {
+    GetProgramBinary = reinterpret_cast<GetProgramBinaryFn>(load("glGetProgramBinary"));
+    ProgramBinary = reinterpret_cast<ProgramBinaryFn>(load("glProgramBinary"));
+    ProgramParameteri = reinterpret_cast<ProgramParameteriFn>(load("glProgramParameteri"));
+
+    GLint formats = 0;
+    if (GetProgramBinary && ProgramBinary && ProgramParameteri)
+        glGetIntegerv(NUM_PROGRAM_BINARY_FORMATS, &formats);
+    programBinaryFormats = formats > 0;
+
+    MaxShaderCompilerThreads = nullptr;
+    if (HasExtension("GL_KHR_parallel_shader_compile"))
+        MaxShaderCompilerThreads = reinterpret_cast<MaxShaderCompilerThreadsFn>(load("glMaxShaderCompilerThreadsKHR"));
+    else if (HasExtension("GL_ARB_parallel_shader_compile"))
+        MaxShaderCompilerThreads = reinterpret_cast<MaxShaderCompilerThreadsFn>(load("glMaxShaderCompilerThreadsARB"));
+    if (MaxShaderCompilerThreads) MaxShaderCompilerThreads(0xFFFFFFFFu); // implementation-chosen
+
+    textureCompressionS3tc = HasExtension("GL_EXT_texture_compression_s3tc");
+
+    // the loader may hand out entry points the context does not support
+    DrawArraysInstancedBaseInstance = reinterpret_cast<DrawArraysInstancedBaseInstanceFn>(load("glDrawArraysInstancedBaseInstance"));
+    DrawElementsInstancedBaseInstance = reinterpret_cast<DrawElementsInstancedBaseInstanceFn>(load("glDrawElementsInstancedBaseInstance"));
+    baseInstance = DrawArraysInstancedBaseInstance && DrawElementsInstancedBaseInstance
+        && (HasVersion(4, 2) || HasExtension("GL_ARB_base_instance"));
+}
+
+bool HasProgramBinary() { return programBinaryFormats; }
+bool HasParallelShaderCompile() { return MaxShaderCompilerThreads != nullptr; }
+bool HasTextureCompressionS3tc() { return textureCompressionS3tc; }
+bool HasBaseInstance() { return baseInstance; }
+
+}
@@ -0,0 +1,60 @@
+/* Entry points newer than the GL 3.3 core profile glad was generated for.
+   They are looked up at runtime with the same loader glad used and stay
+   null when the driver does not have them, so callers check Has*() first.
+
+   Call glext::Load(glfwGetProcAddress) right after gladLoadGL. */
+#pragma once
+#include <glad/gl.h>
+
+namespace glext {
+
+// GL 4.1 / ARB_get_program_binary
+constexpr GLenum PROGRAM_BINARY_RETRIEVABLE_HINT = 0x8257;
+constexpr GLenum PROGRAM_BINARY_LENGTH = 0x8741;
+constexpr GLenum NUM_PROGRAM_BINARY_FORMATS = 0x87FE;
+
+using GetProgramBinaryFn = void (GLAD_API_PTR*)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+using ProgramBinaryFn = void (GLAD_API_PTR*)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+using ProgramParameteriFn = void (GLAD_API_PTR*)(GLuint program, GLenum pname, GLint value);
+
+// KHR_parallel_shader_compile (or the ARB version, same enum)
+constexpr GLenum COMPLETION_STATUS = 0x91B1;
+
+using MaxShaderCompilerThreadsFn = void (GLAD_API_PTR*)(GLuint count);
+
+// EXT_texture_compression_s3tc (BC1/BC3), sRGB forms from EXT_texture_sRGB.
+// Uploaded with the core glCompressedTexImage2D, so there are no entry points.
+constexpr GLenum COMPRESSED_RGB_S3TC_DXT1 = 0x83F0;
+constexpr GLenum COMPRESSED_RGBA_S3TC_DXT5 = 0x83F3;
+constexpr GLenum COMPRESSED_SRGB_S3TC_DXT1 = 0x8C4C;
+constexpr GLenum COMPRESSED_SRGB_ALPHA_S3TC_DXT5 = 0x8C4F;
+
+// GL 4.2 / ARB_base_instance
+using DrawArraysInstancedBaseInstanceFn = void (GLAD_API_PTR*)(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount, GLuint baseInstance);
+using DrawElementsInstancedBaseInstanceFn = void (GLAD_API_PTR*)(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount, GLuint baseInstance);
+
+extern GetProgramBinaryFn GetProgramBinary;
+extern ProgramBinaryFn ProgramBinary;
+extern ProgramParameteriFn ProgramParameteri;
+extern MaxShaderCompilerThreadsFn MaxShaderCompilerThreads;
+extern DrawArraysInstancedBaseInstanceFn DrawArraysInstancedBaseInstance;
+extern DrawElementsInstancedBaseInstanceFn DrawElementsInstancedBaseInstance;
+
+void Load(GLADloadfunc load);
+
+// True when the entry points exist and the driver offers at least one format.
+bool HasProgramBinary();
+
+// True when compiles and links run on driver threads and COMPLETION_STATUS
+// can be polled without blocking. Load() lets the driver pick the thread count.
+bool HasParallelShaderCompile();
+
+// True when the driver accepts the S3TC formats above.
+bool HasTextureCompressionS3tc();
+
+// True when instanced draws can start at a base instance, so per-instance
+// attributes need not be re-pointed for every draw: the context is GL 4.2
+// or has ARB_base_instance, and both entry points were found.
+bool HasBaseInstance();
+
+}
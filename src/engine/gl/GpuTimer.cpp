@@ -0,0 +1,85 @@
+#include "GpuTimer.hpp"
+
+bool GpuTimer::Supported() {
+    return GLAD_GL_VERSION_3_3 != 0;
+}
+
+uint32_t GpuTimer::Timestamp(GLBackend& gl) {
+    Frame& frame = frames[current];
+    if (frame.used == frame.queries.size()) {
+        const std::size_t grown = frame.queries.empty() ? 16 : frame.queries.size() * 2;
+        const std::size_t added = grown - frame.queries.size();
+        frame.queries.resize(grown);
+        gl.GenQueries(static_cast<GLsizei>(added), frame.queries.data() + grown - added);
+    }
+    gl.QueryCounter(frame.queries[frame.used], GL_TIMESTAMP);
+    return frame.used++;
+}
+
+void GpuTimer::Begin(GLBackend& gl, const char* name) {
+    if (!enabled) return;
+    Frame& frame = frames[current];
+    if (frame.used == 0) frame.cpuStartNs = Profiler::Instance().NowNs();
+    open.push_back(static_cast<uint32_t>(frame.spans.size()));
+    frame.spans.push_back({ name, Timestamp(gl), 0 });
+}
+
+void GpuTimer::End(GLBackend& gl) {
+    if (!enabled || open.empty()) return;
+    const uint32_t span = open.back();
+    open.pop_back();
+    frames[current].spans[span].end = Timestamp(gl);
+}
+
+// Nothing is read until the frame's last query has landed; the earlier ones
+// were issued before it and are then available too.
+bool GpuTimer::Read(GLBackend& gl, Frame& frame) {
+    GLint available = GL_FALSE;
+    gl.GetQueryObjectiv(frame.queries[frame.used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return false;
+
+    results.resize(frame.used);
+    for (uint32_t i = 0; i < frame.used; ++i) gl.GetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &results[i]);
+
+    Profiler& profiler = Profiler::Instance();
+    const GLuint64 base = results[0];
+    for (const Span& span : frame.spans) {
+        profiler.AddTrackEvent("GPU", span.name,
+                               frame.cpuStartNs + static_cast<int64_t>(results[span.begin] - base),
+                               frame.cpuStartNs + static_cast<int64_t>(results[span.end] - base));
+    }
+    return true;
+}
+
+void GpuTimer::Collect(GLBackend& gl) {
+    if (!enabled) return;
+    // spans still open at the end of the frame are closed here
+    while (!open.empty()) End(gl);
+
+    frames[current].pending = frames[current].used > 0;
+    current = (current + 1) % FramesInFlight;
+
+    for (std::size_t age = 0; age < FramesInFlight; ++age) {
+        Frame& frame = frames[(current + age) % FramesInFlight];
+        if (!frame.pending) continue;
+        if (!Read(gl, frame)) {
+            if (age > 0) break;  // later frames cannot be done either
+            ++droppedFrames;     // its slot is needed now
+        }
+        frame.pending = false;
+        frame.used = 0;
+        frame.spans.clear();
+    }
+
+    Frame& next = frames[current];
+    next.used = 0;
+    next.spans.clear();
+}
+
+void GpuTimer::Release(GLBackend& gl) {
+    for (Frame& frame : frames) {
+        if (!frame.queries.empty()) gl.DeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+        frame = Frame{};
+    }
+    open.clear();
+}
@@ -0,0 +1,100 @@
+/* GPU times for the profiler, from GL_TIMESTAMP timer queries.
+
+   Begin / End put a timestamp query into the command stream on each side of
+   the GPU work issued in between. Results are read FramesInFlight frames
+   later, when the GPU is done with them, so reading never stalls the CPU;
+   a frame whose queries are still pending when its slot comes round again
+   is dropped instead. Collect() hands every finished span to the Profiler
+   as an event on the "GPU" track. GPU and CPU clocks are not related by
+   GL 3.3, so each frame's spans are placed on the trace relative to the CPU
+   time its first Begin was issued at: durations are exact, start times
+   approximate.
+
+   Disabled by default; a disabled timer issues no GL calls. Timer queries
+   are core in GL 3.3, Supported() checks the current context has them.
+
+example usage:
+
+timer.SetEnabled(GpuTimer::Supported());
+...
+timer.Begin(gl, "Shadows (GPU)");
+DrawShadows();
+timer.End(gl);
+window.SwapBuffers();
+timer.Collect(gl);   // once per frame */
+#pragma once
+#include "GLBackend.hpp"
+#include "../core/Profiler.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class GpuTimer {
+public:
+    static constexpr std::size_t FramesInFlight = 4;
+
+    static bool Supported();
+
+    void SetEnabled(bool value) { enabled = value; }
+    bool Enabled() const { return enabled; }
+
+    // Bracket GPU work; spans may nest. `name` must outlive the profiler's
+    // use of it, as with PROFILE_SCOPE.
+    void Begin(GLBackend& gl, const char* name);
+    void End(GLBackend& gl);
+
+    // Closes the frame and reports the spans of earlier frames that finished.
+    void Collect(GLBackend& gl);
+    // Deletes the queries; call while the context is current.
+    void Release(GLBackend& gl);
+
+    uint64_t DroppedFrames() const { return droppedFrames; }
+
+    // Begin / End around a C++ scope.
+    class Scope {
+    public:
+        Scope(GpuTimer& timer, GLBackend& gl, const char* name) : timer(timer), gl(gl) { timer.Begin(gl, name); }
+        ~Scope() { timer.End(gl); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        GpuTimer& timer;
+        GLBackend& gl;
+    };
+
+private:
+    struct Span {
+        const char* name;
+        uint32_t begin; // query indices in the frame's pool
+        uint32_t end;
+    };
+
+    struct Frame {
+        std::vector<GLuint> queries;  // pool, grown on demand and reused
+        std::vector<Span> spans;
+        uint32_t used = 0;
+        int64_t cpuStartNs = 0;
+        bool pending = false;         // issued, results not read yet
+    };
+
+    uint32_t Timestamp(GLBackend& gl);
+    bool Read(GLBackend& gl, Frame& frame);
+
+    std::array<Frame, FramesInFlight> frames;
+    std::vector<uint32_t> open;       // spans begun and not ended, innermost last
+    std::vector<GLuint64> results;
+    std::size_t current = 0;
+    uint64_t droppedFrames = 0;
+    bool enabled = false;
+};
+
+#ifdef ENGINE_PROFILE
+#define PROFILE_GPU_SCOPE(timer, gl, name) GpuTimer::Scope PROFILE_CONCAT(gpuScope, __LINE__)(timer, gl, name)
+#define PROFILE_GPU_COLLECT(timer, gl) (timer).Collect(gl)
+#else
+#define PROFILE_GPU_SCOPE(timer, gl, name) ((void)0)
+#define PROFILE_GPU_COLLECT(timer, gl) ((void)0)
+#endif
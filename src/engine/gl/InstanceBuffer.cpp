@@ -0,0 +1,40 @@
+#include "InstanceBuffer.hpp"
+#include <bit>
+#include <cstdint>
+
+void InstanceBuffer::Upload(GLBackend& gl, std::span<const InstanceData> instances) {
+    if (instances.empty()) return;
+    if (buffer == 0) gl.GenBuffers(1, &buffer);
+    gl.BindBuffer(GL_ARRAY_BUFFER, buffer);
+
+    segment = (segment + 1) % FramesInFlight;
+    if (instances.size() > capacity) {
+        capacity = std::bit_ceil(instances.size());
+        segment = 0;
+        gl.BufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(FramesInFlight * capacity * sizeof(InstanceData)),
+                      nullptr, GL_STREAM_DRAW);
+    }
+    gl.BufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(SegmentOffset()),
+                     static_cast<GLsizeiptr>(instances.size_bytes()), instances.data());
+}
+
+GLuint InstanceBuffer::BindAttributes(GLBackend& gl, std::size_t first) const {
+    const std::size_t firstInstance = segment * capacity + first;
+    const bool baseInstance = gl.HasBaseInstance();
+    const uintptr_t base = baseInstance ? 0 : firstInstance * sizeof(InstanceData);
+    const GLsizei stride = sizeof(InstanceData);
+
+    gl.BindBuffer(GL_ARRAY_BUFFER, buffer);
+    for (GLuint column = 0; column < 4; ++column) {
+        const GLuint location = WorldLocation + column;
+        gl.EnableVertexAttribArray(location);
+        gl.VertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride,
+                               reinterpret_cast<const void*>(base + offsetof(InstanceData, world) + column * sizeof(glm::vec4)));
+        gl.VertexAttribDivisor(location, 1);
+    }
+    gl.EnableVertexAttribArray(ParamsLocation);
+    gl.VertexAttribPointer(ParamsLocation, 4, GL_FLOAT, GL_FALSE, stride,
+                           reinterpret_cast<const void*>(base + offsetof(InstanceData, params)));
+    gl.VertexAttribDivisor(ParamsLocation, 1);
+    return baseInstance ? static_cast<GLuint>(firstInstance) : 0;
+}
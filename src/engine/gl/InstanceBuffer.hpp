@@ -0,0 +1,61 @@
+/* Per-frame vertex buffer of per-instance data for instanced draws.
+
+   Each instance is a world matrix plus one vec4 of free parameters (tint,
+   animation phase, ...). Shaders that draw instanced read them as vertex
+   attributes starting at InstanceBuffer::WorldLocation (mat4, four slots)
+   and ParamsLocation; see shaders/instanced.vert. Locations below 4 are
+   left for mesh attributes (position, normal, uv).
+
+   The buffer is a ring of FramesInFlight segments, like UniformRing: each
+   frame's instances go into the next segment with one BufferSubData, so
+   the driver never waits on draws still reading an earlier frame. Storage
+   is only reallocated when a frame needs more room than a segment has.
+
+   Where the context has base instance (GL 4.2 / ARB_base_instance) the
+   attributes of a VAO always point at the start of the buffer and each
+   draw selects its slice with the base instance BindAttributes returns;
+   repeating the same pointers is dropped by GLContext, so each mesh's VAO
+   is set up once. Without it the attributes are re-pointed at the slice
+   for every batch and the returned base instance is 0.
+
+example usage:
+
+instances.Upload(gl, data);
+gl.BindVertexArray(mesh.vao);
+const GLuint base = instances.BindAttributes(gl, firstInstance);
+gl.DrawElementsInstancedBaseInstance(GL_TRIANGLES, mesh.count, GL_UNSIGNED_INT, nullptr, instanceCount, base); */
+#pragma once
+#include "GLBackend.hpp"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <span>
+
+struct InstanceData {
+    glm::mat4 world;
+    glm::vec4 params;
+};
+
+class InstanceBuffer {
+public:
+    static constexpr GLuint WorldLocation = 4;  // 4..7, one column each
+    static constexpr GLuint ParamsLocation = 8;
+    static constexpr std::size_t FramesInFlight = 3;
+
+    // Writes the frame's instances into the next segment. Segments grow (to
+    // the next power of two) only when a frame needs more room; growing
+    // reallocates the storage and starts over at segment 0.
+    void Upload(GLBackend& gl, std::span<const InstanceData> instances);
+
+    // Points the instance attributes of the bound VAO at this frame's data
+    // and returns the base instance that makes a draw start at `first`.
+    GLuint BindAttributes(GLBackend& gl, std::size_t first) const;
+
+    GLuint Buffer() const { return buffer; }
+    std::size_t SegmentCapacity() const { return capacity; } // in instances
+    std::size_t SegmentOffset() const { return segment * capacity * sizeof(InstanceData); }
+
+private:
+    GLuint buffer = 0;
+    std::size_t capacity = 0;
+    std::size_t segment = 0;
+};
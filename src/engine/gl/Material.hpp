@@ -0,0 +1,10 @@
+/* Shader program plus the state a draw needs from it. */
+#pragma once
+#include <glad/gl.h>
+
+struct Material {
+    GLuint program = 0;
+    GLuint texture = 0;      // bound to unit 0; 0 unbinds whatever was there
+    bool transparent = false;
+    bool instanced = false;  // program reads per-instance attributes (InstanceBuffer.hpp) instead of the ObjectData block
+};
@@ -0,0 +1,13 @@
+#include "Mesh.hpp"
+#include "GLContext.hpp"
+
+void Mesh::Draw(GLBackend& gl) const {
+    gl.BindVertexArray(vao);
+
+    if (indexed)
+        gl.DrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr);
+    else
+        gl.DrawArrays(GL_TRIANGLES, 0, count);
+}
+
+void Mesh::Draw() const { Draw(GLContext::Instance()); }
@@ -0,0 +1,16 @@
+/* GPU-side mesh: a VAO plus the element/vertex count needed to draw it. */
+#pragma once
+#include <glad/gl.h>
+#include "GLBackend.hpp"
+#include "../utils/Aabb.hpp"
+
+struct Mesh {
+    GLuint vao = 0;
+    GLsizei count = 0;     // index count when indexed, vertex count otherwise
+    bool indexed = false;  // GL_UNSIGNED_INT indices bound to the VAO
+    Aabb bounds;           // object-space bounds; infinite (never culled) if unknown
+
+    // Binds the VAO and draws; through GLContext::Instance() by default.
+    void Draw(GLBackend& gl) const;
+    void Draw() const;
+};
@@ -0,0 +1,163 @@
+#include "RenderQueue.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+namespace {
+
+constexpr uint64_t Mask(uint32_t bits) { return (uint64_t{ 1 } << bits) - 1; }
+
+uint64_t QuantizeDepth(float depth01) {
+    const float clamped = std::clamp(depth01, 0.0f, 1.0f);
+    return static_cast<uint64_t>(clamped * static_cast<float>(Mask(RenderQueue::DepthBits)));
+}
+
+uint64_t Field(uint32_t value, uint32_t bits) {
+    assert(value <= Mask(bits) && "Sort key field out of range.");
+    return value & Mask(bits);
+}
+
+}
+
+uint64_t RenderQueue::OpaqueKey(uint32_t layer, uint32_t shader, uint32_t material, uint32_t mesh, float depth01) {
+    uint64_t key = Field(layer, LayerBits);
+    key = (key << 1);                                   // opaque
+    key = (key << ShaderBits) | Field(shader, ShaderBits);
+    key = (key << MaterialBits) | Field(material, MaterialBits);
+    key = (key << MeshBits) | Field(mesh, MeshBits);
+    key = (key << DepthBits) | QuantizeDepth(depth01);   // front to back
+    return key;
+}
+
+uint64_t RenderQueue::TransparentKey(uint32_t layer, uint32_t shader, uint32_t material, uint32_t mesh, float depth01) {
+    uint64_t key = Field(layer, LayerBits);
+    key = (key << 1) | 1u;                               // transparent
+    key = (key << DepthBits) | (Mask(DepthBits) - QuantizeDepth(depth01)); // back to front
+    key = (key << ShaderBits) | Field(shader, ShaderBits);
+    key = (key << MaterialBits) | Field(material, MaterialBits);
+    key = (key << MeshBits) | Field(mesh, MeshBits);
+    return key;
+}
+
+// LSD radix sort, one byte per pass. All eight histograms are built in one
+// read of the keys; a pass whose byte is the same in every key is skipped,
+// which drops most passes when few layers/shaders are in use. Stable, so
+// equal keys keep push order.
+void RenderQueue::Sort() {
+    const std::size_t count = commands.size();
+    order.resize(count);
+    scratch.resize(count);
+    for (uint32_t i = 0; i < count; ++i) order[i] = { commands[i].key, i };
+    if (count < 2) return;
+
+    std::array<std::array<uint32_t, 256>, 8> histograms{};
+    for (const SortItem& item : order)
+        for (int pass = 0; pass < 8; ++pass) ++histograms[pass][(item.key >> (pass * 8)) & 0xFF];
+
+    for (int pass = 0; pass < 8; ++pass) {
+        std::array<uint32_t, 256>& histogram = histograms[pass];
+        const uint32_t firstByte = (order[0].key >> (pass * 8)) & 0xFF;
+        if (histogram[firstByte] == count) continue;
+
+        uint32_t offset = 0;
+        for (uint32_t& bucket : histogram) {
+            const uint32_t size = bucket;
+            bucket = offset;
+            offset += size;
+        }
+        for (const SortItem& item : order) scratch[histogram[(item.key >> (pass * 8)) & 0xFF]++] = item;
+        order.swap(scratch);
+    }
+}
+
+// Batches are formed first so the instance data and object uniforms of the
+// whole frame go up in one upload each before any draw is issued.
+RenderStats RenderQueue::Submit(GLBackend& gl, std::span<const Mesh> meshes, std::span<const Material> materials) {
+    assert(order.size() == commands.size() && "RenderQueue::Submit called without Sort().");
+    RenderStats stats;
+    stats.commands = static_cast<uint32_t>(order.size());
+
+    batches.clear();
+    instanceData.clear();
+    objects.BeginFrame(gl);
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        const DrawCommand& command = commands[order[i].index];
+        if (!materials[command.material].instanced) {
+            const ObjectUniforms object{ *command.world, command.params ? *command.params : glm::vec4(1.0f) };
+            batches.push_back({ i, 1, false, static_cast<uint32_t>(objects.Push(&object, sizeof(object))) });
+            continue;
+        }
+
+        const DrawCommand* previous = i > 0 ? &commands[order[i - 1].index] : nullptr;
+        if (previous && !batches.empty() && batches.back().instanced
+            && previous->mesh == command.mesh && previous->material == command.material)
+            ++batches.back().count;
+        else
+            batches.push_back({ i, 1, true, 0 });
+        instanceData.push_back({ *command.world, command.params ? *command.params : glm::vec4(1.0f) });
+    }
+    instances.Upload(gl, instanceData);
+    objects.Upload(gl);
+
+    GLuint program = 0, vao = 0, texture = 0;
+    bool textureKnown = false; // whatever the last frame left bound is not known here
+    bool textureUnitSelected = false;
+    std::size_t firstInstance = 0;
+    const bool baseInstanceDraws = gl.HasBaseInstance();
+
+    for (const Batch& batch : batches) {
+        const DrawCommand& command = commands[order[batch.begin].index];
+        const Material& material = materials[command.material];
+        const Mesh& mesh = meshes[command.mesh];
+
+        if (material.program != program) {
+            program = material.program;
+            gl.UseProgram(program);
+            ++stats.programBinds;
+        }
+
+        // an untextured material binds 0, so it never samples the previous batch's texture
+        if (!textureKnown || material.texture != texture) {
+            if (!textureUnitSelected) {
+                gl.ActiveTexture(GL_TEXTURE0);
+                textureUnitSelected = true;
+            }
+            texture = material.texture;
+            textureKnown = true;
+            gl.BindTexture(GL_TEXTURE_2D, texture);
+            ++stats.textureBinds;
+        }
+
+        if (mesh.vao != vao) {
+            vao = mesh.vao;
+            gl.BindVertexArray(vao);
+            ++stats.vaoBinds;
+        }
+
+        ++stats.drawCalls;
+        if (batch.instanced) {
+            const GLuint baseInstance = instances.BindAttributes(gl, firstInstance);
+            const GLsizei count = static_cast<GLsizei>(batch.count);
+            firstInstance += batch.count;
+            if (baseInstanceDraws && mesh.indexed)
+                gl.DrawElementsInstancedBaseInstance(GL_TRIANGLES, mesh.count, GL_UNSIGNED_INT, nullptr, count, baseInstance);
+            else if (baseInstanceDraws)
+                gl.DrawArraysInstancedBaseInstance(GL_TRIANGLES, 0, mesh.count, count, baseInstance);
+            else if (mesh.indexed)
+                gl.DrawElementsInstanced(GL_TRIANGLES, mesh.count, GL_UNSIGNED_INT, nullptr, count);
+            else
+                gl.DrawArraysInstanced(GL_TRIANGLES, 0, mesh.count, count);
+            ++stats.instancedDraws;
+            stats.instances += batch.count;
+            continue;
+        }
+
+        objects.BindRange(gl, UniformBinding::Object, batch.objectOffset, sizeof(ObjectUniforms));
+
+        if (mesh.indexed)
+            gl.DrawElements(GL_TRIANGLES, mesh.count, GL_UNSIGNED_INT, nullptr);
+        else
+            gl.DrawArrays(GL_TRIANGLES, 0, mesh.count);
+    }
+    return stats;
+}
@@ -0,0 +1,118 @@
+/* Per-frame list of draw commands ordered by a 64-bit sort key.
+
+   Key layout, most significant bits first:
+
+     opaque:       layer:4 | 0 | shader:10 | material:12 | mesh:13 | depth:24
+     transparent:  layer:4 | 1 | ~depth:24 | shader:10 | material:12 | mesh:13
+
+   Layers draw in ascending order and opaque before transparent within a
+   layer. Opaque draws are grouped by state so binds are minimal, and run
+   front to back within one shader/material/mesh; transparent draws run
+   strictly back to front. Sorting is an LSD radix sort on the keys that
+   skips byte positions every key agrees on.
+
+   Runs of consecutive commands that share mesh and material are issued as
+   one instanced draw when the material is `instanced`: their world matrices
+   and params go into the frame's InstanceBuffer. Opaque keys put equal
+   mesh/material pairs next to each other, so every copy of a prop in a
+   layer collapses into a single draw; transparent runs only merge where
+   depth order allows.
+
+   Every other draw reads its model matrix and params from the ObjectData
+   uniform block: Submit writes them into the queue's UniformRing before
+   the first draw and selects each draw's slice with one BindBufferRange.
+   Nothing in the draw loop sets a uniform or looks one up by name.
+
+example usage:
+
+queue.Clear();
+queue.Push({ RenderQueue::OpaqueKey(0, shader, material, mesh, depth), &world, mesh, material });
+queue.Sort();
+RenderStats stats = queue.Submit(gl, meshes, materials); */
+#pragma once
+#include "GLBackend.hpp"
+#include "InstanceBuffer.hpp"
+#include "Mesh.hpp"
+#include "Material.hpp"
+#include "UniformBuffer.hpp"
+#include "../components/MeshRenderer.hpp"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct DrawCommand {
+    uint64_t key = 0;
+    const glm::mat4* world = nullptr; // points into Transform storage, valid for the frame
+    MeshHandle mesh = 0;
+    MaterialHandle material = 0;
+    const glm::vec4* params = nullptr; // MeshRenderer::params; vec4(1) if null
+};
+
+// What one Submit() sent to the backend.
+struct RenderStats {
+    uint32_t commands = 0;
+    uint32_t drawCalls = 0;
+    uint32_t instancedDraws = 0; // part of drawCalls
+    uint32_t instances = 0;      // commands drawn through instanced draws
+    uint32_t programBinds = 0;
+    uint32_t vaoBinds = 0;
+    uint32_t textureBinds = 0;
+    uint32_t culled = 0;      // drawables rejected before the queue (filled by RenderSystem)
+    uint32_t notResident = 0; // visible, but skipped: streamed mesh not on the GPU (filled by RenderSystem)
+
+    uint32_t StateChanges() const { return programBinds + vaoBinds + textureBinds; }
+};
+
+class RenderQueue {
+public:
+    static constexpr uint32_t LayerBits = 4;
+    static constexpr uint32_t ShaderBits = 10;
+    static constexpr uint32_t MaterialBits = 12;
+    static constexpr uint32_t MeshBits = 13;
+    static constexpr uint32_t DepthBits = 24;
+
+    // depth01 is the view distance normalised to [0, 1] (near..far); clamped.
+    static uint64_t OpaqueKey(uint32_t layer, uint32_t shader, uint32_t material, uint32_t mesh, float depth01);
+    static uint64_t TransparentKey(uint32_t layer, uint32_t shader, uint32_t material, uint32_t mesh, float depth01);
+
+    void Clear() { commands.clear(); }
+    void Reserve(std::size_t count) { commands.reserve(count); }
+    void Push(const DrawCommand& command) { commands.push_back(command); }
+
+    void Sort();
+
+    // Issues every command in key order, skipping program/VAO/texture binds
+    // that match the previous draw and batching instanced materials (see
+    // above). Expects the FrameData block to be bound by the caller.
+    RenderStats Submit(GLBackend& gl, std::span<const Mesh> meshes, std::span<const Material> materials);
+
+    const InstanceBuffer& GetInstanceBuffer() const { return instances; }
+    const UniformRing& GetObjectRing() const { return objects; }
+
+    std::size_t Size() const { return commands.size(); }
+    // Commands in submission order (after Sort()).
+    const DrawCommand& operator[](std::size_t i) const { return commands[order[i].index]; }
+
+private:
+    struct SortItem {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    std::vector<DrawCommand> commands;
+    std::vector<SortItem> order;
+    std::vector<SortItem> scratch;
+
+    // One entry per draw: `count` sorted commands starting at `begin`.
+    struct Batch {
+        uint32_t begin;
+        uint32_t count;
+        bool instanced;
+        uint32_t objectOffset; // ObjectUniforms in the ring, non-instanced only
+    };
+    std::vector<Batch> batches;
+    std::vector<InstanceData> instanceData;
+    InstanceBuffer instances;
+    UniformRing objects;
+};
@@ -1,25 +1,188 @@
 #include "Shader.hpp"
+#include "../core/Profiler.hpp"
+#include <algorithm>
+#include <cassert>
 #include <fstream>
-#include <sstream>
 #include <iostream>
 
-// Helper function to read a file into a string
-static std::string ReadFile(const std::string& filepath) {
+static bool ReadWholeFile(const std::string& filepath, std::string& contents) {
+    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return false;
 
-    std::ifstream file(filepath);
-    if (!file.is_open()) 
-    {
+    contents.assign(static_cast<std::size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(contents.data(), static_cast<std::streamsize>(contents.size()));
+    return true;
+}
+
+// Reads a whole file into a string with one sized read
+std::string ReadShaderFile(const std::string& filepath) {
+
+    std::string contents;
+    if (!ReadWholeFile(filepath, contents)) 
         std::cerr << "Failed to open shader file: " << filepath << std::endl;
-        return "";
+    return contents;
+}
+
+ShaderIncludeLoader ShaderDirectoryLoader() {
+    return [](const std::string& name) -> std::optional<std::string> {
+        std::string contents;
+        if (!ReadWholeFile(std::string(SHADER_DIR) + "/" + name, contents)) return std::nullopt;
+        return contents;
+    };
+}
+
+namespace {
+
+std::string_view TrimLeft(std::string_view text) {
+    const std::size_t start = text.find_first_not_of(" \t");
+    return start == std::string_view::npos ? std::string_view() : text.substr(start);
+}
+
+// "#  include" is a valid spelling, so the directive is matched after the '#'.
+bool IsDirective(std::string_view line, std::string_view directive, std::string_view& rest) {
+    line = TrimLeft(line);
+    if (line.empty() || line[0] != '#') return false;
+    line = TrimLeft(line.substr(1));
+    if (line.substr(0, directive.size()) != directive) return false;
+    rest = line.substr(directive.size());
+    return rest.empty() || rest[0] == ' ' || rest[0] == '\t' || rest[0] == '"' || rest[0] == '<';
+}
+
+std::vector<std::string> SplitWords(std::string_view text) {
+    std::vector<std::string> words;
+    std::size_t i = 0;
+    while (i < text.size()) {
+        const std::size_t start = text.find_first_not_of(" \t\r", i);
+        if (start == std::string_view::npos) break;
+        const std::size_t end = std::min(text.find_first_of(" \t\r", start), text.size());
+        words.emplace_back(text.substr(start, end - start));
+        i = end;
     }
+    return words;
+}
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+bool ExpandFile(std::string_view text, int fileIndex, const ShaderIncludeLoader& load, ShaderSource& out) {
+    int lineNumber = 0;
+    std::size_t position = 0;
+    while (position <= text.size()) {
+        const std::size_t end = std::min(text.find('\n', position), text.size());
+        const std::string_view line = text.substr(position, end - position);
+        const bool lastLine = end == text.size();
+        position = end + 1;
+        ++lineNumber;
+        if (lastLine && line.empty()) break;
+
+        std::string_view rest;
+        if (IsDirective(line, "include", rest)) {
+            rest = TrimLeft(rest);
+            const char close = !rest.empty() && rest[0] == '<' ? '>' : '"';
+            const std::size_t nameEnd = rest.size() > 1 ? rest.find(close, 1) : std::string_view::npos;
+            if (rest.empty() || (rest[0] != '"' && rest[0] != '<') || nameEnd == std::string_view::npos) {
+                out.error = out.files[fileIndex] + ":" + std::to_string(lineNumber) + ": malformed #include";
+                return false;
+            }
+
+            const std::string name(rest.substr(1, nameEnd - 1));
+            if (std::find(out.files.begin(), out.files.end(), name) != out.files.end()) {
+                out.text += '\n'; // already included: keep the line count
+                continue;
+            }
+            std::optional<std::string> contents = load(name);
+            if (!contents) {
+                out.error = out.files[fileIndex] + ":" + std::to_string(lineNumber) + ": cannot open include \"" + name + "\"";
+                return false;
+            }
+
+            const int includeIndex = static_cast<int>(out.files.size());
+            out.files.push_back(name);
+            out.text += "#line 1 " + std::to_string(includeIndex) + "\n";
+            if (!ExpandFile(*contents, includeIndex, load, out)) return false;
+            if (!out.text.empty() && out.text.back() != '\n') out.text += '\n';
+            out.text += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileIndex) + "\n";
+            continue;
+        }
+
+        if (IsDirective(line, "pragma", rest)) {
+            std::vector<std::string> words = SplitWords(rest);
+            if (!words.empty() && words[0] == "multi_compile") {
+                words.erase(words.begin());
+                if (words.size() == 1) words.insert(words.begin(), "_");
+                if (words.size() > 1) MergeKeywordSets(out.keywordSets, { words });
+                out.text += '\n';
+                continue;
+            }
+        }
+
+        out.text.append(line);
+        if (!lastLine) out.text += '\n';
+    }
+    return true;
+}
+
+}
+
+ShaderSource PreprocessShader(const std::string& name, const ShaderIncludeLoader& load) {
+    ShaderSource out;
+    out.files.push_back(name);
+    std::optional<std::string> root = load(name);
+    if (!root) {
+        out.error = "cannot open \"" + name + "\"";
+        return out;
+    }
+    out.text.reserve(root->size());
+    if (!ExpandFile(*root, 0, load, out)) out.text.clear();
+    return out;
+}
+
+std::string ApplyDefines(std::string_view source, const std::vector<std::string>& defines) {
+    if (defines.empty()) return std::string(source);
+
+    std::size_t insertAt = 0;
+    int nextLine = 1;
+    const std::size_t version = source.find("#version");
+    if (version != std::string_view::npos) {
+        const std::size_t lineEnd = source.find('\n', version);
+        insertAt = lineEnd == std::string_view::npos ? source.size() : lineEnd + 1;
+        nextLine = 2 + static_cast<int>(std::count(source.begin(), source.begin() + version, '\n'));
+    }
+
+    std::string result(source.substr(0, insertAt));
+    if (!result.empty() && result.back() != '\n') result += '\n';
+    for (const std::string& define : defines) result.append("#define ").append(define).append("\n");
+    result.append("#line ").append(std::to_string(nextLine)).append("\n");
+    result.append(source.substr(insertAt));
+    return result;
+}
+
+std::vector<std::vector<std::string>> EnumerateVariants(const std::vector<ShaderKeywordSet>& keywordSets) {
+    std::size_t count = 1;
+    for (const ShaderKeywordSet& set : keywordSets) count *= set.size();
+    assert(count <= 65536 && "Too many shader variants; split the keyword sets.");
+
+    std::vector<std::vector<std::string>> variants(count);
+    for (std::size_t v = 0; v < count; ++v) {
+        // mixed-radix digits of v, last set fastest
+        std::size_t rest = v;
+        std::vector<std::string>& defines = variants[v];
+        for (std::size_t s = keywordSets.size(); s-- > 0;) {
+            const std::string& keyword = keywordSets[s][rest % keywordSets[s].size()];
+            rest /= keywordSets[s].size();
+            if (keyword != "_") defines.push_back(keyword);
+        }
+        std::reverse(defines.begin(), defines.end());
+    }
+    return variants;
+}
+
+void MergeKeywordSets(std::vector<ShaderKeywordSet>& sets, const std::vector<ShaderKeywordSet>& extra) {
+    for (const ShaderKeywordSet& set : extra)
+        if (std::find(sets.begin(), sets.end(), set) == sets.end()) sets.push_back(set);
 }
 
 static GLuint CompileShader(GLenum type, const std::string& source, const std::string& name) {
-    
+    PROFILE_SCOPE("Compile shader");
     GLuint shader = glCreateShader(type);
     const char* src = source.c_str();
     glShaderSource(shader, 1, &src, nullptr);
@@ -33,31 +196,32 @@ static GLuint CompileShader(GLenum type, const std::string& source, const std::s
         char log[512];
         glGetShaderInfoLog(shader, 512, nullptr, log);
         std::cerr << "Shader compilation failed (" << name << "):\n" << log << std::endl;
-    } 
-
-    else 
-        std::cout << "Shader compiled: " << name << std::endl;
-    
+    }
 
     return shader;
 }
 
+static std::string LoadStageSource(const std::string& filename) {
+    const ShaderSource source = PreprocessShader(filename, ShaderDirectoryLoader());
+    if (!source.Ok())
+        std::cerr << "Shader preprocessing failed: " << source.error << std::endl;
+    return source.text;
+}
+
 GLuint LoadVert(const std::string& filename) 
 {
-    std::string source = ReadFile(std::string(SHADER_DIR) + "/" + filename);
-    return CompileShader(GL_VERTEX_SHADER, source, filename);
+    return CompileShader(GL_VERTEX_SHADER, LoadStageSource(filename), filename);
 }
 
 
 GLuint LoadFrag(const std::string& filename) 
 {
-    std::string source = ReadFile(std::string(SHADER_DIR) + "/" + filename);
-    return CompileShader(GL_FRAGMENT_SHADER, source, filename);
+    return CompileShader(GL_FRAGMENT_SHADER, LoadStageSource(filename), filename);
 }
 
 GLuint LinkProgram(GLuint vertShader, GLuint fragShader) 
 {
-
+    PROFILE_SCOPE("Link shader program");
     GLuint program = glCreateProgram();
     glAttachShader(program, vertShader);
     glAttachShader(program, fragShader);
@@ -71,11 +235,7 @@ GLuint LinkProgram(GLuint vertShader, GLuint fragShader)
         char log[512];
         glGetProgramInfoLog(program, 512, nullptr, log);
         std::cerr << "Shader program link failed:\n" << log << std::endl;
-    } 
-    
-    else 
-        std::cout << "Shader program linked successfully.\n";
-
+    }
 
     glDeleteShader(vertShader);
     glDeleteShader(fragShader);
@@ -1,7 +1,64 @@
+/* Shader sources: loading, preprocessing and variant enumeration.
+
+   PreprocessShader expands #include "file" directives (each file at most
+   once per shader, so include cycles and diamond includes are harmless)
+   and emits #line markers so driver errors point at the right file and
+   line: source string 0 is the root, string N is ShaderSource::files[N].
+
+   "#pragma multi_compile A B C" declares a keyword set: every variant
+   defines exactly one of A, B, C ("_" stands for "none of them"; a set with
+   a single keyword toggles it). EnumerateVariants builds the cartesian
+   product of all sets, which ShaderLibrary compiles as separate programs.
+
+   None of this touches GL, so it runs on worker threads and in headless
+   tests.
+
+example usage:
+
+ShaderSource vert = PreprocessShader("lit.vert", ShaderDirectoryLoader());
+for (const std::vector<std::string>& defines : EnumerateVariants(vert.keywordSets))
+    Compile(ApplyDefines(vert.text, defines)); */
 #pragma once
+#include <functional>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <glad/gl.h>
 
+// Returns the contents of an include (or root) file, or nullopt if missing.
+using ShaderIncludeLoader = std::function<std::optional<std::string>(const std::string& name)>;
+
+// Loads names relative to SHADER_DIR.
+ShaderIncludeLoader ShaderDirectoryLoader();
+
+using ShaderKeywordSet = std::vector<std::string>;
+
+struct ShaderSource {
+    std::string text;                         // includes expanded, pragmas blanked
+    std::vector<std::string> files;           // [0] is the root
+    std::vector<ShaderKeywordSet> keywordSets;
+    std::string error;                        // empty on success
+
+    bool Ok() const { return error.empty(); }
+};
+
+ShaderSource PreprocessShader(const std::string& name, const ShaderIncludeLoader& load);
+
+// Adds a "#define <entry>" line per entry right after the #version line
+// (or at the top if there is none), then a #line marker so the original
+// lines keep their numbers. "NAME VALUE" entries define a value.
+std::string ApplyDefines(std::string_view source, const std::vector<std::string>& defines);
+
+// One define list per permutation; the first set varies slowest.
+std::vector<std::vector<std::string>> EnumerateVariants(const std::vector<ShaderKeywordSet>& keywordSets);
+
+// Appends the sets of `extra` that `sets` does not already have.
+void MergeKeywordSets(std::vector<ShaderKeywordSet>& sets, const std::vector<ShaderKeywordSet>& extra);
+
+// Single stages and programs, compiled on every call. Prefer ShaderLibrary,
+// which compiles each source once and caches linked programs on disk.
+std::string ReadShaderFile(const std::string& filepath);
 GLuint LoadVert(const std::string& filename);
 GLuint LoadFrag(const std::string& filename);
 GLuint LinkProgram(GLuint vertShader, GLuint fragShader);
@@ -0,0 +1,75 @@
+#include "ShaderCache.hpp"
+#include <cstdio>
+#include <system_error>
+
+namespace {
+
+constexpr uint32_t Magic = 0x43425348; // "HSBC"
+constexpr uint32_t FormatVersion = 1;
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t binaryFormat;
+    uint32_t size;
+};
+
+}
+
+ShaderCache::ShaderCache(std::filesystem::path dir) : directory(std::move(dir)) {
+    std::error_code error;
+    if (Enabled()) std::filesystem::create_directories(directory, error);
+}
+
+std::filesystem::path ShaderCache::PathOf(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return directory / name;
+}
+
+std::optional<ProgramBinary> ShaderCache::Load(uint64_t key) const {
+    if (!Enabled()) return std::nullopt;
+    std::FILE* file = std::fopen(PathOf(key).string().c_str(), "rb");
+    if (!file) return std::nullopt;
+
+    Header header{};
+    ProgramBinary binary;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1
+           && header.magic == Magic && header.version == FormatVersion && header.key == key && header.size > 0;
+    if (ok) {
+        binary.format = header.binaryFormat;
+        binary.data.resize(header.size);
+        ok = std::fread(binary.data.data(), 1, header.size, file) == header.size && std::fgetc(file) == EOF;
+    }
+    std::fclose(file);
+    if (!ok) return std::nullopt;
+    return binary;
+}
+
+bool ShaderCache::Store(uint64_t key, const ProgramBinary& binary) const {
+    if (!Enabled() || binary.data.empty()) return false;
+    const std::filesystem::path path = PathOf(key);
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+
+    std::FILE* file = std::fopen(temporary.string().c_str(), "wb");
+    if (!file) return false;
+    const Header header{ Magic, FormatVersion, key, binary.format, static_cast<uint32_t>(binary.data.size()) };
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+           && std::fwrite(binary.data.data(), 1, binary.data.size(), file) == binary.data.size();
+    ok = std::fclose(file) == 0 && ok;
+
+    std::error_code error;
+    if (ok) std::filesystem::rename(temporary, path, error);
+    if (!ok || error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+void ShaderCache::Remove(uint64_t key) const {
+    std::error_code error;
+    if (Enabled()) std::filesystem::remove(PathOf(key), error);
+}
@@ -0,0 +1,39 @@
+/* Directory of linked program binaries, one file per program key.
+
+   File layout: a fixed header (magic, format version, key, GL binary
+   format, payload size) followed by the driver's blob. Loads check all of
+   it, so a truncated, foreign or stale file reads as a miss. Stores write a
+   temporary file and rename it, so a crash never leaves half an entry.
+
+example usage:
+
+ShaderCache cache("build/shader_cache");
+if (std::optional<ProgramBinary> binary = cache.Load(key)) { ... }
+cache.Store(key, { format, bytes }); */
+#pragma once
+#include <glad/gl.h>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+struct ProgramBinary {
+    GLenum format = 0;
+    std::vector<unsigned char> data;
+};
+
+class ShaderCache {
+public:
+    // An empty directory disables the cache: loads miss, stores do nothing.
+    explicit ShaderCache(std::filesystem::path directory);
+
+    std::optional<ProgramBinary> Load(uint64_t key) const;
+    bool Store(uint64_t key, const ProgramBinary& binary) const;
+    void Remove(uint64_t key) const;
+
+    bool Enabled() const { return !directory.empty(); }
+    std::filesystem::path PathOf(uint64_t key) const;
+
+private:
+    std::filesystem::path directory;
+};
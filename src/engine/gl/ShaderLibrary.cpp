@@ -0,0 +1,339 @@
+#include "ShaderLibrary.hpp"
+#include "GLExtensions.hpp"
+#include "../core/JobSystem.hpp"
+#include "../core/Profiler.hpp"
+#include "../utils/Hash.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+std::string_view GLString(GLenum name) {
+    const GLubyte* value = glGetString(name);
+    return value ? reinterpret_cast<const char*>(value) : "";
+}
+
+bool LinkSucceeded(GLuint program) {
+    GLint success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    return success == GL_TRUE;
+}
+
+void PrintCompileLog(GLuint shader, const char* stage) {
+    GLint success = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (success) return;
+    char log[512];
+    glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+    std::cerr << "Shader compilation failed (" << stage << "):\n" << log << std::endl;
+}
+
+// Runs fn(i) for i in [0, count), spread over the pool when there is one.
+template<typename Fn>
+void RunJobs(JobSystem* jobs, std::size_t count, Fn&& fn) {
+    if (!jobs || count < 2) {
+        for (std::size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+    const std::size_t chunk = std::max<std::size_t>(1, count / (jobs->ThreadCount() * 4));
+    JobCounter done;
+    for (std::size_t begin = 0; begin < count; begin += chunk) {
+        const std::size_t end = std::min(count, begin + chunk);
+        jobs->Submit([&fn, begin, end] { for (std::size_t i = begin; i < end; ++i) fn(i); }, &done);
+    }
+    jobs->Wait(done);
+}
+
+}
+
+namespace {
+
+// The defines among `defines` that `source` declares a keyword for.
+std::vector<std::string> StageDefines(const ShaderSource& source, const std::vector<std::string>& defines) {
+    std::vector<std::string> declared;
+    for (const std::string& define : defines)
+        for (const ShaderKeywordSet& set : source.keywordSets)
+            if (std::find(set.begin(), set.end(), define) != set.end()) {
+                declared.push_back(define);
+                break;
+            }
+    return declared;
+}
+
+}
+
+// Each stage only gets the keywords it declares, so a vertex shader is the
+// same source (and one compile) across fragment-only permutations. Declared
+// keywords are put in keyword-set order, the order EnumerateVariants lists
+// them in, so the same permutation asked for by name hashes the same.
+ShaderVariantSource BuildShaderVariant(const ShaderSource& vert, const ShaderSource& frag, const std::vector<std::string>& defines) {
+    std::vector<ShaderKeywordSet> keywordSets = vert.keywordSets;
+    MergeKeywordSets(keywordSets, frag.keywordSets);
+    const auto setOf = [&](const std::string& define) {
+        for (std::size_t s = 0; s < keywordSets.size(); ++s)
+            if (std::find(keywordSets[s].begin(), keywordSets[s].end(), define) != keywordSets[s].end()) return s;
+        return keywordSets.size();
+    };
+
+    std::vector<std::string> declared;
+    ShaderVariantSource variant;
+    for (const std::string& define : defines)
+        (setOf(define) < keywordSets.size() ? declared : variant.defines).push_back(define);
+    std::stable_sort(declared.begin(), declared.end(),
+                     [&](const std::string& a, const std::string& b) { return setOf(a) < setOf(b); });
+
+    // defines no stage declares go to both, ahead of the keywords
+    std::vector<std::string> vertDefines = variant.defines, fragDefines = variant.defines;
+    for (std::string& define : StageDefines(vert, declared)) vertDefines.push_back(std::move(define));
+    for (std::string& define : StageDefines(frag, declared)) fragDefines.push_back(std::move(define));
+    variant.defines.insert(variant.defines.end(), declared.begin(), declared.end());
+
+    variant.vert = ApplyDefines(vert.text, vertDefines);
+    variant.frag = ApplyDefines(frag.text, fragDefines);
+    variant.vertHash = HashString(variant.vert);
+    variant.fragHash = HashString(variant.frag);
+    return variant;
+}
+
+std::vector<ShaderVariantSource> BuildShaderVariants(const ShaderSource& vert, const ShaderSource& frag, JobSystem* jobs) {
+    std::vector<ShaderKeywordSet> keywordSets = vert.keywordSets;
+    MergeKeywordSets(keywordSets, frag.keywordSets);
+    const std::vector<std::vector<std::string>> defineLists = EnumerateVariants(keywordSets);
+
+    std::vector<ShaderVariantSource> variants(defineLists.size());
+    RunJobs(jobs, variants.size(), [&](std::size_t i) { variants[i] = BuildShaderVariant(vert, frag, defineLists[i]); });
+    return variants;
+}
+
+ShaderLibrary::ShaderLibrary() : ShaderLibrary(SHADER_CACHE_DIR) {}
+
+ShaderLibrary::ShaderLibrary(std::filesystem::path cacheDirectory) : cache(std::move(cacheDirectory)) {}
+
+// Preprocessed once per file for the library's lifetime; null if that failed.
+const ShaderSource* ShaderLibrary::Preprocessed(const std::string& file) {
+    auto it = sources.find(file);
+    if (it == sources.end()) {
+        it = sources.emplace(file, PreprocessShader(file, ShaderDirectoryLoader())).first;
+        if (!it->second.Ok()) std::cerr << "Shader preprocessing failed: " << it->second.error << std::endl;
+    }
+    return it->second.Ok() ? &it->second : nullptr;
+}
+
+ShaderRequest ShaderLibrary::Add(ShaderVariantSource&& variant) {
+    if (driverHash == 0) {
+        driverHash = HashString(GLString(GL_VENDOR));
+        driverHash = HashString(GLString(GL_RENDERER), driverHash);
+        driverHash = HashString(GLString(GL_VERSION), driverHash);
+    }
+    const uint64_t key = HashCombine(HashCombine(driverHash, variant.vertHash), variant.fragHash);
+    if (auto it = byKey.find(key); it != byKey.end()) {
+        ++stats.programsReused;
+        return it->second;
+    }
+
+    const ShaderRequest id = static_cast<ShaderRequest>(requests.size());
+    Request& request = requests.emplace_back();
+    request.key = key;
+    request.defines = std::move(variant.defines);
+    request.vert = std::move(variant.vert);
+    request.frag = std::move(variant.frag);
+    request.vertHash = variant.vertHash;
+    request.fragHash = variant.fragHash;
+    byKey.emplace(key, id);
+    inFlight.push_back(id);
+    return id;
+}
+
+ShaderRequest ShaderLibrary::QueueSources(const ShaderSource& vert, const ShaderSource& frag, const std::vector<std::string>& defines) {
+    return Add(BuildShaderVariant(vert, frag, defines));
+}
+
+GLuint ShaderLibrary::Load(const std::string& vertFile, const std::string& fragFile, const std::vector<std::string>& defines) {
+    const ShaderSource* vert = Preprocessed(vertFile);
+    const ShaderSource* frag = Preprocessed(fragFile);
+    if (!vert || !frag) return 0;
+
+    Request& request = requests[QueueSources(*vert, *frag, defines)];
+    if (request.state == State::Queued) Issue(request);
+    if (request.state == State::Linking) Finish(request);
+    return request.program;
+}
+
+GLuint ShaderLibrary::LoadFromSource(std::string_view vertSource, std::string_view fragSource, const std::vector<std::string>& defines) {
+    ShaderSource vert, frag;
+    vert.text = vertSource;
+    frag.text = fragSource;
+
+    Request& request = requests[QueueSources(vert, frag, defines)];
+    if (request.state == State::Queued) Issue(request);
+    if (request.state == State::Linking) Finish(request);
+    return request.program;
+}
+
+ShaderRequest ShaderLibrary::Queue(const std::string& vertFile, const std::string& fragFile, const std::vector<std::string>& defines) {
+    const ShaderSource* vert = Preprocessed(vertFile);
+    const ShaderSource* frag = Preprocessed(fragFile);
+    if (!vert || !frag) {
+        requests.emplace_back().state = State::Failed;
+        return static_cast<ShaderRequest>(requests.size() - 1);
+    }
+    return QueueSources(*vert, *frag, defines);
+}
+
+std::vector<ShaderRequest> ShaderLibrary::QueueVariants(const std::string& vertFile, const std::string& fragFile) {
+    // the two roots (and their includes) are read and expanded in parallel
+    const std::string files[2] = { vertFile, fragFile };
+    ShaderSource loaded[2];
+    bool needed[2] = { !sources.contains(vertFile), !sources.contains(fragFile) && fragFile != vertFile };
+    RunJobs(jobs, 2, [&](std::size_t i) {
+        if (needed[i]) loaded[i] = PreprocessShader(files[i], ShaderDirectoryLoader());
+    });
+    for (int i = 0; i < 2; ++i) {
+        if (!needed[i]) continue;
+        if (!loaded[i].Ok()) std::cerr << "Shader preprocessing failed: " << loaded[i].error << std::endl;
+        sources.emplace(files[i], std::move(loaded[i]));
+    }
+
+    const ShaderSource* vert = Preprocessed(vertFile);
+    const ShaderSource* frag = Preprocessed(fragFile);
+    if (!vert || !frag) return {};
+
+    std::vector<ShaderVariantSource> variants = BuildShaderVariants(*vert, *frag, jobs);
+    std::vector<ShaderRequest> queued;
+    queued.reserve(variants.size());
+    for (ShaderVariantSource& variant : variants) queued.push_back(Add(std::move(variant)));
+    return queued;
+}
+
+bool ShaderLibrary::IsPending(ShaderRequest request) const {
+    const State state = requests[request].state;
+    return state == State::Queued || state == State::Linking;
+}
+
+std::size_t ShaderLibrary::Poll(std::size_t blockingBudget) {
+    const bool parallel = glext::HasParallelShaderCompile();
+
+    std::size_t blocking = 0;
+    for (ShaderRequest id : inFlight) {
+        Request& request = requests[id];
+        if (request.state != State::Queued) continue;
+        if (!parallel && blocking++ >= blockingBudget) break;
+        Issue(request);
+    }
+
+    blocking = 0;
+    for (ShaderRequest id : inFlight) {
+        Request& request = requests[id];
+        if (request.state != State::Linking) continue;
+        if (parallel) {
+            GLint done = GL_FALSE;
+            glGetProgramiv(request.program, glext::COMPLETION_STATUS, &done);
+            if (!done) continue;
+        } else if (blocking++ >= blockingBudget) {
+            break;
+        }
+        Finish(request);
+    }
+
+    std::erase_if(inFlight, [this](ShaderRequest id) { return !IsPending(id); });
+    return inFlight.size();
+}
+
+GLuint ShaderLibrary::Stage(GLenum type, const std::string& source, uint64_t hash) {
+    const uint64_t key = HashCombine(hash, type);
+    if (auto it = stages.find(key); it != stages.end()) {
+        ++stats.stagesReused;
+        return it->second;
+    }
+
+    const GLuint shader = glCreateShader(type);
+    const char* text = source.c_str();
+    glShaderSource(shader, 1, &text, nullptr);
+    glCompileShader(shader);
+    ++stats.stagesCompiled;
+    stages.emplace(key, shader);
+    return shader;
+}
+
+GLuint ShaderLibrary::LoadBinary(uint64_t key) {
+    if (!glext::HasProgramBinary()) return 0;
+    const std::optional<ProgramBinary> binary = cache.Load(key);
+    if (!binary) return 0;
+
+    const GLuint program = glCreateProgram();
+    glext::ProgramBinary(program, binary->format, binary->data.data(), static_cast<GLsizei>(binary->data.size()));
+    if (LinkSucceeded(program)) {
+        ++stats.binaryLoads;
+        return program;
+    }
+
+    ++stats.binaryRejects;
+    glDeleteProgram(program);
+    cache.Remove(key);
+    return 0;
+}
+
+// Compile and link are only started here; no status is read, so with
+// parallel compile the driver finishes them in the background.
+void ShaderLibrary::Issue(Request& request) {
+    PROFILE_SCOPE("Issue shader program");
+    request.program = LoadBinary(request.key);
+    if (request.program != 0) {
+        request.state = State::Ready;
+    } else {
+        request.vertShader = Stage(GL_VERTEX_SHADER, request.vert, request.vertHash);
+        request.fragShader = Stage(GL_FRAGMENT_SHADER, request.frag, request.fragHash);
+
+        request.program = glCreateProgram();
+        glAttachShader(request.program, request.vertShader);
+        glAttachShader(request.program, request.fragShader);
+        if (glext::HasProgramBinary())
+            glext::ProgramParameteri(request.program, glext::PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(request.program);
+        ++stats.programsLinked;
+        request.state = State::Linking;
+    }
+    request.vert = std::string();
+    request.frag = std::string();
+}
+
+void ShaderLibrary::Finish(Request& request) {
+    PROFILE_SCOPE("Finish shader program");
+    glDetachShader(request.program, request.vertShader);
+    glDetachShader(request.program, request.fragShader);
+
+    if (!LinkSucceeded(request.program)) {
+        PrintCompileLog(request.vertShader, "vertex");
+        PrintCompileLog(request.fragShader, "fragment");
+        char log[512];
+        glGetProgramInfoLog(request.program, sizeof(log), nullptr, log);
+        std::cerr << "Shader program link failed:\n" << log << std::endl;
+        glDeleteProgram(request.program);
+        request.program = 0;
+        request.state = State::Failed;
+        return;
+    }
+    request.state = State::Ready;
+
+    if (glext::HasProgramBinary() && cache.Enabled()) {
+        GLint length = 0;
+        glGetProgramiv(request.program, glext::PROGRAM_BINARY_LENGTH, &length);
+        ProgramBinary binary;
+        binary.data.resize(static_cast<std::size_t>(length));
+        GLsizei written = 0;
+        if (length > 0) glext::GetProgramBinary(request.program, length, &written, &binary.format, binary.data.data());
+        binary.data.resize(static_cast<std::size_t>(written));
+        if (cache.Store(request.key, binary)) ++stats.binaryStores;
+    }
+}
+
+void ShaderLibrary::Clear() {
+    for (const Request& request : requests)
+        if (request.program != 0) glDeleteProgram(request.program);
+    for (const auto& [key, shader] : stages) glDeleteShader(shader);
+    requests.clear();
+    inFlight.clear();
+    byKey.clear();
+    stages.clear();
+    sources.clear();
+}
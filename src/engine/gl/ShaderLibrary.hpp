@@ -0,0 +1,138 @@
+/* Compiles and links shader programs at most once.
+
+   Every program is keyed by a hash of its final stage sources (after
+   includes and defines) and the driver's vendor/renderer/version strings.
+   Within a run each unique stage is compiled once and each unique program
+   linked once; asking again returns the same GL object. Across runs linked
+   programs are stored as driver binaries in a ShaderCache, so a warm start
+   skips compile and link altogether. A binary the driver rejects (new
+   driver, different GPU) is deleted and the program is rebuilt from source.
+
+   Programs can also be queued: QueueVariants preprocesses both stages,
+   enumerates their "#pragma multi_compile" permutations (see Shader.hpp)
+   and hashes every variant on the JobSystem, then queues one program per
+   variant. Poll() issues the queued compiles and links and collects the
+   finished ones; with GL_KHR_parallel_shader_compile the driver works on
+   them concurrently and Poll() never blocks on it.
+
+   Needs glext::Load() to have run for the binary cache and parallel
+   compile; without them it still deduplicates and works synchronously.
+
+example usage:
+
+ShaderLibrary shaders;                      // cache in SHADER_CACHE_DIR
+GLuint lit = shaders.Load("lit.vert", "lit.frag", { "USE_NORMAL_MAP", "MAX_LIGHTS 8" });
+
+std::vector<ShaderRequest> variants = shaders.QueueVariants("lit.vert", "lit.frag");
+while (shaders.Poll() > 0) { ... draw a loading frame ... }
+GLuint program = shaders.Program(variants[0]);
+...
+shaders.Clear();                            // while the context is alive */
+#pragma once
+#include "Shader.hpp"
+#include "ShaderCache.hpp"
+#include <glad/gl.h>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class JobSystem;
+
+struct ShaderLibraryStats {
+    uint32_t stagesCompiled = 0;
+    uint32_t stagesReused = 0;    // same stage source seen again this run
+    uint32_t programsLinked = 0;
+    uint32_t programsReused = 0;  // same program requested again this run
+    uint32_t binaryLoads = 0;     // programs restored from the disk cache
+    uint32_t binaryRejects = 0;   // cached binaries the driver refused
+    uint32_t binaryStores = 0;
+};
+
+// Final stage sources of one keyword permutation. Hashes do not include
+// the driver; ShaderLibrary mixes that in.
+struct ShaderVariantSource {
+    std::vector<std::string> defines;
+    std::string vert, frag;
+    uint64_t vertHash = 0, fragHash = 0;
+};
+
+// One permutation, as Load / Queue build it: each stage gets the keywords
+// among `defines` that it declares, in keyword-set order, so the result
+// matches the BuildShaderVariants entry for the same keywords; defines
+// neither stage declares are applied to both. No GL calls.
+ShaderVariantSource BuildShaderVariant(const ShaderSource& vert, const ShaderSource& frag, const std::vector<std::string>& defines);
+
+// Every permutation of the keyword sets of both stages, defines applied and
+// hashed; spread over `jobs` when given. A stage only gets the defines for
+// keywords it declares itself. No GL calls.
+std::vector<ShaderVariantSource> BuildShaderVariants(const ShaderSource& vert, const ShaderSource& frag, JobSystem* jobs);
+
+using ShaderRequest = uint32_t;
+
+class ShaderLibrary {
+public:
+    ShaderLibrary(); // caches in SHADER_CACHE_DIR
+    explicit ShaderLibrary(std::filesystem::path cacheDirectory);
+
+    // Workers for preprocessing and hashing; null runs them on the caller.
+    void SetJobSystem(JobSystem* jobSystem) { jobs = jobSystem; }
+
+    // Blocking. Stage files are read from SHADER_DIR. Returns 0 on failure.
+    GLuint Load(const std::string& vertFile, const std::string& fragFile, const std::vector<std::string>& defines = {});
+    GLuint LoadFromSource(std::string_view vertSource, std::string_view fragSource, const std::vector<std::string>& defines = {});
+
+    // Non-blocking; nothing reaches GL until Poll(). Requests for a program
+    // that is already known return its existing request.
+    ShaderRequest Queue(const std::string& vertFile, const std::string& fragFile, const std::vector<std::string>& defines = {});
+    std::vector<ShaderRequest> QueueVariants(const std::string& vertFile, const std::string& fragFile);
+
+    // Issues queued compiles and collects finished programs; returns how
+    // many are still pending. Without parallel compile support finishing a
+    // program waits on the driver, so at most `blockingBudget` are finished
+    // per call.
+    std::size_t Poll(std::size_t blockingBudget = 4);
+
+    GLuint Program(ShaderRequest request) const { return requests[request].program; } // 0 until ready
+    bool IsPending(ShaderRequest request) const;
+    bool Failed(ShaderRequest request) const { return requests[request].state == State::Failed; }
+    const std::vector<std::string>& Defines(ShaderRequest request) const { return requests[request].defines; }
+
+    // Deletes every stage and program this library created.
+    void Clear();
+
+    const ShaderLibraryStats& GetStats() const { return stats; }
+
+private:
+    enum class State : uint8_t { Queued, Linking, Ready, Failed };
+
+    struct Request {
+        State state = State::Queued;
+        uint64_t key = 0;
+        std::vector<std::string> defines;
+        std::string vert, frag;     // released once issued
+        uint64_t vertHash = 0, fragHash = 0;
+        GLuint vertShader = 0, fragShader = 0;
+        GLuint program = 0;
+    };
+
+    const ShaderSource* Preprocessed(const std::string& file);
+    ShaderRequest Add(ShaderVariantSource&& variant);
+    void Issue(Request& request);
+    void Finish(Request& request);
+    GLuint Stage(GLenum type, const std::string& source, uint64_t hash);
+    GLuint LoadBinary(uint64_t key);
+    ShaderRequest QueueSources(const ShaderSource& vert, const ShaderSource& frag, const std::vector<std::string>& defines);
+
+    ShaderCache cache;
+    JobSystem* jobs = nullptr;
+    uint64_t driverHash = 0;
+    std::unordered_map<std::string, ShaderSource> sources;  // file -> preprocessed
+    std::unordered_map<uint64_t, GLuint> stages;            // (type, source) hash -> shader
+    std::unordered_map<uint64_t, ShaderRequest> byKey;      // program key -> request
+    std::vector<Request> requests;
+    std::vector<ShaderRequest> inFlight;                    // queued or linking
+    ShaderLibraryStats stats;
+};
@@ -0,0 +1,77 @@
+#include "ShaderProgram.hpp"
+#include "UniformBuffer.hpp"
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+
+ShaderProgram::ShaderProgram(GLBackend& gl, GLuint programId) : program(programId) {
+    if (program == 0) return;
+
+    GLint count = 0, maxLength = 0;
+    gl.GetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    gl.GetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::string name(static_cast<std::size_t>(std::max(maxLength, 1)), '\0');
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        gl.GetActiveUniform(program, static_cast<GLuint>(i), static_cast<GLsizei>(name.size()), &length, &size, &type, name.data());
+        std::string uniformName(name.data(), static_cast<std::size_t>(length));
+
+        // block members have no location; they are set through their buffer
+        const GLint location = gl.GetUniformLocation(program, uniformName.c_str());
+        if (location < 0) continue;
+        if (uniformName.ends_with("[0]")) uniformName.resize(uniformName.size() - 3);
+        uniforms.push_back({ std::move(uniformName), location, type, size });
+    }
+    std::sort(uniforms.begin(), uniforms.end(), [](const Uniform& a, const Uniform& b) { return a.name < b.name; });
+
+    GLint blockCount = 0;
+    gl.GetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+    gl.GetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+    name.assign(static_cast<std::size_t>(std::max(maxLength, 1)), '\0');
+    for (GLint i = 0; i < blockCount; ++i) {
+        const GLuint index = static_cast<GLuint>(i);
+        GLsizei length = 0;
+        GLint dataSize = 0;
+        gl.GetActiveUniformBlockName(program, index, static_cast<GLsizei>(name.size()), &length, name.data());
+        gl.GetActiveUniformBlockiv(program, index, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize);
+
+        Block block{ std::string(name.data(), static_cast<std::size_t>(length)), index, dataSize, -1 };
+        if (block.name == FrameBlockName) block.binding = UniformBinding::Frame;
+        if (block.name == ObjectBlockName) block.binding = UniformBinding::Object;
+        if (block.binding >= 0) gl.UniformBlockBinding(program, index, static_cast<GLuint>(block.binding));
+        blocks.push_back(std::move(block));
+    }
+}
+
+const ShaderProgram::Uniform* ShaderProgram::Find(std::string_view name) const {
+    auto it = std::lower_bound(uniforms.begin(), uniforms.end(), name,
+                               [](const Uniform& uniform, std::string_view key) { return uniform.name < key; });
+    return it != uniforms.end() && it->name == name ? &*it : nullptr;
+}
+
+GLint ShaderProgram::Location(std::string_view name) const {
+    const Uniform* uniform = Find(name);
+    return uniform ? uniform->location : -1;
+}
+
+const ShaderProgram::Block* ShaderProgram::FindBlock(std::string_view name) const {
+    auto it = std::find_if(blocks.begin(), blocks.end(), [name](const Block& block) { return block.name == name; });
+    return it != blocks.end() ? &*it : nullptr;
+}
+
+void ShaderProgram::Set(GLBackend& gl, GLint location, int value) {
+    if (location >= 0) gl.Uniform1i(location, value);
+}
+
+void ShaderProgram::Set(GLBackend& gl, GLint location, float value) {
+    if (location >= 0) gl.Uniform1f(location, value);
+}
+
+void ShaderProgram::Set(GLBackend& gl, GLint location, const glm::vec4& value) {
+    if (location >= 0) gl.Uniform4fv(location, 1, glm::value_ptr(value));
+}
+
+void ShaderProgram::Set(GLBackend& gl, GLint location, const glm::mat4& value) {
+    if (location >= 0) gl.UniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+}
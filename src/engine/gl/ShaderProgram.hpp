@@ -0,0 +1,71 @@
+/* A linked program plus what the driver reports about it.
+
+   Construction reflects the program once: every active uniform outside a
+   block with its location, type and array size, and every uniform block.
+   Blocks named like the engine's shared blocks (FrameData, ObjectData; see
+   UniformBuffer.hpp) are attached to their binding points right away, so
+   buffers bound there reach every program without further calls.
+
+   Location() is a binary search over the reflected names and never asks
+   the driver, so render code can look names up freely; hot paths should
+   still look a location up once and keep it. Array uniforms are listed
+   under their plain name ("uLights", not "uLights[0]").
+
+   Set() writes to the program in use (UseProgram first).
+
+example usage:
+
+ShaderProgram lit(gl, shaders.Load("lit.vert", "lit.frag"));
+const GLint exposure = lit.Location("uExposure");
+gl.UseProgram(lit.Id());
+lit.Set(gl, exposure, 1.5f); */
+#pragma once
+#include "GLBackend.hpp"
+#include <glm/glm.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class ShaderProgram {
+public:
+    struct Uniform {
+        std::string name;
+        GLint location;
+        GLenum type;
+        GLint size; // array length, 1 for non-arrays
+    };
+
+    struct Block {
+        std::string name;
+        GLuint index;
+        GLint dataSize;
+        GLint binding; // -1 unless it is one of the engine blocks
+    };
+
+    ShaderProgram() = default;
+    ShaderProgram(GLBackend& gl, GLuint program);
+
+    GLuint Id() const { return program; }
+
+    // -1 if the program has no such uniform (or it lives in a block).
+    GLint Location(std::string_view name) const;
+    const Uniform* Find(std::string_view name) const;
+    const Block* FindBlock(std::string_view name) const;
+
+    const std::vector<Uniform>& Uniforms() const { return uniforms; }
+    const std::vector<Block>& Blocks() const { return blocks; }
+
+    // No-ops for location -1, like glUniform*.
+    static void Set(GLBackend& gl, GLint location, int value);
+    static void Set(GLBackend& gl, GLint location, float value);
+    static void Set(GLBackend& gl, GLint location, const glm::vec4& value);
+    static void Set(GLBackend& gl, GLint location, const glm::mat4& value);
+
+    template<typename T>
+    void Set(GLBackend& gl, std::string_view name, const T& value) const { Set(gl, Location(name), value); }
+
+private:
+    GLuint program = 0;
+    std::vector<Uniform> uniforms; // sorted by name
+    std::vector<Block> blocks;
+};
@@ -0,0 +1,59 @@
+#include "UniformBuffer.hpp"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstring>
+
+void UniformBuffer::Update(GLBackend& gl, const void* data, std::size_t bytes) {
+    if (buffer == 0) gl.GenBuffers(1, &buffer);
+    gl.BindBuffer(GL_UNIFORM_BUFFER, buffer);
+    if (bytes != size) {
+        size = bytes;
+        gl.BufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(size), data, GL_DYNAMIC_DRAW);
+        return;
+    }
+    gl.BufferSubData(GL_UNIFORM_BUFFER, 0, static_cast<GLsizeiptr>(size), data);
+}
+
+void UniformBuffer::BindBase(GLBackend& gl, GLuint binding) const {
+    assert(buffer != 0 && "UniformBuffer::BindBase before Update.");
+    gl.BindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+}
+
+void UniformRing::BeginFrame(GLBackend& gl) {
+    if (alignment == 0) {
+        GLint queried = 0;
+        gl.GetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &queried);
+        // 256 is the largest alignment drivers report; safe when the query fails
+        alignment = queried > 0 ? static_cast<std::size_t>(queried) : 256;
+    }
+    segment = (segment + 1) % FramesInFlight;
+    staging.clear();
+}
+
+std::size_t UniformRing::Push(const void* data, std::size_t size) {
+    assert(alignment != 0 && "UniformRing::Push before BeginFrame.");
+    const std::size_t offset = (staging.size() + alignment - 1) / alignment * alignment;
+    staging.resize(offset + size);
+    std::memcpy(staging.data() + offset, data, size);
+    return offset;
+}
+
+void UniformRing::Upload(GLBackend& gl) {
+    if (staging.empty()) return;
+    if (buffer == 0) gl.GenBuffers(1, &buffer);
+    gl.BindBuffer(GL_UNIFORM_BUFFER, buffer);
+
+    if (staging.size() > segmentCapacity) {
+        // alignment is a power of two, so segment starts stay aligned
+        segmentCapacity = std::max(std::bit_ceil(staging.size()), alignment);
+        gl.BufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(segmentCapacity * FramesInFlight), nullptr, GL_DYNAMIC_DRAW);
+    }
+    gl.BufferSubData(GL_UNIFORM_BUFFER, static_cast<GLintptr>(SegmentOffset()),
+                     static_cast<GLsizeiptr>(staging.size()), staging.data());
+}
+
+void UniformRing::BindRange(GLBackend& gl, GLuint binding, std::size_t offset, std::size_t size) const {
+    gl.BindBufferRange(GL_UNIFORM_BUFFER, binding, buffer,
+                       static_cast<GLintptr>(SegmentOffset() + offset), static_cast<GLsizeiptr>(size));
+}
@@ -0,0 +1,103 @@
+/* Uniform buffers for the engine's shared uniform blocks.
+
+   Data every shader may read lives in std140 blocks declared in
+   shaders/engine.glsl, each on a fixed binding point (UniformBinding):
+
+     FrameData   camera matrices and time; one UniformBuffer, written once
+                 per frame and bound once with BindBufferBase.
+     ObjectData  per-draw model matrix and params; suballocated from a
+                 UniformRing and selected with BindBufferRange per draw.
+
+   The structs below mirror those blocks byte for byte; keep them in sync.
+   ShaderProgram attaches every program's blocks to these binding points
+   when it reflects the program, so no draw sets a uniform by name.
+
+   UniformRing splits its buffer into FramesInFlight segments and writes a
+   different one each frame, so the CPU never overwrites data the GPU may
+   still be reading from the previous frames. Pushes go to a CPU staging
+   copy and reach the buffer in a single BufferSubData.
+
+example usage:
+
+ring.BeginFrame(gl);
+const std::size_t offset = ring.Push(&object, sizeof(object));
+ring.Upload(gl);
+ring.BindRange(gl, UniformBinding::Object, offset, sizeof(object));
+gl.DrawElements(GL_TRIANGLES, mesh.count, GL_UNSIGNED_INT, nullptr); */
+#pragma once
+#include "GLBackend.hpp"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace UniformBinding {
+constexpr GLuint Frame = 0;
+constexpr GLuint Object = 1;
+}
+
+// layout(std140) uniform FrameData
+struct FrameUniforms {
+    glm::mat4 view{1.0f};
+    glm::mat4 projection{1.0f};
+    glm::mat4 viewProjection{1.0f};
+    glm::vec4 cameraPosition{0.0f}; // w unused
+    glm::vec4 time{0.0f};           // seconds since start, frame delta, frame index, 0
+};
+
+// layout(std140) uniform ObjectData
+struct ObjectUniforms {
+    glm::mat4 model{1.0f};
+    glm::vec4 params{1.0f};
+};
+
+static_assert(sizeof(FrameUniforms) == 224, "FrameUniforms must match the std140 FrameData block.");
+static_assert(sizeof(ObjectUniforms) == 80, "ObjectUniforms must match the std140 ObjectData block.");
+
+inline constexpr const char* FrameBlockName = "FrameData";
+inline constexpr const char* ObjectBlockName = "ObjectData";
+
+// A fixed-size block rewritten as a whole.
+class UniformBuffer {
+public:
+    // Replaces the contents; the first call allocates `size` bytes.
+    void Update(GLBackend& gl, const void* data, std::size_t size);
+    void BindBase(GLBackend& gl, GLuint binding) const;
+
+    GLuint Buffer() const { return buffer; }
+
+private:
+    GLuint buffer = 0;
+    std::size_t size = 0;
+};
+
+class UniformRing {
+public:
+    static constexpr std::size_t FramesInFlight = 3;
+
+    // Moves to the next segment and empties the staging copy.
+    void BeginFrame(GLBackend& gl);
+
+    // Copies `size` bytes to the staging copy and returns their offset in
+    // this frame's segment, aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.
+    std::size_t Push(const void* data, std::size_t size);
+
+    // Sends this frame's pushes to the GPU. When they do not fit a segment
+    // the buffer is reallocated with segments of the next power of two.
+    void Upload(GLBackend& gl);
+
+    // Binds `size` bytes at `offset` (as returned by Push) of this frame's segment.
+    void BindRange(GLBackend& gl, GLuint binding, std::size_t offset, std::size_t size) const;
+
+    GLuint Buffer() const { return buffer; }
+    std::size_t Alignment() const { return alignment; }
+    std::size_t SegmentCapacity() const { return segmentCapacity; }
+    std::size_t SegmentOffset() const { return segment * segmentCapacity; }
+    std::size_t Used() const { return staging.size(); }
+
+private:
+    GLuint buffer = 0;
+    std::size_t alignment = 0;      // queried on first BeginFrame
+    std::size_t segmentCapacity = 0; // bytes
+    std::size_t segment = 0;
+    std::vector<unsigned char> staging;
+};
@@ -1,4 +1,5 @@
 #include "Window.hpp"
+#include "../gl/GLExtensions.hpp"
 #include <iostream>
 #include <stdexcept>
 
@@ -32,6 +33,7 @@ Window::Window(int width, int height, const std::string& title) {
         glfwTerminate();
         throw std::runtime_error("Failed to initialize GLAD");
     }
+    glext::Load(glfwGetProcAddress);
 
     m_lastTime = glfwGetTime();
 }
@@ -55,6 +57,11 @@ void Window::SwapBuffers() const {
     glfwSwapBuffers(m_Window); 
 }
 
+void Window::SetVSync(bool enabled) const {
+    if (m_Window)
+        glfwSwapInterval(enabled ? 1 : 0);
+}
+
 
 float Window::GetDeltaTime()
 {
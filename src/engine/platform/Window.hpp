@@ -23,6 +23,8 @@ public:
     bool ShouldClose() const;
     void PollEvents() const;
     void SwapBuffers() const;
+    // Wait for vertical blank on swap (on by default).
+    void SetVSync(bool enabled) const;
 
     // Returns delta time (seconds) since last call.
     float GetDeltaTime();
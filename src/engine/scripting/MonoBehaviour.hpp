@@ -22,6 +22,10 @@ public:
     // Called every frame while the component is enabled. dt = delta time in seconds.
     virtual void Update(float dt) {}
 
+    // Called once per fixed simulation step, before the ECS simulation
+    // systems; dt is the fixed step. Gameplay and physics input go here.
+    virtual void FixedUpdate(float /*dt*/) {}
+
     // Optional hooks
     virtual void OnEnable() {}
     virtual void OnDisable() {}
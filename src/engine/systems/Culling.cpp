@@ -0,0 +1,261 @@
+#include "Culling.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define ENGINE_CULL_AVX 1
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define ENGINE_CULL_SSE 1
+#endif
+
+Frustum Frustum::FromMatrix(const glm::mat4& m) {
+    const glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    const glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    const glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    const glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    Frustum frustum{ { row3 + row0, row3 - row0, row3 + row2, row3 - row2, row3 + row1, row3 - row1 } };
+    for (glm::vec4& plane : frustum.planes)
+        plane /= glm::length(glm::vec3(plane));
+    return frustum;
+}
+
+bool Frustum::Intersects(const Aabb& box) const {
+    const glm::vec3 center = box.Center();
+    const glm::vec3 extents = box.Extents();
+    for (const glm::vec4& plane : planes) {
+        const glm::vec3 normal(plane);
+        if (glm::dot(normal, center) + plane.w + glm::dot(glm::abs(normal), extents) < 0.0f) return false;
+    }
+    return true;
+}
+
+void BoundsSoA::Clear() {
+    for (Column* column : { &minX, &minY, &minZ, &maxX, &maxY, &maxZ }) column->clear();
+}
+
+void BoundsSoA::Reserve(std::size_t count) {
+    for (Column* column : { &minX, &minY, &minZ, &maxX, &maxY, &maxZ }) column->reserve(count);
+}
+
+void BoundsSoA::Resize(std::size_t count) {
+    for (Column* column : { &minX, &minY, &minZ, &maxX, &maxY, &maxZ }) column->resize(count);
+}
+
+void BoundsSoA::Push(const Aabb& box) {
+    Resize(Size() + 1);
+    Set(Size() - 1, box);
+}
+
+void BoundsSoA::Set(std::size_t i, const Aabb& box) {
+    minX[i] = box.min.x; minY[i] = box.min.y; minZ[i] = box.min.z;
+    maxX[i] = box.max.x; maxY[i] = box.max.y; maxZ[i] = box.max.z;
+}
+
+// A box is outside when its corner furthest along a plane's normal (the
+// "positive vertex") is behind that plane. Which of min/max that corner
+// uses per axis depends only on the normal's signs, so the column to read
+// is picked once per plane and each plane costs three multiply-adds per box.
+// Lanes are compacted branch-free: every lane writes its index and only
+// visible lanes advance the output cursor.
+std::size_t CullBounds(const Frustum& frustum, const BoundsSoA& b, std::size_t begin, std::size_t end, uint32_t* out) {
+    const float* px[6];
+    const float* py[6];
+    const float* pz[6];
+    for (int p = 0; p < 6; ++p) {
+        const glm::vec4& plane = frustum.planes[p];
+        px[p] = plane.x >= 0.0f ? b.maxX.data() : b.minX.data();
+        py[p] = plane.y >= 0.0f ? b.maxY.data() : b.minY.data();
+        pz[p] = plane.z >= 0.0f ? b.maxZ.data() : b.minZ.data();
+    }
+
+    std::size_t count = 0;
+    std::size_t i = begin;
+
+#if defined(ENGINE_CULL_AVX)
+    __m256 nx[6], ny[6], nz[6], nw[6];
+    for (int p = 0; p < 6; ++p) {
+        const glm::vec4& plane = frustum.planes[p];
+        nx[p] = _mm256_set1_ps(plane.x);
+        ny[p] = _mm256_set1_ps(plane.y);
+        nz[p] = _mm256_set1_ps(plane.z);
+        nw[p] = _mm256_set1_ps(plane.w);
+    }
+    const __m256 zero = _mm256_setzero_ps();
+
+    for (; i + 8 <= end; i += 8) {
+        __m256 outside = zero;
+        for (int p = 0; p < 6; ++p) {
+            __m256 d = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(px[p] + i), nx[p]), nw[p]);
+            d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_loadu_ps(py[p] + i), ny[p]));
+            d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_loadu_ps(pz[p] + i), nz[p]));
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(d, zero, _CMP_LT_OQ));
+        }
+        const int visible = ~_mm256_movemask_ps(outside) & 0xFF;
+        for (int lane = 0; lane < 8; ++lane) {
+            out[count] = static_cast<uint32_t>(i + lane);
+            count += (visible >> lane) & 1;
+        }
+    }
+#elif defined(ENGINE_CULL_SSE)
+    __m128 nx[6], ny[6], nz[6], nw[6];
+    for (int p = 0; p < 6; ++p) {
+        const glm::vec4& plane = frustum.planes[p];
+        nx[p] = _mm_set1_ps(plane.x);
+        ny[p] = _mm_set1_ps(plane.y);
+        nz[p] = _mm_set1_ps(plane.z);
+        nw[p] = _mm_set1_ps(plane.w);
+    }
+    const __m128 zero = _mm_setzero_ps();
+
+    for (; i + 4 <= end; i += 4) {
+        __m128 outside = zero;
+        for (int p = 0; p < 6; ++p) {
+            __m128 d = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(px[p] + i), nx[p]), nw[p]);
+            d = _mm_add_ps(d, _mm_mul_ps(_mm_loadu_ps(py[p] + i), ny[p]));
+            d = _mm_add_ps(d, _mm_mul_ps(_mm_loadu_ps(pz[p] + i), nz[p]));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(d, zero));
+        }
+        const int visible = ~_mm_movemask_ps(outside) & 0xF;
+        out[count] = static_cast<uint32_t>(i);     count += visible & 1;
+        out[count] = static_cast<uint32_t>(i + 1); count += (visible >> 1) & 1;
+        out[count] = static_cast<uint32_t>(i + 2); count += (visible >> 2) & 1;
+        out[count] = static_cast<uint32_t>(i + 3); count += (visible >> 3) & 1;
+    }
+#endif
+
+    for (; i < end; ++i) {
+        bool inside = true;
+        for (int p = 0; p < 6; ++p) {
+            const glm::vec4& plane = frustum.planes[p];
+            inside = inside && px[p][i] * plane.x + py[p][i] * plane.y + pz[p][i] * plane.z + plane.w >= 0.0f;
+        }
+        out[count] = static_cast<uint32_t>(i);
+        count += inside;
+    }
+    return count;
+}
+
+void BoundsBvh::Clear() {
+    nodes.clear();
+    bounds.Clear();
+    ids.clear();
+}
+
+namespace {
+
+// Spreads the low 10 bits of v so there are two zero bits between each.
+uint32_t SpreadBits(uint32_t v) {
+    v = (v | (v << 16)) & 0x030000FF;
+    v = (v | (v << 8)) & 0x0300F00F;
+    v = (v | (v << 4)) & 0x030C30C3;
+    v = (v | (v << 2)) & 0x09249249;
+    return v;
+}
+
+}
+
+// Linear BVH: items are sorted along a 30-bit Morton curve of their centers
+// (radix sort, O(n)), and every node splits its range in the middle, so
+// spatially close items share subtrees. Node bounds are merged bottom-up.
+// Much cheaper to build than a SAH or median-split tree and good enough for
+// culling, where leaves are tested with SIMD anyway.
+void BoundsBvh::Build(std::span<const Aabb> boxes) {
+    Clear();
+    if (boxes.empty()) return;
+
+    glm::vec3 lo(std::numeric_limits<float>::max()), hi(-std::numeric_limits<float>::max());
+    for (const Aabb& box : boxes) {
+        lo = glm::min(lo, box.Center());
+        hi = glm::max(hi, box.Center());
+    }
+    const glm::vec3 scale = 1023.0f / glm::max(hi - lo, glm::vec3(1e-6f));
+
+    struct Item { uint32_t code, id; };
+    std::vector<Item> items(boxes.size()), scratch(boxes.size());
+    for (uint32_t i = 0; i < items.size(); ++i) {
+        const glm::uvec3 cell = glm::uvec3((boxes[i].Center() - lo) * scale);
+        items[i] = { SpreadBits(cell.x) | (SpreadBits(cell.y) << 1) | (SpreadBits(cell.z) << 2), i };
+    }
+    for (int shift = 0; shift < 32; shift += 8) {
+        uint32_t offsets[257] = {};
+        for (const Item& item : items) ++offsets[((item.code >> shift) & 0xFF) + 1];
+        for (int b = 1; b < 257; ++b) offsets[b] += offsets[b - 1];
+        for (const Item& item : items) scratch[offsets[(item.code >> shift) & 0xFF]++] = item;
+        items.swap(scratch);
+    }
+
+    ids.resize(items.size());
+    bounds.Resize(items.size());
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        ids[i] = items[i].id;
+        bounds.Set(i, boxes[items[i].id]);
+    }
+
+    nodes.reserve(2 * boxes.size() / LeafSize + 1);
+    Aabb root;
+    BuildNode(0, static_cast<uint32_t>(ids.size()), root);
+}
+
+uint32_t BoundsBvh::BuildNode(uint32_t first, uint32_t count, Aabb& nodeBounds) {
+    const uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back({});
+
+    if (count <= LeafSize) {
+        nodeBounds = { glm::vec3(std::numeric_limits<float>::max()), glm::vec3(-std::numeric_limits<float>::max()) };
+        for (uint32_t i = first; i < first + count; ++i) {
+            nodeBounds.min = glm::min(nodeBounds.min, glm::vec3(bounds.minX[i], bounds.minY[i], bounds.minZ[i]));
+            nodeBounds.max = glm::max(nodeBounds.max, glm::vec3(bounds.maxX[i], bounds.maxY[i], bounds.maxZ[i]));
+        }
+        nodes[index] = { nodeBounds.Center(), first, nodeBounds.Extents(), count, 0 };
+        return index;
+    }
+
+    Aabb left, right;
+    const uint32_t half = count / 2;
+    BuildNode(first, half, left);
+    const uint32_t rightIndex = BuildNode(first + half, count - half, right);
+    nodeBounds = { glm::min(left.min, right.min), glm::max(left.max, right.max) };
+    nodes[index] = { nodeBounds.Center(), first, nodeBounds.Extents(), count, rightIndex };
+    return index;
+}
+
+void BoundsBvh::Cull(const Frustum& frustum, std::vector<uint32_t>& visible) const {
+    if (nodes.empty()) return;
+
+    glm::vec3 absNormals[6];
+    for (int p = 0; p < 6; ++p) absNormals[p] = glm::abs(glm::vec3(frustum.planes[p]));
+
+    uint32_t stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+
+        bool outside = false, straddles = false;
+        for (int p = 0; p < 6 && !outside; ++p) {
+            const float d = glm::dot(glm::vec3(frustum.planes[p]), node.center) + frustum.planes[p].w;
+            const float r = glm::dot(absNormals[p], node.extents);
+            outside = d + r < 0.0f;
+            straddles = straddles || d - r < 0.0f;
+        }
+        if (outside) continue;
+
+        if (!straddles) {
+            // fully inside: take the whole subtree without further tests
+            visible.insert(visible.end(), ids.begin() + node.first, ids.begin() + node.first + node.count);
+        } else if (node.right == 0) {
+            const std::size_t base = visible.size();
+            visible.resize(base + node.count);
+            const std::size_t kept = CullBounds(frustum, bounds, node.first, node.first + node.count, visible.data() + base);
+            for (std::size_t i = base; i < base + kept; ++i) visible[i] = ids[visible[i]];
+            visible.resize(base + kept);
+        } else {
+            stack[top++] = node.right;
+            stack[top++] = static_cast<uint32_t>(&node - nodes.data()) + 1;
+        }
+    }
+}
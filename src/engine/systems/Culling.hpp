@@ -0,0 +1,84 @@
+/* Frustum culling over packed bounding boxes.
+
+   BoundsSoA stores boxes as separate min/max coordinate arrays so the kernel can
+   test 4 (SSE) or 8 (AVX) boxes per iteration against the six planes and
+   write a compact list of visible indices. BoundsBvh holds geometry that
+   does not move: whole subtrees are rejected (or accepted) with one test,
+   and only leaves that straddle a plane go through the SIMD kernel.
+
+example usage:
+
+const Frustum frustum = Frustum::FromMatrix(projection * view);
+visible.resize(bounds.Size());
+visible.resize(CullBounds(frustum, bounds, 0, bounds.Size(), visible.data()));
+staticBvh.Cull(frustum, staticVisible); */
+#pragma once
+#include "../utils/Aabb.hpp"
+#include "../utils/AlignedAllocator.hpp"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Six planes (left, right, near, far, bottom, top) with normals pointing
+// inwards: a point p is inside a plane when dot(normal, p) + d >= 0. The
+// order puts the planes that reject most in typical scenes first.
+struct Frustum {
+    glm::vec4 planes[6];
+
+    // Extracts the planes of a view-projection matrix (GL clip space).
+    static Frustum FromMatrix(const glm::mat4& viewProjection);
+
+    bool Intersects(const Aabb& box) const;
+};
+
+class BoundsSoA {
+public:
+    void Clear();
+    void Reserve(std::size_t count);
+    void Push(const Aabb& box);
+    void Set(std::size_t i, const Aabb& box);
+    void Resize(std::size_t count);
+
+    std::size_t Size() const { return minX.size(); }
+
+    using Column = std::vector<float, AlignedAllocator<float>>;
+    Column minX, minY, minZ;
+    Column maxX, maxY, maxZ;
+};
+
+// Writes the indices in [begin, end) of the boxes that intersect the frustum
+// to `out` (room for end - begin entries) and returns how many were written.
+std::size_t CullBounds(const Frustum& frustum, const BoundsSoA& bounds, std::size_t begin, std::size_t end, uint32_t* out);
+
+class BoundsBvh {
+public:
+    static constexpr uint32_t LeafSize = 16;
+
+    // Builds over `boxes`; item ids are positions in the span.
+    void Build(std::span<const Aabb> boxes);
+    void Clear();
+
+    // Appends the ids of the items that intersect the frustum.
+    void Cull(const Frustum& frustum, std::vector<uint32_t>& visible) const;
+
+    std::size_t Size() const { return ids.size(); }
+    std::size_t NodeCount() const { return nodes.size(); }
+
+private:
+    // Nodes are in depth-first order: the left child of node i is i + 1.
+    // Every node covers the items [first, first + count) of the BVH order.
+    struct Node {
+        glm::vec3 center;
+        uint32_t first;
+        glm::vec3 extents;
+        uint32_t count;
+        uint32_t right; // 0 for leaves
+    };
+
+    uint32_t BuildNode(uint32_t first, uint32_t count, Aabb& nodeBounds);
+
+    std::vector<Node> nodes;
+    BoundsSoA bounds;          // items in BVH order
+    std::vector<uint32_t> ids; // BVH order -> item id
+};
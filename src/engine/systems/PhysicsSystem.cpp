@@ -0,0 +1,382 @@
+#include "PhysicsSystem.hpp"
+#include "TransformSystem.hpp"
+#include "../ecs/ParallelFor.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <numeric>
+
+namespace {
+
+constexpr std::size_t BodyChunkSize = 4096;
+constexpr std::size_t CellChunkSize = 1024;
+constexpr std::size_t PairChunkSize = 4096;
+
+constexpr uint64_t NoKey = UINT64_MAX; // oversized bodies, sorted after every cell
+
+enum BodyFlags : uint8_t {
+    Dynamic = 1,   // has a Rigidbody
+    Trigger = 2,
+};
+
+// Cell coordinates are packed 21 bits per axis (x:y:z) with a bias, so keys
+// sort by x, then y, then z. They are clamped one cell inside that range, so
+// adding a neighbour offset to a key never carries into the next axis.
+constexpr float CellBias = float(1 << 20);
+constexpr float CellLimit = float(1 << 20) - 2.0f;
+
+uint64_t PackCell(const glm::vec3& cell) {
+    const glm::vec3 biased = glm::clamp(glm::floor(cell), glm::vec3(-CellLimit), glm::vec3(CellLimit)) + CellBias;
+    return (uint64_t(biased.x) << 42) | (uint64_t(biased.y) << 21) | uint64_t(biased.z);
+}
+
+constexpr uint64_t Offset(int64_t dx, int64_t dy, int64_t dz) {
+    return uint64_t(dx * (int64_t(1) << 42) + dy * (int64_t(1) << 21) + dz);
+}
+
+// The 13 of the 26 neighbours that come after a cell in key order, as five
+// key ranges [key + first, key + last]; the other 13 test against this cell
+// from their side.
+struct NeighbourRow {
+    uint64_t first;
+    uint64_t last;
+};
+
+constexpr NeighbourRow ForwardRows[] = {
+    { Offset(0, 0, 1), Offset(0, 0, 1) },
+    { Offset(0, 1, -1), Offset(0, 1, 1) },
+    { Offset(1, -1, -1), Offset(1, -1, 1) },
+    { Offset(1, 0, -1), Offset(1, 0, 1) },
+    { Offset(1, 1, -1), Offset(1, 1, 1) },
+};
+
+// ParallelChunks when there is a pool and enough work, otherwise one chunk
+// on the calling thread.
+template<typename Fn>
+void ForChunks(JobSystem* jobs, std::size_t count, std::size_t chunkSize, Fn&& fn) {
+    if (count == 0) return;
+    if (!jobs || count <= chunkSize) {
+        fn(ecs::ChunkContext{ 0, 0, count, 0 });
+        return;
+    }
+    ecs::ParallelChunks(*jobs, count, chunkSize, fn);
+}
+
+}
+
+PhysicsSystem::PhysicsSystem() {
+    Writes<Transform, Rigidbody>();
+    Reads<Collider>();
+}
+
+void PhysicsSystem::SetCellSize(float size) {
+    autoCellSize = size <= 0.0f;
+    if (!autoCellSize) cellSize = size;
+    builtVersion = UINT64_MAX; // re-measure or re-sort with the new size
+}
+
+void PhysicsSystem::Update(float dt) {
+    if (entities.Version() != builtVersion) Rebuild();
+
+    JobSystem* jobs = coordinator->GetJobSystem();
+    const std::size_t count = bodyEntity.size();
+    stats = {};
+    stats.bodies = count;
+    pairs.clear();
+    contacts.clear();
+    if (count == 0) return;
+
+    ForChunks(jobs, count, BodyChunkSize, [&](const ecs::ChunkContext& chunk) { Gather(dt, chunk.begin, chunk.end); });
+
+    SortByCell();
+    ForChunks(jobs, count, BodyChunkSize, [&](const ecs::ChunkContext& chunk) { Arrange(chunk.begin, chunk.end); });
+    BuildCells();
+    stats.cells = cells.size();
+    stats.oversized = count - gridCount;
+
+    threadPairs.resize(jobs ? jobs->ThreadCount() : 1);
+    for (ThreadPairs& thread : threadPairs) {
+        thread.pairs.clear();
+        thread.tested = 0;
+    }
+    ForChunks(jobs, cells.size(), CellChunkSize, [&](const ecs::ChunkContext& chunk) {
+        TestCells(threadPairs[chunk.thread], chunk.begin, chunk.end);
+    });
+    ForChunks(jobs, count - gridCount, 1, [&](const ecs::ChunkContext& chunk) {
+        TestOversized(threadPairs[chunk.thread], chunk.begin, chunk.end);
+    });
+
+    // merge, then put in body order: which thread found a pair is not deterministic
+    for (ThreadPairs& thread : threadPairs) {
+        pairs.insert(pairs.end(), thread.pairs.begin(), thread.pairs.end());
+        stats.pairsTested += thread.tested;
+    }
+    std::sort(pairs.begin(), pairs.end(), [](const Pair& x, const Pair& y) { return x.a != y.a ? x.a < y.a : x.b < y.b; });
+
+    contacts.resize(pairs.size());
+    ForChunks(jobs, pairs.size(), PairChunkSize, [&](const ecs::ChunkContext& chunk) { MakeContacts(chunk.begin, chunk.end); });
+    stats.contacts = contacts.size();
+
+    Resolve();
+    ForChunks(jobs, count, BodyChunkSize, [&](const ecs::ChunkContext& chunk) { WriteBack(chunk.begin, chunk.end); });
+}
+
+// The set of bodies changed: new columns, a full sort and, with the automatic
+// cell size, a new measurement.
+void PhysicsSystem::Rebuild() {
+    bodyEntity.assign(entities.begin(), entities.end());
+    const std::size_t count = bodyEntity.size();
+
+    for (Column* column : { &posX, &posY, &posZ, &velX, &velY, &velZ, &inverseMass, &restitution })
+        column->resize(count);
+    bounds.Resize(count);
+    sortedBounds.Resize(count);
+    flags.resize(count);
+    cellKey.resize(count);
+    sortedKey.resize(count);
+    sortedFlags.resize(count);
+
+    if (autoCellSize && count > 0) {
+        ecs::ComponentArray<Transform>& transforms = coordinator->GetComponentStorage<Transform>();
+        ecs::ComponentArray<Collider>& colliders = coordinator->GetComponentStorage<Collider>();
+        double total = 0.0;
+        for (ecs::Entity e : bodyEntity) {
+            const glm::vec3 size = 2.0f * colliders.GetData(e).halfExtents * glm::abs(transforms.GetData(e).scale);
+            total += std::max({ size.x, size.y, size.z });
+        }
+        const float average = float(total / double(count));
+        cellSize = average > 0.0f ? 2.0f * average : 1.0f;
+    }
+
+    resort = true;
+    builtVersion = entities.Version();
+}
+
+// Reads the components of bodies [begin, end), integrates the dynamic ones
+// and computes their boxes and cells.
+void PhysicsSystem::Gather(float dt, std::size_t begin, std::size_t end) {
+    ecs::ComponentArray<Transform>& transforms = coordinator->GetComponentStorage<Transform>();
+    ecs::ComponentArray<Collider>& colliders = coordinator->GetComponentStorage<Collider>();
+    ecs::ComponentArray<Rigidbody>& rigidbodies = coordinator->GetComponentStorage<Rigidbody>();
+    const float inverseCell = 1.0f / cellSize;
+
+    for (std::size_t i = begin; i < end; ++i) {
+        const ecs::Entity e = bodyEntity[i];
+        const Transform& transform = transforms.GetData(e);
+        const Collider& collider = colliders.GetData(e);
+
+        glm::vec3 position = transform.position;
+        glm::vec3 velocity{0.0f};
+        float bodyInverseMass = 0.0f;
+        float bodyRestitution = 0.0f;
+        uint8_t bodyFlags = collider.isTrigger ? Trigger : 0;
+        if (rigidbodies.HasData(e)) {
+            const Rigidbody& body = rigidbodies.GetData(e);
+            bodyFlags |= Dynamic;
+            velocity = body.velocity;
+            if (body.mass > 0.0f) {
+                bodyInverseMass = 1.0f / body.mass;
+                if (body.useGravity) velocity += gravity * dt;
+            }
+            bodyRestitution = body.restitution;
+            position += velocity * dt;
+        }
+
+        posX[i] = position.x; posY[i] = position.y; posZ[i] = position.z;
+        velX[i] = velocity.x; velY[i] = velocity.y; velZ[i] = velocity.z;
+        inverseMass[i] = bodyInverseMass;
+        restitution[i] = bodyRestitution;
+        flags[i] = bodyFlags;
+
+        const glm::vec3 half = collider.halfExtents * glm::abs(transform.scale);
+        const glm::vec3 center = position + collider.offset * transform.scale;
+        bounds.minX[i] = center.x - half.x; bounds.maxX[i] = center.x + half.x;
+        bounds.minY[i] = center.y - half.y; bounds.maxY[i] = center.y + half.y;
+        bounds.minZ[i] = center.z - half.z; bounds.maxZ[i] = center.z + half.z;
+
+        // a box no wider than a cell only overlaps boxes whose centres are in
+        // the same or a neighbouring cell
+        const bool fits = std::max({ half.x, half.y, half.z }) * 2.0f <= cellSize;
+        cellKey[i] = fits ? PackCell(center * inverseCell) : NoKey;
+    }
+}
+
+// Orders the bodies by (cell, body). Between steps most bodies keep their
+// cell, so last step's order is nearly sorted and insertion sort touches
+// little more than the bodies that moved; after a rebuild, or when many
+// bodies changed cell, it is a full sort.
+void PhysicsSystem::SortByCell() {
+    const std::size_t count = bodyEntity.size();
+    const auto less = [&](uint32_t x, uint32_t y) { return cellKey[x] != cellKey[y] ? cellKey[x] < cellKey[y] : x < y; };
+
+    std::size_t moved = 0;
+    if (!resort) {
+        for (std::size_t i = 0; i < count; ++i) moved += cellKey[i] != previousKey[i];
+    }
+
+    if (resort || moved * 16 > count) {
+        order.resize(count);
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), less);
+        resort = false;
+        stats.resorted = true;
+    } else {
+        for (std::size_t i = 1; i < count; ++i) {
+            const uint32_t body = order[i];
+            std::size_t j = i;
+            for (; j > 0 && less(body, order[j - 1]); --j) order[j] = order[j - 1];
+            order[j] = body;
+        }
+    }
+    previousKey = cellKey;
+}
+
+// Copies keys, flags and boxes into sorted order so the cell tests read
+// them sequentially.
+void PhysicsSystem::Arrange(std::size_t begin, std::size_t end) {
+    for (std::size_t k = begin; k < end; ++k) {
+        const uint32_t body = order[k];
+        sortedKey[k] = cellKey[body];
+        sortedFlags[k] = flags[body];
+        sortedBounds.minX[k] = bounds.minX[body]; sortedBounds.maxX[k] = bounds.maxX[body];
+        sortedBounds.minY[k] = bounds.minY[body]; sortedBounds.maxY[k] = bounds.maxY[body];
+        sortedBounds.minZ[k] = bounds.minZ[body]; sortedBounds.maxZ[k] = bounds.maxZ[body];
+    }
+}
+
+void PhysicsSystem::BuildCells() {
+    const std::size_t count = sortedKey.size();
+    cells.clear();
+    std::size_t k = 0;
+    for (; k < count && sortedKey[k] != NoKey; ++k) {
+        if (cells.empty() || cells.back().key != sortedKey[k])
+            cells.push_back({ sortedKey[k], uint32_t(k), uint32_t(k) });
+        cells.back().end = uint32_t(k + 1);
+    }
+    gridCount = uint32_t(k);
+}
+
+// i and j are positions in sorted order.
+void PhysicsSystem::TestPair(ThreadPairs& out, uint32_t i, uint32_t j) const {
+    if (!((sortedFlags[i] | sortedFlags[j]) & Dynamic)) return;
+    ++out.tested;
+    const BoundsSoA& b = sortedBounds;
+    if (b.minX[i] > b.maxX[j] || b.minX[j] > b.maxX[i] ||
+        b.minY[i] > b.maxY[j] || b.minY[j] > b.maxY[i] ||
+        b.minZ[i] > b.maxZ[j] || b.minZ[j] > b.maxZ[i]) return;
+    const uint32_t x = order[i];
+    const uint32_t y = order[j];
+    out.pairs.push_back(x < y ? Pair{ x, y } : Pair{ y, x });
+}
+
+// Cells [begin, end) against themselves and their forward neighbours. The
+// neighbour rows' key ranges grow with the cell's key, so each row is found
+// by a cursor that only moves forward through `cells`: no lookups, and the
+// whole pass reads `cells` sequentially.
+void PhysicsSystem::TestCells(ThreadPairs& out, std::size_t begin, std::size_t end) const {
+    constexpr std::size_t RowCount = std::size(ForwardRows);
+    std::size_t cursor[RowCount];
+    for (std::size_t row = 0; row < RowCount; ++row) {
+        const uint64_t first = cells[begin].key + ForwardRows[row].first;
+        cursor[row] = std::partition_point(cells.begin() + begin, cells.end(),
+                                           [&](const Cell& cell) { return cell.key < first; }) - cells.begin();
+    }
+
+    for (std::size_t c = begin; c < end; ++c) {
+        const Cell& cell = cells[c];
+        for (uint32_t i = cell.begin; i < cell.end; ++i)
+            for (uint32_t j = i + 1; j < cell.end; ++j) TestPair(out, i, j);
+
+        for (std::size_t row = 0; row < RowCount; ++row) {
+            const uint64_t first = cell.key + ForwardRows[row].first;
+            const uint64_t last = cell.key + ForwardRows[row].last;
+            std::size_t n = cursor[row];
+            while (n < cells.size() && cells[n].key < first) ++n;
+            cursor[row] = n;
+            for (; n < cells.size() && cells[n].key <= last; ++n)
+                for (uint32_t i = cell.begin; i < cell.end; ++i)
+                    for (uint32_t j = cells[n].begin; j < cells[n].end; ++j) TestPair(out, i, j);
+        }
+    }
+}
+
+// [begin, end) counts from gridCount: each oversized body against every
+// grid body and against the oversized bodies after it.
+void PhysicsSystem::TestOversized(ThreadPairs& out, std::size_t begin, std::size_t end) const {
+    const uint32_t count = uint32_t(sortedKey.size());
+    for (std::size_t k = gridCount + begin; k < gridCount + end; ++k) {
+        const uint32_t i = uint32_t(k);
+        for (uint32_t j = 0; j < gridCount; ++j) TestPair(out, i, j);
+        for (uint32_t j = i + 1; j < count; ++j) TestPair(out, i, j);
+    }
+}
+
+// Contact normal along the axis of least overlap, pointing from a to b.
+void PhysicsSystem::MakeContacts(std::size_t begin, std::size_t end) {
+    for (std::size_t k = begin; k < end; ++k) {
+        const uint32_t a = pairs[k].a;
+        const uint32_t b = pairs[k].b;
+        const glm::vec3 minA{ bounds.minX[a], bounds.minY[a], bounds.minZ[a] };
+        const glm::vec3 maxA{ bounds.maxX[a], bounds.maxY[a], bounds.maxZ[a] };
+        const glm::vec3 minB{ bounds.minX[b], bounds.minY[b], bounds.minZ[b] };
+        const glm::vec3 maxB{ bounds.maxX[b], bounds.maxY[b], bounds.maxZ[b] };
+        const glm::vec3 overlap = glm::min(maxA, maxB) - glm::max(minA, minB);
+        const glm::vec3 towardsB = (minB + maxB) - (minA + maxA);
+
+        int axis = 0;
+        if (overlap.y < overlap[axis]) axis = 1;
+        if (overlap.z < overlap[axis]) axis = 2;
+        glm::vec3 normal{0.0f};
+        normal[axis] = towardsB[axis] < 0.0f ? -1.0f : 1.0f;
+
+        contacts[k] = Contact{ bodyEntity[a], bodyEntity[b], normal, overlap[axis],
+                               ((flags[a] | flags[b]) & Trigger) != 0 };
+    }
+}
+
+// Sequential, in contact order: pushes the bodies apart in proportion to
+// their inverse mass and removes the approaching normal velocity.
+void PhysicsSystem::Resolve() {
+    for (std::size_t k = 0; k < contacts.size(); ++k) {
+        const Contact& contact = contacts[k];
+        if (contact.trigger) continue;
+        const uint32_t a = pairs[k].a;
+        const uint32_t b = pairs[k].b;
+        const float massA = inverseMass[a];
+        const float massB = inverseMass[b];
+        const float total = massA + massB;
+        if (total == 0.0f) continue;
+
+        const glm::vec3 n = contact.normal;
+        const glm::vec3 correction = n * (contact.depth / total);
+        posX[a] -= correction.x * massA; posY[a] -= correction.y * massA; posZ[a] -= correction.z * massA;
+        posX[b] += correction.x * massB; posY[b] += correction.y * massB; posZ[b] += correction.z * massB;
+
+        const glm::vec3 velocityA{ velX[a], velY[a], velZ[a] };
+        const glm::vec3 velocityB{ velX[b], velY[b], velZ[b] };
+        const float approach = glm::dot(velocityB - velocityA, n);
+        if (approach >= 0.0f) continue;
+        const float impulse = -(1.0f + std::max(restitution[a], restitution[b])) * approach / total;
+        const glm::vec3 newA = velocityA - n * (impulse * massA);
+        const glm::vec3 newB = velocityB + n * (impulse * massB);
+        velX[a] = newA.x; velY[a] = newA.y; velZ[a] = newA.z;
+        velX[b] = newB.x; velY[b] = newB.y; velZ[b] = newB.z;
+    }
+}
+
+void PhysicsSystem::WriteBack(std::size_t begin, std::size_t end) {
+    ecs::ComponentArray<Transform>& transforms = coordinator->GetComponentStorage<Transform>();
+    ecs::ComponentArray<Rigidbody>& rigidbodies = coordinator->GetComponentStorage<Rigidbody>();
+
+    for (std::size_t i = begin; i < end; ++i) {
+        if (!(flags[i] & Dynamic)) continue;
+        const ecs::Entity e = bodyEntity[i];
+        rigidbodies.GetData(e).velocity = glm::vec3(velX[i], velY[i], velZ[i]);
+
+        Transform& transform = transforms.GetData(e);
+        const glm::vec3 position{ posX[i], posY[i], posZ[i] };
+        if (position == transform.position) continue;
+        transform.position = position;
+        if (transformSystem) transformSystem->MarkDirty(e);
+    }
+}
@@ -0,0 +1,151 @@
+/* Rigid bodies with axis-aligned box colliders: Euler integration, a grid
+   broadphase, contact resolution and a per-step contact list.
+
+   Each Update(dt) works on SoA copies of the bodies' state (one column per
+   field, indexed by body):
+
+     1. gather: position, velocity and collider are read from the components,
+        dynamic bodies take a semi-implicit Euler step, and each body's world
+        box and grid cell are computed (parallel over bodies);
+     2. broadphase: bodies are kept sorted by cell. The order from the last
+        step is re-sorted by insertion, which is close to linear while bodies
+        stay in or near their cells; boxes larger than a cell are kept out of
+        the grid. Every occupied cell tests its bodies against each other and
+        against its 13 forward neighbours, so every pair is tested once
+        (parallel over cells; cells are sorted too, so the neighbours are
+        found by cursors moving through them, not by lookups). The overlapping pairs go to per-thread lists
+        and are merged and sorted after the pass, so the result does not
+        depend on the thread count;
+     3. narrowphase: normal and depth of every pair (parallel over pairs);
+     4. the contacts are resolved in order (position correction and a
+        restitution impulse) and positions and velocities are written back;
+        moved transforms are marked dirty in the TransformSystem, if set.
+
+   The system's signature must include Transform and Collider; a Rigidbody
+   makes an entity dynamic, and Rigidbody must be registered even if no
+   entity has one. Transform::position is used as the world position, so
+   bodies should be hierarchy roots. Pairs where neither body has a Rigidbody
+   are not tested.
+
+example usage:
+
+coordinator.RegisterComponent<Rigidbody>();
+coordinator.RegisterComponent<Collider>();
+auto physics = coordinator.RegisterSystem<PhysicsSystem>();
+coordinator.SetSystemSignature<PhysicsSystem>(ecs::Signature::Of<Transform, Collider>());
+physics->SetTransformSystem(transforms.get());
+...
+physics->Update(fixedDt);
+for (const Contact& contact : physics->Contacts()) OnHit(contact.a, contact.b); */
+#pragma once
+#include "Culling.hpp"
+#include "../ecs/Coordinator.hpp"
+#include "../components/Collider.hpp"
+#include "../components/Rigidbody.hpp"
+#include "../components/Transform.hpp"
+#include "../utils/AlignedAllocator.hpp"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class TransformSystem;
+
+struct Contact {
+    ecs::Entity a;
+    ecs::Entity b;
+    glm::vec3 normal;   // from a towards b
+    float depth;        // overlap along the normal
+    bool trigger;       // one of the colliders is a trigger: reported, not resolved
+};
+
+struct PhysicsStats {
+    std::size_t bodies = 0;
+    std::size_t oversized = 0;    // boxes larger than a cell, tested against every body
+    std::size_t cells = 0;        // occupied grid cells
+    std::size_t pairsTested = 0;  // box-box tests in the broadphase
+    std::size_t contacts = 0;
+    bool resorted = false;        // the grid order was rebuilt instead of updated
+};
+
+class PhysicsSystem : public ecs::System {
+public:
+    PhysicsSystem();
+
+    void Update(float dt) override;
+
+    void SetGravity(const glm::vec3& value) { gravity = value; }
+    // Edge length of a grid cell. 0 (the default) uses twice the average box
+    // size, measured again whenever the set of bodies changes.
+    void SetCellSize(float size);
+    void SetTransformSystem(TransformSystem* system) { transformSystem = system; }
+
+    // Every overlapping pair of the last Update, sorted by body.
+    std::span<const Contact> Contacts() const { return contacts; }
+    const PhysicsStats& GetStats() const { return stats; }
+    float GetCellSize() const { return cellSize; }
+
+private:
+    struct Pair {
+        uint32_t a; // body indices, a < b
+        uint32_t b;
+    };
+
+    // A run of bodies in `order` that share a grid cell.
+    struct Cell {
+        uint64_t key;
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    // Broadphase output of one thread; merged after the pass.
+    struct alignas(CacheLineSize) ThreadPairs {
+        std::vector<Pair> pairs;
+        std::size_t tested = 0;
+    };
+
+    void Rebuild();
+    void Gather(float dt, std::size_t begin, std::size_t end);
+    void SortByCell();
+    void Arrange(std::size_t begin, std::size_t end);
+    void BuildCells();
+    void TestPair(ThreadPairs& out, uint32_t i, uint32_t j) const;
+    void TestCells(ThreadPairs& out, std::size_t begin, std::size_t end) const;
+    void TestOversized(ThreadPairs& out, std::size_t begin, std::size_t end) const;
+    void MakeContacts(std::size_t begin, std::size_t end);
+    void Resolve();
+    void WriteBack(std::size_t begin, std::size_t end);
+
+    using Column = std::vector<float, AlignedAllocator<float>>;
+
+    // Per body, in `entities` order as of the last Rebuild.
+    std::vector<ecs::Entity> bodyEntity;
+    Column posX, posY, posZ;
+    Column velX, velY, velZ;
+    Column inverseMass, restitution;
+    BoundsSoA bounds;
+    std::vector<uint8_t> flags;
+    std::vector<uint64_t> cellKey;
+    std::vector<uint64_t> previousKey;
+
+    // Bodies sorted by (cell, body), and their boxes in that order. Oversized
+    // bodies have no cell and come last, from gridCount on.
+    std::vector<uint32_t> order;
+    std::vector<uint64_t> sortedKey;
+    std::vector<uint8_t> sortedFlags;
+    BoundsSoA sortedBounds;
+    uint32_t gridCount = 0;
+    std::vector<Cell> cells;          // occupied cells, in key order
+
+    std::vector<ThreadPairs, AlignedAllocator<ThreadPairs>> threadPairs;
+    std::vector<Pair> pairs;
+    std::vector<Contact> contacts;
+
+    glm::vec3 gravity{0.0f, -9.81f, 0.0f};
+    float cellSize = 1.0f;
+    bool autoCellSize = true;
+    bool resort = true;
+    uint64_t builtVersion = UINT64_MAX;
+    TransformSystem* transformSystem = nullptr;
+    PhysicsStats stats;
+};
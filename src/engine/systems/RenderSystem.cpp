@@ -0,0 +1,292 @@
+#include "RenderSystem.hpp"
+#include "TransformSystem.hpp"
+#include "../gl/GLContext.hpp"
+#include "../assets/ResidencyManager.hpp"
+#include <algorithm>
+
+RenderSystem::RenderSystem() : gl(&GLContext::Instance()) {
+    Reads<Transform, MeshRenderer, Camera>();
+    RunOnMainThread(); // owns the GL context
+    RunPerFrame();
+}
+
+MeshHandle RenderSystem::AddMesh(const Mesh& mesh) {
+    meshes.push_back(mesh);
+    meshAssets.emplace_back();
+    meshMissing.push_back(0);
+    meshScreenSize.push_back(0.0f);
+    return static_cast<MeshHandle>(meshes.size() - 1);
+}
+
+// Unbounded until the asset is first resolved.
+MeshHandle RenderSystem::AddMesh(Asset<MeshAsset> mesh) {
+    const MeshHandle handle = AddMesh(Mesh{});
+    meshAssets[handle] = std::move(mesh);
+    meshMissing[handle] = 1;
+    streaming = true;
+    return handle;
+}
+
+MaterialHandle RenderSystem::AddMaterial(const Material& material) {
+    auto it = std::find(shaderPrograms.begin(), shaderPrograms.end(), material.program);
+    if (it == shaderPrograms.end()) it = shaderPrograms.insert(shaderPrograms.end(), material.program);
+    materialShader.push_back(static_cast<uint32_t>(it - shaderPrograms.begin()));
+
+    materials.push_back(material);
+    textureAssets.emplace_back();
+    materialScreenSize.push_back(0.0f);
+    return static_cast<MaterialHandle>(materials.size() - 1);
+}
+
+MaterialHandle RenderSystem::AddMaterial(const Material& material, Asset<TextureAsset> texture) {
+    const MaterialHandle handle = AddMaterial(material);
+    textureAssets[handle] = std::move(texture);
+    streaming = true;
+    return handle;
+}
+
+void RenderSystem::SetView(const glm::mat4& viewMatrix, float nearDistance, float farDistance) {
+    view = viewMatrix;
+    nearPlane = nearDistance;
+    farPlane = farDistance;
+}
+
+void RenderSystem::SetTransformSystem(TransformSystem* system) {
+    if (transformSystem && system != transformSystem)
+        for (ecs::Entity entity : published) transformSystem->SetLocalBounds(entity, Aabb{});
+    publishedSet.Clear();
+    published.clear();
+    transformSystem = system;
+    InvalidateBounds();
+}
+
+// Splits the drawables into static, moving and unbounded ones. Runs only
+// when the system's entity set (or the TransformSystem's layout) changed;
+// the static BVH is rebuilt only if the static subset itself differs.
+void RenderSystem::Partition() {
+    partitionVersion = entities.Version();
+    ecs::ComponentArray<MeshRenderer>& renderers = coordinator->GetComponentStorage<MeshRenderer>();
+
+    dynamicEntities.clear();
+    unboundedEntities.clear();
+    std::vector<ecs::Entity> statics;
+    for (ecs::Entity entity : entities) {
+        const MeshRenderer& renderer = renderers.GetData(entity);
+        if (!meshes[renderer.mesh].bounds.IsFinite())
+            unboundedEntities.push_back(entity);
+        else
+            (renderer.isStatic ? statics : dynamicEntities).push_back(entity);
+    }
+    if (transformSystem) PublishBounds(dynamicEntities);
+
+    if (!staticDirty && statics.size() == staticSet.size()
+        && std::all_of(statics.begin(), statics.end(), [&](ecs::Entity e) { return staticSet.Contains(e); }))
+        return;
+
+    staticDirty = false;
+    staticEntities = std::move(statics);
+    staticSet.Clear();
+    staticSet.InsertRange(staticEntities.data(), staticEntities.size());
+
+    ecs::ComponentArray<Transform>& transforms = coordinator->GetComponentStorage<Transform>();
+    std::vector<Aabb> boxes;
+    boxes.reserve(staticEntities.size());
+    for (ecs::Entity entity : staticEntities)
+        boxes.push_back(meshes[renderers.GetData(entity).mesh].bounds.Transformed(transforms.GetData(entity).world));
+    staticBvh.Build(boxes);
+}
+
+// Hands the moving drawables' mesh bounds to the TransformSystem, which
+// keeps their world boxes from then on, and takes back those of drawables
+// that left. Entities it has no node for yet stay in `moving`, to be packed
+// per frame until its next relayout re-runs Partition.
+void RenderSystem::PublishBounds(std::vector<ecs::Entity>& moving) {
+    transformLayout = transformSystem->LayoutVersion();
+    ecs::ComponentArray<MeshRenderer>& renderers = coordinator->GetComponentStorage<MeshRenderer>();
+
+    std::vector<ecs::Entity> kept;
+    const std::vector<ecs::Entity> previous = std::move(published);
+    published.clear();
+    publishedSet.Clear();
+    for (ecs::Entity entity : moving) {
+        if (!transformSystem->HasNode(entity)) {
+            kept.push_back(entity);
+            continue;
+        }
+        transformSystem->SetLocalBounds(entity, meshes[renderers.GetData(entity).mesh].bounds);
+        published.push_back(entity);
+    }
+    publishedSet.InsertRange(published.data(), published.size());
+    for (ecs::Entity entity : previous)
+        if (!publishedSet.Contains(entity)) transformSystem->SetLocalBounds(entity, Aabb{});
+    moving = std::move(kept);
+}
+
+const glm::mat4& RenderSystem::WorldOf(ecs::Entity entity, const Transform& transform) const {
+    return transformSystem ? transformSystem->RenderMatrix(entity, transform) : transform.world;
+}
+
+void RenderSystem::Emit(const glm::mat4& world, const MeshRenderer& renderer) {
+    if (streaming) {
+        Track(world, renderer);
+        if (meshMissing[renderer.mesh]) {
+            ++notResident;
+            return;
+        }
+    }
+    // view-space depth of the object origin is enough to order whole draws
+    const float distance = -(view[0][2] * world[3].x + view[1][2] * world[3].y
+                           + view[2][2] * world[3].z + view[3][2]);
+    const float depth01 = (distance - nearPlane) / (farPlane - nearPlane);
+    const uint32_t shader = materialShader[renderer.material];
+
+    const uint64_t key = materials[renderer.material].transparent
+        ? RenderQueue::TransparentKey(renderer.layer, shader, renderer.material, renderer.mesh, depth01)
+        : RenderQueue::OpaqueKey(renderer.layer, shader, renderer.material, renderer.mesh, depth01);
+    queue.Push({ key, &world, renderer.mesh, renderer.material, &renderer.params });
+}
+
+// Bounding sphere of the mesh at `world`, projected; entities with unknown
+// bounds count as filling the view.
+void RenderSystem::Track(const glm::mat4& world, const MeshRenderer& renderer) {
+    const Aabb& bounds = meshes[renderer.mesh].bounds;
+    float size = viewportHeight;
+    if (bounds.IsFinite()) {
+        const glm::vec3 center = glm::vec3(world * glm::vec4(bounds.Center(), 1.0f));
+        const float scale = std::sqrt(std::max({ glm::dot(glm::vec3(world[0]), glm::vec3(world[0])),
+                                                 glm::dot(glm::vec3(world[1]), glm::vec3(world[1])),
+                                                 glm::dot(glm::vec3(world[2]), glm::vec3(world[2])) }));
+        size = ProjectedSize(glm::length(bounds.Extents()) * scale, glm::length(center - eye), tanHalfFovY, viewportHeight);
+    }
+    meshScreenSize[renderer.mesh] = std::max(meshScreenSize[renderer.mesh], size);
+    materialScreenSize[renderer.material] = std::max(materialScreenSize[renderer.material], size);
+}
+
+void RenderSystem::BeginTracking() {
+    if (!streaming) return;
+    eye = glm::vec3(glm::inverse(view)[3]);
+    tanHalfFovY = 1.0f / projection[1][1];
+}
+
+// Picks up the GL objects streaming left the assets with this frame. Mesh
+// bounds are kept while a mesh is evicted, so it is still culled, and
+// touched, like a resident one.
+void RenderSystem::ResolveAssets() {
+    for (std::size_t i = 0; i < meshAssets.size(); ++i) {
+        if (!meshAssets[i]) continue;
+        const MeshAsset* asset = meshAssets[i].Get();
+        meshMissing[i] = asset == nullptr;
+        if (!asset) continue;
+        const Aabb bounds = meshes[i].bounds;
+        meshes[i] = asset->mesh;
+        if (bounds.min != meshes[i].bounds.min || bounds.max != meshes[i].bounds.max) {
+            InvalidateBounds();
+            InvalidateStatic();
+        }
+    }
+    for (std::size_t i = 0; i < textureAssets.size(); ++i) {
+        if (!textureAssets[i]) continue;
+        const TextureAsset* asset = textureAssets[i].Get();
+        materials[i].texture = asset ? asset->texture : 0;
+    }
+}
+
+void RenderSystem::TouchAssets() {
+    for (std::size_t i = 0; i < meshAssets.size(); ++i) {
+        if (meshScreenSize[i] > 0.0f) meshAssets[i].Touch(meshScreenSize[i]);
+        meshScreenSize[i] = 0.0f;
+    }
+    for (std::size_t i = 0; i < textureAssets.size(); ++i) {
+        if (materialScreenSize[i] > 0.0f) textureAssets[i].Touch(materialScreenSize[i]);
+        materialScreenSize[i] = 0.0f;
+    }
+}
+
+// Reflects programs added since the last frame, writes FrameData and draws
+// the queue.
+void RenderSystem::Submit(float dt) {
+    while (programs.size() < shaderPrograms.size())
+        programs.emplace_back(*gl, shaderPrograms[programs.size()]);
+
+    frameUniforms.view = view;
+    frameUniforms.projection = projection;
+    frameUniforms.viewProjection = projection * view;
+    frameUniforms.cameraPosition = glm::vec4(glm::vec3(glm::inverse(view)[3]), 1.0f);
+    frameUniforms.time = glm::vec4(frameUniforms.time.x + dt, dt, frameUniforms.time.z + 1.0f, 0.0f);
+    frameBuffer.Update(*gl, &frameUniforms, sizeof(frameUniforms));
+    frameBuffer.BindBase(*gl, UniformBinding::Frame);
+
+    if (streaming) TouchAssets();
+    queue.Sort();
+    stats = queue.Submit(*gl, meshes, materials);
+    stats.notResident = notResident;
+}
+
+void RenderSystem::Update(float dt) {
+    ecs::ComponentArray<Transform>& transforms = coordinator->GetComponentStorage<Transform>();
+    ecs::ComponentArray<MeshRenderer>& renderers = coordinator->GetComponentStorage<MeshRenderer>();
+    queue.Clear();
+    queue.Reserve(entities.size());
+    notResident = 0;
+    if (streaming) ResolveAssets();
+
+    const bool culling = cameraEntity.IsValid() && coordinator->IsAlive(cameraEntity);
+    if (!culling) {
+        BeginTracking();
+        for (ecs::Entity entity : entities) Emit(WorldOf(entity, transforms.GetData(entity)), renderers.GetData(entity));
+        Submit(dt);
+        return;
+    }
+
+    const Camera& camera = coordinator->GetComponent<Camera>(cameraEntity);
+    // the interpolated matrix, like every drawable, so a camera following a
+    // simulated body does not judder against it
+    SetView(Camera::ViewMatrix(WorldOf(cameraEntity, transforms.GetData(cameraEntity))), camera.nearPlane, camera.farPlane);
+    projection = camera.ProjectionMatrix();
+    const Frustum frustum = Frustum::FromMatrix(projection * view);
+    BeginTracking();
+
+    if (entities.Version() != partitionVersion || staticDirty
+        || (transformSystem && transformSystem->LayoutVersion() != transformLayout))
+        Partition();
+
+    for (ecs::Entity entity : unboundedEntities) Emit(WorldOf(entity, transforms.GetData(entity)), renderers.GetData(entity));
+
+    // moving drawables the TransformSystem keeps boxes for: one SIMD sweep
+    // over its bounds, no gather (nodes without bounds never pass)
+    if (transformSystem && !published.empty()) {
+        const BoundsSoA& bounds = transformSystem->GetWorldBounds();
+        visible.resize(bounds.Size());
+        visible.resize(CullBounds(frustum, bounds, 0, bounds.Size(), visible.data()));
+        for (uint32_t node : visible) {
+            const ecs::Entity entity = transformSystem->NodeEntity(node);
+            if (publishedSet.Contains(entity)) Emit(transformSystem->NodeRenderMatrix(node), renderers.GetData(entity));
+        }
+    }
+
+    // the other moving drawables: pack world bounds, cull them in one SIMD sweep
+    dynamicBounds.Resize(dynamicEntities.size());
+    dynamicCandidates.clear();
+    for (ecs::Entity entity : dynamicEntities) {
+        const glm::mat4& world = WorldOf(entity, transforms.GetData(entity));
+        dynamicBounds.Set(dynamicCandidates.size(), meshes[renderers.GetData(entity).mesh].bounds.Transformed(world));
+        dynamicCandidates.push_back(entity);
+    }
+
+    visible.resize(dynamicCandidates.size());
+    visible.resize(CullBounds(frustum, dynamicBounds, 0, dynamicCandidates.size(), visible.data()));
+    for (uint32_t i : visible) {
+        const ecs::Entity entity = dynamicCandidates[i];
+        Emit(WorldOf(entity, transforms.GetData(entity)), renderers.GetData(entity));
+    }
+
+    visible.clear();
+    staticBvh.Cull(frustum, visible);
+    for (uint32_t id : visible) {
+        const ecs::Entity entity = staticEntities[id];
+        Emit(transforms.GetData(entity).world, renderers.GetData(entity));
+    }
+
+    Submit(dt);
+    stats.culled = static_cast<uint32_t>(entities.size()) - stats.commands - stats.notResident;
+}
@@ -1,21 +1,150 @@
-/* example usage:
-
 #pragma once
-// these includes will be fixed in Cmake
-#include "../ecs/SystemManager.hpp"
+#include <vector>
+#include "../ecs/Coordinator.hpp"
+#include "../components/Camera.hpp"
 #include "../components/Transform.hpp"
 #include "../components/MeshRenderer.hpp"
-#include "../core/MonoBehavviour.hpp"
+#include "../gl/GLBackend.hpp"
+#include "../gl/Mesh.hpp"
+#include "../gl/Material.hpp"
+#include "../gl/RenderQueue.hpp"
+#include "../gl/ShaderProgram.hpp"
+#include "../gl/UniformBuffer.hpp"
+#include "../assets/AssetManager.hpp"
+#include "../assets/MeshLoader.hpp"
+#include "../assets/TextureLoader.hpp"
+#include "Culling.hpp"
+
+class TransformSystem;
 
-class RenderSystem : public System {
+// Draws every entity with a Transform and a MeshRenderer.
+// Meshes and materials are registered once and referenced by handle. Each
+// frame every visible entity emits a DrawCommand into a RenderQueue, which is
+// sorted (see RenderQueue.hpp for the key layout) and submitted with
+// redundant binds skipped. Entities sharing a mesh and an `instanced`
+// material are drawn with one instanced draw; GetStats() shows how many
+// draw calls a frame actually took.
+//
+// With a camera set, entities are frustum culled first: static ones
+// (MeshRenderer::isStatic) through a BVH that is rebuilt only when the set of
+// static entities changes, moving ones through world AABBs. With a
+// TransformSystem set, those boxes are the ones it keeps next to its world
+// matrices (TransformSystem::SetLocalBounds), refreshed only for nodes it
+// recomputes; without one they are packed from Transform::world each frame.
+// Call InvalidateStatic() after moving a static entity anyway, and
+// InvalidateBounds() after changing a MeshRenderer's mesh.
+//
+// Runs once per rendered frame (RunPerFrame). With a TransformSystem set,
+// moving entities and the camera are placed at its interpolated
+// RenderMatrix().
+//
+// Camera and time go into the FrameData uniform block once per Update; each
+// material's program is reflected once (ShaderProgram) so its blocks are
+// attached to the engine binding points before it first draws.
+//
+// Meshes and textures added as asset handles are looked up again at the
+// start of every Update, since residency streaming may replace their GL
+// objects or evict them; entities whose mesh is not on the GPU are skipped,
+// materials whose texture is not bind texture 0. Every such asset an entity
+// drew (or would have, while evicted) is touched once per Update with the
+// largest size in pixels it covered, for the AssetManager's residency.
+class RenderSystem : public ecs::System {
 public:
-    void Update(float deltaTime) override {
-        for (auto const& entity : entities) {
-            auto& transform = gCoordinator.GetComponent<Transform>(entity);
-            auto& mesh      = gCoordinator.GetComponent<MeshRenderer>(entity);
-            // Call OpenGL rendering logic here
-            DrawMesh(mesh, transforma);
-        }
-    }
+    RenderSystem();
+
+    MeshHandle AddMesh(const Mesh& mesh);
+    MeshHandle AddMesh(Asset<MeshAsset> mesh);
+    MaterialHandle AddMaterial(const Material& material);
+    // `material` drawn with `texture`'s current GL name in place of material.texture.
+    MaterialHandle AddMaterial(const Material& material, Asset<TextureAsset> texture);
+
+    // Entity with Transform + Camera to render from; enables culling.
+    void SetCamera(ecs::Entity camera) { cameraEntity = camera; }
+
+    // View used for depth sorting when no camera entity is set (no culling).
+    void SetView(const glm::mat4& view, float nearPlane, float farPlane);
+    // Projection written to FrameData when no camera entity is set.
+    void SetProjection(const glm::mat4& matrix) { projection = matrix; }
+
+    // Source of interpolated world matrices and of the moving drawables'
+    // world bounds; null draws Transform::world.
+    void SetTransformSystem(TransformSystem* system);
+
+    // Where GL calls go; GLContext::Instance() unless a test swaps it.
+    void SetBackend(GLBackend& backend) { gl = &backend; }
+
+    // Height of the render target, for the screen sizes streamed assets are touched with.
+    void SetViewportHeight(float pixels) { viewportHeight = pixels; }
+
+    void InvalidateStatic() { staticDirty = true; }
+    void InvalidateBounds() { partitionVersion = UINT64_MAX; }
+
+    void Update(float dt) override;
+
+    // Counters of the last Update.
+    const RenderStats& GetStats() const { return stats; }
+    const RenderQueue& GetQueue() const { return queue; }
+    const FrameUniforms& GetFrameUniforms() const { return frameUniforms; }
+    // Reflection of a material's program; valid after the first Update that follows AddMaterial.
+    const ShaderProgram& GetProgram(MaterialHandle material) const { return programs[materialShader[material]]; }
+
+private:
+    void Partition();
+    void PublishBounds(std::vector<ecs::Entity>& moving);
+    const glm::mat4& WorldOf(ecs::Entity entity, const Transform& transform) const;
+    void Emit(const glm::mat4& world, const MeshRenderer& renderer);
+    void BeginTracking();
+    void Track(const glm::mat4& world, const MeshRenderer& renderer);
+    void ResolveAssets();
+    void TouchAssets();
+    void Submit(float dt);
+
+    std::vector<Mesh> meshes;
+    std::vector<Material> materials;
+
+    // Streamed meshes and textures; empty handles for the ones added as copies.
+    std::vector<Asset<MeshAsset>> meshAssets;
+    std::vector<Asset<TextureAsset>> textureAssets; // per material
+    std::vector<uint8_t> meshMissing;               // streamed mesh not on the GPU this frame
+    uint32_t notResident = 0;                       // entities skipped for it this Update
+    std::vector<float> meshScreenSize;              // largest size drawn this frame, pixels
+    std::vector<float> materialScreenSize;
+    bool streaming = false;                         // any asset handles at all
+    float viewportHeight = 1080.0f;
+    float tanHalfFovY = 1.0f;
+    glm::vec3 eye{0.0f};
+    std::vector<uint32_t> materialShader; // per material: index into shaderPrograms, the sort key's shader field
+    std::vector<GLuint> shaderPrograms;
+    std::vector<ShaderProgram> programs;  // reflection per shaderPrograms entry, filled on Update
+
+    ecs::Entity cameraEntity = ecs::NullEntity;
+    glm::mat4 view{1.0f};
+    glm::mat4 projection{1.0f};
+    float nearPlane = 0.1f;
+    float farPlane = 1000.0f;
+
+    // Culling state: drawables split into moving and static on membership change.
+    uint64_t partitionVersion = UINT64_MAX;
+    bool staticDirty = true;
+    std::vector<ecs::Entity> dynamicEntities;   // bounded, culled through dynamicBounds
+    std::vector<ecs::Entity> unboundedEntities; // no mesh bounds: never culled
+    std::vector<ecs::Entity> staticEntities; // BVH item id -> entity
+    ecs::EntitySet staticSet;
+    BoundsBvh staticBvh;
+    BoundsSoA dynamicBounds;
+    std::vector<ecs::Entity> dynamicCandidates; // entity per dynamicBounds entry
+    std::vector<uint32_t> visible;
+
+    // Moving drawables whose world bounds the TransformSystem keeps; the
+    // ones it has no node for yet stay in dynamicEntities.
+    ecs::EntitySet publishedSet;
+    std::vector<ecs::Entity> published;
+    uint64_t transformLayout = UINT64_MAX;
+
+    TransformSystem* transformSystem = nullptr;
+    GLBackend* gl;
+    FrameUniforms frameUniforms;
+    UniformBuffer frameBuffer;
+    RenderQueue queue;
+    RenderStats stats;
 };
-*/
\ No newline at end of file
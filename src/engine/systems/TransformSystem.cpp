@@ -0,0 +1,430 @@
+#include "TransformSystem.hpp"
+#include "../ecs/ParallelFor.hpp"
+#include "../utils/MatrixSimd.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Levels smaller than this are cheaper to do on one thread than to split.
+constexpr uint32_t ParallelLevelSize = 4096;
+constexpr std::size_t LevelChunkSize = 1024;
+// Removed plus appended nodes tolerated before a relayout: an eighth of the
+// nodes, but at least this many.
+constexpr std::size_t MinUnsortedNodes = 1024;
+
+// Inside-out box: its positive vertex is behind every plane, so CullBounds
+// and Frustum::Intersects reject it. 1e30 rather than FLT_MAX keeps its
+// extents finite, and so free of 0 * inf.
+const Aabb EmptyBounds{ glm::vec3(1e30f), glm::vec3(-1e30f) };
+
+}
+
+TransformSystem::TransformSystem() {
+    Writes<Transform>();
+    entities.TrackChanges(true);
+}
+
+uint32_t TransformSystem::NodeOf(ecs::Entity entity) const {
+    if (entity.index >= nodeOf.size()) return NoNode;
+    const uint32_t node = nodeOf[entity.index];
+    return node < nodeEntity.size() && nodeEntity[node] == entity ? node : NoNode;
+}
+
+void TransformSystem::MarkDirty(ecs::Entity entity) {
+    // entities not in the arrays yet are computed by the next Rebuild anyway
+    const uint32_t node = NodeOf(entity);
+    if (node == NoNode) return;
+
+    std::atomic_ref<uint8_t>(nodeDirty[node]).store(1, std::memory_order_relaxed);
+    anyDirty.store(true, std::memory_order_relaxed);
+}
+
+void TransformSystem::MarkAllDirty() {
+    hierarchyChanged.store(true, std::memory_order_relaxed);
+}
+
+void TransformSystem::SetParent(ecs::Entity child, ecs::Entity parent) {
+    coordinator->GetComponent<Transform>(child).parent = parent;
+    hierarchyChanged.store(true, std::memory_order_relaxed);
+}
+
+void TransformSystem::SetLocalBounds(ecs::Entity entity, const Aabb& bounds) {
+    if (entity.index >= localBounds.size()) {
+        localBounds.resize(static_cast<std::size_t>(entity.index) + 1);
+        localBoundsOwner.resize(static_cast<std::size_t>(entity.index) + 1, ecs::NullEntity);
+    }
+    localBounds[entity.index] = bounds;
+    localBoundsOwner[entity.index] = entity;
+
+    const uint32_t node = NodeOf(entity);
+    if (node == NoNode) return;
+    nodeLocalBounds[node] = bounds;
+    RefreshBounds(node);
+}
+
+// World box of a node from its current matrices; the caller has finished
+// nodeWorld (and nodePrevious / nodeStep) for it.
+void TransformSystem::RefreshBounds(uint32_t node) {
+    const Aabb& local = nodeLocalBounds[node];
+    if (!local.IsFinite()) {
+        nodeBounds.Set(node, EmptyBounds);
+        return;
+    }
+    Aabb box = local.Transformed(nodeWorld[node]);
+    if (!nodeStep.empty() && nodeStep[node] == step) {
+        const Aabb previous = local.Transformed(nodePrevious[node]);
+        box = { glm::min(box.min, previous.min), glm::max(box.max, previous.max) };
+    }
+    nodeBounds.Set(node, box);
+}
+
+void TransformSystem::SetInterpolation(bool enabled) {
+    interpolation = enabled;
+    renderStep = 0;
+    hierarchyChanged.store(true, std::memory_order_relaxed); // sizes or drops the arrays
+}
+
+void TransformSystem::Update(float /*dt*/) {
+    updatedCount.store(0, std::memory_order_relaxed);
+    if (++step == 0) step = 1;
+    renderStep = 0;
+    recordStep = interpolation ? step : 0;
+
+    bool relayout = hierarchyChanged.exchange(false, std::memory_order_relaxed);
+    if (!relayout && entities.Version() != builtVersion) relayout = !ApplyChanges();
+    if (relayout) {
+        Rebuild();
+        recordStep = 0; // nodeWorld is stale after a relayout
+    } else if (!anyDirty.load(std::memory_order_relaxed)) {
+        return; // static frame
+    }
+    anyDirty.store(false, std::memory_order_relaxed);
+
+    ecs::ComponentArray<Transform>& transforms = coordinator->GetComponentStorage<Transform>();
+    JobSystem* jobs = coordinator->GetJobSystem();
+
+    for (;;) {
+        for (std::size_t level = 0; level + 1 < levels.size(); ++level) {
+            const uint32_t begin = levels[level];
+            const uint32_t end = levels[level + 1];
+            if (!jobs || end - begin < ParallelLevelSize) {
+                UpdateRange(transforms, begin, end);
+                continue;
+            }
+
+            ecs::ParallelChunks(*jobs, end - begin, LevelChunkSize, [&](const ecs::ChunkContext& chunk) {
+                UpdateRange(transforms, begin + static_cast<uint32_t>(chunk.begin), begin + static_cast<uint32_t>(chunk.end));
+            });
+        }
+        UpdateTail(transforms);
+
+        // Transform::parent was written directly: relink and redo the step
+        if (!linkChanged.exchange(false, std::memory_order_relaxed)) break;
+        Rebuild();
+        recordStep = 0;
+        updatedCount.store(0, std::memory_order_relaxed);
+    }
+}
+
+// Patches the node arrays for the transforms added and removed since the
+// last Update. Returns false if a relayout is needed instead: the change log
+// overflowed, a removed node still has children, a new transform is the
+// parent of a node already in the system, new transforms form a parent
+// cycle, or the unsorted nodes grew too many.
+bool TransformSystem::ApplyChanges() {
+    builtVersion = entities.Version();
+    if (entities.ChangesOverflowed()) return false;
+    ecs::ComponentArray<Transform>& transforms = coordinator->GetComponentStorage<Transform>();
+
+    std::vector<uint32_t> removed;
+    for (ecs::Entity entity : entities.Changes()) {
+        const uint32_t node = NodeOf(entity);
+        if (node == NoNode || entities.Contains(entity)) continue;
+        nodeEntity[node] = ecs::NullEntity;
+        nodeDirty[node] = 0;
+        nodeLocalBounds[node] = Aabb{};
+        nodeBounds.Set(node, EmptyBounds);
+        removed.push_back(node);
+    }
+    // removed nodes' children become roots, which takes a relayout
+    const uint32_t sorted = levels.back();
+    for (uint32_t node : removed) {
+        if (node >= sorted) continue;
+        for (uint32_t child = childBegin[node]; child < childBegin[node + 1]; ++child)
+            if (nodeEntity[child].IsValid()) return false;
+    }
+    if (!removed.empty()) {
+        for (uint32_t node = sorted; node < nodeEntity.size(); ++node) {
+            const uint32_t parent = nodeParent[node];
+            if (nodeEntity[node].IsValid() && parent != NoNode && !nodeEntity[parent].IsValid()) return false;
+        }
+    }
+
+    std::vector<ecs::Entity> chain;
+    for (ecs::Entity entity : entities.Changes()) {
+        if (!entities.Contains(entity)) continue;
+        const uint32_t node = NodeOf(entity);
+        if (node != NoNode) { // left and came back: its Transform may be a new one
+            nodeDirty[node] = 1;
+            anyDirty.store(true, std::memory_order_relaxed);
+            continue;
+        }
+
+        // append new parents before their children
+        chain.assign(1, entity);
+        for (;;) {
+            if (awaitedParents.Contains(chain.back())) return false;
+            const ecs::Entity parent = transforms.GetData(chain.back()).parent;
+            if (!entities.Contains(parent) || NodeOf(parent) != NoNode) break;
+            if (std::find(chain.begin(), chain.end(), parent) != chain.end()) return false;
+            chain.push_back(parent);
+        }
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) AppendNode(*it, transforms);
+    }
+
+    removedNodes += removed.size();
+    const std::size_t unsorted = removedNodes + (nodeEntity.size() - sorted);
+    if (unsorted > std::max(MinUnsortedNodes, nodeEntity.size() / 8)) return false;
+
+    entities.ClearChanges();
+    ++layoutVersion;
+    return true;
+}
+
+// Adds a node after all others; its parent, if any, already has one.
+void TransformSystem::AppendNode(ecs::Entity entity, ecs::ComponentArray<Transform>& transforms) {
+    const Transform& transform = transforms.GetData(entity);
+    const bool linked = entities.Contains(transform.parent);
+    if (transform.parent.IsValid() && !linked) awaitedParents.Insert(transform.parent);
+    const uint32_t parent = linked ? NodeOf(transform.parent) : NoNode;
+
+    // The world matrix it would have had last step, so the first
+    // interpolated frames start there rather than at the origin.
+    const glm::mat4 local = transform.LocalMatrix();
+    const glm::mat4 world = parent == NoNode ? local : nodeWorld[parent] * local;
+
+    const uint32_t node = static_cast<uint32_t>(nodeEntity.size());
+    nodeEntity.push_back(entity);
+    nodeLink.push_back(transform.parent);
+    nodeParent.push_back(parent);
+    nodeWorld.push_back(world);
+    nodeDirty.push_back(1);
+    nodeComputed.push_back(0);
+    const bool bounded = entity.index < localBoundsOwner.size() && localBoundsOwner[entity.index] == entity;
+    nodeLocalBounds.push_back(bounded ? localBounds[entity.index] : Aabb{});
+    nodeBounds.Push(EmptyBounds);
+    if (interpolation) {
+        nodePrevious.push_back(world);
+        nodeRender.push_back(world);
+        nodeStep.push_back(0);
+    }
+    if (entity.index >= nodeOf.size()) nodeOf.resize(static_cast<std::size_t>(entity.index) + 1, NoNode);
+    nodeOf[entity.index] = node;
+    anyDirty.store(true, std::memory_order_relaxed);
+}
+
+void TransformSystem::Interpolate(float alpha) {
+    renderStep = 0;
+    if (!interpolation || nodeStep.size() != nodeEntity.size()) return;
+
+    alpha = std::clamp(alpha, 0.0f, 1.0f);
+    const uint32_t count = static_cast<uint32_t>(nodeEntity.size());
+    JobSystem* jobs = coordinator->GetJobSystem();
+    if (!jobs || count < ParallelLevelSize) {
+        InterpolateRange(alpha, 0, count);
+    } else {
+        ecs::ParallelChunks(*jobs, count, LevelChunkSize, [&](const ecs::ChunkContext& chunk) {
+            InterpolateRange(alpha, static_cast<uint32_t>(chunk.begin), static_cast<uint32_t>(chunk.end));
+        });
+    }
+    renderStep = step;
+}
+
+void TransformSystem::InterpolateRange(float alpha, uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i) {
+        if (nodeStep[i] != step) continue;
+        nodeRender[i] = nodePrevious[i] + (nodeWorld[i] - nodePrevious[i]) * alpha;
+    }
+}
+
+const glm::mat4& TransformSystem::RenderMatrix(ecs::Entity entity, const Transform& transform) const {
+    if (renderStep == 0) return transform.world;
+    const uint32_t node = NodeOf(entity);
+    if (node == NoNode || nodeStep[node] != renderStep) return transform.world;
+    return nodeRender[node];
+}
+
+const glm::mat4& TransformSystem::NodeRenderMatrix(uint32_t node) const {
+    return renderStep != 0 && nodeStep[node] == renderStep ? nodeRender[node] : nodeWorld[node];
+}
+
+// Recomputes one node from its Transform and its parent's world matrix.
+void TransformSystem::ComputeNode(uint32_t node, Transform& transform) {
+    if (transform.parent != nodeLink[node]) linkChanged.store(true, std::memory_order_relaxed);
+    transform.local = transform.LocalMatrix();
+    const uint32_t parent = nodeParent[node];
+    if (parent == NoNode)
+        transform.world = transform.local;
+    else
+        MulMat4(nodeWorld[parent], transform.local, transform.world);
+    if (recordStep) {
+        nodePrevious[node] = nodeWorld[node];
+        nodeStep[node] = recordStep;
+    }
+    nodeWorld[node] = transform.world;
+    nodeComputed[node] = step;
+    if (nodeLocalBounds[node].IsFinite()) RefreshBounds(node);
+}
+
+// Recomputes the dirty nodes in [begin, end) of one level and marks their
+// children, which are contiguous in the next level. Clean runs are skipped
+// eight flags at a time, so static parts of the scene cost almost nothing.
+void TransformSystem::UpdateRange(ecs::ComponentArray<Transform>& transforms, uint32_t begin, uint32_t end) {
+    const std::span<Transform> dense = transforms.Components();
+    const std::span<const ecs::Entity> packed = transforms.Entities();
+    std::size_t updated = 0;
+    for (uint32_t i = begin; i < end;) {
+        if (i + 8 <= end) {
+            uint64_t flags;
+            std::memcpy(&flags, &nodeDirty[i], sizeof(flags));
+            if (flags == 0) { i += 8; continue; }
+        }
+        if (!nodeDirty[i]) { ++i; continue; }
+        nodeDirty[i] = 0;
+        if (!nodeEntity[i].IsValid()) { ++i; continue; } // removed, and has no children
+
+        // Rebuild put node i at dense index i; Transforms added or removed
+        // since can have moved it.
+        ComputeNode(i, packed[i] == nodeEntity[i] ? dense[i] : transforms.GetData(nodeEntity[i]));
+        std::fill(nodeDirty.begin() + childBegin[i], nodeDirty.begin() + childBegin[i + 1], uint8_t{ 1 });
+        ++updated;
+        ++i;
+    }
+    updatedCount.fetch_add(updated, std::memory_order_relaxed);
+}
+
+// Nodes appended since the last relayout, in order (parents first): each is
+// recomputed if marked or if its parent was recomputed this step.
+void TransformSystem::UpdateTail(ecs::ComponentArray<Transform>& transforms) {
+    std::size_t updated = 0;
+    for (uint32_t i = levels.back(); i < nodeEntity.size(); ++i) {
+        const uint32_t parent = nodeParent[i];
+        if (!nodeDirty[i] && (parent == NoNode || nodeComputed[parent] != step)) continue;
+        nodeDirty[i] = 0;
+        if (!nodeEntity[i].IsValid()) continue;
+        ComputeNode(i, transforms.GetData(nodeEntity[i]));
+        ++updated;
+    }
+    updatedCount.fetch_add(updated, std::memory_order_relaxed);
+}
+
+// Lays the hierarchy out breadth-first: roots first, then the children of
+// each node in order, so levels are contiguous and the children of one node
+// form one run. The Transform array is reordered to match, so updates stream
+// through it. Every node starts dirty.
+void TransformSystem::Rebuild() {
+    builtVersion = entities.Version();
+    entities.ClearChanges();
+    removedNodes = 0;
+    awaitedParents.Clear();
+    ecs::ComponentArray<Transform>& transforms = coordinator->GetComponentStorage<Transform>();
+
+    std::size_t slotCount = 0;
+    for (ecs::Entity entity : entities) slotCount = std::max<std::size_t>(slotCount, entity.index + 1);
+
+    // Resolve each entity's effective parent. Parents without a Transform
+    // count as no parent; a parent cycle is broken where it is detected.
+    enum : uint8_t { Unvisited, Visiting, Done };
+    std::vector<uint8_t> state(slotCount, Unvisited);
+    std::vector<ecs::Entity> parentOf(slotCount, ecs::NullEntity);
+    std::vector<ecs::Entity> path;
+    for (ecs::Entity entity : entities) {
+        ecs::Entity current = entity;
+        path.clear();
+        while (state[current.index] == Unvisited) {
+            state[current.index] = Visiting;
+            path.push_back(current);
+
+            const ecs::Entity parent = transforms.GetData(current).parent;
+            if (!entities.Contains(parent)) {
+                if (parent.IsValid()) awaitedParents.Insert(parent);
+                break;
+            }
+            if (state[parent.index] == Visiting) break; // cycle: leave `current` as a root
+            parentOf[current.index] = parent;
+            current = parent;
+        }
+        for (ecs::Entity visited : path) state[visited.index] = Done;
+    }
+
+    // Children per parent, indexed by entity index.
+    std::vector<uint32_t> childOffset(slotCount + 1, 0);
+    for (ecs::Entity entity : entities)
+        if (parentOf[entity.index].IsValid()) ++childOffset[parentOf[entity.index].index + 1];
+    for (std::size_t i = 1; i < childOffset.size(); ++i) childOffset[i] += childOffset[i - 1];
+    std::vector<ecs::Entity> children(childOffset.back());
+    {
+        std::vector<uint32_t> cursor(childOffset.begin(), childOffset.end() - 1);
+        for (ecs::Entity entity : entities)
+            if (parentOf[entity.index].IsValid()) children[cursor[parentOf[entity.index].index]++] = entity;
+    }
+
+    const std::size_t count = entities.size();
+    nodeEntity.clear();
+    nodeParent.clear();
+    nodeEntity.reserve(count);
+    nodeParent.reserve(count);
+    childBegin.assign(count + 1, 0);
+    levels.assign(1, 0);
+
+    for (ecs::Entity entity : entities) {
+        if (!parentOf[entity.index].IsValid()) {
+            nodeEntity.push_back(entity);
+            nodeParent.push_back(NoNode);
+        }
+    }
+
+    for (uint32_t levelBegin = 0; levelBegin < nodeEntity.size();) {
+        const uint32_t levelEnd = static_cast<uint32_t>(nodeEntity.size());
+        levels.push_back(levelEnd);
+        for (uint32_t node = levelBegin; node < levelEnd; ++node) {
+            childBegin[node] = static_cast<uint32_t>(nodeEntity.size());
+            const ecs::EntityIndex index = nodeEntity[node].index;
+            for (uint32_t c = childOffset[index]; c < childOffset[index + 1]; ++c) {
+                nodeEntity.push_back(children[c]);
+                nodeParent.push_back(node);
+            }
+        }
+        levelBegin = levelEnd;
+    }
+    childBegin[count] = static_cast<uint32_t>(count);
+
+    nodeOf.assign(slotCount, NoNode);
+    for (uint32_t node = 0; node < nodeEntity.size(); ++node) nodeOf[nodeEntity[node].index] = node;
+    nodeLink.resize(count);
+    for (uint32_t node = 0; node < count; ++node) nodeLink[node] = transforms.GetData(nodeEntity[node]).parent;
+
+    nodeWorld.resize(count);
+    nodeDirty.assign(count, 1);
+    nodeComputed.assign(count, 0);
+    nodeLocalBounds.assign(count, Aabb{});
+    for (uint32_t node = 0; node < count; ++node) {
+        const ecs::Entity entity = nodeEntity[node];
+        if (entity.index < localBoundsOwner.size() && localBoundsOwner[entity.index] == entity)
+            nodeLocalBounds[node] = localBounds[entity.index];
+    }
+    nodeBounds.Resize(count);
+    for (uint32_t node = 0; node < count; ++node) nodeBounds.Set(node, EmptyBounds);
+    ++layoutVersion;
+    if (interpolation) {
+        nodePrevious.resize(count);
+        nodeRender.resize(count);
+        nodeStep.assign(count, 0);
+    } else {
+        nodePrevious = {};
+        nodeRender = {};
+        nodeStep = {};
+    }
+    transforms.Reorder(nodeEntity);
+}
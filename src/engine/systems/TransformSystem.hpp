@@ -0,0 +1,124 @@
+#pragma once
+#include "../ecs/Coordinator.hpp"
+#include "../components/Transform.hpp"
+#include "../utils/Aabb.hpp"
+#include "../utils/AlignedAllocator.hpp"
+#include "Culling.hpp"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Computes Transform::local and Transform::world for a parent/child hierarchy.
+//
+// The hierarchy is kept in depth-sorted SoA arrays, so every parent is
+// finished before its children and each depth level can be processed in
+// parallel. Only nodes marked dirty, and everything below them, are
+// recomputed: a frame in which nothing was marked costs one flag check.
+//
+// Transforms added or removed are patched in without a relayout: new nodes
+// are appended after the sorted levels (parents first) and updated serially,
+// removed ones leave a hole. Once those make up an eighth of the nodes, or
+// a parent link changes, the arrays are laid out again from scratch.
+//
+// After changing position/rotation/scale call MarkDirty(entity); change
+// parents through SetParent(). Both may be called from systems running in
+// parallel as long as those systems declare Writes<Transform>(). Writing
+// Transform::parent directly works too, but is only seen once the node is
+// marked dirty: it then relinks the hierarchy within that Update.
+//
+// With SetInterpolation(true) every recomputed node also keeps the world
+// matrix it had before the step, and Interpolate(alpha) blends the two for
+// the nodes the last Update moved; RenderMatrix() hands renderers the blend
+// (or Transform::world for everything else). Matrices are blended element by
+// element: exact for translation and close enough for the rotation of one
+// step. A hierarchy rebuild snaps instead of blending.
+//
+// World bounds live next to the world matrices: give an entity object-space
+// bounds with SetLocalBounds() and every recompute of its node refreshes its
+// box in GetWorldBounds(), a BoundsSoA in node order that culling reads
+// without a per-entity gather. A box covers whatever RenderMatrix() hands
+// out: with interpolation, the union of the step's start and end boxes
+// (a blend of two matrices moves every corner between its two positions).
+// Nodes without bounds hold an empty box that no frustum intersects.
+class TransformSystem : public ecs::System {
+public:
+    TransformSystem();
+
+    void Update(float dt) override;
+    void Interpolate(float alpha) override;
+
+    void MarkDirty(ecs::Entity entity);
+    void MarkAllDirty();
+    void SetParent(ecs::Entity child, ecs::Entity parent);
+
+    void SetInterpolation(bool enabled);
+    // World matrix to draw `entity` with this frame; `transform` is its Transform.
+    const glm::mat4& RenderMatrix(ecs::Entity entity, const Transform& transform) const;
+
+    // Nodes recomputed by the last Update (for stats and tests).
+    std::size_t GetUpdatedCount() const { return updatedCount; }
+
+    // An infinite Aabb (the default) clears the entity's bounds. Kept across
+    // relayouts; entities not in the system yet pick theirs up when they join.
+    void SetLocalBounds(ecs::Entity entity, const Aabb& bounds);
+    const BoundsSoA& GetWorldBounds() const { return nodeBounds; }
+
+    // Node access for GetWorldBounds() users. Node indices change with every
+    // relayout, which bumps LayoutVersion(); so do nodes being added or
+    // removed. A removed node's NodeEntity() is NullEntity.
+    bool HasNode(ecs::Entity entity) const { return NodeOf(entity) != NoNode; }
+    ecs::Entity NodeEntity(uint32_t node) const { return nodeEntity[node]; }
+    // RenderMatrix() of a node, without its Transform.
+    const glm::mat4& NodeRenderMatrix(uint32_t node) const;
+    uint64_t LayoutVersion() const { return layoutVersion; }
+
+private:
+    static constexpr uint32_t NoNode = UINT32_MAX;
+
+    uint32_t NodeOf(ecs::Entity entity) const;
+    void Rebuild();
+    bool ApplyChanges();
+    void AppendNode(ecs::Entity entity, ecs::ComponentArray<Transform>& transforms);
+    void RefreshBounds(uint32_t node);
+    void ComputeNode(uint32_t node, Transform& transform);
+    void UpdateRange(ecs::ComponentArray<Transform>& transforms, uint32_t begin, uint32_t end);
+    void UpdateTail(ecs::ComponentArray<Transform>& transforms);
+    void InterpolateRange(float alpha, uint32_t begin, uint32_t end);
+
+    // Depth-sorted node arrays; levels[d]..levels[d + 1] is depth d, and
+    // nodes from levels.back() on were appended since the last relayout.
+    std::vector<ecs::Entity> nodeEntity; // NullEntity for removed nodes
+    std::vector<ecs::Entity> nodeLink;   // Transform::parent the node was linked with
+    std::vector<uint32_t> nodeParent;    // NoNode for roots
+    std::vector<uint32_t> childBegin;    // sorted children of node i are [childBegin[i], childBegin[i + 1])
+    std::vector<glm::mat4, AlignedAllocator<glm::mat4>> nodeWorld;
+    std::vector<uint8_t> nodeDirty;
+    std::vector<uint32_t> nodeComputed;  // step that last recomputed the node; appended nodes follow their parent by it
+    std::vector<uint32_t> levels;
+    std::vector<uint32_t> nodeOf; // Entity::index -> node
+    ecs::EntitySet awaitedParents;       // Transform::parent values not in the system; one joining relinks
+    std::size_t removedNodes = 0;
+
+    // Bounds: object space by entity (survives relayouts), then per node.
+    std::vector<Aabb> localBounds;           // Entity::index -> bounds of localBoundsOwner
+    std::vector<ecs::Entity> localBoundsOwner;
+    std::vector<Aabb> nodeLocalBounds;       // infinite for nodes without bounds
+    BoundsSoA nodeBounds;
+    uint64_t layoutVersion = 0;
+
+    // Interpolation, sized only while enabled. nodeStep is the Update that
+    // last recomputed a node; only nodes stamped by the latest one blend.
+    std::vector<glm::mat4, AlignedAllocator<glm::mat4>> nodePrevious;
+    std::vector<glm::mat4, AlignedAllocator<glm::mat4>> nodeRender;
+    std::vector<uint32_t> nodeStep;
+    bool interpolation = false;
+    uint32_t step = 0;        // Update count
+    uint32_t recordStep = 0;  // step being recorded by UpdateRange, 0 for none
+    uint32_t renderStep = 0;  // step nodeRender was blended for, 0 for none
+
+    uint64_t builtVersion = UINT64_MAX;
+    std::atomic<bool> hierarchyChanged{ true };
+    std::atomic<bool> linkChanged{ false }; // a recomputed node's Transform::parent differs from nodeLink
+    std::atomic<bool> anyDirty{ false };
+    std::atomic<std::size_t> updatedCount{ 0 };
+};
@@ -0,0 +1,30 @@
+/* Axis-aligned bounding box. The default box is infinite, meaning "bounds
+   unknown": culling and broadphase code treat it as always overlapping. */
+#pragma once
+
+#include <glm/glm.hpp>
+#include <limits>
+
+struct Aabb {
+    glm::vec3 min{ -std::numeric_limits<float>::infinity() };
+    glm::vec3 max{ std::numeric_limits<float>::infinity() };
+
+    bool IsFinite() const {
+        return glm::all(glm::lessThan(glm::abs(min), glm::vec3(std::numeric_limits<float>::infinity())))
+            && glm::all(glm::lessThan(glm::abs(max), glm::vec3(std::numeric_limits<float>::infinity())));
+    }
+
+    glm::vec3 Center() const { return (min + max) * 0.5f; }
+    glm::vec3 Extents() const { return (max - min) * 0.5f; }
+
+    // Bounds of this box after an affine transform (Arvo's method: the
+    // extents go through the absolute value of the linear part).
+    Aabb Transformed(const glm::mat4& m) const {
+        const glm::vec3 center = glm::vec3(m * glm::vec4(Center(), 1.0f));
+        const glm::vec3 e = Extents();
+        const glm::vec3 extents = glm::abs(glm::vec3(m[0])) * e.x
+                                + glm::abs(glm::vec3(m[1])) * e.y
+                                + glm::abs(glm::vec3(m[2])) * e.z;
+        return { center - extents, center + extents };
+    }
+};
@@ -0,0 +1,34 @@
+/* std::allocator replacement that aligns every allocation to `Alignment`
+   bytes (a cache line by default). Used for packed component storage so
+   parallel chunks can start on cache-line boundaries. */
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+inline constexpr std::size_t CacheLineSize = 64;
+
+template<typename T, std::size_t Alignment = CacheLineSize>
+struct AlignedAllocator {
+    using value_type = T;
+
+    static constexpr std::size_t alignment = Alignment > alignof(T) ? Alignment : alignof(T);
+
+    template<typename U>
+    struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() noexcept = default;
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignment)));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept {
+        ::operator delete(p, std::align_val_t(alignment));
+    }
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+};
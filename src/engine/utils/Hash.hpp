@@ -0,0 +1,25 @@
+/* 64-bit FNV-1a for content keys (shader sources, cache entries). Not for
+   hash tables on hot paths: it is byte-at-a-time. */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+constexpr uint64_t HashBytes(const void* data, std::size_t size, uint64_t seed = 14695981039346656037ull) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+inline uint64_t HashString(std::string_view text, uint64_t seed = 14695981039346656037ull) {
+    return HashBytes(text.data(), text.size(), seed);
+}
+
+// Order-dependent: HashCombine(a, b) != HashCombine(b, a).
+constexpr uint64_t HashCombine(uint64_t seed, uint64_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
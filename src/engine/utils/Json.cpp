@@ -0,0 +1,209 @@
+#include "Json.hpp"
+#include <charconv>
+
+const JsonValue* JsonValue::Find(std::string_view key) const {
+    for (std::size_t i = 0; i < keys.size(); ++i)
+        if (keys[i] == key) return &items[i];
+    return nullptr;
+}
+
+class JsonParser {
+public:
+    explicit JsonParser(std::string_view source) : text(source) {}
+
+    std::optional<JsonValue> Parse(std::string* error) {
+        JsonValue root;
+        SkipSpace();
+        if (ParseValue(root, 0)) {
+            SkipSpace();
+            if (at == text.size()) return root;
+            Fail("unexpected trailing characters");
+        }
+        if (error) {
+            std::size_t line = 1, column = 1;
+            for (std::size_t i = 0; i < failedAt && i < text.size(); ++i) {
+                if (text[i] == '\n') {
+                    ++line;
+                    column = 1;
+                } else {
+                    ++column;
+                }
+            }
+            *error = std::to_string(line) + ":" + std::to_string(column) + ": " + message;
+        }
+        return std::nullopt;
+    }
+
+private:
+    static constexpr int MaxDepth = 256;
+
+    bool Fail(const char* what) {
+        if (message.empty()) {
+            message = what;
+            failedAt = at;
+        }
+        return false;
+    }
+
+    void SkipSpace() {
+        while (at < text.size() && (text[at] == ' ' || text[at] == '\t' || text[at] == '\n' || text[at] == '\r')) ++at;
+    }
+
+    bool Consume(char c) {
+        SkipSpace();
+        if (at < text.size() && text[at] == c) {
+            ++at;
+            return true;
+        }
+        return false;
+    }
+
+    bool Literal(std::string_view word) {
+        if (text.substr(at, word.size()) != word) return Fail("invalid literal");
+        at += word.size();
+        return true;
+    }
+
+    bool ParseValue(JsonValue& value, int depth) {
+        if (depth > MaxDepth) return Fail("nested too deeply");
+        SkipSpace();
+        if (at >= text.size()) return Fail("unexpected end of input");
+        switch (text[at]) {
+        case '{': return ParseObject(value, depth);
+        case '[': return ParseArray(value, depth);
+        case '"':
+            value.type = JsonValue::Type::String;
+            return ParseString(value.text);
+        case 't':
+            value.type = JsonValue::Type::Bool;
+            value.number = 1.0;
+            return Literal("true");
+        case 'f':
+            value.type = JsonValue::Type::Bool;
+            return Literal("false");
+        case 'n': return Literal("null");
+        default: return ParseNumber(value);
+        }
+    }
+
+    bool ParseNumber(JsonValue& value) {
+        // a JSON number starts with '-' or a digit; from_chars alone would also take "inf" and "nan"
+        const std::size_t digit = text[at] == '-' ? at + 1 : at;
+        if (digit >= text.size() || text[digit] < '0' || text[digit] > '9') return Fail("unexpected character");
+        const auto [end, ec] = std::from_chars(text.data() + at, text.data() + text.size(), value.number);
+        if (ec != std::errc()) return Fail("invalid number");
+        at = static_cast<std::size_t>(end - text.data());
+        value.type = JsonValue::Type::Number;
+        return true;
+    }
+
+    static void AppendUtf8(std::string& out, uint32_t codePoint) {
+        if (codePoint < 0x80) {
+            out += static_cast<char>(codePoint);
+        } else if (codePoint < 0x800) {
+            out += static_cast<char>(0xC0 | (codePoint >> 6));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else if (codePoint < 0x10000) {
+            out += static_cast<char>(0xE0 | (codePoint >> 12));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (codePoint >> 18));
+            out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+
+    bool ParseHex4(uint32_t& out) {
+        if (at + 4 > text.size()) return Fail("truncated \\u escape");
+        out = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char c = text[at++];
+            out <<= 4;
+            if (c >= '0' && c <= '9') out |= static_cast<uint32_t>(c - '0');
+            else if (c >= 'a' && c <= 'f') out |= static_cast<uint32_t>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') out |= static_cast<uint32_t>(c - 'A' + 10);
+            else return Fail("invalid \\u escape");
+        }
+        return true;
+    }
+
+    bool ParseString(std::string& out) {
+        ++at; // opening quote
+        for (;;) {
+            // copy the run up to the next quote or escape in one go
+            const std::size_t start = at;
+            while (at < text.size() && text[at] != '"' && text[at] != '\\') {
+                if (static_cast<unsigned char>(text[at]) < 0x20) return Fail("control character in string");
+                ++at;
+            }
+            out.append(text.data() + start, at - start);
+            if (at >= text.size()) return Fail("unterminated string");
+            if (text[at++] == '"') return true;
+
+            if (at >= text.size()) return Fail("unterminated string");
+            switch (text[at++]) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                uint32_t codePoint;
+                if (!ParseHex4(codePoint)) return false;
+                if (codePoint >= 0xD800 && codePoint < 0xDC00) {
+                    uint32_t low;
+                    if (text.substr(at, 2) != "\\u") return Fail("unpaired surrogate");
+                    at += 2;
+                    if (!ParseHex4(low)) return false;
+                    if (low < 0xDC00 || low >= 0xE000) return Fail("unpaired surrogate");
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                AppendUtf8(out, codePoint);
+                break;
+            }
+            default: return Fail("invalid escape");
+            }
+        }
+    }
+
+    bool ParseArray(JsonValue& value, int depth) {
+        ++at;
+        value.type = JsonValue::Type::Array;
+        if (Consume(']')) return true;
+        do {
+            value.items.emplace_back();
+            if (!ParseValue(value.items.back(), depth + 1)) return false;
+        } while (Consume(','));
+        return Consume(']') || Fail("expected ',' or ']'");
+    }
+
+    bool ParseObject(JsonValue& value, int depth) {
+        ++at;
+        value.type = JsonValue::Type::Object;
+        if (Consume('}')) return true;
+        do {
+            SkipSpace();
+            if (at >= text.size() || text[at] != '"') return Fail("expected a key");
+            value.keys.emplace_back();
+            if (!ParseString(value.keys.back())) return false;
+            if (!Consume(':')) return Fail("expected ':'");
+            value.items.emplace_back();
+            if (!ParseValue(value.items.back(), depth + 1)) return false;
+        } while (Consume(','));
+        return Consume('}') || Fail("expected ',' or '}'");
+    }
+
+    std::string_view text;
+    std::size_t at = 0;
+    std::string message;
+    std::size_t failedAt = 0;
+};
+
+std::optional<JsonValue> ParseJson(std::string_view text, std::string* error) {
+    return JsonParser(text).Parse(error);
+}
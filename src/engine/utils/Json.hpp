@@ -0,0 +1,60 @@
+/* Minimal JSON reader for offline tools (scene_compiler) and config files.
+
+   ParseJson builds a small DOM: objects keep their members in file order
+   (keys and values in parallel vectors), numbers are doubles. Accessors
+   never throw; asking a value for the wrong type returns the fallback, so
+   callers validate with the Is*() checks where it matters. Not meant for
+   hot paths: runtime data goes through the baked binary formats.
+
+example usage:
+
+std::string error;
+std::optional<JsonValue> root = ParseJson(text, &error);
+if (!root) Log(error);
+else if (const JsonValue* fov = root->Find("fovY")) camera.fovY = fov->Number(60.0); */
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class JsonValue {
+public:
+    enum class Type : uint8_t { Null, Bool, Number, String, Array, Object };
+
+    JsonValue() = default;
+
+    Type GetType() const { return type; }
+    bool IsNull() const { return type == Type::Null; }
+    bool IsBool() const { return type == Type::Bool; }
+    bool IsNumber() const { return type == Type::Number; }
+    bool IsString() const { return type == Type::String; }
+    bool IsArray() const { return type == Type::Array; }
+    bool IsObject() const { return type == Type::Object; }
+
+    bool Bool(bool fallback = false) const { return type == Type::Bool ? number != 0.0 : fallback; }
+    double Number(double fallback = 0.0) const { return type == Type::Number ? number : fallback; }
+    std::string_view String(std::string_view fallback = {}) const { return type == Type::String ? std::string_view(text) : fallback; }
+
+    // Array elements or object values, in file order; empty for scalars.
+    const std::vector<JsonValue>& Items() const { return items; }
+    // Object keys, parallel to Items().
+    const std::vector<std::string>& Keys() const { return keys; }
+    std::size_t Size() const { return items.size(); }
+
+    // Object member by key (the first, if repeated); null if absent or not an object.
+    const JsonValue* Find(std::string_view key) const;
+
+private:
+    friend class JsonParser;
+
+    Type type = Type::Null;
+    double number = 0.0;
+    std::string text;
+    std::vector<JsonValue> items;
+    std::vector<std::string> keys;
+};
+
+// nullopt on malformed input; `error` then says what and where (line:column).
+std::optional<JsonValue> ParseJson(std::string_view text, std::string* error = nullptr);
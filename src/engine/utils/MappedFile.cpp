@@ -0,0 +1,104 @@
+#include "MappedFile.hpp"
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr std::size_t PageSize = 4096; // touching every 4 KiB also covers larger pages
+
+}
+
+std::optional<MappedFile> MappedFile::Open(const std::filesystem::path& path) {
+    MappedFile mapped;
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return std::nullopt;
+    mapped.file = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) return std::nullopt;
+    mapped.size = static_cast<std::size_t>(size.QuadPart);
+
+    mapped.mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapped.mapping) return std::nullopt;
+    mapped.data = static_cast<const std::byte*>(MapViewOfFile(mapped.mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!mapped.data) return std::nullopt;
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return std::nullopt;
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return std::nullopt;
+    }
+    void* view = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if (view == MAP_FAILED) return std::nullopt;
+
+    mapped.data = static_cast<const std::byte*>(view);
+    mapped.size = static_cast<std::size_t>(info.st_size);
+#endif
+    return mapped;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data(std::exchange(other.data, nullptr)), size(std::exchange(other.size, 0))
+#ifdef _WIN32
+    , file(std::exchange(other.file, nullptr)), mapping(std::exchange(other.mapping, nullptr))
+#endif
+{}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Close();
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+#ifdef _WIN32
+        file = std::exchange(other.file, nullptr);
+        mapping = std::exchange(other.mapping, nullptr);
+#endif
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() { Close(); }
+
+void MappedFile::Close() {
+#ifdef _WIN32
+    if (data) UnmapViewOfFile(data);
+    if (mapping) CloseHandle(mapping);
+    if (file) CloseHandle(file);
+    mapping = nullptr;
+    file = nullptr;
+#else
+    if (data) ::munmap(const_cast<std::byte*>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+void MappedFile::Prefetch() const {
+    if (!data) return;
+#ifdef _WIN32
+    WIN32_MEMORY_RANGE_ENTRY range{ const_cast<std::byte*>(data), size };
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+    ::madvise(const_cast<std::byte*>(data), size, MADV_WILLNEED);
+#endif
+    volatile unsigned char sink = 0;
+    for (std::size_t offset = 0; offset < size; offset += PageSize)
+        sink = sink + static_cast<unsigned char>(data[offset]);
+    (void)sink;
+}
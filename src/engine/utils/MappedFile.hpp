@@ -0,0 +1,44 @@
+/* Read-only memory mapping of a whole file.
+
+   The contents are paged in by the OS on first touch instead of being
+   copied through a read buffer; Prefetch() touches every page up front,
+   which is how a loader on a worker thread keeps page faults off the GL
+   thread that later reads the mapping.
+
+example usage:
+
+std::optional<MappedFile> file = MappedFile::Open("assets/models/rock.emesh");
+if (file) Parse(file->Data(), file->Size()); */
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+
+class MappedFile {
+public:
+    // nullopt if the file is missing, empty or cannot be mapped.
+    static std::optional<MappedFile> Open(const std::filesystem::path& path);
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    const std::byte* Data() const { return data; }
+    std::size_t Size() const { return size; }
+
+    // Asks the OS to read the file ahead and touches one byte per page.
+    void Prefetch() const;
+
+private:
+    MappedFile() = default;
+    void Close();
+
+    const std::byte* data = nullptr;
+    std::size_t size = 0;
+#ifdef _WIN32
+    void* file = nullptr;    // HANDLE
+    void* mapping = nullptr; // HANDLE
+#endif
+};
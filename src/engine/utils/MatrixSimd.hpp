@@ -0,0 +1,33 @@
+/* SSE kernel for the 4x4 products in TransformSystem. GLM only vectorises
+   mat4 * mat4 with GLM_FORCE_INTRINSICS and aligned types, which would change
+   the layout of every glm::mat4 in the engine, so the hot loop uses this
+   instead. Falls back to plain GLM when SSE is not available. */
+#pragma once
+
+#include <glm/glm.hpp>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define ENGINE_MATRIX_SSE 1
+#endif
+
+// out = a * b (column-major, same result as glm). `out` may alias `a` or `b`.
+inline void MulMat4(const glm::mat4& a, const glm::mat4& b, glm::mat4& out) {
+#ifdef ENGINE_MATRIX_SSE
+    const __m128 a0 = _mm_loadu_ps(&a[0][0]);
+    const __m128 a1 = _mm_loadu_ps(&a[1][0]);
+    const __m128 a2 = _mm_loadu_ps(&a[2][0]);
+    const __m128 a3 = _mm_loadu_ps(&a[3][0]);
+
+    for (int c = 0; c < 4; ++c) {
+        const __m128 col = _mm_loadu_ps(&b[c][0]);
+        __m128 r =            _mm_mul_ps(a0, _mm_shuffle_ps(col, col, _MM_SHUFFLE(0, 0, 0, 0)));
+        r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_shuffle_ps(col, col, _MM_SHUFFLE(1, 1, 1, 1))));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_shuffle_ps(col, col, _MM_SHUFFLE(2, 2, 2, 2))));
+        r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_shuffle_ps(col, col, _MM_SHUFFLE(3, 3, 3, 3))));
+        _mm_storeu_ps(&out[c][0], r);
+    }
+#else
+    out = a * b;
+#endif
+}
@@ -0,0 +1,22 @@
+/* Reserving for batches that keep coming.
+
+   vector::reserve(size() + n) asks for exactly that much, so a container
+   that grows by a small batch at a time reallocates and copies everything
+   on every batch: O(N) per batch where push_back alone is amortised O(1).
+   ReserveMore keeps the geometric growth and still makes one allocation
+   for a large batch.
+
+example usage:
+
+ReserveMore(dense, dense.size() + count);
+for (...) dense.push_back(entity); */
+#pragma once
+#include <algorithm>
+#include <cstddef>
+
+// Ensures room for `needed` elements: nothing if there is room already,
+// otherwise at least twice the current capacity.
+template<typename Container>
+void ReserveMore(Container& container, std::size_t needed) {
+    if (needed > container.capacity()) container.reserve(std::max(needed, 2 * container.capacity()));
+}
@@ -0,0 +1,101 @@
+/* mesh_compiler: bakes OBJ files into .emesh files (see MeshFile.hpp).
+
+usage:
+
+mesh_compiler rock.obj                  writes rock.emesh next to it
+mesh_compiler rock.obj -o out/rock.emesh
+mesh_compiler assets/models             every .obj below the directory
+
+A source is skipped when its .emesh is newer, so the tool can run as a
+build step; --force rebuilds everything. */
+#include <engine/assets/MeshLoader.hpp>
+#include <engine/assets/MeshOptimizer.hpp>
+#include <engine/core/JobSystem.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Job {
+    fs::path input, output;
+};
+
+bool UpToDate(const Job& job) {
+    std::error_code error;
+    const fs::file_time_type out = fs::last_write_time(job.output, error);
+    return !error && out >= fs::last_write_time(job.input, error) && !error;
+}
+
+bool Compile(const Job& job, const ObjImportOptions& options) {
+    const auto start = std::chrono::steady_clock::now();
+    const std::optional<MeshData> mesh = ImportObj(job.input, options);
+    if (!mesh) {
+        std::fprintf(stderr, "mesh_compiler: cannot import %s\n", job.input.string().c_str());
+        return false;
+    }
+    if (!WriteMeshFile(job.output, mesh->View())) {
+        std::fprintf(stderr, "mesh_compiler: cannot write %s\n", job.output.string().c_str());
+        return false;
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%s -> %s: %u vertices, %zu triangles, %zu submeshes, ACMR %.2f (%.1f ms)\n",
+                job.input.string().c_str(), job.output.string().c_str(), mesh->View().VertexCount(),
+                mesh->indices.size() / 3, mesh->submeshes.size(), ComputeAcmr(mesh->indices, mesh->View().VertexCount()), ms);
+    return true;
+}
+
+int Usage() {
+    std::fprintf(stderr, "usage: mesh_compiler [--force] <file.obj | directory>... [-o output.emesh]\n");
+    return 2;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::vector<fs::path> inputs;
+    fs::path output;
+    bool force = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            output = argv[++i];
+        else if (std::strcmp(argv[i], "--force") == 0)
+            force = true;
+        else if (argv[i][0] == '-')
+            return Usage();
+        else
+            inputs.emplace_back(argv[i]);
+    }
+    if (inputs.empty() || (!output.empty() && (inputs.size() != 1 || fs::is_directory(inputs[0])))) return Usage();
+
+    std::vector<Job> jobs;
+    for (const fs::path& input : inputs) {
+        if (!fs::is_directory(input)) {
+            jobs.push_back({ input, output.empty() ? fs::path(input).replace_extension(".emesh") : output });
+            continue;
+        }
+        for (const fs::directory_entry& entry : fs::recursive_directory_iterator(input))
+            if (entry.is_regular_file() && entry.path().extension() == ".obj")
+                jobs.push_back({ entry.path(), fs::path(entry.path()).replace_extension(".emesh") });
+    }
+
+    JobSystem pool;
+    ObjImportOptions options;
+    options.jobs = &pool;
+    int failures = 0, skipped = 0;
+    for (const Job& job : jobs) {
+        if (!force && UpToDate(job)) {
+            ++skipped;
+            continue;
+        }
+        failures += Compile(job, options) ? 0 : 1;
+    }
+    std::printf("mesh_compiler: %zu compiled, %d up to date, %d failed\n", jobs.size() - skipped - failures, skipped, failures);
+    return failures ? 1 : 0;
+}
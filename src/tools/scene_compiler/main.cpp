@@ -0,0 +1,114 @@
+/* scene_compiler: bakes JSON scenes into .escene files (see SceneFile.hpp,
+   SceneLoader.hpp for the JSON layout).
+
+usage:
+
+scene_compiler level1.json                   writes level1.escene next to it
+scene_compiler level1.json -o out/level1.escene
+scene_compiler assets/scenes                 every .json below the directory
+scene_compiler --chunk 4096 level1.json      entities per parallel load chunk
+
+A source is skipped when its .escene is newer, so the tool can run as a
+build step; --force rebuilds everything. */
+#include <engine/assets/SceneLoader.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Job {
+    fs::path input, output;
+};
+
+bool UpToDate(const Job& job) {
+    std::error_code error;
+    const fs::file_time_type out = fs::last_write_time(job.output, error);
+    return !error && out >= fs::last_write_time(job.input, error) && !error;
+}
+
+bool Compile(const Job& job, uint32_t chunkEntities) {
+    const auto start = std::chrono::steady_clock::now();
+    std::ifstream file(job.input, std::ios::binary);
+    if (!file) {
+        std::fprintf(stderr, "scene_compiler: cannot read %s\n", job.input.string().c_str());
+        return false;
+    }
+    std::stringstream json;
+    json << file.rdbuf();
+
+    std::string error;
+    const std::optional<SceneData> scene = ParseSceneJson(json.str(), &error);
+    if (!scene) {
+        std::fprintf(stderr, "scene_compiler: %s: %s\n", job.input.string().c_str(), error.c_str());
+        return false;
+    }
+    if (job.output.has_parent_path()) fs::create_directories(job.output.parent_path());
+    if (!WriteSceneFile(job.output, *scene, chunkEntities)) {
+        std::fprintf(stderr, "scene_compiler: cannot write %s\n", job.output.string().c_str());
+        return false;
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%s -> %s: %zu entities, %zu meshes, %zu materials (%.1f ms)\n", job.input.string().c_str(),
+                job.output.string().c_str(), scene->entities.size(), scene->meshes.size(), scene->materials.size(), ms);
+    return true;
+}
+
+int Usage() {
+    std::fprintf(stderr, "usage: scene_compiler [--force] [--chunk entities] <file.json | directory>... [-o output.escene]\n");
+    return 2;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::vector<fs::path> inputs;
+    fs::path output;
+    bool force = false;
+    uint32_t chunkEntities = DefaultSceneChunkEntities;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            output = argv[++i];
+        else if (std::strcmp(argv[i], "--force") == 0)
+            force = true;
+        else if (std::strcmp(argv[i], "--chunk") == 0 && i + 1 < argc)
+            chunkEntities = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (argv[i][0] == '-')
+            return Usage();
+        else
+            inputs.emplace_back(argv[i]);
+    }
+    if (inputs.empty() || chunkEntities == 0 || (!output.empty() && (inputs.size() != 1 || fs::is_directory(inputs[0]))))
+        return Usage();
+
+    std::vector<Job> jobs;
+    for (const fs::path& input : inputs) {
+        if (!fs::is_directory(input)) {
+            jobs.push_back({ input, output.empty() ? fs::path(input).replace_extension(".escene") : output });
+            continue;
+        }
+        for (const fs::directory_entry& entry : fs::recursive_directory_iterator(input))
+            if (entry.is_regular_file() && entry.path().extension() == ".json")
+                jobs.push_back({ entry.path(), fs::path(entry.path()).replace_extension(".escene") });
+    }
+
+    int failures = 0, skipped = 0;
+    for (const Job& job : jobs) {
+        if (!force && UpToDate(job)) {
+            ++skipped;
+            continue;
+        }
+        failures += Compile(job, chunkEntities) ? 0 : 1;
+    }
+    std::printf("scene_compiler: %zu compiled, %d up to date, %d failed\n", jobs.size() - skipped - failures, skipped, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,339 @@
+/* GLBackend stand-in for headless tests: records every call instead of
+   talking to a driver. Uniform locations are handed out per name so the
+   render path behaves as if every uniform exists. Buffer contents are kept
+   per name, and program reflection reports whatever a test puts in
+   activeUniforms / activeBlocks. Timer queries read a fake GPU clock that
+   advances gpuStepNs per QueryCounter. */
+#pragma once
+
+#include <engine/gl/GLBackend.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+struct RecordedCall {
+    enum Op { UseProgram, BindVertexArray, ActiveTexture, BindTexture, GetUniformLocation,
+              UniformMatrix4fv, DrawArrays, DrawElements, DrawArraysInstanced, DrawElementsInstanced,
+              GenBuffers, BindBuffer, BufferData, BufferSubData, EnableVertexAttribArray,
+              VertexAttribPointer, VertexAttribDivisor, Enable, Disable, BlendFunc, DepthFunc, DepthMask,
+              CullFace, Viewport, ClearColor, Clear, GenVertexArrays, DeleteBuffers, DeleteVertexArrays,
+              DeleteTextures, DeleteProgram, BindBufferBase, BindBufferRange, UniformBlockBinding,
+              Uniform1i, Uniform1f, Uniform4fv, GenTextures, TexParameteri, TexImage2D,
+              CompressedTexImage2D, GenQueries, DeleteQueries, QueryCounter } op;
+    unsigned a = 0;             // program / vao / unit / texture / location / first / buffer / attribute / enum
+    int count = 0;              // draw count / buffer size / attribute divisor / object count / binding index / image level
+    float matrix[16] = {};      // UniformMatrix4fv / Uniform4fv value, Uniform1f in [0]
+    int instances = 0;          // instanced draws; block binding for UniformBlockBinding, value for Uniform1i
+    std::size_t offset = 0;     // VertexAttribPointer / BufferSubData / BindBufferRange offset; CompressedTexImage2D size; base instance
+    const void* data = nullptr; // BufferData / BufferSubData / TexImage2D / CompressedTexImage2D source
+    int width = 0, height = 0;  // TexImage2D / CompressedTexImage2D; TexParameteri value in width
+};
+
+class RecordingGL final : public GLBackend {
+public:
+    std::vector<RecordedCall> calls;
+    std::vector<std::string> uniformNames;
+    std::vector<unsigned char> uploaded; // bytes of the last BufferSubData
+    GLuint nextBuffer = 1;   // names handed out by GenBuffers / GenVertexArrays
+    bool baseInstance = false; // what HasBaseInstance reports
+    bool s3tc = true;          // what HasTextureCompressionS3tc reports
+
+    std::map<GLuint, std::vector<unsigned char>> contents; // buffer name -> bytes
+    std::map<GLenum, GLuint> boundBuffers;                 // target -> buffer
+
+    struct ActiveUniform {
+        std::string name;
+        GLenum type;
+        GLint size; // array length
+    };
+    struct ActiveBlock {
+        std::string name;
+        GLint dataSize;
+    };
+    std::vector<ActiveUniform> activeUniforms;
+    std::vector<ActiveBlock> activeBlocks;
+    GLint uniformBufferAlignment = 256;
+
+    std::map<GLuint, GLuint64> timestamps; // query name -> GPU time it recorded
+    GLuint64 gpuClock = 0;
+    GLuint64 gpuStepNs = 1000;
+    bool queriesAvailable = true;
+
+    std::size_t Count(RecordedCall::Op op) const {
+        return static_cast<std::size_t>(std::count_if(calls.begin(), calls.end(),
+                                                      [op](const RecordedCall& c) { return c.op == op; }));
+    }
+
+    std::size_t Draws() const {
+        return Count(RecordedCall::DrawArrays) + Count(RecordedCall::DrawElements)
+             + Count(RecordedCall::DrawArraysInstanced) + Count(RecordedCall::DrawElementsInstanced);
+    }
+
+    void UseProgram(GLuint program) override { calls.push_back({ RecordedCall::UseProgram, program }); }
+    void BindVertexArray(GLuint vao) override { calls.push_back({ RecordedCall::BindVertexArray, vao }); }
+    void ActiveTexture(GLenum unit) override { calls.push_back({ RecordedCall::ActiveTexture, unit }); }
+    void BindTexture(GLenum, GLuint texture) override { calls.push_back({ RecordedCall::BindTexture, texture }); }
+
+    GLint GetUniformLocation(GLuint, const GLchar* name) override {
+        calls.push_back({ RecordedCall::GetUniformLocation });
+        auto it = std::find(uniformNames.begin(), uniformNames.end(), name);
+        if (it == uniformNames.end()) it = uniformNames.insert(uniformNames.end(), name);
+        return static_cast<GLint>(it - uniformNames.begin());
+    }
+
+    void UniformMatrix4fv(GLint location, GLsizei, GLboolean, const GLfloat* value) override {
+        RecordedCall call{ RecordedCall::UniformMatrix4fv, static_cast<unsigned>(location) };
+        std::copy(value, value + 16, call.matrix);
+        calls.push_back(call);
+    }
+
+    void DrawArrays(GLenum, GLint first, GLsizei count) override {
+        calls.push_back({ RecordedCall::DrawArrays, static_cast<unsigned>(first), count });
+    }
+
+    void DrawElements(GLenum, GLsizei count, GLenum, const void*) override {
+        calls.push_back({ RecordedCall::DrawElements, 0, count });
+    }
+
+    void DrawArraysInstanced(GLenum, GLint first, GLsizei count, GLsizei instances) override {
+        RecordedCall call{ RecordedCall::DrawArraysInstanced, static_cast<unsigned>(first), count };
+        call.instances = instances;
+        calls.push_back(call);
+    }
+
+    void DrawElementsInstanced(GLenum, GLsizei count, GLenum, const void*, GLsizei instances) override {
+        RecordedCall call{ RecordedCall::DrawElementsInstanced, 0, count };
+        call.instances = instances;
+        calls.push_back(call);
+    }
+
+    // recorded as the plain instanced draws, with the base instance in `offset`
+    bool HasBaseInstance() override { return baseInstance; }
+
+    void DrawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count, GLsizei instances, GLuint base) override {
+        DrawArraysInstanced(mode, first, count, instances);
+        calls.back().offset = base;
+    }
+
+    void DrawElementsInstancedBaseInstance(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instances, GLuint base) override {
+        DrawElementsInstanced(mode, count, type, indices, instances);
+        calls.back().offset = base;
+    }
+
+    void GenBuffers(GLsizei n, GLuint* buffers) override {
+        for (GLsizei i = 0; i < n; ++i) buffers[i] = nextBuffer++;
+        calls.push_back({ RecordedCall::GenBuffers, 0, n });
+    }
+
+    void BindBuffer(GLenum target, GLuint buffer) override {
+        boundBuffers[target] = buffer;
+        calls.push_back({ RecordedCall::BindBuffer, buffer });
+    }
+
+    void BindBufferBase(GLenum target, GLuint index, GLuint buffer) override {
+        boundBuffers[target] = buffer;
+        calls.push_back({ RecordedCall::BindBufferBase, buffer, static_cast<int>(index) });
+    }
+
+    void BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr) override {
+        boundBuffers[target] = buffer;
+        RecordedCall call{ RecordedCall::BindBufferRange, buffer, static_cast<int>(index) };
+        call.offset = static_cast<std::size_t>(offset);
+        calls.push_back(call);
+    }
+
+    void BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum) override {
+        std::vector<unsigned char>& bytes = contents[boundBuffers[target]];
+        bytes.assign(static_cast<std::size_t>(size), 0);
+        if (data) std::memcpy(bytes.data(), data, static_cast<std::size_t>(size));
+        RecordedCall call{ RecordedCall::BufferData, target, static_cast<int>(size) };
+        call.data = data;
+        calls.push_back(call);
+    }
+
+    void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) override {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        uploaded.assign(bytes, bytes + size);
+        std::vector<unsigned char>& stored = contents[boundBuffers[target]];
+        if (stored.size() < static_cast<std::size_t>(offset + size)) stored.resize(static_cast<std::size_t>(offset + size));
+        std::memcpy(stored.data() + offset, data, static_cast<std::size_t>(size));
+        RecordedCall call{ RecordedCall::BufferSubData, 0, static_cast<int>(size) };
+        call.offset = static_cast<std::size_t>(offset);
+        call.data = data;
+        calls.push_back(call);
+    }
+
+    // Reads a T at `offset` of the buffer's simulated contents.
+    template<typename T>
+    T Read(GLuint buffer, std::size_t offset) const {
+        T value{};
+        const std::vector<unsigned char>& bytes = contents.at(buffer);
+        if (offset + sizeof(T) <= bytes.size()) std::memcpy(&value, bytes.data() + offset, sizeof(T));
+        return value;
+    }
+
+    void GetIntegerv(GLenum pname, GLint* data) override {
+        *data = pname == GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT ? uniformBufferAlignment : 0;
+    }
+
+    void GetProgramiv(GLuint, GLenum pname, GLint* params) override {
+        *params = 0;
+        if (pname == GL_ACTIVE_UNIFORMS) *params = static_cast<GLint>(activeUniforms.size());
+        if (pname == GL_ACTIVE_UNIFORM_BLOCKS) *params = static_cast<GLint>(activeBlocks.size());
+        if (pname == GL_ACTIVE_UNIFORM_MAX_LENGTH)
+            for (const ActiveUniform& uniform : activeUniforms)
+                *params = std::max(*params, static_cast<GLint>(uniform.name.size() + 4)); // room for "[0]"
+        if (pname == GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH)
+            for (const ActiveBlock& block : activeBlocks)
+                *params = std::max(*params, static_cast<GLint>(block.name.size() + 1));
+    }
+
+    // Arrays report "name[0]" like real drivers do.
+    void GetActiveUniform(GLuint, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name) override {
+        const ActiveUniform& uniform = activeUniforms[index];
+        const std::string reported = uniform.size > 1 ? uniform.name + "[0]" : uniform.name;
+        const std::size_t n = std::min(reported.size(), static_cast<std::size_t>(bufSize - 1));
+        std::memcpy(name, reported.data(), n);
+        name[n] = '\0';
+        if (length) *length = static_cast<GLsizei>(n);
+        *size = uniform.size;
+        *type = uniform.type;
+    }
+
+    void GetActiveUniformBlockiv(GLuint, GLuint index, GLenum pname, GLint* params) override {
+        *params = pname == GL_UNIFORM_BLOCK_DATA_SIZE ? activeBlocks[index].dataSize : 0;
+    }
+
+    void GetActiveUniformBlockName(GLuint, GLuint index, GLsizei bufSize, GLsizei* length, GLchar* name) override {
+        const std::string& reported = activeBlocks[index].name;
+        const std::size_t n = std::min(reported.size(), static_cast<std::size_t>(bufSize - 1));
+        std::memcpy(name, reported.data(), n);
+        name[n] = '\0';
+        if (length) *length = static_cast<GLsizei>(n);
+    }
+
+    void UniformBlockBinding(GLuint program, GLuint blockIndex, GLuint binding) override {
+        RecordedCall call{ RecordedCall::UniformBlockBinding, program, static_cast<int>(blockIndex) };
+        call.instances = static_cast<int>(binding);
+        calls.push_back(call);
+    }
+
+    void Uniform1i(GLint location, GLint value) override {
+        RecordedCall call{ RecordedCall::Uniform1i, static_cast<unsigned>(location) };
+        call.instances = value;
+        calls.push_back(call);
+    }
+
+    void Uniform1f(GLint location, GLfloat value) override {
+        RecordedCall call{ RecordedCall::Uniform1f, static_cast<unsigned>(location) };
+        call.matrix[0] = value;
+        calls.push_back(call);
+    }
+
+    void Uniform4fv(GLint location, GLsizei, const GLfloat* value) override {
+        RecordedCall call{ RecordedCall::Uniform4fv, static_cast<unsigned>(location) };
+        std::copy(value, value + 4, call.matrix);
+        calls.push_back(call);
+    }
+
+    void EnableVertexAttribArray(GLuint index) override {
+        calls.push_back({ RecordedCall::EnableVertexAttribArray, index });
+    }
+
+    void VertexAttribPointer(GLuint index, GLint, GLenum, GLboolean, GLsizei, const void* pointer) override {
+        RecordedCall call{ RecordedCall::VertexAttribPointer, index };
+        call.offset = reinterpret_cast<std::size_t>(pointer);
+        calls.push_back(call);
+    }
+
+    void VertexAttribDivisor(GLuint index, GLuint divisor) override {
+        calls.push_back({ RecordedCall::VertexAttribDivisor, index, static_cast<int>(divisor) });
+    }
+
+    void Enable(GLenum capability) override { calls.push_back({ RecordedCall::Enable, capability }); }
+    void Disable(GLenum capability) override { calls.push_back({ RecordedCall::Disable, capability }); }
+    void BlendFunc(GLenum source, GLenum) override { calls.push_back({ RecordedCall::BlendFunc, source }); }
+    void DepthFunc(GLenum func) override { calls.push_back({ RecordedCall::DepthFunc, func }); }
+    void DepthMask(GLboolean write) override { calls.push_back({ RecordedCall::DepthMask, write }); }
+    void CullFace(GLenum face) override { calls.push_back({ RecordedCall::CullFace, face }); }
+
+    void Viewport(GLint, GLint, GLsizei width, GLsizei height) override {
+        calls.push_back({ RecordedCall::Viewport, static_cast<unsigned>(width), height });
+    }
+
+    void ClearColor(GLfloat, GLfloat, GLfloat, GLfloat) override { calls.push_back({ RecordedCall::ClearColor }); }
+    void Clear(GLbitfield mask) override { calls.push_back({ RecordedCall::Clear, mask }); }
+
+    void GenVertexArrays(GLsizei n, GLuint* vaos) override {
+        for (GLsizei i = 0; i < n; ++i) vaos[i] = nextBuffer++;
+        calls.push_back({ RecordedCall::GenVertexArrays, 0, n });
+    }
+
+    void DeleteBuffers(GLsizei n, const GLuint* names) override {
+        calls.push_back({ RecordedCall::DeleteBuffers, names[0], n });
+    }
+
+    void DeleteVertexArrays(GLsizei n, const GLuint* vaos) override {
+        calls.push_back({ RecordedCall::DeleteVertexArrays, vaos[0], n });
+    }
+
+    void DeleteTextures(GLsizei n, const GLuint* names) override {
+        calls.push_back({ RecordedCall::DeleteTextures, names[0], n });
+    }
+
+    void DeleteProgram(GLuint program) override { calls.push_back({ RecordedCall::DeleteProgram, program }); }
+
+    void GenTextures(GLsizei n, GLuint* textures) override {
+        for (GLsizei i = 0; i < n; ++i) textures[i] = nextBuffer++;
+        calls.push_back({ RecordedCall::GenTextures, 0, n });
+    }
+
+    void TexParameteri(GLenum, GLenum pname, GLint param) override {
+        RecordedCall call{ RecordedCall::TexParameteri, pname };
+        call.width = param;
+        calls.push_back(call);
+    }
+
+    void TexImage2D(GLenum, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint, GLenum, GLenum,
+                    const void* pixels) override {
+        RecordedCall call{ RecordedCall::TexImage2D, static_cast<unsigned>(internalFormat), level };
+        call.width = width;
+        call.height = height;
+        call.data = pixels;
+        calls.push_back(call);
+    }
+
+    void CompressedTexImage2D(GLenum, GLint level, GLenum internalFormat, GLsizei width, GLsizei height, GLint,
+                              GLsizei imageSize, const void* data) override {
+        RecordedCall call{ RecordedCall::CompressedTexImage2D, internalFormat, level };
+        call.width = width;
+        call.height = height;
+        call.offset = static_cast<std::size_t>(imageSize);
+        call.data = data;
+        calls.push_back(call);
+    }
+
+    bool HasTextureCompressionS3tc() override { return s3tc; }
+
+    void GenQueries(GLsizei n, GLuint* queries) override {
+        for (GLsizei i = 0; i < n; ++i) queries[i] = nextBuffer++;
+        calls.push_back({ RecordedCall::GenQueries, 0, n });
+    }
+
+    void DeleteQueries(GLsizei n, const GLuint*) override { calls.push_back({ RecordedCall::DeleteQueries, 0, n }); }
+
+    void QueryCounter(GLuint query, GLenum) override {
+        timestamps[query] = gpuClock;
+        gpuClock += gpuStepNs;
+        calls.push_back({ RecordedCall::QueryCounter, query });
+    }
+
+    void GetQueryObjectiv(GLuint, GLenum pname, GLint* params) override {
+        *params = pname == GL_QUERY_RESULT_AVAILABLE && queriesAvailable ? GL_TRUE : GL_FALSE;
+    }
+
+    void GetQueryObjectui64v(GLuint query, GLenum, GLuint64* params) override { *params = timestamps[query]; }
+};
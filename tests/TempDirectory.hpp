@@ -0,0 +1,14 @@
+/* Fresh directory under the system temp dir for tests that touch files,
+   removed (with its contents) on scope exit. */
+#pragma once
+
+#include <filesystem>
+
+struct TempDirectory {
+    std::filesystem::path path;
+
+    explicit TempDirectory(const char* name) : path(std::filesystem::temp_directory_path() / name) {
+        std::filesystem::remove_all(path);
+    }
+    ~TempDirectory() { std::filesystem::remove_all(path); }
+};
@@ -0,0 +1,45 @@
+/* Minimal self-registering test harness shared by every tests/*.cpp file.
+   TEST_CASE(Name) { CHECK(expr); } registers a test; test_main.cpp runs them all. */
+#pragma once
+
+#include <iostream>
+#include <vector>
+
+namespace test {
+
+struct TestCase {
+    const char* name;
+    void (*fn)();
+};
+
+inline std::vector<TestCase>& Registry() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+inline int& FailureCount() {
+    static int failures = 0;
+    return failures;
+}
+
+struct Registrar {
+    Registrar(const char* name, void (*fn)()) { Registry().push_back({ name, fn }); }
+};
+
+inline void ReportFailure(const char* expr, const char* file, int line) {
+    ++FailureCount();
+    std::cerr << file << ":" << line << ": CHECK failed: " << expr << "\n";
+}
+
+}
+
+#define TEST_CASE(name)                                              \
+    static void name();                                              \
+    static const test::Registrar name##_registrar(#name, &name);     \
+    static void name()
+
+// Variadic so template argument lists with commas need no extra parentheses.
+#define CHECK(...)                                                            \
+    do {                                                                      \
+        if (!(__VA_ARGS__)) test::ReportFailure(#__VA_ARGS__, __FILE__, __LINE__); \
+    } while (0)
@@ -0,0 +1,858 @@
+#include "TestFramework.hpp"
+#include "RecordingGL.hpp"
+#include "TempDirectory.hpp"
+#include <engine/assets/AssetManager.hpp>
+#include <engine/assets/MeshLoader.hpp>
+#include <engine/assets/MeshOptimizer.hpp>
+#include <engine/assets/SceneLoader.hpp>
+#include <engine/assets/TextureLoader.hpp>
+#include <engine/core/JobSystem.hpp>
+#include <engine/systems/TransformSystem.hpp>
+#include <engine/utils/Json.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void WriteText(const std::filesystem::path& path, const std::string& text) {
+    std::ofstream(path, std::ios::binary) << text;
+}
+
+std::optional<std::string> ReadText(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return std::nullopt;
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// Stand-in for a GPU resource: "uploads" the decoded text into a buffer.
+struct FakeTexture {
+    GLuint name = 0;
+    std::size_t bytes = 0;
+};
+
+}
+
+TEST_CASE(AssetManager_DeduplicatesConcurrentLoadsAndRefCounts) {
+    TempDirectory dir("engine_asset_dedup_test");
+    std::filesystem::create_directories(dir.path);
+    WriteText(dir.path / "a.txt", "alpha");
+    WriteText(dir.path / "b.txt", "beta");
+
+    JobSystem jobs(3);
+    AssetManager assets(&jobs, dir.path);
+    std::atomic<int> decodes{ 0 };
+    assets.RegisterLoader<std::string>([&](const std::filesystem::path& path) {
+        ++decodes;
+        return ReadText(path);
+    });
+
+    // eight threads ask for the same two files at once
+    std::vector<Asset<std::string>> handles(16);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+        threads.emplace_back([&, t] {
+            handles[t * 2] = assets.Load<std::string>("a.txt");
+            handles[t * 2 + 1] = assets.Load<std::string>("b.txt");
+        });
+    for (std::thread& thread : threads) thread.join();
+
+    RecordingGL gl;
+    assets.Flush(gl);
+    CHECK(decodes == 2);
+    CHECK(assets.GetStats().requests == 16 && assets.GetStats().deduplicated == 14);
+    CHECK(handles[0].Get() && *handles[0].Get() == "alpha" && *handles[15].Get() == "beta");
+    for (int t = 0; t < 8; ++t) CHECK(handles[t * 2] == handles[0] && handles[t * 2 + 1] == handles[1]);
+
+    // copies keep it alive; the last handle going away unloads it on Poll
+    Asset<std::string> copy = handles[0];
+    for (Asset<std::string>& handle : handles) handle = {};
+    assets.Poll(gl);
+    CHECK(copy.Ready() && assets.GetStats().resident == 1);
+    copy = {};
+    assets.Poll(gl);
+    CHECK(assets.GetStats().resident == 0);
+
+    // a later request loads it again
+    Asset<std::string> again = assets.Load<std::string>("a.txt");
+    assets.Flush(gl);
+    CHECK(decodes == 3 && again.Ready());
+}
+
+TEST_CASE(AssetManager_UploadsWithinFrameBudgetAndUnloadsOnGLThread) {
+    TempDirectory dir("engine_asset_upload_test");
+    std::filesystem::create_directories(dir.path);
+    for (int i = 0; i < 6; ++i) WriteText(dir.path / (std::to_string(i) + ".tex"), std::string(100 + i, 'x'));
+
+    JobSystem jobs(2);
+    AssetManager assets(&jobs, dir.path);
+    std::thread::id uploadThread;
+    std::vector<GLuint> deleted;
+    assets.RegisterLoader<FakeTexture, std::string>(
+        [](const std::filesystem::path& path) { return ReadText(path); },
+        [&](GLBackend& gl, std::string& pixels) -> std::optional<FakeTexture> {
+            uploadThread = std::this_thread::get_id();
+            FakeTexture texture;
+            gl.GenBuffers(1, &texture.name);
+            gl.BindBuffer(GL_ARRAY_BUFFER, texture.name);
+            gl.BufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(pixels.size()), pixels.data(), GL_STATIC_DRAW);
+            texture.bytes = pixels.size();
+            return texture;
+        },
+        [&](GLBackend& gl, FakeTexture& texture) {
+            gl.DeleteBuffers(1, &texture.name);
+            deleted.push_back(texture.name);
+        });
+
+    std::vector<Asset<FakeTexture>> textures;
+    for (int i = 0; i < 6; ++i) textures.push_back(assets.Load<FakeTexture>(std::to_string(i) + ".tex"));
+    Asset<FakeTexture> missing = assets.Load<FakeTexture>("missing.tex");
+    CHECK(textures[0].State() != AssetState::Ready); // nothing reaches GL before Poll
+
+    // a zero budget still finishes one upload per frame
+    RecordingGL gl;
+    const auto uploading = [](const Asset<FakeTexture>& t) { return t.State() == AssetState::Uploading; };
+    while (std::count_if(textures.begin(), textures.end(), uploading) < 6 || !missing.Failed())
+        std::this_thread::yield();
+    CHECK(assets.Poll(gl, 0.0) == 5);
+    CHECK(assets.GetStats().uploaded == 1 && gl.Count(RecordedCall::BufferData) == 1);
+    CHECK(uploadThread == std::this_thread::get_id());
+
+    assets.Flush(gl);
+    CHECK(missing.Failed() && missing.Get() == nullptr);
+    for (int i = 0; i < 6; ++i) CHECK(textures[i].Ready() && textures[i].Get()->bytes == std::size_t(100 + i));
+
+    const GLuint first = textures[0].Get()->name;
+    textures.erase(textures.begin());
+    CHECK(deleted.empty());
+    assets.Poll(gl);
+    CHECK(deleted == std::vector<GLuint>{ first });
+
+    assets.Clear(gl);
+    CHECK(deleted.size() == 6 && textures[0].Failed());
+}
+
+namespace {
+
+// Unit cube corner positions, two materials, quads and a negative-index face.
+constexpr const char* CubeObj = R"(# test cube
+v 0 0 0
+v 1 0 0
+v 1 1 0
+v 0 1 0
+v 0 0 1
+v 1 0 1
+v 1 1 1
+v 0 1 1
+vt 0 0
+vt 1 0
+vt 1 1
+vt 0 1
+usemtl red
+f 1/1 2/2 3/3 4/4
+f 5/1 8/4 7/3 6/2
+usemtl blue
+f 1/1 5/2 6/3 2/4
+f -5/4 -1/3 -4/2 -8/1
+)";
+
+}
+
+TEST_CASE(MeshLoader_ParsesObjWeldsAndSplitsSubmeshes) {
+    const std::optional<MeshData> mesh = ParseObj(CubeObj);
+    CHECK(mesh.has_value());
+    if (!mesh) return;
+
+    CHECK(mesh->indices.size() == 4 * 6); // four quads, two triangles each
+    CHECK(mesh->vertexStride == sizeof(StandardVertex) && mesh->attributes.size() == 3);
+    CHECK(mesh->View().VertexCount() == 12); // 16 corners, four repeat an earlier position/uv pair
+    CHECK(mesh->submeshes.size() == 2);
+    CHECK(mesh->submeshes[0].material == 0 && mesh->submeshes[0].indexCount == 12);
+    CHECK(mesh->submeshes[1].material == 1 && mesh->submeshes[1].firstIndex == 12);
+    CHECK(mesh->bounds.min == glm::vec3(0.0f) && mesh->bounds.max == glm::vec3(1.0f));
+    CHECK(mesh->submeshes[0].boundsMin[2] == 0.0f && mesh->submeshes[0].boundsMax[2] == 1.0f);
+
+    // no normals in the file: generated, unit length
+    const auto* vertices = reinterpret_cast<const StandardVertex*>(mesh->vertices.data());
+    const glm::vec3 n(vertices[0].normal[0], vertices[0].normal[1], vertices[0].normal[2]);
+    CHECK(std::abs(glm::length(n) - 1.0f) < 1e-5f);
+
+    CHECK(!ParseObj("v 0 0 0\nf 1 2 3\n"));   // index out of range
+    CHECK(!ParseObj("v 0 0\n"));               // short vertex
+
+    // 1-component texture coordinates: v defaults to 0
+    const std::optional<MeshData> strip = ParseObj("v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0.25\nvt 0.5 0.75 0\nf 1/1 2/2 3/1\n");
+    CHECK(strip.has_value());
+    if (strip) {
+        const auto* stripVertices = reinterpret_cast<const StandardVertex*>(strip->vertices.data());
+        CHECK(stripVertices[0].uv[0] == 0.25f && stripVertices[0].uv[1] == 0.0f);
+        CHECK(stripVertices[1].uv[0] == 0.5f && stripVertices[1].uv[1] == 0.75f);
+    }
+    CHECK(!ParseObj("v 0 0 0\nvt\nf 1 1 1\n")); // no components at all
+    CHECK(!ParseObj("# nothing to draw\n"));
+}
+
+TEST_CASE(MeshFile_MapsBakedMeshAndUploadsWithoutCopies) {
+    TempDirectory dir("engine_mesh_file_test");
+    const std::optional<MeshData> mesh = ParseObj(CubeObj);
+    CHECK(mesh && WriteMeshFile(dir.path / "cube.emesh", mesh->View()));
+
+    std::optional<MeshFile> file = MeshFile::Open(dir.path / "cube.emesh");
+    CHECK(file.has_value());
+    if (!file || !mesh) return;
+    const MeshView view = file->View();
+    CHECK(view.VertexCount() == mesh->View().VertexCount() && view.vertexStride == mesh->vertexStride);
+    CHECK(std::equal(view.indices.begin(), view.indices.end(), mesh->indices.begin(), mesh->indices.end()));
+    CHECK(std::equal(view.vertices.begin(), view.vertices.end(), mesh->vertices.begin(), mesh->vertices.end()));
+    CHECK(view.submeshes.size() == 2 && view.submeshes[1].firstIndex == 12);
+    CHECK(view.bounds.max == glm::vec3(1.0f));
+    CHECK(reinterpret_cast<uintptr_t>(view.vertices.data()) % 16 == 0);
+
+    // the buffers are filled straight from the mapping
+    RecordingGL gl;
+    MeshAsset uploaded = UploadMesh(gl, view);
+    std::vector<const void*> sources;
+    for (const RecordedCall& call : gl.calls)
+        if (call.op == RecordedCall::BufferData) sources.push_back(call.data);
+    CHECK(sources == (std::vector<const void*>{ view.vertices.data(), view.indices.data() }));
+    CHECK(gl.Count(RecordedCall::VertexAttribPointer) == 3);
+    CHECK(uploaded.mesh.indexed && uploaded.mesh.count == 24 && uploaded.submeshes.size() == 2);
+    DestroyMesh(gl, uploaded);
+    CHECK(gl.Count(RecordedCall::DeleteVertexArrays) == 1 && gl.Count(RecordedCall::DeleteBuffers) == 1);
+
+    // damaged files are rejected
+    std::filesystem::copy_file(dir.path / "cube.emesh", dir.path / "short.emesh");
+    std::filesystem::resize_file(dir.path / "short.emesh", std::filesystem::file_size(dir.path / "cube.emesh") - 4);
+    CHECK(!MeshFile::Open(dir.path / "short.emesh"));
+    WriteText(dir.path / "text.emesh", std::string(200, 'x'));
+    CHECK(!MeshFile::Open(dir.path / "text.emesh"));
+    CHECK(!MeshFile::Open(dir.path / "missing.emesh"));
+}
+
+TEST_CASE(MeshLoader_LoadsBakedMeshesThroughAssetManager) {
+    TempDirectory dir("engine_mesh_asset_test");
+    CHECK(WriteMeshFile(dir.path / "models/cube.emesh", ParseObj(CubeObj)->View()));
+
+    JobSystem jobs(2);
+    AssetManager assets(&jobs, dir.path);
+    RegisterMeshLoader(assets);
+    Asset<MeshAsset> cube = assets.Load<MeshAsset>("models/cube.emesh");
+    Asset<MeshAsset> missing = assets.Load<MeshAsset>("models/missing.emesh");
+
+    RecordingGL gl;
+    assets.Flush(gl);
+    CHECK(cube.Ready() && cube.Get()->mesh.count == 24 && cube.Get()->mesh.bounds.IsFinite());
+    CHECK(missing.Failed());
+
+    assets.Clear(gl);
+    CHECK(gl.Count(RecordedCall::DeleteVertexArrays) == 1);
+}
+
+namespace {
+
+// n x n quads in row order, vt per vertex and one shared normal; the two
+// halves use different materials and the second half references its
+// vertices with negative indices.
+std::string GridObj(int n) {
+    std::string obj;
+    for (int z = 0; z <= n; ++z)
+        for (int x = 0; x <= n; ++x) {
+            obj += "v " + std::to_string(x) + " 0 " + std::to_string(z) + "\n";
+            obj += "vt " + std::to_string(x) + " " + std::to_string(z) + "\n";
+        }
+    obj += "vn 0 1 0\nusemtl near\n";
+    const int vertexCount = (n + 1) * (n + 1);
+    for (int z = 0; z < n; ++z) {
+        if (z == n / 2) obj += "usemtl far\n";
+        for (int x = 0; x < n; ++x) {
+            obj += "f";
+            const int a = z * (n + 1) + x + 1;
+            for (const int v : { a, a + n + 1, a + n + 2, a + 1 }) {
+                const int reference = z < n / 2 ? v : v - vertexCount - 1;
+                obj += " " + std::to_string(reference) + "/" + std::to_string(reference) + "/1";
+            }
+            obj += "\n";
+        }
+    }
+    return obj;
+}
+
+// Triangles as sets of vertex positions, independent of vertex numbering and corner order.
+using PositionTriangle = std::array<std::array<float, 3>, 3>;
+
+std::multiset<PositionTriangle> PositionTriangles(const MeshData& mesh, uint32_t first, uint32_t count) {
+    const auto* vertices = reinterpret_cast<const StandardVertex*>(mesh.vertices.data());
+    std::multiset<PositionTriangle> triangles;
+    for (uint32_t i = first; i < first + count; i += 3) {
+        PositionTriangle corners;
+        for (uint32_t k = 0; k < 3; ++k) {
+            const float* p = vertices[mesh.indices[i + k]].position;
+            corners[k] = { p[0], p[1], p[2] };
+        }
+        std::sort(corners.begin(), corners.end());
+        triangles.insert(corners);
+    }
+    return triangles;
+}
+
+}
+
+TEST_CASE(MeshLoader_ParallelChunkedParseMatchesSerial) {
+    const std::string obj = GridObj(24);
+    ObjImportOptions serial;
+    serial.optimize = false;
+    const std::optional<MeshData> expected = ParseObj(obj, serial);
+    CHECK(expected && expected->View().VertexCount() == 25 * 25 && expected->indices.size() == 24 * 24 * 6);
+    if (!expected) return;
+
+    JobSystem jobs(3);
+    for (const std::size_t chunkBytes : { std::size_t{ 1 }, std::size_t{ 100 }, std::size_t{ 4096 } }) {
+        ObjImportOptions parallel = serial;
+        parallel.jobs = &jobs;
+        parallel.chunkBytes = chunkBytes;
+        const std::optional<MeshData> mesh = ParseObj(obj, parallel);
+        CHECK(mesh.has_value());
+        if (!mesh) continue;
+        CHECK(mesh->vertices == expected->vertices);
+        CHECK(mesh->indices == expected->indices);
+        CHECK(mesh->submeshes.size() == 2 && mesh->submeshes[1].firstIndex == 12 * 24 * 6);
+        CHECK(mesh->submeshes[1].material == 1 && mesh->submeshes[1].indexCount == 12 * 24 * 6);
+    }
+
+    ObjImportOptions small;
+    small.chunkBytes = 16;
+    CHECK(!ParseObj("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\nf -1 -2 -4\n", small)); // reaches before the first vertex
+}
+
+TEST_CASE(MeshOptimizer_ReordersForVertexCacheAndFetch) {
+    ObjImportOptions raw;
+    raw.optimize = false;
+    const std::optional<MeshData> source = ParseObj(GridObj(64), raw);
+    CHECK(source.has_value());
+    if (!source) return;
+    MeshData mesh = *source;
+    const uint32_t vertexCount = mesh.View().VertexCount();
+
+    // rows of 65 vertices do not fit a 16-entry cache: every vertex is transformed twice
+    const float before = ComputeAcmr(mesh.indices, vertexCount);
+    OptimizeMesh(mesh);
+    const float after = ComputeAcmr(mesh.indices, vertexCount);
+    CHECK(before > 0.95f);
+    CHECK(after < 0.8f && after < before);
+    CHECK(ComputeAcmr(std::vector<uint32_t>{ 0, 1, 2, 2, 1, 3 }, 4) == 2.0f);
+
+    // same triangles, still inside their submeshes
+    CHECK(mesh.submeshes.size() == 2 && mesh.View().VertexCount() == vertexCount);
+    for (const MeshSubmesh& submesh : mesh.submeshes)
+        CHECK(PositionTriangles(mesh, submesh.firstIndex, submesh.indexCount)
+              == PositionTriangles(*source, submesh.firstIndex, submesh.indexCount));
+
+    // vertex fetch order: vertices appear in the index buffer in increasing order
+    uint32_t next = 0;
+    bool firstUseOrder = true;
+    for (uint32_t index : mesh.indices) {
+        if (index > next) firstUseOrder = false;
+        if (index == next) ++next;
+    }
+    CHECK(firstUseOrder && next == vertexCount);
+}
+
+namespace {
+
+// Uncompressed 32-bit TGA, top-left origin; stb_image reads it like any other source.
+void WriteTga(const std::filesystem::path& path, const Image& image) {
+    unsigned char header[18] = {};
+    header[2] = 2; // uncompressed true-colour
+    header[12] = static_cast<unsigned char>(image.width & 0xFF);
+    header[13] = static_cast<unsigned char>(image.width >> 8);
+    header[14] = static_cast<unsigned char>(image.height & 0xFF);
+    header[15] = static_cast<unsigned char>(image.height >> 8);
+    header[16] = 32;
+    header[17] = 0x28; // 8 alpha bits, top-left origin
+    std::string bytes(reinterpret_cast<const char*>(header), sizeof(header));
+    for (std::size_t i = 0; i < image.pixels.size(); i += 4) {
+        const uint8_t* p = image.pixels.data() + i;
+        bytes += { static_cast<char>(p[2]), static_cast<char>(p[1]), static_cast<char>(p[0]), static_cast<char>(p[3]) };
+    }
+    WriteText(path, bytes);
+}
+
+Image Gradient(uint32_t width, uint32_t height, uint8_t alpha) {
+    Image image{ width, height, {} };
+    for (uint32_t y = 0; y < height; ++y)
+        for (uint32_t x = 0; x < width; ++x)
+            image.pixels.insert(image.pixels.end(), { static_cast<uint8_t>(x * 4), static_cast<uint8_t>(y * 8), 64, alpha });
+    return image;
+}
+
+}
+
+TEST_CASE(TextureLoader_BuildsGammaCorrectMipChains) {
+    // black/white checker with alpha 0/255: colour averages in linear light, alpha linearly
+    const Image checker{ 2, 2, { 0, 0, 0, 0,  255, 255, 255, 255,  255, 255, 255, 255,  0, 0, 0, 0 } };
+    const Image srgb = Downsample(checker, ColorSpace::Srgb);
+    CHECK(srgb.width == 1 && srgb.height == 1);
+    CHECK(srgb.pixels == (std::vector<uint8_t>{ 188, 188, 188, 128 })); // linear 0.5 is sRGB 188, not 128
+    CHECK(Downsample(checker, ColorSpace::Linear).pixels == (std::vector<uint8_t>{ 128, 128, 128, 128 }));
+
+    // a flat colour survives every level unchanged
+    Image flat{ 37, 10, {} };
+    for (int i = 0; i < 37 * 10; ++i) flat.pixels.insert(flat.pixels.end(), { 200, 90, 17, 255 });
+    const std::vector<Image> chain = BuildMipChain(flat, ColorSpace::Srgb);
+    CHECK(chain.size() == 6); // 37x10, 18x5, 9x2, 4x1, 2x1, 1x1
+    CHECK(chain[1].width == 18 && chain[1].height == 5 && chain[3].width == 4 && chain[3].height == 1);
+    CHECK(chain.back().width == 1 && chain.back().height == 1);
+    CHECK(chain.back().pixels == (std::vector<uint8_t>{ 200, 90, 17, 255 }));
+}
+
+TEST_CASE(TextureLoader_SimdDownsampleMatchesScalar) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> byte(0, 255);
+    for (const auto [width, height] : { std::pair{ 64u, 64u }, std::pair{ 37u, 21u }, std::pair{ 1u, 9u }, std::pair{ 19u, 1u } }) {
+        Image image{ width, height, std::vector<uint8_t>(std::size_t{ width } * height * 4) };
+        for (uint8_t& value : image.pixels) value = static_cast<uint8_t>(byte(rng));
+        for (const ColorSpace space : { ColorSpace::Srgb, ColorSpace::Linear }) {
+            const Image simd = Downsample(image, space);
+            const Image scalar = DownsampleScalar(image, space);
+            CHECK(simd.width == scalar.width && simd.height == scalar.height && simd.pixels == scalar.pixels);
+        }
+    }
+}
+
+TEST_CASE(TextureLoader_DecodesBlocksWithoutS3tc) {
+    TextureOptions options;
+    const Image opaque = Gradient(20, 12, 255);
+    const TextureData bc1 = BakeTexture(opaque, options);
+    const TextureData bc3 = BakeTexture(Gradient(8, 8, 100), options);
+    CHECK(bc1.format == TextureFormat::BC1 && bc3.format == TextureFormat::BC3);
+
+    // decoded blocks stay close to the source; BC3 keeps its alpha
+    const TextureData decoded = DecompressTexture(bc1.View());
+    CHECK(decoded.format == TextureFormat::RGBA8 && decoded.levels.size() == bc1.levels.size());
+    CHECK(decoded.levels[0].width == 20 && decoded.levels[0].pixels.size() == opaque.pixels.size());
+    int worst = 0;
+    for (std::size_t i = 0; i < opaque.pixels.size(); ++i)
+        worst = std::max(worst, std::abs(int{ decoded.levels[0].pixels[i] } - int{ opaque.pixels[i] }));
+    CHECK(worst <= 12);
+    const TextureData decodedAlpha = DecompressTexture(bc3.View());
+    CHECK(decodedAlpha.levels[0].pixels[3] == 100 && decodedAlpha.levels[0].pixels.back() == 100);
+
+    // without S3TC the upload sends RGBA8 levels, from firstLevel on
+    RecordingGL gl;
+    gl.s3tc = false;
+    TextureAsset texture = UploadTexture(gl, bc1.View(), 1);
+    CHECK(gl.Count(RecordedCall::CompressedTexImage2D) == 0 && gl.Count(RecordedCall::TexImage2D) == 4); // 10x6 .. 1x1
+    CHECK(texture.format == TextureFormat::RGBA8 && texture.firstLevel == 1 && texture.width == 10);
+    CHECK(texture.gpuBytes == (10 * 6 + 5 * 3 + 2 * 1 + 1) * 4);
+    for (const RecordedCall& call : gl.calls)
+        if (call.op == RecordedCall::TexImage2D) CHECK(call.a == GL_SRGB8_ALPHA8 && call.count >= 1);
+
+    // streaming the top level back decodes and sends that level alone
+    gl.calls.clear();
+    RestreamTexture(gl, texture, bc1.View(), 0);
+    CHECK(gl.Count(RecordedCall::TexImage2D) == 1 && gl.Count(RecordedCall::GenTextures) == 0);
+    CHECK(gl.calls.back().op == RecordedCall::TexParameteri && gl.calls.back().width == 0);
+    CHECK(texture.firstLevel == 0 && texture.width == 20 && texture.mipCount == 5);
+    CHECK(texture.gpuBytes == (20 * 12 + 10 * 6 + 5 * 3 + 2 * 1 + 1) * 4);
+}
+
+TEST_CASE(TextureFile_ConcurrentWritersOfOneEntry) {
+    TempDirectory dir("engine_texture_writers_test");
+    const TextureData baked = BakeTexture(Gradient(16, 16, 255), TextureOptions{});
+    const std::filesystem::path path = dir.path / "entry.etex";
+
+    std::atomic<int> failures{ 0 };
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t)
+        writers.emplace_back([&] {
+            for (int i = 0; i < 25; ++i)
+                if (!WriteTextureFile(path, baked.View(), 42)) ++failures;
+        });
+    for (std::thread& writer : writers) writer.join();
+
+    CHECK(failures == 0);
+    std::optional<TextureFile> file = TextureFile::Open(path);
+    CHECK(file && file->Header().sourceKey == 42 && file->Header().mipCount == 5);
+    std::size_t entries = 0;
+    for ([[maybe_unused]] const auto& entry : std::filesystem::directory_iterator(dir.path)) ++entries;
+    CHECK(entries == 1); // no temporaries left behind
+}
+
+TEST_CASE(TextureCache_BakesOnceThenMapsMipChains) {
+    TempDirectory dir("engine_texture_cache_test");
+    std::filesystem::create_directories(dir.path);
+    WriteTga(dir.path / "opaque.tga", Gradient(64, 32, 255));
+    WriteTga(dir.path / "alpha.tga", Gradient(16, 16, 100));
+    TextureCache cache(dir.path / "cache");
+
+    std::optional<TextureFile> cold = cache.Load(dir.path / "opaque.tga");
+    CHECK(cold.has_value() && cache.Bakes() == 1 && cache.Hits() == 0);
+    std::optional<TextureFile> warm = cache.Load(dir.path / "opaque.tga");
+    CHECK(warm.has_value() && cache.Bakes() == 1 && cache.Hits() == 1);
+    if (!warm) return;
+
+    const TextureView view = warm->View();
+    CHECK(view.format == TextureFormat::BC1 && view.srgb && view.levels.size() == 7);
+    CHECK(view.levels[0].width == 64 && view.levels[0].height == 32 && view.levels[0].data.size() == 16 * 8 * 8);
+    CHECK(view.levels[6].width == 1 && view.levels[6].data.size() == 8); // one padded block
+
+    // levels go to the driver straight from the mapping
+    RecordingGL gl;
+    TextureAsset texture = UploadTexture(gl, view);
+    std::vector<const void*> sources;
+    for (const RecordedCall& call : gl.calls)
+        if (call.op == RecordedCall::CompressedTexImage2D) sources.push_back(call.data);
+    CHECK(sources.size() == 7 && sources[0] == view.levels[0].data.data() && sources[6] == view.levels[6].data.data());
+    CHECK(texture.mipCount == 7 && texture.gpuBytes == 1024 + 256 + 64 + 16 + 8 + 8 + 8);
+    DestroyTexture(gl, texture);
+    CHECK(gl.Count(RecordedCall::DeleteTextures) == 1 && texture.texture == 0);
+
+    // alpha picks BC3; uncompressed keeps RGBA8 levels
+    std::optional<TextureFile> alpha = cache.Load(dir.path / "alpha.tga");
+    CHECK(alpha && alpha->Header().format == TextureFormat::BC3 && alpha->Header().mipCount == 5);
+    TextureOptions raw;
+    raw.compress = false;
+    std::optional<TextureFile> rgba = cache.Load(dir.path / "alpha.tga", raw);
+    CHECK(rgba && rgba->Header().format == TextureFormat::RGBA8 && rgba->View().levels[1].data.size() == 8 * 8 * 4);
+    CHECK(cache.Bakes() == 3);
+
+    // a changed source is baked again, a damaged entry is rebuilt, a missing source fails
+    WriteTga(dir.path / "opaque.tga", Gradient(32, 32, 255));
+    std::optional<TextureFile> changed = cache.Load(dir.path / "opaque.tga");
+    CHECK(changed && changed->Header().width == 32 && cache.Bakes() == 4);
+    const std::filesystem::path entry = cache.PathOf(TextureCache::KeyOf(dir.path / "opaque.tga", {}));
+    changed.reset();
+    std::filesystem::resize_file(entry, std::filesystem::file_size(entry) - 1);
+    CHECK(!TextureFile::Open(entry));
+    CHECK(cache.Load(dir.path / "opaque.tga") && cache.Bakes() == 5);
+    CHECK(!cache.Load(dir.path / "missing.tga"));
+}
+
+TEST_CASE(TextureLoader_LoadsThroughAssetManager) {
+    TempDirectory dir("engine_texture_asset_test");
+    std::filesystem::create_directories(dir.path / "textures");
+    WriteTga(dir.path / "textures/a.tga", Gradient(8, 8, 255));
+    TextureCache cache(dir.path / "cache");
+
+    JobSystem jobs(2);
+    AssetManager assets(&jobs, dir.path);
+    RegisterTextureLoader(assets, cache);
+    Asset<TextureAsset> texture = assets.Load<TextureAsset>("textures/a.tga");
+    Asset<TextureAsset> missing = assets.Load<TextureAsset>("textures/none.tga");
+
+    RecordingGL gl;
+    assets.Flush(gl);
+    CHECK(texture.Ready() && texture.Get()->width == 8 && texture.Get()->mipCount == 4);
+    CHECK(missing.Failed());
+    CHECK(gl.Count(RecordedCall::CompressedTexImage2D) == 4);
+
+    assets.Clear(gl);
+    CHECK(gl.Count(RecordedCall::DeleteTextures) == 1);
+}
+
+TEST_CASE(ResidencyManager_EvictsLeastRecentlyUsedToStayInBudget) {
+    ResidencyManager residency({ .budgetBytes = 300 });
+    const uint64_t mesh[] = { 100 };
+    for (uint32_t key = 0; key < 4; ++key) residency.Add(key, mesh);
+
+    // frame 1: 0 and 1 drawn, 2 and 3 just added (which counts as a use),
+    // so nothing can go; the overshoot shows as pressure
+    residency.Touch(0, 10.0f);
+    residency.Touch(1, 50.0f);
+    CHECK(residency.Update().empty());
+    CHECK(residency.GetStats().wantedBytes == 400 && residency.GetStats().Pressure() > 1.0f);
+
+    // frame 2: 0 and 1 idle since frame 1; the less important one goes
+    residency.Touch(2, 10.0f);
+    residency.Touch(3, 10.0f);
+    const std::vector<ResidencyChange> changes = residency.Update();
+    CHECK(changes.size() == 1 && changes[0].key == 0 && changes[0].from == 0 && changes[0].to == 1);
+    CHECK(!residency.Resident(0) && residency.Resident(1));
+    CHECK(residency.GetStats().evicted == 1 && residency.GetStats().residentBytes == 300);
+
+    // frame 3: a smaller budget takes the least recently used next
+    residency.SetBudget(200);
+    residency.Touch(3, 10.0f);
+    residency.Update();
+    CHECK(!residency.Resident(1) && residency.Resident(2) && residency.Resident(3));
+
+    // frame 4: drawing an evicted resource loads it again, evicting another
+    residency.Touch(0, 10.0f);
+    residency.Touch(3, 10.0f);
+    residency.Update();
+    CHECK(residency.Resident(0) && !residency.Resident(2) && residency.Resident(3));
+    CHECK(residency.GetStats().loaded == 1 && residency.GetStats().evicted == 1 && residency.GetStats().resident == 2);
+
+    residency.Remove(0);
+    CHECK(!residency.Contains(0) && residency.ResidentBytes() == 100);
+}
+
+TEST_CASE(ResidencyManager_DropsOversampledMipsAndStreamsThemBack) {
+    // two 256^2 RGBA8 textures: 9 levels, never dropped below 32 texels (level 3)
+    std::vector<uint64_t> levels;
+    for (uint32_t size = 256; size > 0; size /= 2) levels.push_back(uint64_t{ size } * size * 4);
+    uint64_t full = 0;
+    for (uint64_t bytes : levels) full += bytes;
+    ResidencyManager residency({ .budgetBytes = full + full / 4, .minTextureSize = 32, .streamBytesPerFrame = 400000 });
+    residency.Add(0, levels, 256);
+    residency.Add(1, levels, 256);
+
+    // texture 1 covers 64 pixels: 4 texels per pixel, so it loses its top mip
+    residency.Touch(0, 256.0f);
+    residency.Touch(1, 64.0f);
+    residency.Update();
+    CHECK(residency.FirstLevel(0) == 0 && residency.FirstLevel(1) == 1);
+    CHECK(residency.GetStats().mipsDropped == 1 && residency.GetStats().residentBytes == full + full - levels[0]);
+
+    // with room, detail already there is kept; a closer view streams level 0 back
+    residency.SetBudget(4 * full);
+    residency.Touch(1, 64.0f);
+    CHECK(residency.Update().empty());
+    residency.Touch(1, 300.0f);
+    residency.Update();
+    CHECK(residency.FirstLevel(1) == 0 && residency.GetStats().mipsStreamed == 1);
+
+    // an impossible budget stops at the floor and reports the pressure
+    residency.SetBudget(1024);
+    residency.Touch(0, 256.0f);
+    residency.Touch(1, 256.0f);
+    residency.Update();
+    CHECK(residency.FirstLevel(0) == 3 && residency.FirstLevel(1) == 3);
+    CHECK(residency.GetStats().mipsDropped == 6 && residency.GetStats().Pressure() > 1.0f);
+
+    // streaming back is capped per frame, most important first: texture 0
+    // takes 336 KiB of the 390, texture 1 the smallest level that still fits
+    residency.SetBudget(4 * full);
+    residency.Touch(0, 256.0f);
+    residency.Touch(1, 200.0f);
+    residency.Update();
+    CHECK(residency.FirstLevel(0) == 0 && residency.FirstLevel(1) == 2 && residency.GetStats().deferred == 1);
+    residency.Touch(1, 200.0f);
+    residency.Update();
+    CHECK(residency.FirstLevel(1) == 0);
+    CHECK(ProjectedSize(1.0f, 10.0f, 1.0f, 1000.0f) == 100.0f);
+}
+
+TEST_CASE(TextureLoader_StreamsMipsUnderResidencyBudget) {
+    TempDirectory dir("engine_texture_residency_test");
+    std::filesystem::create_directories(dir.path / "textures");
+    WriteTga(dir.path / "textures/a.tga", Gradient(64, 64, 255));
+    WriteTga(dir.path / "textures/b.tga", Gradient(64, 64, 255));
+    TextureCache cache(dir.path / "cache");
+
+    // RGBA8: 21844 bytes per full chain, so two do not fit
+    ResidencyManager residency({ .budgetBytes = 30000, .minTextureSize = 8 });
+    AssetManager assets(nullptr, dir.path);
+    assets.SetResidency(&residency);
+    RegisterTextureLoader(assets, cache, { .compress = false });
+    Asset<TextureAsset> a = assets.Load<TextureAsset>("textures/a.tga");
+    Asset<TextureAsset> b = assets.Load<TextureAsset>("textures/b.tga");
+
+    RecordingGL gl;
+    assets.Flush(gl);
+    CHECK(residency.ResidentBytes() == 2 * 21844);
+
+    // b is drawn small: its base level moves up and level 0 is emptied in place
+    const GLuint bTexture = b.Get()->texture;
+    gl.calls.clear();
+    a.Touch(64.0f);
+    b.Touch(16.0f);
+    assets.UpdateResidency(gl);
+    CHECK(a.Get()->firstLevel == 0 && b.Get()->firstLevel == 1 && b.Get()->texture == bTexture);
+    CHECK(b.Get()->width == 32 && b.Get()->mipCount == 6 && b.Get()->gpuBytes == 21844 - 16384);
+    CHECK(gl.Count(RecordedCall::DeleteTextures) == 0 && gl.Count(RecordedCall::GenTextures) == 0);
+    CHECK(gl.Count(RecordedCall::TexImage2D) == 1);
+    for (const RecordedCall& call : gl.calls) {
+        if (call.op == RecordedCall::TexImage2D) CHECK(call.count == 0 && call.width == 0);
+        if (call.op == RecordedCall::TexParameteri && call.a == GL_TEXTURE_BASE_LEVEL) CHECK(call.width == 1);
+    }
+
+    // a is not drawn: evicted, and b streams only its top level back in
+    gl.calls.clear();
+    b.Touch(64.0f);
+    assets.UpdateResidency(gl);
+    CHECK(a.Get() == nullptr && a.State() == AssetState::Uploading);
+    CHECK(b.Get()->firstLevel == 0 && b.Get()->width == 64 && b.Get()->texture == bTexture);
+    CHECK(gl.Count(RecordedCall::DeleteTextures) == 1 && gl.Count(RecordedCall::TexImage2D) == 1);
+    for (const RecordedCall& call : gl.calls)
+        if (call.op == RecordedCall::TexImage2D) CHECK(call.count == 0 && call.width == 64);
+    CHECK(residency.GetStats().evicted == 1 && residency.GetStats().mipsStreamed == 1);
+
+    // drawing a again brings back only the levels it needs
+    a.Touch(16.0f);
+    b.Touch(16.0f);
+    assets.UpdateResidency(gl);
+    CHECK(a.Ready() && a.Get()->firstLevel == 2 && b.Get()->firstLevel == 0);
+
+    assets.Clear(gl);
+    CHECK(!residency.Contains(a.Slot()) && residency.ResidentBytes() == 0);
+}
+
+TEST_CASE(TextureLoader_BudgetsDecodedBytesWithoutS3tc) {
+    TempDirectory dir("engine_texture_residency_rgba_test");
+    std::filesystem::create_directories(dir.path / "textures");
+    WriteTga(dir.path / "textures/a.tga", Gradient(64, 64, 255));
+    TextureCache cache(dir.path / "cache");
+
+    ResidencyManager residency({ .budgetBytes = 1u << 20 });
+    AssetManager assets(nullptr, dir.path);
+    assets.SetResidency(&residency);
+    RegisterTextureLoader(assets, cache); // BC1 in the cache
+    Asset<TextureAsset> a = assets.Load<TextureAsset>("textures/a.tga");
+
+    // the driver cannot take BC1, so the budget counts the RGBA8 it gets
+    RecordingGL gl;
+    gl.s3tc = false;
+    assets.Flush(gl);
+    CHECK(a.Ready() && a.Get()->format == TextureFormat::RGBA8);
+    CHECK(residency.ResidentBytes() == 21844 && a.Get()->gpuBytes == 21844);
+
+    assets.Clear(gl);
+}
+
+TEST_CASE(Json_ParsesDocumentsAndReportsErrors) {
+    const std::optional<JsonValue> json = ParseJson(R"({ "a": [1, -2.5e1, true, null], "b": { "s": "x\"é😀" } })");
+    CHECK(json && json->IsObject() && json->Size() == 2);
+    const JsonValue* a = json->Find("a");
+    CHECK(a && a->IsArray() && a->Size() == 4);
+    CHECK(a->Items()[0].Number() == 1.0 && a->Items()[1].Number() == -25.0 && a->Items()[2].Bool() && a->Items()[3].IsNull());
+    CHECK(json->Find("b")->Find("s")->String() == "x\"\xc3\xa9\xf0\x9f\x98\x80");
+    CHECK(json->Find("missing") == nullptr);
+
+    std::string error;
+    CHECK(!ParseJson("{\n  \"a\": [1, 2,]\n}", &error));
+    CHECK(error.rfind("2:", 0) == 0);
+    CHECK(!ParseJson("[1] 2") && !ParseJson("-inf") && !ParseJson("\"open"));
+}
+
+TEST_CASE(SceneFile_CompilesJsonScenes) {
+    const char* json = R"({
+        "assets": { "meshes": { "cube": "models/cube.obj" } },
+        "entities": [
+            { "name": "camera", "components": [ { "type": "Transform", "position": [0, 2, 5] },
+                                                { "type": "Camera", "fov": 90, "far": 50 } ] },
+            { "name": "room", "components": [ { "type": "MeshRenderer", "mesh": "room", "material": "wall" },
+                                              { "type": "Transform" } ] },
+            { "name": "cube", "parent": "room",
+              "components": [ { "type": "Transform", "scale": 2 },
+                              { "type": "MeshRenderer", "mesh": "cube", "material": "wall", "layer": 3 } ] },
+            { "name": "marker", "parent": 1 } ] })";
+    std::string error;
+    const std::optional<SceneData> scene = ParseSceneJson(json, &error);
+    CHECK(scene && error.empty());
+    CHECK(scene->entities.size() == 4 && scene->meshes.size() == 2 && scene->materials.size() == 1);
+    CHECK(scene->entities[0].camera && std::fabs(scene->entities[0].camera->fovY - glm::radians(90.0f)) < 1e-6f);
+    CHECK(scene->entities[2].transform->parent == ecs::Entity{ 1, 0 } && scene->entities[2].transform->scale == glm::vec3(2.0f));
+    CHECK(scene->entities[2].meshRenderer->mesh == 1 && scene->entities[2].meshRenderer->layer == 3);
+    // a parent alone implies a Transform to hold it
+    CHECK(scene->entities[3].transform && scene->entities[3].transform->parent == ecs::Entity{ 1, 0 } && !scene->entities[3].meshRenderer);
+
+    CHECK(!ParseSceneJson(R"({ "entities": [ { "parent": "nobody" } ] })", &error));
+    CHECK(error.find("nobody") != std::string::npos);
+    CHECK(!ParseSceneJson(R"({ "entities": [ { "components": [ { "type": "Light" } ] } ] })"));
+    CHECK(!ParseSceneJson(R"({ "entities": [ { "parent": 0 } ] })"));
+
+    TempDirectory dir("engine_scene_file_test");
+    std::filesystem::create_directories(dir.path);
+    CHECK(WriteSceneFile(dir.path / "level.escene", *scene, 2));
+    const std::optional<SceneFile> file = SceneFile::Open(dir.path / "level.escene");
+    CHECK(file && file->Header().entityCount == 4 && file->Columns().size() == 4);
+    CHECK(file->Mesh(0) == "room" && file->Mesh(1) == "cube" && file->Material(0) == "wall");
+    // {camera}, {room, cube}, {marker}: three archetypes, and no run crosses a chunk
+    uint32_t covered = 0;
+    for (const SceneRun& run : file->Runs()) covered += run.count;
+    CHECK(file->Runs().size() >= 3 && covered == 4 && file->Chunks().size() >= 2);
+
+    WriteText(dir.path / "broken.escene", ReadText(dir.path / "level.escene")->substr(0, 100));
+    CHECK(!SceneFile::Open(dir.path / "broken.escene"));
+}
+
+namespace {
+
+struct SceneWorld {
+    ecs::World world;
+    ecs::Coordinator& c = world.GetCoordinator();
+    std::shared_ptr<TransformSystem> transforms;
+
+    SceneWorld() {
+        c.RegisterComponent<Transform>();
+        c.RegisterComponent<MeshRenderer>();
+        c.RegisterComponent<Camera>();
+        transforms = c.RegisterSystem<TransformSystem>();
+        c.SetSystemSignature<TransformSystem>(ecs::Signature::Of<Transform>());
+    }
+};
+
+// A root per 10 entities, the rest parented to it; every third one renders.
+SceneData GeneratedScene(uint32_t count) {
+    SceneData scene;
+    scene.meshes = { "a", "b" };
+    scene.materials = { "m" };
+    scene.entities.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        SceneEntity& entity = scene.entities[i];
+        entity.name = "e" + std::to_string(i);
+        Transform& transform = entity.transform.emplace();
+        transform.position = glm::vec3(static_cast<float>(i), 0.0f, 0.0f);
+        if (i % 10) transform.parent = ecs::Entity{ i - i % 10, 0 };
+        if (i % 3 == 0) entity.meshRenderer = MeshRenderer{ .mesh = i % 2, .material = 0 };
+    }
+    return scene;
+}
+
+}
+
+TEST_CASE(SceneLoader_InstantiatesChunksInParallelLikeSerially) {
+    TempDirectory dir("engine_scene_loader_test");
+    std::filesystem::create_directories(dir.path);
+    const SceneData data = GeneratedScene(1000);
+    CHECK(WriteSceneFile(dir.path / "generated.escene", data, 64));
+    const std::optional<SceneFile> scene = SceneFile::Open(dir.path / "generated.escene");
+    CHECK(scene && scene->Chunks().size() > 8);
+
+    SceneBindings bindings{ [](std::string_view mesh) { return mesh == "a" ? MeshHandle{ 10 } : MeshHandle{ 20 }; },
+                            [](std::string_view) { return MaterialHandle{ 7 }; } };
+    JobSystem jobs(4);
+    SceneWorld serial, parallel;
+    // recycled slots: the loader must not assume entity index == file number
+    for (int i = 0; i < 5; ++i) parallel.world.DestroyEntity(parallel.world.CreateEntity());
+    parallel.world.CreateEntity("existing");
+
+    const std::vector<ecs::Entity> a = InstantiateScene(serial.world, *scene, bindings);
+    const std::vector<ecs::Entity> b = InstantiateScene(parallel.world, *scene, bindings, &jobs);
+    CHECK(a.size() == 1000 && b.size() == 1000);
+    CHECK(serial.world.View<Transform>().size() == 1000 && parallel.world.View<Transform>().size() == 1000);
+    CHECK(serial.world.View<Transform, MeshRenderer>().size() == 334 && parallel.world.View<Transform, MeshRenderer>().size() == 334);
+    CHECK(parallel.world.FindByName("existing").IsValid());
+
+    serial.transforms->Update(0.0f);
+    parallel.transforms->Update(0.0f);
+    bool same = true;
+    for (uint32_t file = 0; file < 1000; ++file) {
+        const ecs::Entity ea = a[file], eb = b[file];
+        same &= serial.world.FindByName("e" + std::to_string(file)) == ea && parallel.world.FindByName("e" + std::to_string(file)) == eb;
+        const Transform& ta = serial.c.GetComponent<Transform>(ea);
+        const Transform& tb = parallel.c.GetComponent<Transform>(eb);
+        const uint32_t root = file - file % 10;
+        same &= file % 10 ? (ta.parent == a[root] && tb.parent == b[root]) : (!ta.parent.IsValid() && !tb.parent.IsValid());
+        // world x: own offset plus the root's
+        same &= std::fabs(tb.world[3][0] - static_cast<float>(file % 10 ? file + root : file)) < 1e-3f && ta.world == tb.world;
+        if (file % 3 == 0) {
+            const MeshRenderer& ra = serial.c.GetComponent<MeshRenderer>(ea);
+            const MeshRenderer& rb = parallel.c.GetComponent<MeshRenderer>(eb);
+            same &= ra.mesh == (file % 2 ? 20u : 10u) && rb.mesh == ra.mesh && rb.material == 7;
+        } else {
+            same &= !parallel.c.HasComponent<MeshRenderer>(eb);
+        }
+    }
+    CHECK(same);
+}
@@ -0,0 +1,293 @@
+#include "TestFramework.hpp"
+#include <engine/core/FixedTimestep.hpp>
+#include <engine/core/FrameScheduler.hpp>
+#include <engine/core/Profiler.hpp>
+#include <engine/utils/Json.hpp>
+#include <engine/ecs/ParallelFor.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace {
+
+struct A { int v = 0; };
+struct B { int v = 0; };
+struct C { int v = 0; };
+
+std::atomic<int> logicalClock{ 0 };
+
+// Records the logical time it started and finished at.
+struct TimedSystem : ecs::System {
+    int started = -1, finished = -1;
+    std::thread::id thread;
+
+    void Update(float) override {
+        started = logicalClock.fetch_add(1);
+        thread = std::this_thread::get_id();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        finished = logicalClock.fetch_add(1);
+    }
+};
+
+struct WriteA : TimedSystem { WriteA() { Writes<A>(); } };
+struct ReadA : TimedSystem { ReadA() { Reads<A>(); Writes<C>(); } };
+struct WriteB : TimedSystem { WriteB() { Writes<B>(); } };
+struct MainOnly : TimedSystem { MainOnly() { Reads<B>(); RunOnMainThread(); } };
+struct Undeclared : TimedSystem {};
+
+struct CountingSystem : ecs::System {
+    int updates = 0;
+    float lastDt = 0.0f;
+    void Update(float dt) override { ++updates; lastDt = dt; }
+};
+struct SimulationSystem : CountingSystem { SimulationSystem() { Writes<A>(); } };
+struct FrameSystem : CountingSystem { FrameSystem() { Reads<A>(); RunPerFrame(); } };
+
+}
+
+TEST_CASE(JobSystem_RunsAllJobs) {
+    JobSystem jobs(3);
+    JobCounter counter;
+    std::atomic<int> sum{ 0 };
+    for (int i = 1; i <= 100; ++i)
+        jobs.Submit([&sum, i] { sum += i; }, &counter);
+    jobs.Wait(counter);
+    CHECK(sum == 5050);
+}
+
+TEST_CASE(JobSystem_NestedSubmitAndWait) {
+    JobSystem jobs(2);
+    JobCounter outer;
+    std::atomic<int> leaves{ 0 };
+    for (int i = 0; i < 8; ++i) {
+        jobs.Submit([&] {
+            JobCounter inner;
+            for (int j = 0; j < 8; ++j) jobs.Submit([&leaves] { ++leaves; }, &inner);
+            jobs.Wait(inner);
+        }, &outer);
+    }
+    jobs.Wait(outer);
+    CHECK(leaves == 64);
+}
+
+TEST_CASE(FrameScheduler_RespectsDeclaredAccess) {
+    ecs::Coordinator c;
+    c.Init();
+    c.RegisterComponent<A>();
+    c.RegisterComponent<B>();
+    c.RegisterComponent<C>();
+
+    auto writeA = c.RegisterSystem<WriteA>();
+    auto readA = c.RegisterSystem<ReadA>();
+    auto writeB = c.RegisterSystem<WriteB>();
+    auto mainOnly = c.RegisterSystem<MainOnly>();
+    auto undeclared = c.RegisterSystem<Undeclared>();
+
+    JobSystem jobs(4);
+    FrameScheduler scheduler(jobs);
+    scheduler.Run(c, 0.016f);
+
+    CHECK(writeA->finished < readA->started);     // reader waits for the writer
+    CHECK(writeB->started < readA->finished);     // unrelated systems overlap
+    CHECK(writeB->finished < mainOnly->started);  // B written before it is read
+    CHECK(mainOnly->thread == std::this_thread::get_id());
+    for (auto* s : { static_cast<TimedSystem*>(writeA.get()), static_cast<TimedSystem*>(readA.get()),
+                     static_cast<TimedSystem*>(writeB.get()), static_cast<TimedSystem*>(mainOnly.get()) })
+        CHECK(s->finished < undeclared->started); // undeclared access acts as a barrier
+
+    const FrameStats& stats = scheduler.GetLastFrameStats();
+    CHECK(stats.systemMs.size() == 5);
+    CHECK(stats.criticalPath.size() == 3);          // WriteA -> ReadA -> Undeclared (or via B)
+    CHECK(stats.criticalPath.back() == undeclared->GetName());
+    CHECK(stats.criticalPathMs <= stats.totalSystemMs);
+}
+
+TEST_CASE(FrameScheduler_RunsOnePhaseAtATime) {
+    ecs::Coordinator c;
+    c.Init();
+    c.RegisterComponent<A>();
+    auto simulation = c.RegisterSystem<SimulationSystem>();
+    auto frame = c.RegisterSystem<FrameSystem>();
+
+    JobSystem jobs(2);
+    FrameScheduler scheduler(jobs);
+    for (int step = 0; step < 3; ++step) scheduler.Run(c, 0.01f, ecs::SystemPhase::Simulation);
+    scheduler.Run(c, 0.025f, ecs::SystemPhase::Frame);
+    CHECK(simulation->updates == 3 && simulation->lastDt == 0.01f);
+    CHECK(frame->updates == 1 && frame->lastDt == 0.025f);
+    CHECK(scheduler.GetLastFrameStats().systemMs.size() == 1);
+
+    scheduler.Run(c, 0.016f); // no phase: everything
+    CHECK(simulation->updates == 4 && frame->updates == 2);
+}
+
+TEST_CASE(FixedTimestep_AccumulatesAndCapsSteps) {
+    FixedTimestep timestep(0.01, 4);
+
+    // frames shorter than a step accumulate
+    CHECK(timestep.Advance(0.004) == 0);
+    CHECK(timestep.Advance(0.004) == 0);
+    CHECK(timestep.Advance(0.004) == 1);
+    CHECK(std::fabs(timestep.Alpha() - 0.2) < 1e-9);
+
+    // a long frame runs several steps and keeps the remainder
+    CHECK(timestep.Advance(0.0355) == 3);
+    CHECK(std::fabs(timestep.Alpha() - 0.75) < 1e-9);
+
+    // a hitch runs at most four and drops the rest of the backlog, not the phase
+    CHECK(timestep.Advance(1.0) == 4);
+    CHECK(std::fabs(timestep.Alpha() - 0.75) < 1e-6);
+    CHECK(std::fabs(timestep.DroppedSeconds() - 0.96) < 1e-6);
+    CHECK(timestep.Advance(0.0) == 0 && timestep.Advance(-1.0) == 0);
+}
+
+TEST_CASE(ParallelForEach_VisitsEveryComponentOnce) {
+    ecs::Coordinator c;
+    c.Init();
+    c.RegisterComponent<A>();
+    c.RegisterComponent<B>();
+    for (int i = 0; i < 10000; ++i) {
+        const ecs::Entity e = c.CreateEntity();
+        c.AddComponent(e, A{ i });
+        if (i % 3 == 0) c.AddComponent(e, B{ 0 });
+    }
+
+    JobSystem jobs(4);
+    ecs::ParallelForEach(jobs, c.GetComponentStorage<A>(), [](ecs::Entity, A& a) { a.v *= 2; }, 100);
+    for (const A& a : c.GetComponentStorage<A>().Components()) CHECK(a.v % 2 == 0);
+
+    ecs::ParallelForEach(jobs, c.View<A, B>(), [](ecs::Entity, A& a, B& b) { b.v = a.v + 1; });
+    std::size_t visited = 0;
+    for (auto [e, a, b] : c.View<A, B>()) {
+        CHECK(b.v == a.v + 1);
+        ++visited;
+    }
+    CHECK(visited == 3334);
+}
+
+TEST_CASE(ParallelChunks_StartOnCacheLines) {
+    CHECK(ecs::AlignedChunkSize<float>(1) == 16);
+    CHECK(ecs::AlignedChunkSize<float>(17) == 32);
+    CHECK(ecs::AlignedChunkSize<double[6]>(1) == 4); // 48-byte elements: 4 per 192 bytes
+    CHECK(ecs::AlignedChunkSize<ecs::Entity>(0) == ecs::DefaultChunkBytes / sizeof(ecs::Entity));
+
+    ecs::ComponentArray<A> arr;
+    for (ecs::EntityIndex i = 0; i < 1000; ++i) arr.InsertData(ecs::Entity{ i, 0 }, A{});
+    const auto base = reinterpret_cast<std::uintptr_t>(arr.Components().data());
+    CHECK(base % CacheLineSize == 0);
+}
+
+TEST_CASE(ParallelReduce_IsBitExactAcrossThreadCounts) {
+    ecs::ComponentArray<float> values;
+    for (ecs::EntityIndex i = 0; i < 100000; ++i)
+        values.InsertData(ecs::Entity{ i, 0 }, 1.0f / static_cast<float>(i + 1));
+
+    const auto sum = [&](unsigned threads) {
+        JobSystem jobs(threads);
+        return ecs::ParallelReduce(jobs, values, 0.0f,
+            [](float& acc, ecs::Entity, float& v) { acc += v; },
+            [](float& acc, const float& chunk) { acc += chunk; }, 256);
+    };
+
+    const float one = sum(1);
+    CHECK(one == sum(2));
+    CHECK(one == sum(7));
+
+    JobSystem jobs(3);
+    ecs::PerThread<int> scratch(jobs);
+    ecs::ParallelForEach(jobs, values, [&](ecs::Entity, float&) { ++scratch.Local(); }, 64);
+    int total = 0;
+    scratch.ForEach([&](int& n) { total += n; });
+    CHECK(total == 100000);
+}
+
+TEST_CASE(Profiler_AggregatesScopesPerFrame) {
+    Profiler& profiler = Profiler::Instance();
+    profiler.EndFrame(); // whatever earlier tests left behind
+
+    const auto spin = [](int microseconds) {
+        const auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(microseconds);
+        while (std::chrono::steady_clock::now() < until) {}
+    };
+    for (int frame = 0; frame < 10; ++frame) {
+        ProfileScope outer("test.profiler.outer");
+        for (int i = 0; i < 3; ++i) {
+            ProfileScope inner("test.profiler.inner");
+            spin(frame == 9 ? 2000 : 100);
+        }
+    }
+    std::thread worker([] { ProfileScope scope("test.profiler.worker"); });
+    worker.join();
+    profiler.EndFrame();
+
+    // all ten outer scopes closed in one frame
+    const ScopeStats outer = profiler.Statistics("test.profiler.outer");
+    CHECK(outer.frames == 1);
+    CHECK(outer.calls == 10);
+    CHECK(outer.lastMs >= 0.3 * 9 + 6.0 - 0.5);
+
+    for (int frame = 0; frame < 10; ++frame) {
+        for (int i = 0; i < 3; ++i) {
+            ProfileScope inner("test.profiler.inner");
+            spin(frame == 9 ? 2000 : 100);
+        }
+        profiler.EndFrame();
+    }
+    const ScopeStats inner = profiler.Statistics("test.profiler.inner");
+    CHECK(inner.frames == 11);
+    CHECK(inner.calls == 3);
+    CHECK(inner.minMs >= 0.25 && inner.minMs < 2.0);
+    CHECK(inner.minMs <= inner.avgMs && inner.avgMs <= inner.p99Ms && inner.p99Ms <= inner.maxMs);
+    CHECK(inner.p99Ms >= 5.5);   // the slow frames are in the tail
+    CHECK(inner.lastMs >= 5.5);
+
+    CHECK(profiler.Statistics("test.profiler.worker").frames == 1);
+    CHECK(profiler.Statistics("test.profiler.never").frames == 0);
+}
+
+TEST_CASE(Profiler_ExportsChromeTrace) {
+    Profiler& profiler = Profiler::Instance();
+    const char* name = "test.trace \"quoted\"";
+    {
+        ProfileScope scope(name);
+    }
+    std::thread worker([] {
+        Profiler::Instance().SetThreadName("test worker");
+        ProfileScope scope("test.trace.worker");
+    });
+    worker.join();
+    const int64_t now = profiler.NowNs();
+    profiler.AddTrackEvent("GPU", "test.trace.gpu", now, now + 1500);
+    profiler.EndFrame();
+
+    std::string error;
+    const std::optional<JsonValue> root = ParseJson(profiler.ChromeTrace(), &error);
+    CHECK(root.has_value());
+    const JsonValue* events = root ? root->Find("traceEvents") : nullptr;
+    CHECK(events && events->IsArray());
+    if (!events) return;
+
+    double mainTrack = -1.0, workerTrack = -2.0, gpuTrack = -3.0, gpuDuration = 0.0;
+    bool workerNamed = false;
+    for (const JsonValue& event : events->Items()) {
+        const std::string eventName(event.Find("name")->String());
+        const double track = event.Find("tid")->Number();
+        if (eventName == name) mainTrack = track;
+        if (eventName == "test.trace.worker") workerTrack = track;
+        if (eventName == "test.trace.gpu") {
+            gpuTrack = track;
+            gpuDuration = event.Find("dur")->Number();
+        }
+        if (eventName == "thread_name" && event.Find("args")->Find("name")->String() == "test worker")
+            workerNamed = true;
+    }
+    CHECK(mainTrack >= 0.0);
+    CHECK(workerTrack >= 0.0 && workerTrack != mainTrack);
+    CHECK(gpuTrack >= 0.0 && gpuTrack != mainTrack && gpuTrack != workerTrack);
+    CHECK(std::abs(gpuDuration - 1.5) < 1e-6);
+    CHECK(workerNamed);
+}
@@ -0,0 +1,604 @@
+#include "TestFramework.hpp"
+#include <engine/ecs/ComponentManager.hpp>
+#include <engine/ecs/World.hpp>
+#include <engine/ecs/CommandBuffer.hpp>
+#include <engine/ecs/WorldSnapshot.hpp>
+#include <engine/core/JobSystem.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct Position {
+    float x = 0.0f, y = 0.0f;
+};
+
+struct Velocity {
+    float dx = 0.0f, dy = 0.0f;
+};
+
+struct Name {
+    std::string value;
+};
+
+struct MovementSystem : ecs::System {};
+
+template<int N> struct Tag { int value = N; };
+struct WideSystem : ecs::System {};
+
+template<int... Ns>
+void RegisterTags(ecs::Coordinator& c, std::integer_sequence<int, Ns...>) {
+    (c.RegisterComponent<Tag<Ns>>(), ...);
+}
+
+ecs::Entity E(ecs::EntityIndex index) { return ecs::Entity{ index, 0 }; }
+
+}
+
+TEST_CASE(ComponentArray_InsertGetHas) {
+    ecs::ComponentArray<Position> arr;
+    arr.InsertData(E(3), { 1.0f, 2.0f });
+    arr.InsertData(E(7), { 3.0f, 4.0f });
+
+    CHECK(arr.Size() == 2);
+    CHECK(arr.HasData(E(3)));
+    CHECK(arr.HasData(E(7)));
+    CHECK(!arr.HasData(E(5)));
+    CHECK(!arr.HasData(E(1000)));
+    CHECK(!arr.HasData(ecs::Entity{ 3, 1 })); // same slot, other generation
+    CHECK(arr.GetData(E(7)).y == 4.0f);
+}
+
+TEST_CASE(ComponentArray_SwapAndPopKeepsIndexConsistent) {
+    ecs::ComponentArray<Position> arr;
+    for (ecs::EntityIndex e = 1; e <= 5; ++e)
+        arr.InsertData(E(e), { static_cast<float>(e), 0.0f });
+
+    arr.RemoveData(E(2));
+    CHECK(arr.Size() == 4);
+    CHECK(!arr.HasData(E(2)));
+    // the last element (5) was moved into slot 1
+    CHECK(arr.Entities()[1] == E(5));
+    CHECK(arr.GetData(E(5)).x == 5.0f);
+
+    arr.EntityDestroyed(E(5));
+    arr.EntityDestroyed(E(5)); // destroying twice is harmless
+    CHECK(arr.Size() == 3);
+    for (ecs::EntityIndex e : { 1u, 3u, 4u })
+        CHECK(arr.GetData(E(e)).x == static_cast<float>(e));
+}
+
+TEST_CASE(ComponentArray_SpansAreParallel) {
+    ecs::ComponentArray<Position> arr;
+    for (ecs::EntityIndex e = 10; e < 20; ++e)
+        arr.InsertData(E(e), { static_cast<float>(e), 0.0f });
+    arr.RemoveData(E(12));
+
+    auto comps = arr.Components();
+    auto ents = arr.Entities();
+    CHECK(comps.size() == ents.size());
+    for (std::size_t i = 0; i < comps.size(); ++i)
+        CHECK(comps[i].x == static_cast<float>(ents[i].index));
+}
+
+TEST_CASE(View_MatchesOnlyEntitiesWithAllComponents) {
+    ecs::World world;
+    auto& c = world.GetCoordinator();
+    c.RegisterComponent<Position>();
+    c.RegisterComponent<Velocity>();
+
+    const ecs::Entity a = world.CreateEntity("a");
+    const ecs::Entity b = world.CreateEntity("b");
+    c.AddComponent(a, Position{ 1.0f, 0.0f });
+    c.AddComponent(a, Velocity{ 2.0f, 0.0f });
+    c.AddComponent(b, Position{ 5.0f, 0.0f });
+
+    std::size_t visited = 0;
+    for (auto [entity, pos, vel] : world.View<Position, Velocity>()) {
+        CHECK(entity == a);
+        pos.x += vel.dx;
+        ++visited;
+    }
+    CHECK(visited == 1);
+    CHECK(c.GetComponent<Position>(a).x == 3.0f);
+    CHECK(world.View<Position>().size() == 2);
+}
+
+TEST_CASE(View_CacheUpdatesIncrementally) {
+    ecs::World world;
+    auto& c = world.GetCoordinator();
+    c.RegisterComponent<Position>();
+    c.RegisterComponent<Velocity>();
+
+    const ecs::Entity a = world.CreateEntity();
+    c.AddComponent(a, Position{});
+    CHECK(world.View<Position, Velocity>().empty());
+
+    c.AddComponent(a, Velocity{});
+    CHECK(world.View<Position, Velocity>().size() == 1);
+
+    c.RemoveComponent<Velocity>(a);
+    CHECK(world.View<Position, Velocity>().empty());
+    CHECK(world.View<Position>().size() == 1);
+
+    world.DestroyEntity(a);
+    CHECK(world.View<Position>().empty());
+}
+
+TEST_CASE(View_WalksSmallestArrayAndRefreshesColumns) {
+    ecs::World world;
+    auto& c = world.GetCoordinator();
+    c.RegisterComponent<Position>();
+    c.RegisterComponent<Velocity>();
+
+    std::vector<ecs::Entity> entities;
+    for (int i = 0; i < 8; ++i) {
+        entities.push_back(world.CreateEntity());
+        c.AddComponent(entities.back(), Position{ static_cast<float>(i), 0.0f });
+    }
+    // velocities in reverse, so the two arrays' dense orders disagree
+    for (int i = 7; i >= 0; --i) c.AddComponent(entities[i], Velocity{ static_cast<float>(i), 0.0f });
+
+    // every Velocity matches: the view walks that array in dense order
+    auto view = world.View<Velocity, Position>();
+    const auto velocities = c.GetComponentStorage<Velocity>().Entities();
+    CHECK(std::equal(view.Entities().begin(), view.Entities().end(), velocities.begin(), velocities.end()));
+    for (auto [entity, vel, pos] : view) CHECK(vel.dx == pos.x);
+
+    // a Position-only entity: the match list is walked instead
+    c.AddComponent(world.CreateEntity(), Position{ 100.0f, 0.0f });
+    c.RemoveComponent<Velocity>(entities[2]);
+    std::size_t visited = 0;
+    world.View<Position, Velocity>().Each([&](ecs::Entity entity, Position& pos, Velocity& vel) {
+        CHECK(entity != entities[2] && pos.x == vel.dx);
+        ++visited;
+    });
+    CHECK(visited == 7);
+
+    // a reorder changes dense indices without touching the match list
+    std::vector<ecs::Entity> reversed(entities.rbegin(), entities.rend());
+    c.GetComponentStorage<Position>().Reorder(reversed);
+    for (auto [entity, pos, vel] : world.View<Position, Velocity>()) CHECK(pos.x == vel.dx);
+}
+
+TEST_CASE(System_TracksMatchingEntities) {
+    ecs::World world;
+    auto& c = world.GetCoordinator();
+    c.RegisterComponent<Position>();
+    c.RegisterComponent<Velocity>();
+
+    auto sys = c.RegisterSystem<MovementSystem>();
+    c.SetSystemSignature<MovementSystem>(ecs::Signature::Of<Position, Velocity>());
+
+    const ecs::Entity a = world.CreateEntity();
+    c.AddComponent(a, Position{});
+    CHECK(!sys->entities.Contains(a));
+    c.AddComponent(a, Velocity{});
+    CHECK(sys->entities.Contains(a));
+    world.DestroyEntity(a);
+    CHECK(sys->entities.empty());
+}
+
+TEST_CASE(ComponentArray_ReorderMovesEntitiesToFront) {
+    ecs::ComponentArray<Position> arr;
+    for (ecs::EntityIndex i = 0; i < 5; ++i) arr.InsertData(E(i), { float(i), 0.0f });
+
+    const ecs::Entity order[] = { E(3), E(0), E(4) };
+    arr.Reorder(order);
+
+    CHECK(arr.Entities()[0] == E(3) && arr.Entities()[1] == E(0) && arr.Entities()[2] == E(4));
+    CHECK(arr.Components()[0].x == 3.0f && arr.Components()[2].x == 4.0f);
+    for (ecs::EntityIndex i = 0; i < 5; ++i) CHECK(arr.GetData(E(i)).x == float(i));
+}
+
+TEST_CASE(ComponentType_IdsAreStableAndDistinct) {
+    CHECK(ecs::ComponentType<Position>::id == ecs::ComponentType<Position>::id);
+    CHECK(ecs::ComponentType<Position>::id != ecs::ComponentType<Velocity>::id);
+    CHECK(ecs::ComponentType<Position>::id < ecs::MaxComponents);
+}
+
+TEST_CASE(Signature_SupportsMoreThan64Types) {
+    ecs::World world;
+    auto& c = world.GetCoordinator();
+    RegisterTags(c, std::make_integer_sequence<int, 80>{});
+
+    const ecs::Signature wide = ecs::Signature::Of<Tag<0>, Tag<79>>();
+    CHECK(wide.count() == 2);
+    CHECK(wide.test(ecs::ComponentType<Tag<79>>::id));
+
+    auto sys = c.RegisterSystem<WideSystem>();
+    c.SetSystemSignature<WideSystem>(wide);
+
+    const ecs::Entity e = world.CreateEntity();
+    c.AddComponent(e, Tag<79>{});
+    CHECK(!sys->entities.Contains(e));
+    c.AddComponent(e, Tag<0>{});
+    CHECK(sys->entities.Contains(e));
+    CHECK(c.GetComponent<Tag<79>>(e).value == 79);
+    CHECK(world.View<Tag<0>, Tag<79>>().size() == 1);
+
+    c.RemoveComponent<Tag<79>>(e);
+    CHECK(!sys->entities.Contains(e));
+}
+
+TEST_CASE(EntityManager_RecyclesSlotsWithNewGeneration) {
+    ecs::EntityManager em;
+    const ecs::Entity a = em.CreateEntity();
+    const ecs::Entity b = em.CreateEntity();
+    CHECK(a.index != b.index);
+
+    em.DestroyEntity(a);
+    CHECK(!em.IsAlive(a));
+    CHECK(em.GetSignature(a).none());
+
+    const ecs::Entity c = em.CreateEntity();
+    CHECK(c.index == a.index);          // slot reused through the free list
+    CHECK(c.generation == a.generation + 1);
+    CHECK(em.IsAlive(c));
+    CHECK(!em.IsAlive(a));              // the old handle stays stale
+    CHECK(em.Size() == 2);
+}
+
+TEST_CASE(EntityManager_ChurnDoesNotGrowSlots) {
+    ecs::EntityManager em;
+    std::vector<ecs::Entity> live;
+    for (int i = 0; i < 1000; ++i) live.push_back(em.CreateEntity());
+
+    for (int frame = 0; frame < 10; ++frame) {
+        for (auto& e : live) {
+            em.DestroyEntity(e);
+            e = em.CreateEntity();
+        }
+    }
+
+    std::size_t count = 0;
+    ecs::EntityIndex maxIndex = 0;
+    for (ecs::Entity e : em.GetAllEntities()) {
+        ++count;
+        maxIndex = std::max(maxIndex, e.index);
+        CHECK(em.IsAlive(e));
+    }
+    CHECK(count == 1000);
+    CHECK(maxIndex == 999);
+}
+
+TEST_CASE(World_StaleHandleDoesNotAliasRecycledEntity) {
+    ecs::World world;
+    auto& c = world.GetCoordinator();
+    c.RegisterComponent<Position>();
+
+    const ecs::Entity a = world.CreateEntity("a");
+    c.AddComponent(a, Position{ 1.0f, 0.0f });
+    world.DestroyEntity(a);
+    CHECK(world.FindByName("a") == ecs::NullEntity);
+
+    const ecs::Entity b = world.CreateEntity();
+    c.AddComponent(b, Position{ 2.0f, 0.0f });
+    CHECK(b.index == a.index);
+    CHECK(!c.IsAlive(a));
+    CHECK(!c.HasComponent<Position>(a));
+    CHECK(c.HasComponent<Position>(b));
+}
+
+TEST_CASE(CommandBuffer_CreatesAndCoalescesPerEntity) {
+    ecs::World world;
+    auto& c = world.GetCoordinator();
+    c.RegisterComponent<Position>();
+    c.RegisterComponent<Velocity>();
+    c.RegisterComponent<Name>();
+
+    ecs::CommandBuffer cmds;
+    const ecs::Entity pending = cmds.CreateEntity();
+    CHECK(ecs::CommandBuffer::IsPending(pending));
+    cmds.AddComponent(pending, Position{ 1.0f, 0.0f });
+    cmds.AddComponent(pending, Velocity{ 1.0f, 1.0f });
+    cmds.AddComponent(pending, Name{ "spawned" });
+    cmds.AddComponent(pending, Position{ 9.0f, 0.0f }); // later add wins
+    cmds.RemoveComponent<Velocity>(pending);            // add then remove cancels out
+    CHECK(world.View<Position>().empty());              // nothing applied before the flush
+
+    std::vector<ecs::Entity> created;
+    cmds.Flush(c, created);
+    CHECK(cmds.Empty());
+    CHECK(created.size() == 1);
+
+    const ecs::Entity e = created[0];
+    CHECK(c.IsAlive(e));
+    CHECK(c.GetComponent<Position>(e).x == 9.0f);
+    CHECK(c.GetComponent<Name>(e).value == "spawned");
+    CHECK(!c.HasComponent<Velocity>(e));
+    CHECK(world.View<Position, Name>().size() == 1);
+    CHECK(world.View<Velocity>().empty());
+}
+
+TEST_CASE(CommandBuffer_DestroyAndRemoveExisting) {
+    ecs::World world;
+    auto& c = world.GetCoordinator();
+    c.RegisterComponent<Position>();
+    c.RegisterComponent<Velocity>();
+
+    const ecs::Entity a = world.CreateEntity();
+    const ecs::Entity b = world.CreateEntity();
+    c.AddComponent(a, Position{});
+    c.AddComponent(a, Velocity{});
+    c.AddComponent(b, Position{});
+
+    ecs::CommandBuffer cmds;
+    cmds.RemoveComponent<Velocity>(a);
+    cmds.AddComponent(b, Velocity{ 3.0f, 0.0f });
+    cmds.DestroyEntity(b);
+    cmds.Flush(c);
+
+    CHECK(c.HasComponent<Position>(a));
+    CHECK(!c.HasComponent<Velocity>(a));
+    CHECK(!c.IsAlive(b));
+    CHECK(world.View<Position>().size() == 1);
+    CHECK(world.View<Velocity>().empty());
+}
+
+TEST_CASE(CommandBuffer_RecordsFromMultipleThreads) {
+    ecs::World world;
+    auto& c = world.GetCoordinator();
+    c.RegisterComponent<Position>();
+    c.RegisterComponent<Velocity>();
+
+    ecs::CommandBuffer cmds;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&cmds, t] {
+            for (int i = 0; i < 1000; ++i) {
+                const ecs::Entity e = cmds.CreateEntity();
+                cmds.AddComponent(e, Position{ static_cast<float>(t), static_cast<float>(i) });
+                cmds.AddComponent(e, Velocity{});
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    cmds.Flush(c);
+    CHECK(world.View<Position, Velocity>().size() == 4000);
+}
+
+TEST_CASE(CommandBuffer_BatchSpawnMatchesOnce) {
+    ecs::World world;
+    auto& c = world.GetCoordinator();
+    c.RegisterComponent<Position>();
+    c.RegisterComponent<Velocity>();
+
+    ecs::CommandBuffer cmds;
+    const ecs::Entity first = cmds.CreateEntities(100, Position{ 1.0f, 2.0f }, Velocity{ 3.0f, 4.0f });
+    // per-entity commands on a batch member apply on top of the batch
+    cmds.RemoveComponent<Velocity>(ecs::Entity{ first.index + 10, first.generation });
+
+    std::vector<ecs::Entity> created;
+    cmds.Flush(c, created);
+    CHECK(created.size() == 100);
+    CHECK(world.View<Position>().size() == 100);
+    CHECK(world.View<Position, Velocity>().size() == 99);
+    CHECK(!c.HasComponent<Velocity>(created[10]));
+    CHECK(c.GetComponent<Velocity>(created[99]).dy == 4.0f);
+}
+
+TEST_CASE(CommandBuffer_SmallFlushesKeepGeometricGrowth) {
+    ecs::World world;
+    auto& c = world.GetCoordinator();
+    c.RegisterComponent<Position>();
+    CHECK(world.View<Position>().empty()); // a cached query set grows with every flush too
+
+    // one spawn per flush: the storage must not be reallocated every time
+    ecs::CommandBuffer cmds;
+    std::vector<ecs::Entity> created;
+    const Position* storage = nullptr;
+    int reallocations = 0;
+    for (int i = 0; i < 1000; ++i) {
+        cmds.CreateEntities(1, Position{ float(i), 0.0f });
+        cmds.Flush(c, created);
+        const Position* data = c.GetComponentStorage<Position>().Components().data();
+        reallocations += data != storage;
+        storage = data;
+    }
+    CHECK(world.View<Position>().size() == 1000);
+    CHECK(reallocations <= 12);
+}
+
+namespace {
+
+// Counts every construction at an address that misses its alignment.
+struct alignas(128) Wide {
+    static inline int misaligned = 0;
+    float value = 0.0f;
+
+    Wide() = default;
+    explicit Wide(float value) : value(value) { Check(); }
+    Wide(const Wide& other) : value(other.value) { Check(); }
+    Wide& operator=(const Wide&) = default;
+    void Check() const { misaligned += reinterpret_cast<std::uintptr_t>(this) % alignof(Wide) != 0; }
+};
+
+struct Huge {
+    unsigned char bytes[100'000] = {};
+};
+
+}
+
+TEST_CASE(CommandBuffer_AlignsPayloadsAndTakesOversizedOnes) {
+    ecs::World world;
+    auto& c = world.GetCoordinator();
+    c.RegisterComponent<Position>();
+    c.RegisterComponent<Wide>();
+    c.RegisterComponent<Huge>();
+
+    ecs::CommandBuffer cmds;
+    for (int i = 0; i < 1000; ++i) {
+        const ecs::Entity e = cmds.CreateEntity();
+        cmds.AddComponent(e, Position{ static_cast<float>(i), 0.0f }); // 8 bytes: shifts the next offset
+        cmds.AddComponent(e, Wide(static_cast<float>(i)));
+    }
+    auto huge = std::make_unique<Huge>();
+    huge->bytes[99'999] = 7;
+    const ecs::Entity big = cmds.CreateEntity();
+    cmds.AddComponent(big, *huge); // larger than an arena block
+
+    std::vector<ecs::Entity> created;
+    cmds.Flush(c, created);
+    CHECK(Wide::misaligned == 0);
+    CHECK(world.View<Position, Wide>().size() == 1000);
+    CHECK(c.GetComponent<Wide>(created[999]).value == 999.0f);
+    CHECK(c.GetComponent<Huge>(created[1000]).bytes[99'999] == 7);
+}
+
+TEST_CASE(CommandBuffer_BatchesAndDestroysWithJobs) {
+    JobSystem jobs(3);
+    ecs::World world;
+    auto& c = world.GetCoordinator();
+    c.SetJobSystem(&jobs);
+    c.RegisterComponent<Position>();
+    c.RegisterComponent<Velocity>();
+    auto movement = c.RegisterSystem<MovementSystem>();
+    c.SetSystemSignature<MovementSystem>(ecs::Signature::Of<Position, Velocity>());
+
+    ecs::CommandBuffer cmds;
+    cmds.CreateEntities(10'000, Position{ 1.0f, 2.0f }, Velocity{ 3.0f, 4.0f });
+    const ecs::Entity single = cmds.CreateEntity();
+    cmds.AddComponent(single, Position{});
+    cmds.AddComponent(single, Velocity{});
+    std::vector<ecs::Entity> created;
+    cmds.Flush(c, created);
+    CHECK(movement->entities.size() == 10'001);
+    CHECK(world.View<Position, Velocity>().size() == 10'001);
+    CHECK(c.GetComponent<Velocity>(created[5000]).dx == 3.0f);
+
+    // every destroy of the flush leaves arrays, systems and queries together
+    for (std::size_t i = 0; i < created.size(); i += 2) cmds.DestroyEntity(created[i]);
+    cmds.Flush(c);
+    CHECK(movement->entities.size() == 5000);
+    CHECK(world.View<Position>().size() == 5000);
+    CHECK(!c.IsAlive(created[0]) && c.IsAlive(created[1]));
+    CHECK(c.GetComponent<Position>(created[1]).y == 2.0f);
+}
+
+namespace {
+
+struct SnapshotWorld {
+    ecs::World world;
+    ecs::Coordinator& c = world.GetCoordinator();
+    std::shared_ptr<MovementSystem> movement;
+
+    SnapshotWorld() {
+        c.RegisterComponent<Position>();
+        c.RegisterComponent<Velocity>();
+        c.RegisterComponent<Name>();
+        c.SetComponentSerializer<Name>({ [](const Name& name, ecs::ByteWriter& out) { out.WriteString(name.value); },
+                                         [](ecs::ByteReader& in) { return Name{ in.ReadString() }; } });
+        movement = c.RegisterSystem<MovementSystem>();
+        c.SetSystemSignature<MovementSystem>(ecs::Signature::Of<Position, Velocity>());
+    }
+};
+
+}
+
+TEST_CASE(WorldSnapshot_RestoresEntitiesComponentsSystemsAndNames) {
+    SnapshotWorld s;
+    std::vector<ecs::Entity> entities;
+    for (int i = 0; i < 100; ++i) {
+        const ecs::Entity e = s.world.CreateEntity("e" + std::to_string(i));
+        s.c.AddComponent(e, Position{ float(i), 0.0f });
+        if (i % 2) s.c.AddComponent(e, Velocity{ 1.0f, 0.0f });
+        if (i % 5 == 0) s.c.AddComponent(e, Name{ "named" + std::to_string(i) });
+        entities.push_back(e);
+    }
+    CHECK(s.world.View<Position, Name>().size() == 20);
+    const std::vector<ecs::Entity> moving(s.movement->entities.begin(), s.movement->entities.end());
+
+    ecs::WorldSnapshot snapshot;
+    const ecs::SnapshotStats& first = snapshot.Capture(s.world);
+    CHECK(first.pagesWritten == first.pages && first.bytes > 100 * sizeof(Position));
+
+    // everything a frame might do: move, destroy, recycle a slot, add, remove, rename
+    for (ecs::Entity e : entities) s.c.GetComponent<Position>(e).x += 10.0f;
+    s.world.DestroyEntity(entities[3]);
+    const ecs::Entity recycled = s.world.CreateEntity("late");
+    s.c.AddComponent(recycled, Position{});
+    s.c.AddComponent(recycled, Velocity{});
+    s.c.AddComponent(entities[0], Velocity{});
+    s.c.RemoveComponent<Velocity>(entities[1]);
+    s.c.GetComponent<Name>(entities[5]).value = "changed";
+    CHECK(recycled.index == entities[3].index && !s.c.IsAlive(entities[3]));
+
+    CHECK(snapshot.Restore(s.world));
+    CHECK(s.c.IsAlive(entities[3]) && !s.c.IsAlive(recycled));
+    CHECK(!s.world.FindByName("late").IsValid() && s.world.FindByName("e3") == entities[3]);
+    bool same = true;
+    for (int i = 0; i < 100; ++i) {
+        same &= s.c.GetComponent<Position>(entities[i]).x == float(i);
+        same &= s.c.HasComponent<Velocity>(entities[i]) == (i % 2 == 1);
+    }
+    CHECK(same);
+    CHECK(s.c.GetComponent<Name>(entities[5]).value == "named5");
+    // system membership comes back in its old order, queries match again
+    CHECK(std::equal(moving.begin(), moving.end(), s.movement->entities.begin(), s.movement->entities.end()));
+    CHECK(s.world.View<Position, Name>().size() == 20 && s.world.View<Velocity>().size() == 50);
+
+    // the world keeps working from the restored state
+    const ecs::Entity next = s.world.CreateEntity();
+    CHECK(next.index == 100);
+    s.c.AddComponent(next, Position{});
+    CHECK(s.world.View<Position>().size() == 101);
+
+    // a world with other registrations is refused and left alone
+    ecs::World other;
+    other.GetCoordinator().RegisterComponent<Position>();
+    const ecs::Entity kept = other.CreateEntity("kept");
+    CHECK(!snapshot.Restore(other) && other.FindByName("kept") == kept);
+}
+
+TEST_CASE(WorldSnapshot_CopiesOnlyChangedPagesAndStepsThroughDeltas) {
+    SnapshotWorld s;
+    std::vector<ecs::Entity> entities;
+    for (int i = 0; i < 10000; ++i) {
+        entities.push_back(s.world.CreateEntity("e" + std::to_string(i)));
+        s.c.AddComponent(entities.back(), Position{ float(i), 0.0f });
+    }
+
+    ecs::WorldSnapshot snapshot;
+    std::vector<ecs::SnapshotDelta> history(3);
+    snapshot.Capture(s.world, &history[0]);
+
+    // nothing changed: the component pages compared equal, the structural
+    // blocks and the name index were not even compared
+    const ecs::SnapshotStats idle = snapshot.Capture(s.world, &history[1]);
+    CHECK(idle.pagesWritten == 0 && history[1].Empty());
+    CHECK(idle.blocksSkipped > 1 && idle.pages * ecs::WorldSnapshot::PageSize < idle.bytes);
+
+    // one component moved: one page
+    s.c.GetComponent<Position>(entities[5000]).y = 1.0f;
+    const ecs::SnapshotStats moved = snapshot.Capture(s.world, &history[1]);
+    CHECK(moved.pagesWritten == 1 && history[1].pages.size() == 1 && history[1].bytes.size() == 2 * ecs::WorldSnapshot::PageSize);
+
+    // a new entity grows the arrays
+    const ecs::Entity late = s.world.CreateEntity("late");
+    s.c.AddComponent(late, Position{ -1.0f, -1.0f });
+    s.c.GetComponent<Position>(entities[0]).y = 2.0f;
+    snapshot.Capture(s.world, &history[2]);
+    CHECK(!history[2].resizes.empty());
+
+    // back two frames: the state of the first capture
+    snapshot.Revert(history[2]);
+    snapshot.Revert(history[1]);
+    CHECK(snapshot.Restore(s.world));
+    CHECK(!s.c.IsAlive(late) && !s.world.FindByName("late").IsValid());
+    CHECK(s.c.GetComponent<Position>(entities[5000]).y == 0.0f && s.c.GetComponent<Position>(entities[0]).y == 0.0f);
+
+    // and forward again
+    snapshot.Apply(history[1]);
+    snapshot.Apply(history[2]);
+    CHECK(snapshot.Restore(s.world));
+    CHECK(s.c.IsAlive(late) && s.world.FindByName("late") == late);
+    CHECK(s.c.GetComponent<Position>(entities[5000]).y == 1.0f && s.c.GetComponent<Position>(late).x == -1.0f);
+}
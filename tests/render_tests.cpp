@@ -0,0 +1,745 @@
+#include "TestFramework.hpp"
+#include "RecordingGL.hpp"
+#include <engine/ecs/World.hpp>
+#include <engine/systems/RenderSystem.hpp>
+#include <engine/systems/Culling.hpp>
+#include <engine/systems/TransformSystem.hpp>
+#include <engine/gl/GLContext.hpp>
+#include <engine/gl/GpuTimer.hpp>
+#include <engine/assets/AssetManager.hpp>
+#include <engine/assets/ResidencyManager.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct RenderScene {
+    ecs::World world;
+    ecs::Coordinator& c = world.GetCoordinator();
+    std::shared_ptr<RenderSystem> system;
+    RecordingGL gl;
+
+    RenderScene() {
+        c.RegisterComponent<Transform>();
+        c.RegisterComponent<MeshRenderer>();
+        system = c.RegisterSystem<RenderSystem>();
+        c.SetSystemSignature<RenderSystem>(ecs::Signature::Of<Transform, MeshRenderer>());
+        system->SetBackend(gl);
+        system->SetView(glm::mat4(1.0f), 0.1f, 100.0f); // camera at the origin looking down -z
+    }
+
+    ecs::Entity Spawn(MaterialHandle material, MeshHandle mesh, float z, uint8_t layer = 0) {
+        const ecs::Entity e = world.CreateEntity();
+        Transform t;
+        t.world[3] = glm::vec4(0.0f, 0.0f, z, 1.0f);
+        c.AddComponent(e, t);
+        c.AddComponent(e, MeshRenderer{ mesh, material, layer });
+        return e;
+    }
+};
+
+}
+
+TEST_CASE(RenderQueue_RadixSortIsStableAndOrdered) {
+    RenderQueue queue;
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> keys;
+    for (int i = 0; i < 5000; ++i) {
+        // few distinct high bytes, like real keys, plus duplicates
+        const uint64_t key = (rng() % 4) << 60 | (rng() % 300) << 24 | (rng() % 50);
+        keys.push_back(key);
+        queue.Push({ key, nullptr, static_cast<MeshHandle>(i), 0 });
+    }
+    queue.Sort();
+
+    bool ordered = true, stable = true;
+    for (std::size_t i = 1; i < queue.Size(); ++i) {
+        ordered = ordered && queue[i - 1].key <= queue[i].key;
+        if (queue[i - 1].key == queue[i].key) stable = stable && queue[i - 1].mesh < queue[i].mesh;
+    }
+    CHECK(ordered);
+    CHECK(stable);
+}
+
+TEST_CASE(RenderQueue_KeysOrderLayersOpaqueAndDepth) {
+    // layer dominates, opaque before transparent, opaque near first, transparent far first
+    CHECK(RenderQueue::TransparentKey(0, 9, 9, 9, 0.9f) < RenderQueue::OpaqueKey(1, 0, 0, 0, 0.0f));
+    CHECK(RenderQueue::OpaqueKey(0, 9, 9, 9, 1.0f) < RenderQueue::TransparentKey(0, 0, 0, 0, 0.0f));
+    CHECK(RenderQueue::OpaqueKey(0, 1, 1, 1, 0.2f) < RenderQueue::OpaqueKey(0, 1, 1, 1, 0.3f));
+    CHECK(RenderQueue::OpaqueKey(0, 0, 5, 5, 0.9f) < RenderQueue::OpaqueKey(0, 1, 0, 0, 0.0f));
+    CHECK(RenderQueue::TransparentKey(0, 1, 1, 1, 0.3f) < RenderQueue::TransparentKey(0, 0, 0, 0, 0.2f));
+}
+
+TEST_CASE(RenderSystem_SortsAndSkipsRedundantBinds) {
+    RenderScene s;
+    const MeshHandle quad = s.system->AddMesh({ 1, 6, false });
+    const MeshHandle cube = s.system->AddMesh({ 2, 36, true });
+    const MaterialHandle brick = s.system->AddMaterial({ 10, 100, false });
+    const MaterialHandle stone = s.system->AddMaterial({ 10, 101, false });
+    const MaterialHandle flat = s.system->AddMaterial({ 20, 0, false });
+    const MaterialHandle glass = s.system->AddMaterial({ 20, 0, true });
+
+    s.Spawn(brick, quad, -5.0f);
+    s.Spawn(flat, cube, -3.0f);
+    s.Spawn(stone, quad, -8.0f);
+    s.Spawn(brick, quad, -2.0f);
+    s.Spawn(glass, quad, -4.0f);
+    s.Spawn(glass, cube, -9.0f);
+    s.Spawn(flat, cube, -1.0f);
+    s.Spawn(brick, cube, -6.0f);
+    s.Spawn(brick, quad, -1.0f, 1);
+
+    s.system->Update(0.0f);
+
+    // each draw selects its ObjectData slice; the ring holds the model matrices
+    const UniformRing& ring = s.system->GetQueue().GetObjectRing();
+    std::vector<float> drawnZ;
+    for (const RecordedCall& call : s.gl.calls)
+        if (call.op == RecordedCall::BindBufferRange && call.count == int(UniformBinding::Object))
+            drawnZ.push_back(s.gl.Read<ObjectUniforms>(call.a, call.offset).model[3].z);
+    const std::vector<float> expected = { -2, -5, -6, -8,   // program 10: brick quad near->far, brick cube, stone
+                                          -1, -3,           // program 20 opaque, near->far
+                                          -9, -4,           // transparent, far->near
+                                          -1 };             // layer 1
+    CHECK(drawnZ == expected);
+    CHECK(ring.Used() > 0 && ring.Used() % ring.Alignment() == sizeof(ObjectUniforms));
+
+    // no uniform is looked up or set while drawing
+    CHECK(s.gl.Count(RecordedCall::GetUniformLocation) == 0);
+    CHECK(s.gl.Count(RecordedCall::UniformMatrix4fv) == 0);
+    CHECK(s.gl.Count(RecordedCall::BindBufferBase) == 1); // FrameData, once
+
+    CHECK(s.gl.Count(RecordedCall::UseProgram) == 3);       // 10, 20, 10 for layer 1
+    CHECK(s.gl.Count(RecordedCall::BindTexture) == 4);      // 100, 101, 0 for program 20, 100
+    CHECK(s.gl.Count(RecordedCall::BindVertexArray) == 5);
+    CHECK(s.gl.Count(RecordedCall::DrawElements) == 4);
+    CHECK(s.gl.Draws() == 9);
+
+    const RenderStats& stats = s.system->GetStats();
+    CHECK(stats.commands == 9 && stats.drawCalls == 9);
+    CHECK(stats.programBinds == 3 && stats.textureBinds == 4 && stats.vaoBinds == 5);
+    CHECK(stats.StateChanges() == 12);
+}
+
+TEST_CASE(RenderSystem_InstancesRepeatedMeshMaterialPairs) {
+    RenderScene s;
+    const MeshHandle rock = s.system->AddMesh({ 1, 300, true });
+    const MeshHandle crate = s.system->AddMesh({ 2, 36, false });
+    Material instanced{ 30, 200, false };
+    instanced.instanced = true;
+    const MaterialHandle rockMaterial = s.system->AddMaterial(instanced);
+    const MaterialHandle crateMaterial = s.system->AddMaterial(instanced);
+    const MaterialHandle flat = s.system->AddMaterial({ 20, 0, false });
+
+    ecs::Entity tinted;
+    for (int i = 0; i < 10'000; ++i) {
+        const ecs::Entity e = s.Spawn(rockMaterial, rock, -1.0f - float(i % 50));
+        if (i == 1234) tinted = e;
+    }
+    for (int i = 0; i < 5'000; ++i) s.Spawn(crateMaterial, crate, -2.0f - float(i % 10));
+    for (int i = 0; i < 3; ++i) s.Spawn(flat, crate, -3.0f);
+    s.c.GetComponent<MeshRenderer>(tinted).params = glm::vec4(0.25f, 0.5f, 0.75f, 1.0f);
+
+    s.system->Update(0.0f);
+
+    const RenderStats& stats = s.system->GetStats();
+    CHECK(stats.commands == 15'003);
+    CHECK(stats.drawCalls == 5 && s.gl.Draws() == 5);
+    CHECK(stats.instancedDraws == 2 && stats.instances == 15'000);
+    // one upload for the instances, one for the three plain draws' ObjectData
+    CHECK(s.gl.Count(RecordedCall::BufferSubData) == 2);
+    CHECK(std::count_if(s.gl.calls.begin(), s.gl.calls.end(), [](const RecordedCall& call) {
+        return call.op == RecordedCall::BufferSubData && call.count == int(15'000 * sizeof(InstanceData));
+    }) == 1);
+
+    std::vector<int> instanceCounts;
+    std::vector<std::size_t> paramsOffsets;
+    for (const RecordedCall& call : s.gl.calls) {
+        if (call.op == RecordedCall::DrawElementsInstanced || call.op == RecordedCall::DrawArraysInstanced)
+            instanceCounts.push_back(call.instances);
+        if (call.op == RecordedCall::VertexAttribPointer && call.a == InstanceBuffer::ParamsLocation)
+            paramsOffsets.push_back(call.offset);
+    }
+    CHECK(instanceCounts == std::vector<int>{ 10'000, 5'000 });
+    CHECK(paramsOffsets == std::vector<std::size_t>{ offsetof(InstanceData, params),
+                                                     10'000 * sizeof(InstanceData) + offsetof(InstanceData, params) });
+
+    // the tinted rock's params and world matrix made it into the buffer
+    const GLuint instanceBuffer = s.system->GetQueue().GetInstanceBuffer().Buffer();
+    const auto* data = reinterpret_cast<const InstanceData*>(s.gl.contents.at(instanceBuffer).data());
+    CHECK(std::count_if(data, data + 10'000, [](const InstanceData& d) {
+        return d.params == glm::vec4(0.25f, 0.5f, 0.75f, 1.0f) && d.world[3].z == -1.0f - float(1234 % 50);
+    }) == 1);
+
+    // the plain material still reads ObjectData, one range per draw
+    CHECK(s.gl.Count(RecordedCall::BindBufferRange) == 3);
+    CHECK(s.gl.Count(RecordedCall::UniformMatrix4fv) == 0);
+}
+
+namespace {
+
+std::vector<Aabb> RandomBoxes(std::size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> position(-200.0f, 200.0f), size(0.1f, 5.0f);
+    std::vector<Aabb> boxes;
+    for (std::size_t i = 0; i < count; ++i) {
+        const glm::vec3 center(position(rng), position(rng) * 0.1f, position(rng));
+        const glm::vec3 extents(size(rng), size(rng), size(rng));
+        boxes.push_back({ center - extents, center + extents });
+    }
+    return boxes;
+}
+
+Frustum TestFrustum() {
+    Camera camera;
+    camera.farPlane = 150.0f;
+    Transform eye;
+    eye.rotation = glm::angleAxis(0.7f, glm::vec3(0.0f, 1.0f, 0.0f));
+    eye.world = eye.LocalMatrix();
+    return Frustum::FromMatrix(camera.ProjectionMatrix() * Camera::ViewMatrix(eye));
+}
+
+}
+
+TEST_CASE(Culling_SimdMatchesScalar) {
+    const std::vector<Aabb> boxes = RandomBoxes(1003, 1); // not a multiple of the SIMD width
+    const Frustum frustum = TestFrustum();
+    BoundsSoA soa;
+    for (const Aabb& box : boxes) soa.Push(box);
+
+    std::vector<uint32_t> visible(boxes.size());
+    visible.resize(CullBounds(frustum, soa, 0, soa.Size(), visible.data()));
+
+    std::vector<uint32_t> expected;
+    for (uint32_t i = 0; i < boxes.size(); ++i)
+        if (frustum.Intersects(boxes[i])) expected.push_back(i);
+    CHECK(visible == expected);
+    CHECK(!expected.empty() && expected.size() < boxes.size());
+}
+
+TEST_CASE(Culling_BvhMatchesBruteForce) {
+    const std::vector<Aabb> boxes = RandomBoxes(20000, 2);
+    const Frustum frustum = TestFrustum();
+    BoundsBvh bvh;
+    bvh.Build(boxes);
+    CHECK(bvh.Size() == boxes.size());
+
+    std::vector<uint32_t> visible;
+    bvh.Cull(frustum, visible);
+    std::sort(visible.begin(), visible.end());
+
+    std::vector<uint32_t> expected;
+    for (uint32_t i = 0; i < boxes.size(); ++i)
+        if (frustum.Intersects(boxes[i])) expected.push_back(i);
+    CHECK(visible == expected);
+}
+
+TEST_CASE(RenderSystem_CullsOffscreenDynamicAndStatic) {
+    RenderScene s;
+    s.c.RegisterComponent<Camera>();
+    const ecs::Entity eye = s.world.CreateEntity();
+    s.c.AddComponent(eye, Transform{});
+    s.c.AddComponent(eye, Camera{});
+    s.system->SetCamera(eye);
+
+    Mesh cube{ 1, 36, true };
+    cube.bounds = { glm::vec3(-1.0f), glm::vec3(1.0f) };
+    const MeshHandle bounded = s.system->AddMesh(cube);
+    const MeshHandle unbounded = s.system->AddMesh({ 2, 3, false });
+    const MaterialHandle material = s.system->AddMaterial({ 10, 0, false });
+
+    const auto spawn = [&](MeshHandle mesh, float z, bool isStatic) {
+        const ecs::Entity e = s.world.CreateEntity();
+        Transform t;
+        t.world[3] = glm::vec4(0.0f, 0.0f, z, 1.0f);
+        s.c.AddComponent(e, t);
+        s.c.AddComponent(e, MeshRenderer{ mesh, material, 0, isStatic });
+        return e;
+    };
+    spawn(bounded, -10.0f, false);   // in front
+    spawn(bounded, 10.0f, false);    // behind the camera
+    spawn(bounded, -20.0f, true);
+    spawn(bounded, 20.0f, true);
+    spawn(unbounded, 10.0f, false);  // no bounds: never culled
+
+    s.system->Update(0.0f);
+    CHECK(s.system->GetStats().drawCalls == 3);
+    CHECK(s.system->GetStats().culled == 2);
+
+    // turning around swaps what is visible; the static BVH is reused
+    s.c.GetComponent<Transform>(eye).world = glm::mat4_cast(glm::angleAxis(3.14159265f, glm::vec3(0.0f, 1.0f, 0.0f)));
+    s.system->Update(0.0f);
+    CHECK(s.system->GetStats().drawCalls == 3);
+    std::vector<float> drawnZ;
+    for (std::size_t i = 0; i < s.system->GetQueue().Size(); ++i) drawnZ.push_back((*s.system->GetQueue()[i].world)[3][2]);
+    std::sort(drawnZ.begin(), drawnZ.end());
+    CHECK(drawnZ == std::vector<float>{ 10.0f, 10.0f, 20.0f });
+}
+
+TEST_CASE(RenderSystem_ResolvesStreamedAssetsAndTouchesThem) {
+    // declared before the scene, whose RenderSystem holds handles into them
+    ResidencyManager residency({ .budgetBytes = 100 });
+    AssetManager assets(nullptr, ".");
+    RenderScene s;
+    s.c.RegisterComponent<Camera>();
+    const ecs::Entity eye = s.world.CreateEntity();
+    s.c.AddComponent(eye, Transform{});
+    s.c.AddComponent(eye, Camera{});
+    s.system->SetCamera(eye);
+
+    // every upload and every stream-in hands out a fresh GL name
+    GLuint nextName = 100;
+    assets.SetResidency(&residency);
+    assets.RegisterLoader<MeshAsset, int>(
+        [](const std::filesystem::path&) -> std::optional<int> { return 0; },
+        [&](GLBackend&, int&) -> std::optional<MeshAsset> {
+            MeshAsset mesh;
+            mesh.mesh = { nextName++, 36, true, { glm::vec3(-1.0f), glm::vec3(1.0f) } };
+            return mesh;
+        });
+    assets.RegisterStreaming<MeshAsset, int>(
+        [](GLBackend&, const int&) { return ResidencyLevels{ { 100 } }; },
+        [&](GLBackend&, MeshAsset& mesh, const int&, uint32_t firstLevel) { mesh.mesh.vao = firstLevel == 0 ? nextName++ : 0; });
+    assets.RegisterLoader<TextureAsset, int>(
+        [](const std::filesystem::path&) -> std::optional<int> { return 0; },
+        [&](GLBackend&, int&) -> std::optional<TextureAsset> { return TextureAsset{ nextName++ }; });
+    assets.RegisterStreaming<TextureAsset, int>(
+        [](GLBackend&, const int&) { return ResidencyLevels{ { 100 } }; },
+        [&](GLBackend&, TextureAsset& texture, const int&, uint32_t firstLevel) { texture.texture = firstLevel == 0 ? nextName++ : 0; });
+
+    const Asset<MeshAsset> meshA = assets.Load<MeshAsset>("a.mesh"), meshB = assets.Load<MeshAsset>("b.mesh");
+    const Asset<TextureAsset> textureB = assets.Load<TextureAsset>("b.tex");
+    const MaterialHandle plain = s.system->AddMaterial({ 10, 0, false });
+    const MaterialHandle textured = s.system->AddMaterial({ 10, 0, false }, textureB);
+    const ecs::Entity a = s.Spawn(plain, s.system->AddMesh(meshA), -10.0f);
+    const ecs::Entity b = s.Spawn(textured, s.system->AddMesh(meshB), 10.0f); // behind the camera
+
+    const auto boundVao = [&] {
+        GLuint vao = 0;
+        for (const RecordedCall& call : s.gl.calls)
+            if (call.op == RecordedCall::BindVertexArray) vao = call.a;
+        return vao;
+    };
+    const auto frame = [&] {
+        s.gl.calls.clear();
+        s.system->Update(0.0f);
+        assets.UpdateResidency(s.gl);
+    };
+
+    // nothing is drawn before the meshes are on the GPU
+    frame();
+    CHECK(s.system->GetStats().drawCalls == 0);
+
+    assets.Flush(s.gl);
+    const GLuint firstTextureB = textureB.Get()->texture;
+    frame();
+    CHECK(s.system->GetStats().drawCalls == 1 && boundVao() == meshA.Get()->mesh.vao);
+
+    // b is culled, so never touched: its mesh and texture are evicted
+    frame();
+    CHECK(residency.Resident(meshA.Slot()) && !residency.Resident(meshB.Slot()) && !residency.Resident(textureB.Slot()));
+
+    // an evicted mesh in view is not drawn, but touched, which streams it back
+    s.c.GetComponent<Transform>(a).world[3].z = 10.0f;
+    s.c.GetComponent<Transform>(b).world[3].z = -12.0f;
+    frame();
+    CHECK(s.system->GetStats().drawCalls == 0);
+    CHECK(s.system->GetStats().notResident == 1 && s.system->GetStats().culled == 1); // a is behind the camera
+    CHECK(residency.Resident(meshB.Slot()) && residency.Resident(textureB.Slot()));
+
+    // and the next frame draws it with the GL names streaming gave it
+    frame();
+    CHECK(s.system->GetStats().drawCalls == 1 && boundVao() == meshB.Get()->mesh.vao);
+    CHECK(textureB.Get()->texture != firstTextureB);
+    CHECK(s.gl.Count(RecordedCall::BindTexture) == 1);
+    bool boundTexture = false;
+    for (const RecordedCall& call : s.gl.calls)
+        if (call.op == RecordedCall::BindTexture) boundTexture = call.a == textureB.Get()->texture;
+    CHECK(boundTexture);
+
+    assets.Clear(s.gl);
+}
+
+TEST_CASE(RenderSystem_UnbindsTextureForMaterialWithoutResidentTexture) {
+    ResidencyManager residency({ .budgetBytes = 1000 });
+    AssetManager assets(nullptr, ".");
+    RenderScene s;
+    assets.SetResidency(&residency);
+    assets.RegisterLoader<TextureAsset, int>(
+        [](const std::filesystem::path&) -> std::optional<int> { return 0; },
+        [](GLBackend&, int&) -> std::optional<TextureAsset> { return TextureAsset{ 300 }; });
+
+    // the streamed texture is requested but not uploaded yet
+    const Asset<TextureAsset> pending = assets.Load<TextureAsset>("pending.tex");
+    const MeshHandle mesh = s.system->AddMesh({ 1, 6, false });
+    const MaterialHandle brick = s.system->AddMaterial({ 10, 100, false });
+    const MaterialHandle streamed = s.system->AddMaterial({ 10, 0, false }, pending);
+    s.Spawn(brick, mesh, -2.0f);
+    s.Spawn(streamed, mesh, -5.0f);
+
+    s.system->Update(0.0f);
+    CHECK(s.system->GetStats().drawCalls == 2);
+    std::vector<GLuint> bound;
+    for (const RecordedCall& call : s.gl.calls)
+        if (call.op == RecordedCall::BindTexture) bound.push_back(call.a);
+    CHECK(bound == std::vector<GLuint>{ 100, 0 });
+}
+
+TEST_CASE(RenderSystem_CullsThroughTransformSystemBounds) {
+    RenderScene s;
+    s.c.RegisterComponent<Camera>();
+    const auto transforms = s.c.RegisterSystem<TransformSystem>();
+    s.c.SetSystemSignature<TransformSystem>(ecs::Signature::Of<Transform>());
+    s.system->SetTransformSystem(transforms.get());
+
+    const ecs::Entity eye = s.world.CreateEntity();
+    s.c.AddComponent(eye, Transform{});
+    s.c.AddComponent(eye, Camera{});
+    s.system->SetCamera(eye);
+
+    Mesh cube{ 1, 36, true };
+    cube.bounds = { glm::vec3(-1.0f), glm::vec3(1.0f) };
+    const MeshHandle mesh = s.system->AddMesh(cube);
+    const MaterialHandle material = s.system->AddMaterial({ 10, 0, false });
+    const auto spawn = [&](float z) {
+        const ecs::Entity e = s.world.CreateEntity();
+        Transform t;
+        t.position.z = z;
+        t.world[3] = glm::vec4(0.0f, 0.0f, z, 1.0f);
+        s.c.AddComponent(e, t);
+        s.c.AddComponent(e, MeshRenderer{ mesh, material });
+        return e;
+    };
+    const ecs::Entity front = spawn(-10.0f);
+    const ecs::Entity back = spawn(10.0f);
+    transforms->Update(0.0f);
+    s.system->Update(0.0f);
+    CHECK(s.system->GetStats().commands == 1 && s.system->GetStats().culled == 1);
+
+    const auto boxOf = [&](ecs::Entity entity) {
+        const BoundsSoA& bounds = transforms->GetWorldBounds();
+        for (uint32_t node = 0; node < bounds.Size(); ++node)
+            if (transforms->NodeEntity(node) == entity)
+                return Aabb{ { bounds.minX[node], bounds.minY[node], bounds.minZ[node] },
+                             { bounds.maxX[node], bounds.maxY[node], bounds.maxZ[node] } };
+        return Aabb{};
+    };
+    CHECK(boxOf(front).min.z == -11.0f && boxOf(front).max.z == -9.0f);
+
+    // moving a node refreshes its box in the TransformSystem's update
+    s.c.GetComponent<Transform>(back).position.z = -5.0f;
+    transforms->MarkDirty(back);
+    transforms->Update(0.0f);
+    CHECK(transforms->GetUpdatedCount() == 1 && boxOf(back).max.z == -4.0f);
+    s.system->Update(0.0f);
+    CHECK(s.system->GetStats().commands == 2);
+
+    // a drawable the TransformSystem has no node for yet is culled from Transform::world
+    spawn(-20.0f);
+    spawn(20.0f);
+    s.system->Update(0.0f);
+    CHECK(s.system->GetStats().commands == 3 && s.system->GetStats().culled == 1);
+
+    // a drawable that leaves gives its bounds back: the node no longer passes
+    s.c.RemoveComponent<MeshRenderer>(front);
+    transforms->Update(0.0f);
+    s.system->Update(0.0f);
+    CHECK(s.system->GetStats().commands == 2);
+    CHECK(!Frustum::FromMatrix(s.system->GetFrameUniforms().viewProjection).Intersects(boxOf(front)));
+}
+
+TEST_CASE(RenderSystem_ViewFollowsInterpolatedCamera) {
+    RenderScene s;
+    s.c.RegisterComponent<Camera>();
+    const auto transforms = s.c.RegisterSystem<TransformSystem>();
+    s.c.SetSystemSignature<TransformSystem>(ecs::Signature::Of<Transform>());
+    transforms->SetInterpolation(true);
+    s.system->SetTransformSystem(transforms.get());
+
+    const ecs::Entity eye = s.world.CreateEntity();
+    s.c.AddComponent(eye, Transform{});
+    s.c.AddComponent(eye, Camera{});
+    s.system->SetCamera(eye);
+    transforms->Update(0.0f);
+
+    // the camera moved 4 units in the last step; a quarter of the way there is drawn
+    s.c.GetComponent<Transform>(eye).position.x = 4.0f;
+    transforms->MarkDirty(eye);
+    transforms->Update(0.0f);
+    transforms->Interpolate(0.25f);
+    s.system->Update(0.0f);
+
+    const glm::mat4& view = s.system->GetFrameUniforms().view;
+    CHECK(std::fabs(view[3][0] + 1.0f) < 1e-5f);
+    CHECK(s.c.GetComponent<Transform>(eye).world[3][0] == 4.0f);
+}
+
+TEST_CASE(GLContext_SkipsRedundantStateAndCounts) {
+    RecordingGL backend;
+    GLContext gl(backend);
+
+    for (int frame = 0; frame < 3; ++frame) {
+        gl.BeginFrame();
+        gl.ClearColor(0.1f, 0.2f, 0.3f, 1.0f);
+        gl.Clear(GL_COLOR_BUFFER_BIT);
+        gl.Viewport(0, 0, 800, 600);
+        gl.Enable(GL_DEPTH_TEST);
+        gl.DepthFunc(GL_LESS);
+        gl.UseProgram(7);
+        gl.ActiveTexture(GL_TEXTURE0);
+        gl.BindTexture(GL_TEXTURE_2D, 3);
+        gl.BindVertexArray(2);
+        gl.DrawArrays(GL_TRIANGLES, 0, 3);
+        gl.BindVertexArray(2);
+        gl.UseProgram(7);
+        gl.DrawArrays(GL_TRIANGLES, 0, 3);
+    }
+
+    // first frame: everything but the repeated VAO/program binds goes out
+    CHECK(backend.Count(RecordedCall::UseProgram) == 1);
+    CHECK(backend.Count(RecordedCall::BindVertexArray) == 1);
+    CHECK(backend.Count(RecordedCall::BindTexture) == 1);
+    CHECK(backend.Count(RecordedCall::Enable) == 1 && backend.Count(RecordedCall::Viewport) == 1);
+    CHECK(backend.Count(RecordedCall::ClearColor) == 1);
+    CHECK(backend.Count(RecordedCall::Clear) == 3 && backend.Draws() == 6);
+
+    // later frames only clear and draw
+    CHECK(gl.GetFrameStats().issued == 3 && gl.GetFrameStats().skipped == 10);
+    CHECK(gl.GetLastFrameStats().issued == 3);
+
+    // state changes and other texture units / targets are not filtered
+    gl.Disable(GL_DEPTH_TEST);
+    gl.ActiveTexture(GL_TEXTURE1);
+    gl.BindTexture(GL_TEXTURE_2D, 3);
+    gl.BindTexture(GL_TEXTURE_3D, 3);
+    gl.BindTexture(GL_TEXTURE_3D, 3);
+    CHECK(backend.Count(RecordedCall::Disable) == 1 && backend.Count(RecordedCall::BindTexture) == 4);
+
+    // after Invalidate the next bind is issued again
+    gl.Invalidate();
+    gl.UseProgram(7);
+    CHECK(backend.Count(RecordedCall::UseProgram) == 2);
+}
+
+TEST_CASE(GLContext_TracksVertexArrayAttributesAndDeletes) {
+    RecordingGL backend;
+    GLContext gl(backend);
+
+    GLuint vaos[2];
+    gl.GenVertexArrays(2, vaos);
+    for (int pass = 0; pass < 2; ++pass) {
+        for (GLuint vao : vaos) {
+            gl.BindVertexArray(vao);
+            gl.EnableVertexAttribArray(4);
+            gl.VertexAttribDivisor(4, 1);
+            gl.VertexAttribDivisor(0, 0); // default for a new VAO
+        }
+    }
+    CHECK(backend.Count(RecordedCall::EnableVertexAttribArray) == 2);
+    CHECK(backend.Count(RecordedCall::VertexAttribDivisor) == 2);
+
+    // a VAO the context did not create starts out unknown
+    gl.BindVertexArray(99);
+    gl.VertexAttribDivisor(0, 0);
+    CHECK(backend.Count(RecordedCall::VertexAttribDivisor) == 3);
+
+    // deleting bound objects resets their bindings, so a reused name binds again
+    GLuint buffer = 0;
+    gl.GenBuffers(1, &buffer);
+    gl.BindBuffer(GL_ARRAY_BUFFER, buffer);
+    gl.BindBuffer(GL_ARRAY_BUFFER, buffer);
+    gl.DeleteBuffers(1, &buffer);
+    gl.BindBuffer(GL_ARRAY_BUFFER, buffer);
+    CHECK(backend.Count(RecordedCall::BindBuffer) == 2);
+
+    gl.BindVertexArray(vaos[0]);
+    gl.DeleteVertexArrays(1, &vaos[0]);
+    gl.BindVertexArray(vaos[0]);
+    CHECK(backend.Count(RecordedCall::BindVertexArray) == 7);
+}
+
+TEST_CASE(GLContext_FiltersRenderSystemAcrossFrames) {
+    RenderScene s;
+    GLContext gl(s.gl);
+    s.system->SetBackend(gl);
+    Material instanced{ 30, 200, false };
+    instanced.instanced = true;
+    const MeshHandle mesh = s.system->AddMesh({ 1, 36, true });
+    const MaterialHandle material = s.system->AddMaterial(instanced);
+    for (int i = 0; i < 100; ++i) s.Spawn(material, mesh, -1.0f - float(i));
+
+    s.system->Update(0.0f);
+    gl.BeginFrame();
+    s.gl.calls.clear();
+    s.system->Update(0.0f);
+
+    // second frame: program, texture, VAO and attribute enables/divisors are already set
+    CHECK(s.gl.Count(RecordedCall::UseProgram) == 0 && s.gl.Count(RecordedCall::BindTexture) == 0);
+    CHECK(s.gl.Count(RecordedCall::BindVertexArray) == 0);
+    CHECK(s.gl.Count(RecordedCall::EnableVertexAttribArray) == 0 && s.gl.Count(RecordedCall::VertexAttribDivisor) == 0);
+    CHECK(s.gl.Count(RecordedCall::BindBufferBase) == 0); // FrameData stays bound
+    CHECK(s.gl.Draws() == 1);
+    CHECK(gl.GetFrameStats().skipped > 0);
+}
+
+TEST_CASE(InstanceBuffer_RotatesSegmentsAndKeepsPointersWithBaseInstance) {
+    RenderScene s;
+    s.gl.baseInstance = true;
+    GLContext gl(s.gl);
+    s.system->SetBackend(gl);
+    Material instanced{ 30, 200, false };
+    instanced.instanced = true;
+    const MeshHandle rock = s.system->AddMesh({ 1, 300, true });
+    const MeshHandle crate = s.system->AddMesh({ 2, 36, false });
+    const MaterialHandle material = s.system->AddMaterial(instanced);
+    for (int i = 0; i < 100; ++i) s.Spawn(material, rock, -1.0f - float(i % 10));
+    for (int i = 0; i < 50; ++i) s.Spawn(material, crate, -2.0f);
+
+    const auto baseInstances = [&] {
+        std::vector<std::size_t> bases;
+        for (const RecordedCall& call : s.gl.calls)
+            if (call.op == RecordedCall::DrawElementsInstanced || call.op == RecordedCall::DrawArraysInstanced)
+                bases.push_back(call.offset);
+        return bases;
+    };
+    const InstanceBuffer& instances = s.system->GetQueue().GetInstanceBuffer();
+
+    s.system->Update(0.0f);
+    CHECK(instances.SegmentCapacity() == 256);
+    CHECK(baseInstances() == std::vector<std::size_t>{ 0, 100 });
+    // each VAO's attributes point at the start of the buffer
+    CHECK(s.gl.Count(RecordedCall::VertexAttribPointer) == 10);
+
+    for (std::size_t frame = 1; frame <= 3; ++frame) {
+        gl.BeginFrame();
+        s.gl.calls.clear();
+        s.system->Update(0.0f);
+
+        const std::size_t segment = frame % InstanceBuffer::FramesInFlight;
+        CHECK(s.gl.Count(RecordedCall::BufferData) == 0);
+        CHECK(s.gl.Count(RecordedCall::VertexAttribPointer) == 0);
+        CHECK(baseInstances() == std::vector<std::size_t>{ segment * 256, segment * 256 + 100 });
+        CHECK(instances.SegmentOffset() == segment * 256 * sizeof(InstanceData));
+    }
+
+    // without base instance every batch re-points its attributes at its slice
+    s.gl.baseInstance = false;
+    gl.BeginFrame();
+    s.gl.calls.clear();
+    s.system->Update(0.0f);
+    std::vector<std::size_t> paramsOffsets;
+    for (const RecordedCall& call : s.gl.calls)
+        if (call.op == RecordedCall::VertexAttribPointer && call.a == InstanceBuffer::ParamsLocation)
+            paramsOffsets.push_back(call.offset);
+    const std::size_t first = 256 + 0, second = 256 + 100; // segment 1 again
+    CHECK(paramsOffsets == std::vector<std::size_t>{ first * sizeof(InstanceData) + offsetof(InstanceData, params),
+                                                     second * sizeof(InstanceData) + offsetof(InstanceData, params) });
+    CHECK(baseInstances() == std::vector<std::size_t>{ 0, 0 });
+}
+
+TEST_CASE(UniformRing_AlignsPushesAndRotatesSegments) {
+    RecordingGL gl;
+    gl.uniformBufferAlignment = 64;
+    UniformRing ring;
+    const ObjectUniforms object{ glm::mat4(2.0f), glm::vec4(3.0f) };
+
+    ring.BeginFrame(gl);
+    std::vector<std::size_t> offsets;
+    for (int i = 0; i < 5; ++i) offsets.push_back(ring.Push(&object, sizeof(object)));
+    ring.Upload(gl);
+    CHECK(offsets == std::vector<std::size_t>{ 0, 128, 256, 384, 512 }); // 80 bytes rounded up to 64
+    CHECK(ring.SegmentCapacity() == 1024);
+    CHECK(gl.Count(RecordedCall::BufferData) == 1 && gl.calls.back().op == RecordedCall::BufferSubData);
+    const std::size_t firstSegment = ring.SegmentOffset();
+
+    // next frame writes the next segment, without reallocating
+    ring.BeginFrame(gl);
+    const std::size_t offset = ring.Push(&object, sizeof(object));
+    ring.Upload(gl);
+    CHECK(offset == 0 && ring.SegmentOffset() == (firstSegment + 1024) % (1024 * UniformRing::FramesInFlight));
+    CHECK(gl.Count(RecordedCall::BufferData) == 1 && gl.calls.back().offset == ring.SegmentOffset());
+
+    ring.BindRange(gl, UniformBinding::Object, offset, sizeof(object));
+    CHECK(gl.calls.back().op == RecordedCall::BindBufferRange && gl.calls.back().offset == ring.SegmentOffset());
+    CHECK(gl.Read<ObjectUniforms>(ring.Buffer(), ring.SegmentOffset()).params == glm::vec4(3.0f));
+
+    // a frame that outgrows its segment reallocates at the next power of two
+    ring.BeginFrame(gl);
+    for (int i = 0; i < 12; ++i) ring.Push(&object, sizeof(object)); // 11 * 128 + 80 bytes
+    ring.Upload(gl);
+    CHECK(ring.SegmentCapacity() == 2048 && gl.Count(RecordedCall::BufferData) == 2);
+}
+
+TEST_CASE(GLContext_SkipsRedundantUniformBufferRanges) {
+    RecordingGL backend;
+    GLContext gl(backend);
+    gl.BindBufferBase(GL_UNIFORM_BUFFER, 0, 5);
+    gl.BindBufferBase(GL_UNIFORM_BUFFER, 0, 5);
+    gl.BindBufferRange(GL_UNIFORM_BUFFER, 1, 6, 0, 80);
+    gl.BindBufferRange(GL_UNIFORM_BUFFER, 1, 6, 0, 80);
+    gl.BindBufferRange(GL_UNIFORM_BUFFER, 1, 6, 256, 80);
+    gl.BindBuffer(GL_UNIFORM_BUFFER, 6); // indexed binds set the generic binding too
+    CHECK(backend.Count(RecordedCall::BindBufferBase) == 1);
+    CHECK(backend.Count(RecordedCall::BindBufferRange) == 2);
+    CHECK(backend.Count(RecordedCall::BindBuffer) == 0);
+
+    const GLuint frame = 5;
+    gl.DeleteBuffers(1, &frame);
+    gl.BindBufferBase(GL_UNIFORM_BUFFER, 0, 5);
+    CHECK(backend.Count(RecordedCall::BindBufferBase) == 2);
+}
+
+TEST_CASE(GpuTimer_ReportsSpansOnceTheQueriesLand) {
+    RecordingGL gl;
+    GpuTimer timer;
+    timer.Begin(gl, "test.gpu.outer");
+    timer.End(gl);
+    timer.Collect(gl);
+    CHECK(gl.calls.empty()); // disabled: no GL work at all
+
+    Profiler& profiler = Profiler::Instance();
+    timer.SetEnabled(true);
+    gl.queriesAvailable = false;
+    for (std::size_t frame = 0; frame < GpuTimer::FramesInFlight - 1; ++frame) {
+        timer.Begin(gl, "test.gpu.outer");
+        timer.Begin(gl, "test.gpu.inner");
+        timer.End(gl);
+        timer.End(gl);
+        timer.Collect(gl);
+    }
+    profiler.EndFrame();
+    CHECK(gl.Count(RecordedCall::QueryCounter) == 4 * (GpuTimer::FramesInFlight - 1));
+    CHECK(gl.Count(RecordedCall::GenQueries) == GpuTimer::FramesInFlight - 1); // one pool per frame slot
+    CHECK(profiler.Statistics("test.gpu.outer").frames == 0);
+
+    // the results of every pending frame arrive together; spans are placed
+    // by the GPU clock, 1 us per query here
+    gl.queriesAvailable = true;
+    timer.Begin(gl, "test.gpu.outer");
+    timer.Collect(gl); // closes the open span
+    profiler.EndFrame();
+    const ScopeStats outer = profiler.Statistics("test.gpu.outer");
+    const ScopeStats inner = profiler.Statistics("test.gpu.inner");
+    CHECK(outer.frames == 1 && outer.calls == GpuTimer::FramesInFlight);
+    CHECK(inner.frames == 1 && inner.calls == GpuTimer::FramesInFlight - 1);
+    CHECK(std::abs(inner.lastMs - 0.001 * (GpuTimer::FramesInFlight - 1)) < 1e-6);
+    CHECK(std::abs(outer.lastMs - (0.003 * (GpuTimer::FramesInFlight - 1) + 0.001)) < 1e-6);
+    CHECK(timer.DroppedFrames() == 0);
+
+    // a frame still pending when its slot is needed again is dropped
+    gl.queriesAvailable = false;
+    for (std::size_t frame = 0; frame < GpuTimer::FramesInFlight; ++frame) {
+        timer.Begin(gl, "test.gpu.outer");
+        timer.End(gl);
+        timer.Collect(gl);
+    }
+    CHECK(timer.DroppedFrames() == 1);
+
+    timer.Release(gl);
+    CHECK(gl.Count(RecordedCall::DeleteQueries) == GpuTimer::FramesInFlight);
+}
@@ -0,0 +1,182 @@
+#include "TestFramework.hpp"
+#include "RecordingGL.hpp"
+#include "TempDirectory.hpp"
+#include <engine/gl/ShaderCache.hpp>
+#include <engine/gl/ShaderLibrary.hpp>
+#include <engine/gl/ShaderProgram.hpp>
+#include <engine/gl/UniformBuffer.hpp>
+#include <engine/core/JobSystem.hpp>
+#include <engine/utils/Hash.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <string>
+
+namespace {
+
+// In-memory shader directory.
+ShaderIncludeLoader MapLoader(const std::map<std::string, std::string>& files) {
+    return [files](const std::string& name) -> std::optional<std::string> {
+        auto it = files.find(name);
+        if (it == files.end()) return std::nullopt;
+        return it->second;
+    };
+}
+
+}
+
+TEST_CASE(ShaderLibrary_ApplyDefinesAfterVersion) {
+    const std::string source = "#version 330 core\nvoid main() {}\n";
+    CHECK(ApplyDefines(source, {}) == source);
+    CHECK(ApplyDefines(source, { "USE_FOG", "MAX_LIGHTS 8" })
+          == "#version 330 core\n#define USE_FOG\n#define MAX_LIGHTS 8\n#line 2\nvoid main() {}\n");
+    CHECK(ApplyDefines("void main() {}", { "A" }) == "#define A\n#line 1\nvoid main() {}");
+    CHECK(ApplyDefines("// header\n#version 330 core", { "A" }) == "// header\n#version 330 core\n#define A\n#line 3\n");
+
+    // different defines, different program keys
+    CHECK(HashString(ApplyDefines(source, { "A" })) != HashString(ApplyDefines(source, { "B" })));
+    CHECK(HashCombine(1, 2) != HashCombine(2, 1));
+}
+
+TEST_CASE(ShaderCache_RoundTripsAndRejectsDamagedEntries) {
+    TempDirectory dir("engine_shader_cache_test");
+    ShaderCache cache(dir.path);
+    CHECK(std::filesystem::is_directory(dir.path));
+    CHECK(!cache.Load(42));
+
+    ProgramBinary binary{ 0x1234, { 1, 2, 3, 4, 5, 6, 7 } };
+    CHECK(cache.Store(42, binary));
+    const std::optional<ProgramBinary> loaded = cache.Load(42);
+    CHECK(loaded && loaded->format == 0x1234 && loaded->data == binary.data);
+    CHECK(!cache.Load(43));
+
+    // an entry renamed to another key is not accepted for it
+    std::filesystem::copy_file(cache.PathOf(42), cache.PathOf(43));
+    CHECK(!cache.Load(43));
+
+    // truncated and overlong files read as misses
+    std::filesystem::resize_file(cache.PathOf(42), std::filesystem::file_size(cache.PathOf(42)) - 1);
+    CHECK(!cache.Load(42));
+    CHECK(cache.Store(42, binary));
+    if (std::FILE* file = std::fopen(cache.PathOf(42).string().c_str(), "ab")) {
+        std::fputc(0, file);
+        std::fclose(file);
+    }
+    CHECK(!cache.Load(42));
+
+    cache.Remove(42);
+    CHECK(!std::filesystem::exists(cache.PathOf(42)));
+
+    // an empty directory disables the cache
+    ShaderCache disabled{ std::filesystem::path() };
+    CHECK(!disabled.Enabled() && !disabled.Store(1, binary) && !disabled.Load(1));
+}
+
+TEST_CASE(ShaderPreprocessor_ExpandsIncludesOnceWithLineMarkers) {
+    const auto load = MapLoader({
+        { "lit.frag", "#version 330 core\n#include \"common.glsl\"\n#include \"lighting.glsl\"\nvoid main() {}\n" },
+        { "common.glsl", "#include \"lighting.glsl\"\nconst float PI = 3.14159;\n" },
+        { "lighting.glsl", "  #  include <common.glsl>\nvec3 Light() { return vec3(PI); }\n" },
+    });
+
+    const ShaderSource source = PreprocessShader("lit.frag", load);
+    CHECK(source.Ok());
+    CHECK(source.files == std::vector<std::string>{ "lit.frag", "common.glsl", "lighting.glsl" });
+    CHECK(source.text ==
+          "#version 330 core\n"
+          "#line 1 1\n"
+          "#line 1 2\n"
+          "\n"                                     // cycle back to common.glsl: skipped
+          "vec3 Light() { return vec3(PI); }\n"
+          "#line 2 1\n"
+          "const float PI = 3.14159;\n"
+          "#line 3 0\n"
+          "\n"                                     // lighting.glsl again: skipped
+          "void main() {}\n");
+
+    const ShaderSource missing = PreprocessShader("bad.frag", MapLoader({ { "bad.frag", "void a();\n#include \"nope.glsl\"\n" } }));
+    CHECK(!missing.Ok() && missing.error == "bad.frag:2: cannot open include \"nope.glsl\"");
+    CHECK(!PreprocessShader("bad.frag", MapLoader({ { "bad.frag", "#include nope\n" } })).Ok());
+    CHECK(!PreprocessShader("absent.frag", load).Ok());
+}
+
+TEST_CASE(ShaderPreprocessor_EnumeratesKeywordVariants) {
+    const auto load = MapLoader({
+        { "lit.vert", "#version 330 core\n#pragma multi_compile _ SKINNED\n#pragma optimize(on)\nvoid main() {}\n" },
+        { "lit.frag", "#version 330 core\n#pragma multi_compile FOG_OFF FOG_LINEAR FOG_EXP\n"
+                      "#pragma multi_compile _ SKINNED\n#pragma multi_compile SHADOWS\nvoid main() {}\n" },
+    });
+    const ShaderSource vert = PreprocessShader("lit.vert", load);
+    const ShaderSource frag = PreprocessShader("lit.frag", load);
+    CHECK(vert.keywordSets == std::vector<ShaderKeywordSet>{ { "_", "SKINNED" } });
+    CHECK(frag.keywordSets.size() == 3 && frag.keywordSets[2] == ShaderKeywordSet{ "_", "SHADOWS" });
+    // declarations become blank lines; other pragmas stay
+    CHECK(vert.text == "#version 330 core\n\n#pragma optimize(on)\nvoid main() {}\n");
+
+    std::vector<ShaderKeywordSet> sets = vert.keywordSets;
+    MergeKeywordSets(sets, frag.keywordSets);
+    CHECK(sets.size() == 3); // SKINNED is shared
+
+    const std::vector<std::vector<std::string>> variants = EnumerateVariants(sets);
+    CHECK(variants.size() == 2 * 3 * 2);
+    CHECK(variants.front() == std::vector<std::string>{ "FOG_OFF" });
+    CHECK(variants[1] == std::vector<std::string>{ "FOG_OFF", "SHADOWS" });
+    CHECK(variants.back() == std::vector<std::string>{ "SKINNED", "FOG_EXP", "SHADOWS" });
+    CHECK(EnumerateVariants({}).size() == 1 && EnumerateVariants({}).front().empty());
+
+    // the job-system path produces the same sources and hashes as the serial one
+    JobSystem jobs(3);
+    const std::vector<ShaderVariantSource> serial = BuildShaderVariants(vert, frag, nullptr);
+    const std::vector<ShaderVariantSource> parallel = BuildShaderVariants(vert, frag, &jobs);
+    CHECK(serial.size() == 12 && parallel.size() == 12);
+    bool same = true, distinct = true;
+    for (std::size_t i = 0; i < serial.size(); ++i) {
+        same = same && serial[i].defines == parallel[i].defines && serial[i].frag == parallel[i].frag
+                    && serial[i].vertHash == parallel[i].vertHash && serial[i].fragHash == parallel[i].fragHash;
+        for (std::size_t j = 0; j < i; ++j) distinct = distinct && serial[i].fragHash != serial[j].fragHash;
+    }
+    CHECK(same && distinct);
+    CHECK(serial[1].frag.find("#define FOG_OFF\n#define SHADOWS\n#line 2\n") != std::string::npos);
+    // SHADOWS and FOG_* are fragment-only keywords: the vertex stage does not change with them
+    CHECK(serial[0].vertHash == serial[1].vertHash && serial[0].vertHash == serial[5].vertHash);
+    CHECK(serial[0].vertHash != serial[6].vertHash); // SKINNED
+    CHECK(serial[6].vert.find("#define SKINNED\n") != std::string::npos && serial[6].vert.find("FOG") == std::string::npos);
+
+    // a permutation asked for by name (Load / Queue) is the prebuilt variant,
+    // whatever order its keywords come in, so the library finds it by key
+    const ShaderVariantSource named = BuildShaderVariant(vert, frag, { "SHADOWS", "FOG_OFF" });
+    CHECK(named.vertHash == serial[1].vertHash && named.fragHash == serial[1].fragHash);
+    CHECK(named.defines == serial[1].defines);
+    // defines no stage declares reach both stages
+    const ShaderVariantSource adHoc = BuildShaderVariant(vert, frag, { "SHADOWS", "MAX_LIGHTS 8" });
+    CHECK(adHoc.vert.find("#define MAX_LIGHTS 8\n") != std::string::npos && adHoc.vert.find("SHADOWS") == std::string::npos);
+    CHECK(adHoc.frag.find("#define MAX_LIGHTS 8\n#define SHADOWS\n") != std::string::npos);
+}
+
+TEST_CASE(ShaderProgram_ReflectsUniformsAndBindsEngineBlocks) {
+    RecordingGL gl;
+    gl.activeUniforms = { { "uTexture", GL_SAMPLER_2D, 1 }, { "uLights", GL_FLOAT_VEC4, 8 }, { "uExposure", GL_FLOAT, 1 } };
+    gl.activeBlocks = { { "ObjectData", 80 }, { "Material", 32 }, { "FrameData", 224 } };
+
+    ShaderProgram program(gl, 7);
+    CHECK(program.Uniforms().size() == 3);
+    CHECK(program.Location("uLights") >= 0 && program.Find("uLights")->size == 8); // "[0]" dropped
+    CHECK(program.Location("uTexture") >= 0 && program.Location("uExposure") >= 0);
+    CHECK(program.Location("uMissing") == -1);
+    CHECK(program.FindBlock("FrameData")->dataSize == int(sizeof(FrameUniforms)));
+    CHECK(program.FindBlock("Material")->binding == -1);
+
+    // engine blocks go to their binding points, others are left alone
+    std::map<unsigned, int> bindings; // block index -> binding
+    for (const RecordedCall& call : gl.calls)
+        if (call.op == RecordedCall::UniformBlockBinding) bindings[static_cast<unsigned>(call.count)] = call.instances;
+    CHECK(bindings == (std::map<unsigned, int>{ { 0, int(UniformBinding::Object) }, { 2, int(UniformBinding::Frame) } }));
+
+    // lookups after reflection never reach the driver
+    const std::size_t lookups = gl.Count(RecordedCall::GetUniformLocation);
+    for (int i = 0; i < 100; ++i) program.Set(gl, "uExposure", 1.5f);
+    program.Set(gl, "uMissing", 1.0f);
+    CHECK(gl.Count(RecordedCall::GetUniformLocation) == lookups);
+    CHECK(gl.Count(RecordedCall::Uniform1f) == 100 && gl.calls.back().matrix[0] == 1.5f);
+}
@@ -0,0 +1,15 @@
+#include "TestFramework.hpp"
+
+int main() {
+    int failedTests = 0;
+    for (const auto& tc : test::Registry()) {
+        const int before = test::FailureCount();
+        tc.fn();
+        const bool passed = test::FailureCount() == before;
+        if (!passed) ++failedTests;
+        std::cout << (passed ? "[ PASS ] " : "[ FAIL ] ") << tc.name << "\n";
+    }
+
+    std::cout << test::Registry().size() - failedTests << "/" << test::Registry().size() << " tests passed\n";
+    return failedTests == 0 ? 0 : 1;
+}